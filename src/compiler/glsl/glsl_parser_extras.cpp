@@ -1924,6 +1924,48 @@ add_builtin_defines(struct _mesa_glsl_parse_state *state,
    }
 }
 
+struct glsl_timings *_mesa_glsl_timings = NULL;
+
+/**
+ * Run the statement(s), adding the time taken to the \p name entry of
+ * _mesa_glsl_timings when timings are being collected.
+ */
+#define GLSL_TIME(name, ...) do {                                       \
+      if (unlikely(_mesa_glsl_timings)) {                               \
+         const uint64_t time_start = _mesa_glsl_timings->now();         \
+         __VA_ARGS__;                                                   \
+         _mesa_glsl_timings_add(name, _mesa_glsl_timings->now() -      \
+                                time_start);                            \
+      } else {                                                          \
+         __VA_ARGS__;                                                   \
+      }                                                                 \
+   } while (false)
+
+void
+_mesa_glsl_timings_add(const char *name, uint64_t ns)
+{
+   struct glsl_timings *t = _mesa_glsl_timings;
+   unsigned i;
+
+   for (i = 0; i < t->num_entries; i++) {
+      if (strcmp(t->entries[i].name, name) == 0)
+         break;
+   }
+
+   if (i == t->num_entries) {
+      if (i == GLSL_MAX_TIMINGS)
+         return;
+
+      t->entries[i].name = name;
+      t->entries[i].ns = 0;
+      t->entries[i].calls = 0;
+      t->num_entries++;
+   }
+
+   t->entries[i].ns += ns;
+   t->entries[i].calls++;
+}
+
 /* Implements parsing checks that we can't do during parsing */
 static void
 do_late_parsing_checks(struct _mesa_glsl_parse_state *state)
@@ -2062,14 +2104,16 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
       (void) p_atomic_cmpxchg(&ir_variable::temporaries_allocate_names,
                               false, true);
 
-   state->error = glcpp_preprocess(state, &source, &state->info_log,
-                                   add_builtin_defines, state, ctx);
+   GLSL_TIME("glcpp",
+             state->error = glcpp_preprocess(state, &source, &state->info_log,
+                                             add_builtin_defines, state, ctx));
 
    if (!state->error) {
-     _mesa_glsl_lexer_ctor(state, source);
-     _mesa_glsl_parse(state);
-     _mesa_glsl_lexer_dtor(state);
-     do_late_parsing_checks(state);
+      GLSL_TIME("parse",
+                _mesa_glsl_lexer_ctor(state, source);
+                _mesa_glsl_parse(state);
+                _mesa_glsl_lexer_dtor(state);
+                do_late_parsing_checks(state));
    }
 
    if (dump_ast) {
@@ -2082,7 +2126,7 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
    ralloc_free(shader->ir);
    shader->ir = new(shader) exec_list;
    if (!state->error && !state->translation_unit.is_empty())
-      _mesa_ast_to_hir(shader->ir, state);
+      GLSL_TIME("ast_to_hir", _mesa_ast_to_hir(shader->ir, state));
 
    if (!state->error) {
       validate_ir_tree(shader->ir);
@@ -2110,7 +2154,8 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
       lower_subroutine(shader->ir, state);
 
       if (!ctx->Cache || force_recompile)
-         opt_shader_and_create_symbol_table(ctx, shader);
+         GLSL_TIME("compile_opt",
+                   opt_shader_and_create_symbol_table(ctx, shader));
       else {
          reparent_ir(shader->ir, shader->ir);
          shader->CompileStatus = compiled_no_opts;
@@ -2165,7 +2210,7 @@ do_common_optimization(exec_list *ir, bool linked,
          fprintf(stderr, "GLSL optimization %s: %s progress\n",         \
                  #PASS, opt_progress ? "made" : "no");                  \
       } else {                                                          \
-         progress = PASS(__VA_ARGS__) || progress;                      \
+         GLSL_TIME(#PASS, progress = PASS(__VA_ARGS__) || progress);    \
       }                                                                 \
    } while (false)
 
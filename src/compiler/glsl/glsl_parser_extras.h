@@ -24,6 +24,8 @@
 #ifndef GLSL_PARSER_EXTRAS_H
 #define GLSL_PARSER_EXTRAS_H
 
+#include <stdint.h>
+
 /*
  * Most of the definitions here only apply to C++
  */
@@ -948,6 +950,30 @@ extern int glcpp_preprocess(void *ctx, const char **shader, char **info_log,
 extern void _mesa_destroy_shader_compiler(void);
 extern void _mesa_destroy_shader_compiler_caches(void);
 
+/**
+ * CPU time spent in each compiler stage and optimization pass.
+ *
+ * Only collected while _mesa_glsl_timings is set, which tools such as the
+ * standalone compiler do; drivers leave it NULL.  Not thread-safe.
+ */
+#define GLSL_MAX_TIMINGS 64
+
+struct glsl_timings {
+   /** Clock used for the measurements, in nanoseconds */
+   uint64_t (*now)(void);
+
+   unsigned num_entries;
+   struct {
+      const char *name;
+      uint64_t ns;
+      unsigned calls;
+   } entries[GLSL_MAX_TIMINGS];
+};
+
+extern struct glsl_timings *_mesa_glsl_timings;
+
+extern void _mesa_glsl_timings_add(const char *name, uint64_t ns);
+
 #ifdef __cplusplus
 }
 #endif
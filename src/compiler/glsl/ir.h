@@ -2402,6 +2402,15 @@ extern void
 do_set_program_inouts(exec_list *instructions, struct gl_program *prog,
                       gl_shader_stage shader_stage);
 
+/**
+ * Whether all the float variables of a GLSL ES shader are mediump or lowp
+ *
+ * \param version  GLSL ES version of the shader, which decides the
+ *                 precision of some built-in variables
+ */
+extern bool
+has_only_mediump_floats(exec_list *instructions, unsigned version);
+
 extern char *
 prototype_string(const glsl_type *return_type, const char *name,
 		 exec_list *parameters);
@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2017 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file ir_float_precision.cpp
+ *
+ * Determine whether all the float variables of a GLSL ES shader are
+ * mediump or lowp, so that the backend may evaluate the whole shader at
+ * reduced precision.
+ */
+
+#include "ir.h"
+#include "ir_hierarchical_visitor.h"
+
+/**
+ * Precision of a built-in float variable.
+ *
+ * Built-ins are declared without a precision qualifier in the IR, the
+ * precision they have is given by the GLSL ES specs instead.
+ */
+static unsigned
+builtin_precision(const ir_variable *var, unsigned version)
+{
+   const char *name = var->name;
+
+   /* GLSL ES 1.00 section 7.1 and 7.2 (Vertex and Fragment Shader Special
+    * Variables) and GLSL ES 3.00 section 7.1 (Built-In Language Variables).
+    */
+   if (strcmp(name, "gl_FragColor") == 0 ||
+       strcmp(name, "gl_FragData") == 0 ||
+       strcmp(name, "gl_PointCoord") == 0)
+      return GLSL_PRECISION_MEDIUM;
+
+   /* These became highp in GLSL ES 3.00. */
+   if (version < 300 &&
+       (strcmp(name, "gl_FragCoord") == 0 ||
+        strcmp(name, "gl_PointSize") == 0))
+      return GLSL_PRECISION_MEDIUM;
+
+   /* gl_Position, gl_FragDepth, gl_DepthRange and the rest. */
+   return GLSL_PRECISION_HIGH;
+}
+
+namespace {
+
+class ir_float_precision_visitor : public ir_hierarchical_visitor {
+public:
+   ir_float_precision_visitor(unsigned version)
+      : mediump(true), version(version)
+   {
+   }
+
+   virtual ir_visitor_status visit(ir_variable *ir)
+   {
+      /* Compiler generated temporaries don't get a precision. */
+      if (ir->data.mode == ir_var_temporary)
+         return visit_continue;
+
+      const glsl_type *type = ir->type->without_array();
+
+      if (type->is_record() || type->is_interface() || type->is_double()) {
+         mediump = false;
+         return visit_stop;
+      }
+
+      if (type->base_type != GLSL_TYPE_FLOAT)
+         return visit_continue;
+
+      unsigned precision = ir->data.precision;
+      if (is_gl_identifier(ir->name))
+         precision = builtin_precision(ir, version);
+
+      if (precision != GLSL_PRECISION_MEDIUM &&
+          precision != GLSL_PRECISION_LOW) {
+         mediump = false;
+         return visit_stop;
+      }
+      return visit_continue;
+   }
+
+   bool mediump;
+
+private:
+   unsigned version;
+};
+
+} /* anonymous namespace */
+
+bool
+has_only_mediump_floats(exec_list *instructions, unsigned version)
+{
+   ir_float_precision_visitor visitor(version);
+   visit_list_elements(&visitor, instructions);
+   return visitor.mediump;
+}
@@ -73,6 +73,7 @@
 #include "program.h"
 #include "program/prog_instruction.h"
 #include "program/program.h"
+#include "util/hash_table.h"
 #include "util/mesa-sha1.h"
 #include "util/set.h"
 #include "util/string_to_uint_map.h"
@@ -84,6 +85,7 @@
 #include "builtin_functions.h"
 #include "shader_cache.h"
 
+#include "main/shaderapi.h"
 #include "main/shaderobj.h"
 #include "main/enums.h"
 
@@ -4217,6 +4219,11 @@ build_program_resource_list(struct gl_context *ctx,
       shProg->data->NumProgramResourceList = 0;
    }
 
+   if (shProg->data->ProgramResourceHash) {
+      _mesa_hash_table_destroy(shProg->data->ProgramResourceHash, NULL);
+      shProg->data->ProgramResourceHash = NULL;
+   }
+
    int input_stage = MESA_SHADER_STAGES, output_stage = 0;
 
    /* Determine first input and final output stage. These are used to
@@ -4376,6 +4383,8 @@ build_program_resource_list(struct gl_context *ctx,
    }
 
    _mesa_set_destroy(resource_set, NULL);
+
+   _mesa_create_program_resource_hash(shProg);
 }
 
 /**
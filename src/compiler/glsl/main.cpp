@@ -45,6 +45,7 @@ const struct option compiler_opts[] = {
    { "dump-builder", no_argument, &options.dump_builder, 1 },
    { "link",     no_argument, &options.do_link,  1 },
    { "just-log", no_argument, &options.just_log, 1 },
+   { "corpus",   no_argument, &options.corpus,   1 },
    { "version",  required_argument, NULL, 'v' },
    { NULL, 0, NULL, 0 }
 };
@@ -58,9 +59,10 @@ usage_fail(const char *name)
 
    const char *header =
       "usage: %s [options] <file.vert | file.tesc | file.tese | file.geom | file.frag | file.comp>\n"
+      "       %s --corpus [options] <directory | file.shader_test>...\n"
       "\n"
       "Possible options are:\n";
-   printf(header, name);
+   printf(header, name, name);
    for (const struct option *o = compiler_opts; o->name != 0; ++o) {
       printf("    --%s\n", o->name);
    }
@@ -87,6 +89,9 @@ main(int argc, char * const* argv)
    if (argc <= optind)
       usage_fail(argv[0]);
 
+   if (options.corpus)
+      return standalone_compile_corpus(&options, argc - optind, &argv[optind]);
+
    struct gl_shader_program *whole_program;
 
    whole_program = standalone_compile_shader(&options, argc - optind, &argv[optind]);
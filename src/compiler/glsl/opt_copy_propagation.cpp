@@ -42,24 +42,171 @@
 
 namespace {
 
-class ir_copy_propagation_visitor : public ir_hierarchical_visitor {
+/**
+ * The available copies of one block.
+ *
+ * Entering an if or a loop used to clone the whole ACP of the enclosing
+ * block, and every kill walked all of it looking for copies of the killed
+ * variable, which made deeply nested control flow quadratic.  Instead,
+ * each block only records its own copies and kills, and falls back to the
+ * enclosing block's state for everything it hasn't touched.
+ */
+class copy_propagation_state {
 public:
-   ir_copy_propagation_visitor()
+   copy_propagation_state(copy_propagation_state *fallback)
+      : fallback(fallback), killed_all(false)
    {
-      progress = false;
-      mem_ctx = ralloc_context(0);
-      lin_ctx = linear_alloc_parent(mem_ctx, 0);
+      mem_ctx = ralloc_context(NULL);
       acp = _mesa_hash_table_create(mem_ctx, _mesa_hash_pointer,
                                     _mesa_key_pointer_equal);
+      rhs_uses = _mesa_hash_table_create(mem_ctx, _mesa_hash_pointer,
+                                         _mesa_key_pointer_equal);
       kills = _mesa_set_create(mem_ctx, _mesa_hash_pointer,
                                _mesa_key_pointer_equal);
-      killed_all = false;
    }
-   ~ir_copy_propagation_visitor()
+
+   ~copy_propagation_state()
    {
       ralloc_free(mem_ctx);
    }
 
+   ir_variable *lookup(ir_variable *var);
+   void add(ir_variable *lhs, ir_variable *rhs);
+   void kill(ir_variable *var);
+   void kill_all();
+
+   /** The state of the enclosing block, NULL if it isn't visible */
+   copy_propagation_state *fallback;
+
+   /** Hash of lhs->rhs: The copies made in this block */
+   hash_table *acp;
+
+   /** Hash of rhs->set of lhs: The copies in acp reading each variable */
+   hash_table *rhs_uses;
+
+   /**
+    * Set of ir_variables: Whose values were killed in this block.
+    */
+   set *kills;
+
+   /** Whether everything was killed, so the fallback doesn't apply */
+   bool killed_all;
+
+private:
+   bool killed_before(copy_propagation_state *state, ir_variable *var);
+
+   void *mem_ctx;
+};
+
+/**
+ * Whether var was killed in one of the blocks nested between this one
+ * and state.
+ */
+bool
+copy_propagation_state::killed_before(copy_propagation_state *state,
+                                      ir_variable *var)
+{
+   for (copy_propagation_state *s = this; s != state; s = s->fallback) {
+      if (_mesa_set_search(s->kills, var))
+         return true;
+   }
+
+   return false;
+}
+
+ir_variable *
+copy_propagation_state::lookup(ir_variable *var)
+{
+   for (copy_propagation_state *s = this; s; s = s->fallback) {
+      struct hash_entry *entry = _mesa_hash_table_search(s->acp, var);
+      if (entry) {
+         ir_variable *rhs = (ir_variable *) entry->data;
+
+         /* The copy was made in an enclosing block, and is no good if its
+          * source was overwritten since.
+          */
+         return killed_before(s, rhs) ? NULL : rhs;
+      }
+
+      if (s->killed_all || _mesa_set_search(s->kills, var))
+         return NULL;
+   }
+
+   return NULL;
+}
+
+void
+copy_propagation_state::add(ir_variable *lhs, ir_variable *rhs)
+{
+   _mesa_hash_table_insert(acp, lhs, rhs);
+
+   struct hash_entry *entry = _mesa_hash_table_search(rhs_uses, rhs);
+   set *uses;
+   if (entry) {
+      uses = (set *) entry->data;
+   } else {
+      uses = _mesa_set_create(mem_ctx, _mesa_hash_pointer,
+                              _mesa_key_pointer_equal);
+      _mesa_hash_table_insert(rhs_uses, rhs, uses);
+   }
+   _mesa_set_add(uses, lhs);
+}
+
+void
+copy_propagation_state::kill(ir_variable *var)
+{
+   assert(var != NULL);
+
+   /* Remove any entries currently in the ACP for this kill. */
+   struct hash_entry *entry = _mesa_hash_table_search(acp, var);
+   if (entry)
+      _mesa_hash_table_remove(acp, entry);
+
+   /* And the copies of it made in this block.  The ones made in enclosing
+    * blocks are caught by lookup() seeing the kill.
+    */
+   entry = _mesa_hash_table_search(rhs_uses, var);
+   if (entry) {
+      set *uses = (set *) entry->data;
+      struct set_entry *use;
+
+      set_foreach(uses, use) {
+         struct hash_entry *copy =
+            _mesa_hash_table_search(acp, use->key);
+
+         /* The lhs may have been overwritten with another copy since */
+         if (copy && copy->data == var)
+            _mesa_hash_table_remove(acp, copy);
+      }
+
+      _mesa_hash_table_remove(rhs_uses, entry);
+      _mesa_set_destroy(uses, NULL);
+   }
+
+   /* Add the LHS variable to the set of killed variables in this block. */
+   _mesa_set_add(kills, var);
+}
+
+void
+copy_propagation_state::kill_all()
+{
+   _mesa_hash_table_clear(acp, NULL);
+   _mesa_hash_table_clear(rhs_uses, NULL);
+   killed_all = true;
+}
+
+class ir_copy_propagation_visitor : public ir_hierarchical_visitor {
+public:
+   ir_copy_propagation_visitor()
+   {
+      progress = false;
+      state = new copy_propagation_state(NULL);
+   }
+   ~ir_copy_propagation_visitor()
+   {
+      delete state;
+   }
+
    virtual ir_visitor_status visit(class ir_dereference_variable *);
    void handle_loop(class ir_loop *, bool keep_acp);
    virtual ir_visitor_status visit_enter(class ir_loop *);
@@ -70,23 +217,13 @@ public:
    virtual ir_visitor_status visit_enter(class ir_if *);
 
    void add_copy(ir_assignment *ir);
-   void kill(ir_variable *ir);
    void handle_if_block(exec_list *instructions);
+   void leave_block(copy_propagation_state *orig_state);
 
-   /** Hash of lhs->rhs: The available copies to propagate */
-   hash_table *acp;
-
-   /**
-    * Set of ir_variables: Whose values were killed in this block.
-    */
-   set *kills;
+   /** The available copies of the current block */
+   copy_propagation_state *state;
 
    bool progress;
-
-   bool killed_all;
-
-   void *mem_ctx;
-   void *lin_ctx;
 };
 
 } /* unnamed namespace */
@@ -98,24 +235,14 @@ ir_copy_propagation_visitor::visit_enter(ir_function_signature *ir)
     * block.  Any instructions at global scope will be shuffled into
     * main() at link time, so they're irrelevant to us.
     */
-   hash_table *orig_acp = this->acp;
-   set *orig_kills = this->kills;
-   bool orig_killed_all = this->killed_all;
+   copy_propagation_state *orig_state = this->state;
 
-   acp = _mesa_hash_table_create(NULL, _mesa_hash_pointer,
-                                 _mesa_key_pointer_equal);
-   kills = _mesa_set_create(NULL, _mesa_hash_pointer,
-                            _mesa_key_pointer_equal);
-   this->killed_all = false;
+   this->state = new copy_propagation_state(NULL);
 
    visit_list_elements(this, &ir->body);
 
-   _mesa_hash_table_destroy(acp, NULL);
-   _mesa_set_destroy(kills, NULL);
-
-   this->kills = orig_kills;
-   this->acp = orig_acp;
-   this->killed_all = orig_killed_all;
+   delete this->state;
+   this->state = orig_state;
 
    return visit_continue_with_parent;
 }
@@ -123,7 +250,7 @@ ir_copy_propagation_visitor::visit_enter(ir_function_signature *ir)
 ir_visitor_status
 ir_copy_propagation_visitor::visit_leave(ir_assignment *ir)
 {
-   kill(ir->lhs->variable_referenced());
+   state->kill(ir->lhs->variable_referenced());
 
    add_copy(ir);
 
@@ -150,9 +277,9 @@ ir_copy_propagation_visitor::visit(ir_dereference_variable *ir)
    if (this->in_assignee)
       return visit_continue;
 
-   struct hash_entry *entry = _mesa_hash_table_search(acp, ir->var);
-   if (entry) {
-      ir->var = (ir_variable *) entry->data;
+   ir_variable *rhs = state->lookup(ir->var);
+   if (rhs) {
+      ir->var = rhs;
       progress = true;
    }
 
@@ -185,11 +312,10 @@ ir_copy_propagation_visitor::visit_enter(ir_call *ir)
     * and out parameters).
     */
    if (!ir->callee->is_intrinsic()) {
-      _mesa_hash_table_clear(acp, NULL);
-      this->killed_all = true;
+      state->kill_all();
    } else {
       if (ir->return_deref)
-         kill(ir->return_deref->var);
+         state->kill(ir->return_deref->var);
 
       foreach_two_lists(formal_node, &ir->callee->parameters,
                         actual_node, &ir->actual_parameters) {
@@ -198,7 +324,7 @@ ir_copy_propagation_visitor::visit_enter(ir_call *ir)
              sig_param->data.mode == ir_var_function_inout) {
             ir_rvalue *ir = (ir_rvalue *) actual_node;
             ir_variable *var = ir->variable_referenced();
-            kill(var);
+            state->kill(var);
          }
       }
    }
@@ -206,43 +332,39 @@ ir_copy_propagation_visitor::visit_enter(ir_call *ir)
    return visit_continue_with_parent;
 }
 
+/**
+ * Returns to the enclosing block's state, applying the kills of the block
+ * just visited to it.
+ */
 void
-ir_copy_propagation_visitor::handle_if_block(exec_list *instructions)
+ir_copy_propagation_visitor::leave_block(copy_propagation_state *orig_state)
 {
-   hash_table *orig_acp = this->acp;
-   set *orig_kills = this->kills;
-   bool orig_killed_all = this->killed_all;
-
-   acp = _mesa_hash_table_create(NULL, _mesa_hash_pointer,
-                                 _mesa_key_pointer_equal);
-   kills = _mesa_set_create(NULL, _mesa_hash_pointer,
-                            _mesa_key_pointer_equal);
-   this->killed_all = false;
-
-   /* Populate the initial acp with a copy of the original */
-   struct hash_entry *entry;
-   hash_table_foreach(orig_acp, entry) {
-      _mesa_hash_table_insert(acp, entry->key, entry->data);
-   }
+   copy_propagation_state *block_state = this->state;
 
-   visit_list_elements(this, instructions);
+   this->state = orig_state;
+
+   if (block_state->killed_all)
+      orig_state->kill_all();
 
-   if (this->killed_all) {
-      _mesa_hash_table_clear(orig_acp, NULL);
+   struct set_entry *entry;
+   set_foreach(block_state->kills, entry) {
+      orig_state->kill((ir_variable *) entry->key);
    }
 
-   set *new_kills = this->kills;
-   this->kills = orig_kills;
-   _mesa_hash_table_destroy(acp, NULL);
-   this->acp = orig_acp;
-   this->killed_all = this->killed_all || orig_killed_all;
+   delete block_state;
+}
 
-   struct set_entry *s_entry;
-   set_foreach(new_kills, s_entry) {
-      kill((ir_variable *) s_entry->key);
-   }
+void
+ir_copy_propagation_visitor::handle_if_block(exec_list *instructions)
+{
+   copy_propagation_state *orig_state = this->state;
+
+   /* The copies available before the if are available inside it too */
+   this->state = new copy_propagation_state(orig_state);
 
-   _mesa_set_destroy(new_kills, NULL);
+   visit_list_elements(this, instructions);
+
+   leave_block(orig_state);
 }
 
 ir_visitor_status
@@ -260,41 +382,13 @@ ir_copy_propagation_visitor::visit_enter(ir_if *ir)
 void
 ir_copy_propagation_visitor::handle_loop(ir_loop *ir, bool keep_acp)
 {
-   hash_table *orig_acp = this->acp;
-   set *orig_kills = this->kills;
-   bool orig_killed_all = this->killed_all;
-
-   acp = _mesa_hash_table_create(NULL, _mesa_hash_pointer,
-                                 _mesa_key_pointer_equal);
-   kills = _mesa_set_create(NULL, _mesa_hash_pointer,
-                            _mesa_key_pointer_equal);
-   this->killed_all = false;
-
-   if (keep_acp) {
-      struct hash_entry *entry;
-      hash_table_foreach(orig_acp, entry) {
-         _mesa_hash_table_insert(acp, entry->key, entry->data);
-      }
-   }
+   copy_propagation_state *orig_state = this->state;
 
-   visit_list_elements(this, &ir->body_instructions);
-
-   if (this->killed_all) {
-      _mesa_hash_table_clear(orig_acp, NULL);
-   }
-
-   set *new_kills = this->kills;
-   this->kills = orig_kills;
-   _mesa_hash_table_destroy(acp, NULL);
-   this->acp = orig_acp;
-   this->killed_all = this->killed_all || orig_killed_all;
+   this->state = new copy_propagation_state(keep_acp ? orig_state : NULL);
 
-   struct set_entry *entry;
-   set_foreach(new_kills, entry) {
-      kill((ir_variable *) entry->key);
-   }
+   visit_list_elements(this, &ir->body_instructions);
 
-   _mesa_set_destroy(new_kills, NULL);
+   leave_block(orig_state);
 }
 
 ir_visitor_status
@@ -314,27 +408,6 @@ ir_copy_propagation_visitor::visit_enter(ir_loop *ir)
    return visit_continue_with_parent;
 }
 
-void
-ir_copy_propagation_visitor::kill(ir_variable *var)
-{
-   assert(var != NULL);
-
-   /* Remove any entries currently in the ACP for this kill. */
-   struct hash_entry *entry = _mesa_hash_table_search(acp, var);
-   if (entry) {
-      _mesa_hash_table_remove(acp, entry);
-   }
-
-   hash_table_foreach(acp, entry) {
-      if (var == (ir_variable *) entry->data) {
-         _mesa_hash_table_remove(acp, entry);
-      }
-   }
-
-   /* Add the LHS variable to the set of killed variables in this block. */
-   _mesa_set_add(kills, var);
-}
-
 /**
  * Adds an entry to the available copy list if it's a plain assignment
  * of a variable to a variable.
@@ -362,7 +435,7 @@ ir_copy_propagation_visitor::add_copy(ir_assignment *ir)
                  lhs_var->data.precise == rhs_var->data.precise) {
          assert(lhs_var);
          assert(rhs_var);
-         _mesa_hash_table_insert(acp, lhs_var, rhs_var);
+         state->add(lhs_var, rhs_var);
       }
    }
 }
@@ -63,6 +63,7 @@
 
 extern "C" {
 #include "main/enums.h"
+#include "main/shaderapi.h"
 #include "main/shaderobj.h"
 #include "program/program.h"
 }
@@ -1065,6 +1066,8 @@ read_program_resource_list(struct blob_reader *metadata,
                       (uint8_t *) &prog->data->ProgramResourceList[i].StageReferences,
                       sizeof(prog->data->ProgramResourceList[i].StageReferences));
    }
+
+   _mesa_create_program_resource_hash(prog);
 }
 
 static void
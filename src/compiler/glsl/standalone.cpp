@@ -43,6 +43,13 @@
 #include "ir_builder_print_visitor.h"
 #include "builtin_functions.h"
 #include "opt_add_neg_to_sub.h"
+#include "glsl_to_nir.h"
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <time.h>
+#include <sys/stat.h>
+#endif
 
 class dead_variable_visitor : public ir_hierarchical_visitor {
 public:
@@ -373,6 +380,31 @@ load_text_file(void *ctx, const char *file_name)
    return text;
 }
 
+/* Returns the shader type for a file extension, or 0 if unknown. */
+static GLenum
+shader_type_from_file_name(const char *file_name)
+{
+   const unsigned len = strlen(file_name);
+   if (len < 6)
+      return 0;
+
+   const char *const ext = &file_name[len - 5];
+   if (strncmp(".vert", ext, 5) == 0 || strncmp(".glsl", ext, 5) == 0)
+      return GL_VERTEX_SHADER;
+   else if (strncmp(".tesc", ext, 5) == 0)
+      return GL_TESS_CONTROL_SHADER;
+   else if (strncmp(".tese", ext, 5) == 0)
+      return GL_TESS_EVALUATION_SHADER;
+   else if (strncmp(".geom", ext, 5) == 0)
+      return GL_GEOMETRY_SHADER;
+   else if (strncmp(".frag", ext, 5) == 0)
+      return GL_FRAGMENT_SHADER;
+   else if (strncmp(".comp", ext, 5) == 0)
+      return GL_COMPUTE_SHADER;
+   else
+      return 0;
+}
+
 void
 compile_shader(struct gl_context *ctx, struct gl_shader *shader)
 {
@@ -390,6 +422,40 @@ compile_shader(struct gl_context *ctx, struct gl_shader *shader)
    return;
 }
 
+static struct gl_shader_program *
+create_program(void)
+{
+   struct gl_shader_program *whole_program;
+
+   whole_program = rzalloc (NULL, struct gl_shader_program);
+   assert(whole_program != NULL);
+   whole_program->data = rzalloc(whole_program, struct gl_shader_program_data);
+   assert(whole_program->data != NULL);
+   whole_program->data->InfoLog = ralloc_strdup(whole_program->data, "");
+
+   /* Created just to avoid segmentation faults */
+   whole_program->AttributeBindings = new string_to_uint_map;
+   whole_program->FragDataBindings = new string_to_uint_map;
+   whole_program->FragDataIndexBindings = new string_to_uint_map;
+
+   return whole_program;
+}
+
+static void
+free_program(struct gl_shader_program *whole_program)
+{
+   for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
+      if (whole_program->_LinkedShaders[i])
+         ralloc_free(whole_program->_LinkedShaders[i]->Program);
+   }
+
+   delete whole_program->AttributeBindings;
+   delete whole_program->FragDataBindings;
+   delete whole_program->FragDataIndexBindings;
+
+   ralloc_free(whole_program);
+}
+
 extern "C" struct gl_shader_program *
 standalone_compile_shader(const struct standalone_options *_options,
       unsigned num_files, char* const* files)
@@ -431,18 +497,7 @@ standalone_compile_shader(const struct standalone_options *_options,
       initialize_context(ctx, options->glsl_version > 130 ? API_OPENGL_CORE : API_OPENGL_COMPAT);
    }
 
-   struct gl_shader_program *whole_program;
-
-   whole_program = rzalloc (NULL, struct gl_shader_program);
-   assert(whole_program != NULL);
-   whole_program->data = rzalloc(whole_program, struct gl_shader_program_data);
-   assert(whole_program->data != NULL);
-   whole_program->data->InfoLog = ralloc_strdup(whole_program->data, "");
-
-   /* Created just to avoid segmentation faults */
-   whole_program->AttributeBindings = new string_to_uint_map;
-   whole_program->FragDataBindings = new string_to_uint_map;
-   whole_program->FragDataIndexBindings = new string_to_uint_map;
+   struct gl_shader_program *whole_program = create_program();
 
    for (unsigned i = 0; i < num_files; i++) {
       whole_program->Shaders =
@@ -455,25 +510,9 @@ standalone_compile_shader(const struct standalone_options *_options,
       whole_program->Shaders[whole_program->NumShaders] = shader;
       whole_program->NumShaders++;
 
-      const unsigned len = strlen(files[i]);
-      if (len < 6)
-         goto fail;
-
-      const char *const ext = & files[i][len - 5];
-      /* TODO add support to read a .shader_test */
-      if (strncmp(".vert", ext, 5) == 0 || strncmp(".glsl", ext, 5) == 0)
-	 shader->Type = GL_VERTEX_SHADER;
-      else if (strncmp(".tesc", ext, 5) == 0)
-	 shader->Type = GL_TESS_CONTROL_SHADER;
-      else if (strncmp(".tese", ext, 5) == 0)
-	 shader->Type = GL_TESS_EVALUATION_SHADER;
-      else if (strncmp(".geom", ext, 5) == 0)
-	 shader->Type = GL_GEOMETRY_SHADER;
-      else if (strncmp(".frag", ext, 5) == 0)
-	 shader->Type = GL_FRAGMENT_SHADER;
-      else if (strncmp(".comp", ext, 5) == 0)
-         shader->Type = GL_COMPUTE_SHADER;
-      else
+      /* .shader_test files are only read in corpus mode */
+      shader->Type = shader_type_from_file_name(files[i]);
+      if (shader->Type == 0)
          goto fail;
       shader->Stage = _mesa_shader_enum_to_shader_stage(shader->Type);
 
@@ -595,16 +634,504 @@ fail:
 extern "C" void
 standalone_compiler_cleanup(struct gl_shader_program *whole_program)
 {
+   free_program(whole_program);
+   _mesa_glsl_release_types();
+   _mesa_glsl_release_builtin_functions();
+}
+
+
+#ifndef _WIN32
+
+/*
+ * Corpus mode: compile, link and convert to NIR every program found under
+ * a set of directories in a single process, timing each stage and
+ * measuring the ralloc memory used.
+ */
+
+#define CORPUS_MAX_SHADERS 16
+
+struct corpus_program {
+   unsigned num_shaders;
+   GLenum types[CORPUS_MAX_SHADERS];
+   const char *sources[CORPUS_MAX_SHADERS];
+};
+
+/* Top level stages, in order.  Everything else timed is an optimization
+ * pass, run as part of compile_opt or link.
+ */
+static const char *const corpus_stages[] = {
+   "glcpp",
+   "parse",
+   "ast_to_hir",
+   "compile_opt",
+   "link",
+   "lower_for_nir",
+   "glsl_to_nir",
+};
+
+static nir_shader_compiler_options corpus_nir_options;
+
+static uint64_t
+corpus_now(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static bool
+is_shader_test(const char *file_name)
+{
+   const unsigned len = strlen(file_name);
+
+   return len > 12 && strcmp(&file_name[len - 12], ".shader_test") == 0;
+}
+
+/**
+ * Split a shader_runner .shader_test file into its shaders.  The sources
+ * point into \p text, which gets a terminator written after each of them.
+ */
+static void
+parse_shader_test(char *text, struct corpus_program *prog)
+{
+   static const struct {
+      const char *name;
+      GLenum type;
+   } sections[] = {
+      { "[vertex shader]", GL_VERTEX_SHADER },
+      { "[tessellation control shader]", GL_TESS_CONTROL_SHADER },
+      { "[tessellation evaluation shader]", GL_TESS_EVALUATION_SHADER },
+      { "[geometry shader]", GL_GEOMETRY_SHADER },
+      { "[fragment shader]", GL_FRAGMENT_SHADER },
+      { "[compute shader]", GL_COMPUTE_SHADER },
+   };
+   bool in_shader = false;
+
+   for (char *line = text; line != NULL && *line != '\0'; ) {
+      char *next = strchr(line, '\n');
+      if (next)
+         next++;
+
+      if (line[0] == '[') {
+         /* End the previous shader at the newline before this section. */
+         if (in_shader)
+            line[-1] = '\0';
+         in_shader = false;
+
+         for (unsigned i = 0; i < ARRAY_SIZE(sections); i++) {
+            if (strncmp(line, sections[i].name,
+                        strlen(sections[i].name)) != 0 ||
+                prog->num_shaders == CORPUS_MAX_SHADERS)
+               continue;
+
+            prog->types[prog->num_shaders] = sections[i].type;
+            prog->sources[prog->num_shaders] = next ? next : "";
+            prog->num_shaders++;
+            in_shader = true;
+            break;
+         }
+      }
+
+      line = next;
+   }
+}
+
+/* Returns the #version of a shader, 110 if there is none. */
+static unsigned
+shader_glsl_version(const char *source, bool *es)
+{
+   const char *version = strstr(source, "#version");
+   char *end;
+
+   *es = false;
+   if (version == NULL)
+      return 110;
+
+   unsigned v = strtol(version + strlen("#version"), &end, 10);
+   while (*end == ' ' || *end == '\t')
+      end++;
+   *es = strncmp(end, "es", 2) == 0;
+
+   return v;
+}
+
+/**
+ * The version the context gets for a program, the lowest one that the
+ * standalone compiler supports and that can compile all of its shaders.
+ * \p es is set if any of the shaders has an "es" #version.  Returns 0 for
+ * unsupported versions, which includes GLSL ES 3.10 and 3.20.
+ */
+static unsigned
+corpus_context_version(const struct corpus_program *prog, bool *es)
+{
+   static const unsigned desktop_versions[] = {
+      110, 120, 130, 140, 150, 330, 400, 410, 420, 430, 440, 450
+   };
+   unsigned max_version = 0;
+
+   *es = false;
+   for (unsigned i = 0; i < prog->num_shaders; i++) {
+      bool shader_es;
+      unsigned v = shader_glsl_version(prog->sources[i], &shader_es);
+
+      max_version = MAX2(max_version, v);
+      *es = *es || shader_es;
+   }
+
+   if (*es)
+      return max_version == 100 || max_version == 300 ? max_version : 0;
+
+   for (unsigned i = 0; i < ARRAY_SIZE(desktop_versions); i++) {
+      if (desktop_versions[i] >= max_version)
+         return desktop_versions[i];
+   }
+
+   return 0;
+}
+
+static void
+find_corpus_files(void *mem_ctx, const char *path,
+                  char ***files, unsigned *num_files)
+{
+   struct stat st;
+
+   if (stat(path, &st) != 0) {
+      fprintf(stderr, "Cannot open %s\n", path);
+      return;
+   }
+
+   if (S_ISDIR(st.st_mode)) {
+      DIR *dir = opendir(path);
+      struct dirent *entry;
+
+      if (!dir)
+         return;
+
+      while ((entry = readdir(dir)) != NULL) {
+         if (entry->d_name[0] == '.')
+            continue;
+
+         find_corpus_files(mem_ctx,
+                           ralloc_asprintf(mem_ctx, "%s/%s", path,
+                                           entry->d_name),
+                           files, num_files);
+      }
+      closedir(dir);
+   } else if (is_shader_test(path) || shader_type_from_file_name(path)) {
+      *files = reralloc(mem_ctx, *files, char *, *num_files + 1);
+      (*files)[(*num_files)++] = ralloc_strdup(mem_ctx, path);
+   }
+}
+
+static int
+compare_file_names(const void *a, const void *b)
+{
+   return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+/* The lowering drivers do on linked GLSL IR before handing it to NIR. */
+static void
+lower_for_nir(exec_list *ir)
+{
+   do_mat_op_to_vec(ir);
+   lower_instructions(ir, DIV_TO_MUL_RCP | SUB_TO_ADD_NEG | EXP_TO_EXP2 |
+                          LOG_TO_LOG2 | DFREXP_DLDEXP_TO_ARITH);
+   do_lower_texture_projection(ir);
+   do_vec_index_to_cond_assign(ir);
+   lower_vector_insert(ir, true);
+   lower_offset_arrays(ir);
+   lower_noise(ir);
+   lower_quadop_vector(ir, false);
+}
+
+/**
+ * Compile, link and convert one program to NIR.  Returns a short
+ * description of the failure, or NULL on success.
+ */
+static const char *
+corpus_run_program(struct gl_context *ctx, const struct corpus_program *p)
+{
+   struct gl_shader_program *prog = create_program();
+   const char *error = NULL;
+   uint64_t start;
+
+   for (unsigned i = 0; i < p->num_shaders; i++) {
+      struct gl_shader *shader = rzalloc(prog, gl_shader);
+
+      prog->Shaders = reralloc(prog, prog->Shaders, struct gl_shader *,
+                               prog->NumShaders + 1);
+      prog->Shaders[prog->NumShaders++] = shader;
+
+      shader->Type = p->types[i];
+      shader->Stage = _mesa_shader_enum_to_shader_stage(shader->Type);
+      shader->Source = p->sources[i];
+
+      compile_shader(ctx, shader);
+
+      if (!shader->CompileStatus) {
+         error = "compile failed";
+         goto out;
+      }
+   }
+
+   _mesa_clear_shader_program_data(ctx, prog);
+
+   start = corpus_now();
+   link_shaders(ctx, prog);
+   _mesa_glsl_timings_add("link", corpus_now() - start);
+
+   if (!prog->data->LinkStatus) {
+      error = "link failed";
+      goto out;
+   }
+
    for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
-      if (whole_program->_LinkedShaders[i])
-         ralloc_free(whole_program->_LinkedShaders[i]->Program);
+      struct gl_linked_shader *shader = prog->_LinkedShaders[i];
+
+      if (!shader)
+         continue;
+
+      start = corpus_now();
+      lower_for_nir(shader->ir);
+      _mesa_glsl_timings_add("lower_for_nir", corpus_now() - start);
+
+      start = corpus_now();
+      ralloc_free(glsl_to_nir(prog, (gl_shader_stage) i,
+                              &corpus_nir_options));
+      _mesa_glsl_timings_add("glsl_to_nir", corpus_now() - start);
    }
 
-   delete whole_program->AttributeBindings;
-   delete whole_program->FragDataBindings;
-   delete whole_program->FragDataIndexBindings;
+out:
+   free_program(prog);
+   return error;
+}
 
-   ralloc_free(whole_program);
+static uint64_t
+timing_ns(const struct glsl_timings *t, const char *name)
+{
+   for (unsigned i = 0; i < t->num_entries; i++) {
+      if (strcmp(t->entries[i].name, name) == 0)
+         return t->entries[i].ns;
+   }
+   return 0;
+}
+
+static bool
+is_corpus_stage(const char *name)
+{
+   for (unsigned i = 0; i < ARRAY_SIZE(corpus_stages); i++) {
+      if (strcmp(corpus_stages[i], name) == 0)
+         return true;
+   }
+   return false;
+}
+
+static int
+compare_timings(const void *a, const void *b)
+{
+   const uint64_t ns_a = *(const uint64_t *) a;
+   const uint64_t ns_b = *(const uint64_t *) b;
+
+   return ns_a < ns_b ? 1 : ns_a > ns_b ? -1 : 0;
+}
+
+extern "C" int
+standalone_compile_corpus(const struct standalone_options *_options,
+                          unsigned num_paths, char* const* paths)
+{
+   static struct gl_context local_ctx;
+   struct gl_context *ctx = &local_ctx;
+   struct standalone_options corpus_options = *_options;
+   struct glsl_timings totals, program_timings;
+   void *mem_ctx = ralloc_context(NULL);
+   char **files = NULL;
+   unsigned num_files = 0;
+   unsigned num_programs = 0, num_failed = 0, num_skipped = 0;
+   unsigned context_version = 0;
+   bool context_es = false;
+   long long max_peak = 0;
+   const char *max_peak_file = NULL;
+   uint64_t total_ns = 0;
+
+   for (unsigned i = 0; i < num_paths; i++)
+      find_corpus_files(mem_ctx, paths[i], &files, &num_files);
+
+   if (num_files == 0) {
+      ralloc_free(mem_ctx);
+      return EXIT_FAILURE;
+   }
+
+   qsort(files, num_files, sizeof(*files), compare_file_names);
+
+   options = &corpus_options;
+   corpus_nir_options.native_integers = true;
+   memset(&totals, 0, sizeof(totals));
+   totals.now = corpus_now;
+
+   /* Don't charge the first program for the built-in functions. */
+   _mesa_glsl_initialize_builtin_functions();
+   ralloc_enable_stats(true);
+
+   for (unsigned f = 0; f < num_files; f++) {
+      struct corpus_program prog;
+      struct ralloc_stats mem;
+      unsigned version;
+      const char *skip = NULL;
+      bool es;
+
+      void *file_ctx = ralloc_context(mem_ctx);
+      char *text = load_text_file(file_ctx, files[f]);
+      if (text == NULL) {
+         ralloc_free(file_ctx);
+         continue;
+      }
+
+      memset(&prog, 0, sizeof(prog));
+      if (is_shader_test(files[f])) {
+         parse_shader_test(text, &prog);
+      } else {
+         prog.num_shaders = 1;
+         prog.types[0] = shader_type_from_file_name(files[f]);
+         prog.sources[0] = text;
+      }
+
+      version = corpus_context_version(&prog, &es);
+      if (version == 0)
+         skip = es ? "unsupported GLSL ES version" : "unsupported GLSL version";
+
+      /* A version given on the command line overrides the one of the
+       * shaders, but not the profile.
+       */
+      if (_options->glsl_version) {
+         version = _options->glsl_version;
+         skip = NULL;
+         if (es != (version == 100 || version == 300))
+            skip = es ? "GLSL ES shaders but desktop --version"
+                      : "desktop shaders but GLSL ES --version";
+      }
+
+      if (prog.num_shaders == 0)
+         skip = "no shaders";
+
+      if (skip) {
+         printf("%s: skipped, %s\n", files[f], skip);
+         num_skipped++;
+         ralloc_free(file_ctx);
+         continue;
+      }
+
+      if (version != context_version || es != context_es) {
+         corpus_options.glsl_version = version;
+         initialize_context(ctx, es ? API_OPENGLES2 :
+                            version > 130 ? API_OPENGL_CORE :
+                                            API_OPENGL_COMPAT);
+         context_version = version;
+         context_es = es;
+      }
+
+      memset(&program_timings, 0, sizeof(program_timings));
+      program_timings.now = corpus_now;
+      _mesa_glsl_timings = &program_timings;
+
+      ralloc_reset_peak();
+      ralloc_get_stats(&mem);
+      const long long base = mem.current;
+
+      const char *error = corpus_run_program(ctx, &prog);
+
+      ralloc_get_stats(&mem);
+      const long long peak = mem.peak - base;
+      _mesa_glsl_timings = NULL;
+
+      printf("%s: %u shaders", files[f], prog.num_shaders);
+      for (unsigned i = 0; i < ARRAY_SIZE(corpus_stages); i++) {
+         printf(", %s %.3f", corpus_stages[i],
+                timing_ns(&program_timings, corpus_stages[i]) / 1000000.0);
+      }
+      printf(" ms, %lld KB peak%s%s\n", peak / 1024,
+             error ? ", " : "", error ? error : "");
+
+      /* Merge into the totals */
+      _mesa_glsl_timings = &totals;
+      for (unsigned i = 0; i < program_timings.num_entries; i++) {
+         _mesa_glsl_timings_add(program_timings.entries[i].name,
+                                program_timings.entries[i].ns);
+         if (is_corpus_stage(program_timings.entries[i].name))
+            total_ns += program_timings.entries[i].ns;
+      }
+      _mesa_glsl_timings = NULL;
+
+      if (peak > max_peak) {
+         max_peak = peak;
+         max_peak_file = files[f];
+      }
+
+      num_programs++;
+      if (error)
+         num_failed++;
+
+      ralloc_free(file_ctx);
+   }
+
+   ralloc_enable_stats(false);
+
+   printf("; %u programs, %u failed, %u skipped, %.3f ms\n",
+          num_programs, num_failed, num_skipped, total_ns / 1000000.0);
+   if (max_peak_file) {
+      printf("; largest peak ralloc memory: %lld KB (%s)\n",
+             max_peak / 1024, max_peak_file);
+   }
+
+   printf("; cpu time per stage:\n");
+   for (unsigned i = 0; i < ARRAY_SIZE(corpus_stages); i++) {
+      const uint64_t ns = timing_ns(&totals, corpus_stages[i]);
+
+      printf(";   %-32s %10.3f ms  %5.1f%%\n", corpus_stages[i],
+             ns / 1000000.0, total_ns ? 100.0 * ns / total_ns : 0.0);
+   }
+
+   /* Sort the passes by time spent, the ns field comes first in a pair. */
+   struct {
+      uint64_t ns;
+      unsigned index;
+   } passes[GLSL_MAX_TIMINGS];
+   unsigned num_passes = 0;
+
+   for (unsigned i = 0; i < totals.num_entries; i++) {
+      if (is_corpus_stage(totals.entries[i].name))
+         continue;
+
+      passes[num_passes].ns = totals.entries[i].ns;
+      passes[num_passes].index = i;
+      num_passes++;
+   }
+   qsort(passes, num_passes, sizeof(passes[0]), compare_timings);
+
+   printf("; cpu time per optimization pass (in compile_opt and link):\n");
+   for (unsigned i = 0; i < num_passes; i++) {
+      printf(";   %-32s %10.3f ms  %8u runs\n",
+             totals.entries[passes[i].index].name,
+             passes[i].ns / 1000000.0,
+             totals.entries[passes[i].index].calls);
+   }
+
+   ralloc_free(mem_ctx);
    _mesa_glsl_release_types();
    _mesa_glsl_release_builtin_functions();
+
+   /* Failing programs are expected in a corpus, they are only reported. */
+   return EXIT_SUCCESS;
+}
+
+#else
+
+extern "C" int
+standalone_compile_corpus(const struct standalone_options *_options,
+                          unsigned num_paths, char* const* paths)
+{
+   fprintf(stderr, "Corpus mode is not supported on this platform\n");
+   return EXIT_FAILURE;
 }
+
+#endif
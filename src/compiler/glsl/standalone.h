@@ -36,6 +36,7 @@ struct standalone_options {
    int dump_builder;
    int do_link;
    int just_log;
+   int corpus;
 };
 
 struct gl_shader_program;
@@ -46,6 +47,14 @@ struct gl_shader_program * standalone_compile_shader(
 
 void standalone_compiler_cleanup(struct gl_shader_program *prog);
 
+/**
+ * Compile, link and convert to NIR every program in the given directories
+ * (.shader_test files and single shaders), printing per-stage times and
+ * peak ralloc memory.  Returns the exit status.
+ */
+int standalone_compile_corpus(const struct standalone_options *options,
+                              unsigned num_paths, char* const* paths);
+
 #ifdef __cplusplus
 }
 #endif
@@ -84,6 +84,11 @@ _mesa_shader_debug(struct gl_context *, GLenum, GLuint *,
 {
 }
 
+void
+_mesa_create_program_resource_hash(struct gl_shader_program *)
+{
+}
+
 struct gl_shader *
 _mesa_new_shader(GLuint name, gl_shader_stage stage)
 {
@@ -0,0 +1,140 @@
+/*
+ * Copyright © 2017 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+#include "main/compiler.h"
+#include "main/mtypes.h"
+#include "main/macros.h"
+#include "ir.h"
+
+/**
+ * \file float_precision_test.cpp
+ *
+ * Test the detection of GLSL ES shaders whose floats are all mediump.
+ */
+
+class float_precision : public ::testing::Test {
+public:
+   virtual void SetUp();
+   virtual void TearDown();
+
+   ir_variable *add_variable(const glsl_type *type, const char *name,
+                             ir_variable_mode mode, unsigned precision);
+
+   void *mem_ctx;
+   exec_list ir;
+};
+
+void
+float_precision::SetUp()
+{
+   this->mem_ctx = ralloc_context(NULL);
+   this->ir.make_empty();
+}
+
+void
+float_precision::TearDown()
+{
+   ralloc_free(this->mem_ctx);
+   this->mem_ctx = NULL;
+}
+
+ir_variable *
+float_precision::add_variable(const glsl_type *type, const char *name,
+                              ir_variable_mode mode, unsigned precision)
+{
+   ir_variable *const var = new(mem_ctx) ir_variable(type, name, mode);
+
+   var->data.precision = precision;
+   ir.push_tail(var);
+   return var;
+}
+
+/**
+ * precision mediump float;
+ * uniform sampler2D s;
+ * varying vec2 coord;
+ * void main() { gl_FragColor = texture2D(s, coord); }
+ */
+TEST_F(float_precision, es2_fragment_shader)
+{
+   add_variable(glsl_type::sampler2D_type, "s", ir_var_uniform,
+                GLSL_PRECISION_LOW);
+   add_variable(glsl_type::vec2_type, "coord", ir_var_shader_in,
+                GLSL_PRECISION_MEDIUM);
+   add_variable(glsl_type::vec4_type, "gl_FragColor", ir_var_shader_out,
+                GLSL_PRECISION_NONE);
+   add_variable(glsl_type::vec4_type, "texture_retval", ir_var_temporary,
+                GLSL_PRECISION_NONE);
+
+   EXPECT_TRUE(has_only_mediump_floats(&ir, 100));
+}
+
+TEST_F(float_precision, highp_variable)
+{
+   add_variable(glsl_type::vec2_type, "coord", ir_var_shader_in,
+                GLSL_PRECISION_HIGH);
+   add_variable(glsl_type::vec4_type, "gl_FragColor", ir_var_shader_out,
+                GLSL_PRECISION_NONE);
+
+   EXPECT_FALSE(has_only_mediump_floats(&ir, 100));
+}
+
+TEST_F(float_precision, unqualified_user_variable)
+{
+   add_variable(glsl_type::vec4_type, "color", ir_var_auto,
+                GLSL_PRECISION_NONE);
+
+   EXPECT_FALSE(has_only_mediump_floats(&ir, 100));
+}
+
+TEST_F(float_precision, non_float_variables)
+{
+   add_variable(glsl_type::int_type, "i", ir_var_uniform,
+                GLSL_PRECISION_HIGH);
+   add_variable(glsl_type::bool_type, "b", ir_var_auto,
+                GLSL_PRECISION_NONE);
+
+   EXPECT_TRUE(has_only_mediump_floats(&ir, 100));
+}
+
+TEST_F(float_precision, frag_coord)
+{
+   add_variable(glsl_type::vec4_type, "gl_FragCoord", ir_var_shader_in,
+                GLSL_PRECISION_NONE);
+   add_variable(glsl_type::get_array_instance(glsl_type::vec4_type, 4),
+                "gl_FragData", ir_var_shader_out, GLSL_PRECISION_NONE);
+
+   /* mediump in GLSL ES 1.00, highp in 3.00. */
+   EXPECT_TRUE(has_only_mediump_floats(&ir, 100));
+   EXPECT_FALSE(has_only_mediump_floats(&ir, 300));
+}
+
+TEST_F(float_precision, position)
+{
+   add_variable(glsl_type::vec4_type, "pos", ir_var_shader_in,
+                GLSL_PRECISION_MEDIUM);
+   add_variable(glsl_type::vec4_type, "gl_Position", ir_var_shader_out,
+                GLSL_PRECISION_NONE);
+
+   EXPECT_FALSE(has_only_mediump_floats(&ir, 100));
+}
@@ -0,0 +1,387 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Cross-stage optimization of the varyings between two linked shaders:
+ * outputs the consumer never reads are demoted to globals, outputs that are
+ * constant or a plain uniform are propagated into a fragment shader consumer,
+ * and the surviving generic varyings are packed into the lowest slots.
+ *
+ * These work on variables, so they must run before nir_lower_io, and only
+ * look at the generic, non-patch varyings (VARYING_SLOT_VAR0 and up) since
+ * the built-in ones may be consumed by fixed function hardware.
+ */
+
+#include "nir.h"
+#include "nir_builder.h"
+
+/**
+ * Returns the generic varying slots used by a variable, as a mask relative
+ * to VARYING_SLOT_VAR0, or 0 if the variable is not a generic varying.
+ */
+static uint64_t
+get_variable_io_mask(nir_variable *var, gl_shader_stage stage)
+{
+   if (var->data.patch || var->data.location < VARYING_SLOT_VAR0 ||
+       var->data.location >= VARYING_SLOT_MAX)
+      return 0;
+
+   const struct glsl_type *type = var->type;
+   if (nir_is_per_vertex_io(var, stage)) {
+      assert(glsl_type_is_array(type));
+      type = glsl_get_array_element(type);
+   }
+
+   unsigned location = var->data.location - VARYING_SLOT_VAR0;
+   unsigned slots = glsl_count_attribute_slots(type, false);
+   assert(location + slots <= MAX_VARYING);
+
+   return ((1ull << slots) - 1) << location;
+}
+
+static uint64_t
+get_io_mask(nir_shader *shader, struct exec_list *var_list)
+{
+   uint64_t mask = 0;
+
+   nir_foreach_variable(var, var_list)
+      mask |= get_variable_io_mask(var, shader->stage);
+
+   return mask;
+}
+
+/**
+ * Demotes the producer's generic outputs that the consumer doesn't declare
+ * as inputs to global variables, so that the usual dead code passes can
+ * remove them along with the code computing them.
+ *
+ * The consumer's input list is trusted to only hold inputs that are read,
+ * so run nir_remove_dead_variables() on it first.  Nothing is done when the
+ * producer is a tessellation control shader, which may read back its own
+ * outputs, or when it has transform feedback outputs.
+ */
+bool
+nir_remove_unused_varyings(nir_shader *producer, nir_shader *consumer)
+{
+   assert(producer->stage != MESA_SHADER_FRAGMENT);
+   assert(consumer->stage != MESA_SHADER_VERTEX);
+
+   if (producer->stage == MESA_SHADER_TESS_CTRL ||
+       producer->info.has_transform_feedback_varyings)
+      return false;
+
+   uint64_t read = get_io_mask(consumer, &consumer->inputs);
+   bool progress = false;
+
+   nir_foreach_variable_safe(var, &producer->outputs) {
+      uint64_t mask = get_variable_io_mask(var, producer->stage);
+      if (mask == 0 || (mask & read))
+         continue;
+
+      var->data.location = 0;
+      var->data.mode = nir_var_global;
+
+      exec_node_remove(&var->node);
+      exec_list_push_tail(&producer->globals, &var->node);
+
+      progress = true;
+   }
+
+   return progress;
+}
+
+static bool
+is_direct_vector_deref(nir_deref_var *deref)
+{
+   return deref->deref.child == NULL &&
+          glsl_type_is_vector_or_scalar(deref->var->type);
+}
+
+/**
+ * Returns the value stored last to an output in the producer, or NULL if
+ * the output isn't fully written by a single direct store at the end of the
+ * shader.
+ */
+static nir_ssa_def *
+get_final_output_value(nir_function_impl *impl, nir_variable *var)
+{
+   nir_foreach_instr_reverse(instr, nir_impl_last_block(impl)) {
+      if (instr->type != nir_instr_type_intrinsic)
+         continue;
+
+      nir_intrinsic_instr *intr = nir_instr_as_intrinsic(instr);
+      unsigned num_vars = nir_intrinsic_infos[intr->intrinsic].num_variables;
+      if (num_vars == 0 || intr->variables[0]->var != var)
+         continue;
+
+      /* The first access found is the last one executed: it has to be a
+       * store of all the components.
+       */
+      if (intr->intrinsic != nir_intrinsic_store_var ||
+          !is_direct_vector_deref(intr->variables[0]) ||
+          nir_intrinsic_write_mask(intr) !=
+          (1 << glsl_get_vector_elements(var->type)) - 1 ||
+          !intr->src[0].is_ssa)
+         return NULL;
+
+      return intr->src[0].ssa;
+   }
+
+   return NULL;
+}
+
+static nir_variable *
+find_uniform(nir_shader *shader, const char *name,
+             const struct glsl_type *type)
+{
+   if (name == NULL)
+      return NULL;
+
+   nir_foreach_variable(var, &shader->uniforms) {
+      if (var->name && strcmp(var->name, name) == 0 && var->type == type)
+         return var;
+   }
+
+   return NULL;
+}
+
+static bool
+replace_input_loads(nir_shader *consumer, nir_variable *input,
+                    nir_load_const_instr *value, nir_variable *uniform)
+{
+   nir_function_impl *impl = nir_shader_get_entrypoint(consumer);
+   bool progress = false;
+
+   nir_builder b;
+   nir_builder_init(&b, impl);
+
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr_safe(instr, block) {
+         if (instr->type != nir_instr_type_intrinsic)
+            continue;
+
+         nir_intrinsic_instr *intr = nir_instr_as_intrinsic(instr);
+         switch (intr->intrinsic) {
+         case nir_intrinsic_load_var:
+         case nir_intrinsic_interp_var_at_centroid:
+         case nir_intrinsic_interp_var_at_sample:
+         case nir_intrinsic_interp_var_at_offset:
+            break;
+         default:
+            continue;
+         }
+
+         if (intr->variables[0]->var != input ||
+             !is_direct_vector_deref(intr->variables[0]))
+            continue;
+
+         b.cursor = nir_before_instr(instr);
+
+         nir_ssa_def *def;
+         if (value) {
+            nir_load_const_instr *load =
+               nir_load_const_instr_create(consumer, value->def.num_components,
+                                           value->def.bit_size);
+            load->value = value->value;
+            nir_builder_instr_insert(&b, &load->instr);
+            def = &load->def;
+         } else {
+            def = nir_load_var(&b, uniform);
+         }
+
+         nir_ssa_def_rewrite_uses(&intr->dest.ssa, nir_src_for_ssa(def));
+         nir_instr_remove(instr);
+         progress = true;
+      }
+   }
+
+   if (progress) {
+      nir_metadata_preserve(impl, nir_metadata_block_index |
+                                  nir_metadata_dominance);
+   }
+
+   return progress;
+}
+
+/**
+ * Replaces the fragment shader inputs whose value is a constant, or a
+ * uniform also declared by the fragment shader, with that value.  The
+ * interpolation qualifiers don't matter since the input is the same for
+ * every vertex.  The producer keeps writing the output until it's removed
+ * by nir_remove_unused_varyings().
+ */
+bool
+nir_link_constant_varyings(nir_shader *producer, nir_shader *consumer)
+{
+   /* A geometry shader may emit a different value with every vertex, and
+    * tessellation control outputs are per-vertex arrays.
+    */
+   if (consumer->stage != MESA_SHADER_FRAGMENT ||
+       (producer->stage != MESA_SHADER_VERTEX &&
+        producer->stage != MESA_SHADER_TESS_EVAL))
+      return false;
+
+   nir_function_impl *impl = nir_shader_get_entrypoint(producer);
+   bool progress = false;
+
+   nir_foreach_variable(out, &producer->outputs) {
+      if (get_variable_io_mask(out, producer->stage) == 0 ||
+          !glsl_type_is_vector_or_scalar(out->type))
+         continue;
+
+      nir_ssa_def *value = get_final_output_value(impl, out);
+      if (value == NULL)
+         continue;
+
+      nir_load_const_instr *load_const = NULL;
+      nir_variable *uniform = NULL;
+
+      if (value->parent_instr->type == nir_instr_type_load_const) {
+         load_const = nir_instr_as_load_const(value->parent_instr);
+      } else if (value->parent_instr->type == nir_instr_type_intrinsic) {
+         nir_intrinsic_instr *load =
+            nir_instr_as_intrinsic(value->parent_instr);
+         if (load->intrinsic != nir_intrinsic_load_var ||
+             load->variables[0]->var->data.mode != nir_var_uniform ||
+             !is_direct_vector_deref(load->variables[0]))
+            continue;
+
+         nir_variable *var = load->variables[0]->var;
+         uniform = find_uniform(consumer, var->name, var->type);
+      }
+
+      if (load_const == NULL && uniform == NULL)
+         continue;
+
+      nir_foreach_variable(in, &consumer->inputs) {
+         if (in->data.location != out->data.location ||
+             in->data.location_frac != out->data.location_frac ||
+             in->type != out->type)
+            continue;
+
+         progress |= replace_input_loads(consumer, in, load_const, uniform);
+      }
+   }
+
+   return progress;
+}
+
+static void
+remap_io_vars(nir_shader *shader, struct exec_list *var_list,
+              const uint8_t *remap)
+{
+   nir_foreach_variable(var, var_list) {
+      if (get_variable_io_mask(var, shader->stage) == 0)
+         continue;
+
+      var->data.location =
+         VARYING_SLOT_VAR0 + remap[var->data.location - VARYING_SLOT_VAR0];
+   }
+}
+
+/**
+ * Moves the generic varyings shared by the two shaders down to the lowest
+ * slots, keeping their order so that multi-slot variables stay contiguous.
+ * Only call this when the two shaders are always used together, and
+ * re-gather the shader info afterwards.
+ */
+bool
+nir_compact_varyings(nir_shader *producer, nir_shader *consumer)
+{
+   if (producer->info.has_transform_feedback_varyings)
+      return false;
+
+   uint64_t used = get_io_mask(producer, &producer->outputs) |
+                   get_io_mask(consumer, &consumer->inputs);
+
+   uint8_t remap[MAX_VARYING];
+   unsigned next = 0;
+   bool progress = false;
+
+   for (unsigned i = 0; i < MAX_VARYING; i++) {
+      if (!(used & (1ull << i)))
+         continue;
+
+      remap[i] = next++;
+      if (remap[i] != i)
+         progress = true;
+   }
+
+   if (progress) {
+      remap_io_vars(producer, &producer->outputs, remap);
+      remap_io_vars(consumer, &consumer->inputs, remap);
+   }
+
+   return progress;
+}
+
+static void
+optimize_linked_shader(nir_shader *shader)
+{
+   bool progress;
+
+   nir_lower_global_vars_to_local(shader);
+   nir_remove_dead_variables(shader, nir_var_local | nir_var_shader_in);
+
+   do {
+      progress = false;
+      progress |= nir_copy_prop(shader);
+      progress |= nir_opt_dce(shader);
+      progress |= nir_opt_dead_cf(shader);
+      progress |= nir_opt_constant_folding(shader);
+   } while (progress);
+}
+
+/**
+ * Runs the passes above on a pair of linked shaders until nothing changes,
+ * cleaning up both shaders in between, then compacts the remaining
+ * varyings.  Returns whether either shader was changed.
+ */
+bool
+nir_link_opt_varyings(nir_shader *producer, nir_shader *consumer)
+{
+   bool any_progress = false;
+   bool progress;
+
+   nir_remove_dead_variables(consumer, nir_var_shader_in);
+
+   do {
+      progress = false;
+
+      if (nir_link_constant_varyings(producer, consumer)) {
+         optimize_linked_shader(consumer);
+         progress = true;
+      }
+
+      if (nir_remove_unused_varyings(producer, consumer)) {
+         optimize_linked_shader(producer);
+         progress = true;
+      }
+
+      any_progress |= progress;
+   } while (progress);
+
+   any_progress |= nir_compact_varyings(producer, consumer);
+
+   return any_progress;
+}
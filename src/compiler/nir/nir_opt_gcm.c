@@ -68,6 +68,9 @@ struct gcm_state {
    struct exec_list instrs;
 
    struct gcm_block_info *blocks;
+
+   /* Whether any instruction ended up in a different block */
+   bool progress;
 };
 
 /* Recursively walks the CFG and builds the block_info structure */
@@ -99,76 +102,135 @@ gcm_build_block_info(struct exec_list *cf_list, struct gcm_state *state,
    }
 }
 
-/* Walks the instruction list and marks immovable instructions as pinned
- *
- * This function also serves to initialize the instr->pass_flags field.
- * After this is completed, all instructions' pass_flags fields will be set
- * to either GCM_INSTR_PINNED or 0.
- */
 static bool
-gcm_pin_instructions_block(nir_block *block, struct gcm_state *state)
+src_is_ssa(nir_src *src, void *state)
 {
-   nir_foreach_instr_safe(instr, block) {
-      switch (instr->type) {
-      case nir_instr_type_alu:
-         switch (nir_instr_as_alu(instr)->op) {
-         case nir_op_fddx:
-         case nir_op_fddy:
-         case nir_op_fddx_fine:
-         case nir_op_fddy_fine:
-         case nir_op_fddx_coarse:
-         case nir_op_fddy_coarse:
-            /* These can only go in uniform control flow; pin them for now */
-            instr->pass_flags = GCM_INSTR_PINNED;
-            break;
-
-         default:
-            instr->pass_flags = 0;
-            break;
-         }
-         break;
+   return src->is_ssa;
+}
 
-      case nir_instr_type_tex:
-         switch (nir_instr_as_tex(instr)->op) {
-         case nir_texop_tex:
-         case nir_texop_txb:
-         case nir_texop_lod:
-            /* These two take implicit derivatives so they need to be pinned */
-            instr->pass_flags = GCM_INSTR_PINNED;
-            break;
+static bool
+dest_is_ssa(nir_dest *dest, void *state)
+{
+   return dest->is_ssa;
+}
 
-         default:
-            instr->pass_flags = 0;
-            break;
-         }
-         break;
+/** Returns whether an instruction may be moved across control flow
+ *
+ * A movable instruction only depends on its sources: it computes the same
+ * value in any block dominated by its sources that dominates its uses.
+ * Anything reading or writing registers stays put.
+ *
+ * Only ALU instructions and constants are also safe to execute
+ * speculatively.  Loads and texture instructions may fault or read out of
+ * bounds when executed in a block their original one didn't run in, so
+ * callers have to keep them in blocks executed whenever the original is.
+ */
+bool
+nir_instr_is_movable(nir_instr *instr)
+{
+   if (!nir_foreach_src(instr, src_is_ssa, NULL) ||
+       !nir_foreach_dest(instr, dest_is_ssa, NULL))
+      return false;
+
+   switch (instr->type) {
+   case nir_instr_type_alu:
+      switch (nir_instr_as_alu(instr)->op) {
+      case nir_op_fddx:
+      case nir_op_fddy:
+      case nir_op_fddx_fine:
+      case nir_op_fddy_fine:
+      case nir_op_fddx_coarse:
+      case nir_op_fddy_coarse:
+         /* These can only go in uniform control flow */
+         return false;
 
-      case nir_instr_type_load_const:
-         instr->pass_flags = 0;
-         break;
+      default:
+         return true;
+      }
 
-      case nir_instr_type_intrinsic: {
-         const nir_intrinsic_info *info =
-            &nir_intrinsic_infos[nir_instr_as_intrinsic(instr)->intrinsic];
+   case nir_instr_type_tex:
+      switch (nir_instr_as_tex(instr)->op) {
+      case nir_texop_tex:
+      case nir_texop_txb:
+      case nir_texop_lod:
+         /* These take implicit derivatives */
+         return false;
 
-         if ((info->flags & NIR_INTRINSIC_CAN_ELIMINATE) &&
-             (info->flags & NIR_INTRINSIC_CAN_REORDER)) {
-            instr->pass_flags = 0;
-         } else {
-            instr->pass_flags = GCM_INSTR_PINNED;
-         }
-         break;
+      default:
+         return true;
       }
 
-      case nir_instr_type_jump:
-      case nir_instr_type_ssa_undef:
-      case nir_instr_type_phi:
-         instr->pass_flags = GCM_INSTR_PINNED;
-         break;
+   case nir_instr_type_load_const:
+      return true;
+
+   case nir_instr_type_intrinsic: {
+      nir_intrinsic_instr *intrin = nir_instr_as_intrinsic(instr);
+      const nir_intrinsic_info *info = &nir_intrinsic_infos[intrin->intrinsic];
+
+      /* Anything with side effects, or reading memory that may be written
+       * by the shader, has to stay where it is.
+       */
+      if (!(info->flags & NIR_INTRINSIC_CAN_ELIMINATE) ||
+          !(info->flags & NIR_INTRINSIC_CAN_REORDER))
+         return false;
+
+      switch (intrin->intrinsic) {
+      case nir_intrinsic_interp_var_at_centroid:
+      case nir_intrinsic_interp_var_at_sample:
+      case nir_intrinsic_interp_var_at_offset:
+      case nir_intrinsic_load_barycentric_at_sample:
+      case nir_intrinsic_load_barycentric_at_offset:
+         /* Some backends compute these from derivatives of the
+          * barycentrics, so like derivatives they need uniform control
+          * flow.
+          */
+         return false;
 
       default:
-         unreachable("Invalid instruction type in GCM");
+         return true;
       }
+   }
+
+   case nir_instr_type_jump:
+   case nir_instr_type_ssa_undef:
+   case nir_instr_type_phi:
+   case nir_instr_type_call:
+   case nir_instr_type_parallel_copy:
+      return false;
+
+   default:
+      unreachable("Invalid instruction type");
+   }
+}
+
+/* GCM places instructions in blocks that may run when their original block
+ * doesn't, such as before an if statement or a loop's breaks, so it only
+ * moves what is safe to execute speculatively.
+ */
+static bool
+gcm_instr_is_movable(nir_instr *instr)
+{
+   switch (instr->type) {
+   case nir_instr_type_alu:
+   case nir_instr_type_load_const:
+      return nir_instr_is_movable(instr);
+
+   default:
+      return false;
+   }
+}
+
+/* Walks the instruction list and marks immovable instructions as pinned
+ *
+ * This function also serves to initialize the instr->pass_flags field.
+ * After this is completed, all instructions' pass_flags fields will be set
+ * to either GCM_INSTR_PINNED or 0.
+ */
+static bool
+gcm_pin_instructions_block(nir_block *block, struct gcm_state *state)
+{
+   nir_foreach_instr_safe(instr, block) {
+      instr->pass_flags = gcm_instr_is_movable(instr) ? 0 : GCM_INSTR_PINNED;
 
       if (!(instr->pass_flags & GCM_INSTR_PINNED)) {
          /* If this is an unpinned instruction, go ahead and pull it out of
@@ -184,6 +246,9 @@ gcm_pin_instructions_block(nir_block *block, struct gcm_state *state)
           */
          exec_node_remove(&instr->node);
          exec_list_push_tail(&state->instrs, &instr->node);
+
+         /* Remember where it came from to tell if we made progress */
+         instr->index = block->index;
       }
    }
 
@@ -320,6 +385,15 @@ gcm_schedule_late_def(nir_ssa_def *def, void *void_state)
    if (lca == NULL)
       return true;
 
+   /* Constants cost nothing to materialize where they're used, while
+    * hoisting them would keep them live across whole loops.  Leave them in
+    * the LCA.
+    */
+   if (def->parent_instr->type == nir_instr_type_load_const) {
+      def->parent_instr->block = lca;
+      return true;
+   }
+
    /* We now have the LCA of all of the uses.  If our invariants hold,
     * this is dominated by the block that we chose when scheduling early.
     * We now walk up the dominance tree and pick the lowest block that is
@@ -434,6 +508,9 @@ gcm_place_instr(nir_instr *instr, struct gcm_state *state)
 
    struct gcm_block_info *block_info = &state->blocks[instr->block->index];
    if (!(instr->pass_flags & GCM_INSTR_PINNED)) {
+      if (instr->block->index != instr->index)
+         state->progress = true;
+
       exec_node_remove(&instr->node);
 
       if (block_info->last_instr) {
@@ -463,6 +540,7 @@ opt_gcm_impl(nir_function_impl *impl, bool value_number)
 
    state.impl = impl;
    state.instr = NULL;
+   state.progress = false;
    exec_list_make_empty(&state.instrs);
    state.blocks = rzalloc_array(NULL, struct gcm_block_info, impl->num_blocks);
 
@@ -498,6 +576,8 @@ opt_gcm_impl(nir_function_impl *impl, bool value_number)
 
    ralloc_free(state.blocks);
 
+   progress |= state.progress;
+
    nir_metadata_preserve(impl, nir_metadata_block_index |
                                nir_metadata_dominance);
 
@@ -0,0 +1,346 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "nir.h"
+
+/*
+ * Implements loop-invariant code motion.  Every movable instruction (see
+ * nir_instr_is_movable) in a loop whose sources are all defined outside of
+ * the loop is moved to the block right before it.  Inner loops are handled
+ * first so that what gets hoisted out of them can then be hoisted out of
+ * the outer loops as well.
+ *
+ * Unlike GCM, this leaves everything that isn't loop invariant alone, so it
+ * is cheap enough to run in the main optimization loop.
+ *
+ * Three things keep this from making things worse:
+ *
+ *  - Constants are only hoisted along with an instruction using them.
+ *    Hoisting a constant on its own only makes it live across the whole
+ *    loop, when it would otherwise be an immediate.
+ *
+ *  - Intrinsics, mostly uniform and input loads, and texture instructions
+ *    are only hoisted from blocks which dominate every exit of the loop,
+ *    that is blocks which are executed at least once whenever the loop
+ *    terminates.  Anything else may be guarded by a condition, a break or a
+ *    continue, and could fault or read out of bounds when executed
+ *    unconditionally.
+ *
+ *  - Every hoisted value is live across the whole loop.  We keep track of
+ *    how many components hoisting added to the registers live in the loop,
+ *    net of the invariant sources it stops being live there, and stop
+ *    hoisting instructions which add more once LICM_MAX_LIVE_COMPONENTS is
+ *    reached.  Spilling in the loop would cost a lot more than recomputing
+ *    a few invariant values on every iteration.
+ */
+
+#define LICM_MAX_LIVE_COMPONENTS 64
+
+struct licm_state {
+   /* The block indices of the loop body */
+   unsigned first_block, last_block;
+
+   /* Where invariant instructions go */
+   nir_block *preheader;
+
+   nir_loop *loop;
+
+   /* Components hoisting has added to what is live across the loop */
+   int live_components;
+};
+
+static bool
+instr_is_in_loop(nir_instr *instr, struct licm_state *state)
+{
+   return instr->block->index >= state->first_block &&
+          instr->block->index <= state->last_block;
+}
+
+static bool
+src_is_invariant(nir_src *src, void *void_state)
+{
+   struct licm_state *state = void_state;
+   nir_instr *parent = src->ssa->parent_instr;
+
+   return !instr_is_in_loop(parent, state) ||
+          parent->type == nir_instr_type_load_const;
+}
+
+static void
+hoist_instr(nir_instr *instr, struct licm_state *state)
+{
+   /* We don't use nir_instr_remove and nir_instr_insert here because we
+    * want to keep the use/def information.
+    */
+   exec_node_remove(&instr->node);
+   instr->block = state->preheader;
+
+   nir_instr *jump_instr = nir_block_last_instr(state->preheader);
+   if (jump_instr && jump_instr->type == nir_instr_type_jump) {
+      exec_node_insert_node_before(&jump_instr->node, &instr->node);
+   } else {
+      exec_list_push_tail(&state->preheader->instr_list, &instr->node);
+   }
+}
+
+static bool
+hoist_const_src(nir_src *src, void *void_state)
+{
+   struct licm_state *state = void_state;
+   nir_instr *parent = src->ssa->parent_instr;
+
+   if (instr_is_in_loop(parent, state)) {
+      assert(parent->type == nir_instr_type_load_const);
+      hoist_instr(parent, state);
+   }
+
+   return true;
+}
+
+static nir_loop *
+innermost_loop(nir_block *block)
+{
+   nir_cf_node *node = block->cf_node.parent;
+
+   while (node->type != nir_cf_node_loop)
+      node = node->parent;
+
+   return nir_cf_node_as_loop(node);
+}
+
+/* Returns whether the block is executed before the loop is left, whichever
+ * break or return leaves it.
+ */
+static bool
+block_dominates_exits(nir_block *block, struct licm_state *state)
+{
+   nir_foreach_block_in_cf_node(other, &state->loop->cf_node) {
+      nir_instr *last = nir_block_last_instr(other);
+      if (!last || last->type != nir_instr_type_jump)
+         continue;
+
+      switch (nir_instr_as_jump(last)->type) {
+      case nir_jump_continue:
+         continue;
+
+      case nir_jump_break:
+         /* Breaks out of inner loops stay in this one */
+         if (innermost_loop(other) != state->loop)
+            continue;
+         break;
+
+      case nir_jump_return:
+         break;
+      }
+
+      if (!nir_block_dominates(block, other))
+         return false;
+   }
+
+   return true;
+}
+
+static bool
+can_hoist(nir_instr *instr, bool dominates_exits, struct licm_state *state)
+{
+   switch (instr->type) {
+   case nir_instr_type_alu:
+      break;
+
+   case nir_instr_type_tex:
+   case nir_instr_type_intrinsic:
+      if (!dominates_exits)
+         return false;
+      break;
+
+   default:
+      /* Constants are only hoisted as sources, see above */
+      return false;
+   }
+
+   return nir_instr_is_movable(instr) &&
+          nir_foreach_src(instr, src_is_invariant, state);
+}
+
+struct hoist_cost_state {
+   struct licm_state *licm;
+   nir_instr *instr;
+   int cost;
+};
+
+static bool
+add_dest_cost(nir_dest *dest, void *void_state)
+{
+   struct hoist_cost_state *state = void_state;
+
+   state->cost += dest->ssa.num_components;
+   return true;
+}
+
+static bool
+sub_src_cost(nir_src *src, void *void_state)
+{
+   struct hoist_cost_state *state = void_state;
+   nir_ssa_def *def = src->ssa;
+   nir_src *first_use = NULL;
+
+   /* Constants are mostly folded into their users by the backends */
+   if (def->parent_instr->type == nir_instr_type_load_const ||
+       !list_empty(&def->if_uses))
+      return true;
+
+   /* The source stops being live across the loop if nothing else but
+    * instructions before the loop use it.
+    */
+   nir_foreach_use(use, def) {
+      if (use->parent_instr == state->instr) {
+         if (!first_use)
+            first_use = use;
+      } else if (use->parent_instr->block->index >= state->licm->first_block) {
+         return true;
+      }
+   }
+
+   /* Only count sources used several times by the instruction once */
+   if (first_use == src)
+      state->cost -= def->num_components;
+
+   return true;
+}
+
+/* Returns how many more components are live across the loop once the
+ * instruction is hoisted.
+ */
+static int
+hoist_cost(nir_instr *instr, struct licm_state *licm)
+{
+   struct hoist_cost_state state = {
+      .licm = licm,
+      .instr = instr,
+      .cost = 0,
+   };
+
+   nir_foreach_dest(instr, add_dest_cost, &state);
+   nir_foreach_src(instr, sub_src_cost, &state);
+
+   return state.cost;
+}
+
+static bool
+licm_loop(nir_loop *loop)
+{
+   struct licm_state state;
+   bool progress = false;
+
+   state.first_block = nir_loop_first_block(loop)->index;
+   state.last_block = nir_loop_last_block(loop)->index;
+   state.preheader = nir_cf_node_as_block(nir_cf_node_prev(&loop->cf_node));
+   state.loop = loop;
+   state.live_components = 0;
+
+   /* Blocks are in program order, so sources are always visited before
+    * their uses and whole chains of invariant instructions get hoisted in
+    * one walk.
+    */
+   nir_foreach_block_in_cf_node(block, &loop->cf_node) {
+      const bool dominates_exits = block_dominates_exits(block, &state);
+
+      nir_foreach_instr_safe(instr, block) {
+         if (!can_hoist(instr, dominates_exits, &state))
+            continue;
+
+         int cost = hoist_cost(instr, &state);
+         if (cost > 0 &&
+             state.live_components + cost > LICM_MAX_LIVE_COMPONENTS)
+            continue;
+
+         state.live_components += cost;
+         nir_foreach_src(instr, hoist_const_src, &state);
+         hoist_instr(instr, &state);
+         progress = true;
+      }
+   }
+
+   return progress;
+}
+
+static bool
+licm_cf_list(struct exec_list *cf_list)
+{
+   bool progress = false;
+
+   foreach_list_typed(nir_cf_node, node, node, cf_list) {
+      switch (node->type) {
+      case nir_cf_node_block:
+         break;
+
+      case nir_cf_node_if: {
+         nir_if *if_stmt = nir_cf_node_as_if(node);
+         progress |= licm_cf_list(&if_stmt->then_list);
+         progress |= licm_cf_list(&if_stmt->else_list);
+         break;
+      }
+
+      case nir_cf_node_loop: {
+         nir_loop *loop = nir_cf_node_as_loop(node);
+         progress |= licm_cf_list(&loop->body);
+         progress |= licm_loop(loop);
+         break;
+      }
+
+      default:
+         unreachable("Invalid CF node type");
+      }
+   }
+
+   return progress;
+}
+
+static bool
+opt_licm_impl(nir_function_impl *impl)
+{
+   nir_metadata_require(impl, nir_metadata_block_index |
+                              nir_metadata_dominance);
+
+   bool progress = licm_cf_list(&impl->body);
+
+   if (progress) {
+      nir_metadata_preserve(impl, nir_metadata_block_index |
+                                  nir_metadata_dominance);
+   }
+
+   return progress;
+}
+
+bool
+nir_opt_licm(nir_shader *shader)
+{
+   bool progress = false;
+
+   nir_foreach_function(function, shader) {
+      if (function->impl)
+         progress |= opt_licm_impl(function->impl);
+   }
+
+   return progress;
+}
@@ -0,0 +1,373 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+#include "nir.h"
+#include "nir_builder.h"
+
+class nir_code_motion_test : public ::testing::Test {
+protected:
+   nir_code_motion_test();
+   ~nir_code_motion_test();
+
+   nir_ssa_def *load_uniform(unsigned base, unsigned num_components);
+   nir_ssa_def *load_ssbo();
+   void store_output(nir_ssa_def *value);
+   void break_if(nir_ssa_def *condition);
+
+   nir_builder b;
+};
+
+nir_code_motion_test::nir_code_motion_test()
+{
+   static const nir_shader_compiler_options options = { };
+   nir_builder_init_simple_shader(&b, NULL, MESA_SHADER_FRAGMENT, &options);
+}
+
+nir_code_motion_test::~nir_code_motion_test()
+{
+   ralloc_free(b.shader);
+}
+
+nir_ssa_def *
+nir_code_motion_test::load_uniform(unsigned base, unsigned num_components)
+{
+   nir_intrinsic_instr *load =
+      nir_intrinsic_instr_create(b.shader, nir_intrinsic_load_uniform);
+   load->num_components = num_components;
+   nir_intrinsic_set_base(load, base);
+   load->src[0] = nir_src_for_ssa(nir_imm_int(&b, 0));
+   nir_ssa_dest_init(&load->instr, &load->dest, num_components, 32, NULL);
+   nir_builder_instr_insert(&b, &load->instr);
+
+   return &load->dest.ssa;
+}
+
+nir_ssa_def *
+nir_code_motion_test::load_ssbo()
+{
+   nir_intrinsic_instr *load =
+      nir_intrinsic_instr_create(b.shader, nir_intrinsic_load_ssbo);
+   load->num_components = 1;
+   load->src[0] = nir_src_for_ssa(nir_imm_int(&b, 0));
+   load->src[1] = nir_src_for_ssa(nir_imm_int(&b, 0));
+   nir_ssa_dest_init(&load->instr, &load->dest, 1, 32, NULL);
+   nir_builder_instr_insert(&b, &load->instr);
+
+   return &load->dest.ssa;
+}
+
+void
+nir_code_motion_test::store_output(nir_ssa_def *value)
+{
+   nir_intrinsic_instr *store =
+      nir_intrinsic_instr_create(b.shader, nir_intrinsic_store_output);
+   store->num_components = value->num_components;
+   nir_intrinsic_set_base(store, 0);
+   nir_intrinsic_set_write_mask(store, (1 << value->num_components) - 1);
+   store->src[0] = nir_src_for_ssa(value);
+   store->src[1] = nir_src_for_ssa(nir_imm_int(&b, 0));
+   nir_builder_instr_insert(&b, &store->instr);
+}
+
+void
+nir_code_motion_test::break_if(nir_ssa_def *condition)
+{
+   nir_push_if(&b, condition);
+   nir_jump(&b, nir_jump_break);
+   nir_pop_if(&b, NULL);
+}
+
+static bool
+is_in_loop(nir_ssa_def *def, nir_loop *loop)
+{
+   for (nir_cf_node *node = &def->parent_instr->block->cf_node; node;
+        node = node->parent) {
+      if (node == &loop->cf_node)
+         return true;
+   }
+
+   return false;
+}
+
+TEST_F(nir_code_motion_test, licm_hoists_invariant_alu)
+{
+   nir_ssa_def *u0 = load_uniform(0, 1);
+   nir_ssa_def *u1 = load_uniform(1, 1);
+
+   nir_loop *loop = nir_push_loop(&b);
+   nir_ssa_def *x = nir_fmul(&b, u0, u1);
+   nir_ssa_def *one = nir_imm_float(&b, 1.0f);
+   nir_ssa_def *y = nir_fadd(&b, x, one);
+   store_output(y);
+   break_if(nir_flt(&b, u0, u1));
+   nir_pop_loop(&b, loop);
+
+   EXPECT_TRUE(nir_opt_licm(b.shader));
+   nir_validate_shader(b.shader);
+
+   EXPECT_FALSE(is_in_loop(x, loop));
+   EXPECT_FALSE(is_in_loop(y, loop));
+   EXPECT_FALSE(is_in_loop(one, loop));
+}
+
+TEST_F(nir_code_motion_test, licm_keeps_variant_alu)
+{
+   nir_ssa_def *u0 = load_uniform(0, 1);
+
+   nir_loop *loop = nir_push_loop(&b);
+   nir_ssa_def *v = load_ssbo();
+   nir_ssa_def *x = nir_fmul(&b, u0, v);
+   store_output(x);
+   break_if(nir_flt(&b, u0, x));
+   nir_pop_loop(&b, loop);
+
+   EXPECT_FALSE(nir_opt_licm(b.shader));
+
+   EXPECT_TRUE(is_in_loop(v, loop));
+   EXPECT_TRUE(is_in_loop(x, loop));
+}
+
+TEST_F(nir_code_motion_test, licm_hoists_load_before_break)
+{
+   nir_loop *loop = nir_push_loop(&b);
+   nir_ssa_def *u = load_uniform(0, 1);
+   store_output(u);
+   break_if(nir_flt(&b, u, nir_imm_float(&b, 0.0f)));
+   nir_pop_loop(&b, loop);
+
+   EXPECT_TRUE(nir_opt_licm(b.shader));
+   nir_validate_shader(b.shader);
+
+   EXPECT_FALSE(is_in_loop(u, loop));
+}
+
+TEST_F(nir_code_motion_test, licm_keeps_load_after_break)
+{
+   nir_ssa_def *u0 = load_uniform(0, 1);
+
+   /* The load may not be executed at all if the loop breaks on the first
+    * iteration.
+    */
+   nir_loop *loop = nir_push_loop(&b);
+   break_if(nir_flt(&b, u0, nir_imm_float(&b, 0.0f)));
+   nir_ssa_def *u1 = load_uniform(1, 1);
+   nir_ssa_def *x = nir_fmul(&b, u1, u1);
+   store_output(x);
+   nir_pop_loop(&b, loop);
+
+   nir_opt_licm(b.shader);
+   nir_validate_shader(b.shader);
+
+   EXPECT_TRUE(is_in_loop(u1, loop));
+   EXPECT_TRUE(is_in_loop(x, loop));
+}
+
+TEST_F(nir_code_motion_test, licm_keeps_load_in_if)
+{
+   nir_ssa_def *u0 = load_uniform(0, 1);
+
+   nir_loop *loop = nir_push_loop(&b);
+   nir_push_if(&b, nir_flt(&b, u0, nir_imm_float(&b, 0.0f)));
+   nir_ssa_def *u1 = load_uniform(1, 1);
+   store_output(u1);
+   nir_pop_if(&b, NULL);
+   break_if(nir_flt(&b, nir_imm_float(&b, 1.0f), u0));
+   nir_pop_loop(&b, loop);
+
+   nir_opt_licm(b.shader);
+   nir_validate_shader(b.shader);
+
+   EXPECT_TRUE(is_in_loop(u1, loop));
+}
+
+TEST_F(nir_code_motion_test, licm_hoists_alu_after_break)
+{
+   nir_ssa_def *u0 = load_uniform(0, 1);
+   nir_ssa_def *u1 = load_uniform(1, 1);
+
+   /* ALU instructions can't fault, so they are hoisted from anywhere */
+   nir_loop *loop = nir_push_loop(&b);
+   break_if(nir_flt(&b, u0, u1));
+   nir_ssa_def *x = nir_fdiv(&b, u0, u1);
+   store_output(x);
+   nir_pop_loop(&b, loop);
+
+   EXPECT_TRUE(nir_opt_licm(b.shader));
+   nir_validate_shader(b.shader);
+
+   EXPECT_FALSE(is_in_loop(x, loop));
+}
+
+TEST_F(nir_code_motion_test, licm_hoists_out_of_nested_loops)
+{
+   nir_ssa_def *u0 = load_uniform(0, 1);
+   nir_ssa_def *u1 = load_uniform(1, 1);
+
+   nir_loop *outer = nir_push_loop(&b);
+   nir_loop *inner = nir_push_loop(&b);
+   nir_ssa_def *x = nir_fmul(&b, u0, u1);
+   store_output(x);
+   break_if(nir_flt(&b, u0, x));
+   nir_pop_loop(&b, inner);
+   break_if(nir_flt(&b, u1, u0));
+   nir_pop_loop(&b, outer);
+
+   EXPECT_TRUE(nir_opt_licm(b.shader));
+   nir_validate_shader(b.shader);
+
+   EXPECT_FALSE(is_in_loop(x, outer));
+}
+
+TEST_F(nir_code_motion_test, licm_limits_live_components)
+{
+   nir_ssa_def *u = load_uniform(0, 4);
+   nir_ssa_def *v = load_uniform(4, 4);
+   nir_ssa_def *sums[20];
+
+   /* Each sum keeps four more components live across the loop, while u
+    * stays live for the others.
+    */
+   nir_loop *loop = nir_push_loop(&b);
+   for (unsigned i = 0; i < ARRAY_SIZE(sums); i++) {
+      sums[i] = nir_fadd(&b, u, nir_imm_vec4(&b, i, i, i, i));
+      store_output(sums[i]);
+   }
+
+   /* v is only used here, hoisting this doesn't add anything */
+   nir_ssa_def *x = nir_fmul(&b, v, v);
+   store_output(x);
+   break_if(nir_flt(&b, nir_channel(&b, u, 0), nir_imm_float(&b, 0.0f)));
+   nir_pop_loop(&b, loop);
+
+   EXPECT_TRUE(nir_opt_licm(b.shader));
+   nir_validate_shader(b.shader);
+
+   unsigned hoisted = 0;
+   for (unsigned i = 0; i < ARRAY_SIZE(sums); i++) {
+      if (!is_in_loop(sums[i], loop))
+         hoisted++;
+   }
+
+   EXPECT_EQ(16u, hoisted);
+   EXPECT_FALSE(is_in_loop(x, loop));
+}
+
+TEST_F(nir_code_motion_test, gcm_hoists_invariant_alu)
+{
+   nir_ssa_def *u0 = load_uniform(0, 1);
+   nir_ssa_def *u1 = load_uniform(1, 1);
+
+   nir_loop *loop = nir_push_loop(&b);
+   nir_ssa_def *x = nir_fmul(&b, u0, u1);
+   store_output(x);
+   break_if(nir_flt(&b, u0, x));
+   nir_pop_loop(&b, loop);
+
+   EXPECT_TRUE(nir_opt_gcm(b.shader, false));
+   nir_validate_shader(b.shader);
+
+   EXPECT_FALSE(is_in_loop(x, loop));
+}
+
+TEST_F(nir_code_motion_test, gcm_keeps_derivative_in_loop)
+{
+   nir_ssa_def *u0 = load_uniform(0, 1);
+
+   nir_loop *loop = nir_push_loop(&b);
+   nir_ssa_def *x = nir_fddx(&b, u0);
+   store_output(x);
+   break_if(nir_flt(&b, u0, x));
+   nir_pop_loop(&b, loop);
+
+   nir_opt_gcm(b.shader, false);
+   nir_validate_shader(b.shader);
+
+   EXPECT_TRUE(is_in_loop(x, loop));
+}
+
+TEST_F(nir_code_motion_test, gcm_leaves_constants_at_uses)
+{
+   nir_ssa_def *u0 = load_uniform(0, 1);
+
+   nir_loop *loop = nir_push_loop(&b);
+   nir_ssa_def *c = nir_imm_float(&b, 2.0f);
+   nir_ssa_def *m = nir_fmul(&b, u0, c);
+   nir_ssa_def *k = nir_imm_float(&b, 3.0f);
+   nir_ssa_def *x = nir_fadd(&b, nir_fddx(&b, m), nir_fddx(&b, k));
+   store_output(x);
+   break_if(nir_flt(&b, u0, x));
+   nir_pop_loop(&b, loop);
+
+   nir_opt_gcm(b.shader, false);
+   nir_validate_shader(b.shader);
+
+   /* The multiplication leaves the loop and takes its constant along, the
+    * constant only used by a derivative stays in the loop with it.
+    */
+   EXPECT_FALSE(is_in_loop(m, loop));
+   EXPECT_FALSE(is_in_loop(c, loop));
+   EXPECT_TRUE(is_in_loop(k, loop));
+}
+
+TEST_F(nir_code_motion_test, gcm_keeps_loads_in_place)
+{
+   nir_ssa_def *u0 = load_uniform(0, 1);
+
+   /* Neither load is executed when u0 >= 0, so hoisting them could read
+    * out of bounds.
+    */
+   nir_loop *loop = nir_push_loop(&b);
+   break_if(nir_fge(&b, u0, nir_imm_float(&b, 0.0f)));
+   nir_ssa_def *u1 = load_uniform(1, 1);
+   nir_if *nif = nir_push_if(&b, nir_flt(&b, u1, nir_imm_float(&b, 1.0f)));
+   nir_ssa_def *u2 = load_uniform(2, 1);
+   store_output(u2);
+   nir_pop_if(&b, nif);
+   nir_pop_loop(&b, loop);
+
+   nir_block *u1_block = u1->parent_instr->block;
+   nir_block *u2_block = u2->parent_instr->block;
+
+   nir_opt_gcm(b.shader, false);
+   nir_validate_shader(b.shader);
+
+   EXPECT_EQ(u1_block, u1->parent_instr->block);
+   EXPECT_EQ(u2_block, u2->parent_instr->block);
+}
+
+TEST_F(nir_code_motion_test, movable_instructions)
+{
+   nir_ssa_def *u = load_uniform(0, 1);
+   nir_ssa_def *s = load_ssbo();
+   nir_ssa_def *x = nir_fmul(&b, u, s);
+   nir_ssa_def *d = nir_fddy(&b, x);
+   store_output(d);
+
+   EXPECT_TRUE(nir_instr_is_movable(u->parent_instr));
+   EXPECT_TRUE(nir_instr_is_movable(x->parent_instr));
+   EXPECT_FALSE(nir_instr_is_movable(s->parent_instr));
+   EXPECT_FALSE(nir_instr_is_movable(d->parent_instr));
+
+   nir_instr *store = nir_block_last_instr(nir_cursor_current_block(b.cursor));
+   EXPECT_FALSE(nir_instr_is_movable(store));
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+#include "nir.h"
+#include "nir_builder.h"
+
+class nir_varying_linking_test : public ::testing::Test {
+protected:
+   nir_varying_linking_test();
+   ~nir_varying_linking_test();
+
+   nir_variable *create_var(nir_shader *shader, nir_variable_mode mode,
+                            const char *name, int location);
+   nir_variable *add_varying(unsigned slot);
+   unsigned count_loads(nir_shader *shader, nir_variable *var);
+
+   static nir_variable *
+   first_var(struct exec_list *list)
+   {
+      return exec_node_data(nir_variable, exec_list_get_head(list), node);
+   }
+
+   nir_builder vs;
+   nir_builder fs;
+   nir_variable *frag_color;
+};
+
+nir_varying_linking_test::nir_varying_linking_test()
+{
+   static const nir_shader_compiler_options options = { };
+   nir_builder_init_simple_shader(&vs, NULL, MESA_SHADER_VERTEX, &options);
+   nir_builder_init_simple_shader(&fs, NULL, MESA_SHADER_FRAGMENT, &options);
+
+   frag_color = create_var(fs.shader, nir_var_shader_out, "color",
+                           FRAG_RESULT_DATA0);
+}
+
+nir_varying_linking_test::~nir_varying_linking_test()
+{
+   ralloc_free(vs.shader);
+   ralloc_free(fs.shader);
+}
+
+nir_variable *
+nir_varying_linking_test::create_var(nir_shader *shader,
+                                     nir_variable_mode mode,
+                                     const char *name, int location)
+{
+   nir_variable *var =
+      nir_variable_create(shader, mode, glsl_vec4_type(), name);
+   var->data.location = location;
+   return var;
+}
+
+/* Adds a generic varying to both shaders and returns the output.  The
+ * fragment shader adds the input to its color output.
+ */
+nir_variable *
+nir_varying_linking_test::add_varying(unsigned slot)
+{
+   nir_variable *out = create_var(vs.shader, nir_var_shader_out, "v",
+                                  VARYING_SLOT_VAR0 + slot);
+   nir_variable *in = create_var(fs.shader, nir_var_shader_in, "v",
+                                 VARYING_SLOT_VAR0 + slot);
+
+   nir_store_var(&fs, frag_color,
+                 nir_fadd(&fs, nir_load_var(&fs, frag_color),
+                          nir_load_var(&fs, in)), 0xf);
+   return out;
+}
+
+unsigned
+nir_varying_linking_test::count_loads(nir_shader *shader, nir_variable *var)
+{
+   unsigned count = 0;
+
+   nir_foreach_block(block, nir_shader_get_entrypoint(shader)) {
+      nir_foreach_instr(instr, block) {
+         if (instr->type != nir_instr_type_intrinsic)
+            continue;
+
+         nir_intrinsic_instr *intr = nir_instr_as_intrinsic(instr);
+         if (intr->intrinsic == nir_intrinsic_load_var &&
+             intr->variables[0]->var == var)
+            count++;
+      }
+   }
+
+   return count;
+}
+
+TEST_F(nir_varying_linking_test, remove_unused_output)
+{
+   nir_variable *used = add_varying(1);
+   nir_variable *unused = create_var(vs.shader, nir_var_shader_out, "u",
+                                     VARYING_SLOT_VAR0);
+   nir_variable *pos = create_var(vs.shader, nir_var_shader_out, "pos",
+                                  VARYING_SLOT_POS);
+
+   EXPECT_TRUE(nir_remove_unused_varyings(vs.shader, fs.shader));
+
+   EXPECT_EQ(nir_var_shader_out, used->data.mode);
+   EXPECT_EQ(nir_var_global, unused->data.mode);
+   EXPECT_EQ(nir_var_shader_out, pos->data.mode);
+   EXPECT_EQ(2u, exec_list_length(&vs.shader->outputs));
+
+   nir_validate_shader(vs.shader);
+}
+
+TEST_F(nir_varying_linking_test, keep_transform_feedback_outputs)
+{
+   add_varying(1);
+   create_var(vs.shader, nir_var_shader_out, "u", VARYING_SLOT_VAR0);
+   vs.shader->info.has_transform_feedback_varyings = true;
+
+   EXPECT_FALSE(nir_remove_unused_varyings(vs.shader, fs.shader));
+   EXPECT_EQ(2u, exec_list_length(&vs.shader->outputs));
+}
+
+TEST_F(nir_varying_linking_test, propagate_constant)
+{
+   nir_variable *out = add_varying(0);
+   nir_store_var(&vs, out, nir_imm_vec4(&vs, 1.0, 0.0, 0.0, 1.0), 0xf);
+
+   nir_variable *in = first_var(&fs.shader->inputs);
+
+   EXPECT_TRUE(nir_link_constant_varyings(vs.shader, fs.shader));
+   EXPECT_EQ(0u, count_loads(fs.shader, in));
+
+   nir_validate_shader(fs.shader);
+}
+
+TEST_F(nir_varying_linking_test, keep_partially_written_output)
+{
+   nir_variable *out = add_varying(0);
+   nir_store_var(&vs, out, nir_imm_vec4(&vs, 1.0, 0.0, 0.0, 1.0), 0x3);
+
+   EXPECT_FALSE(nir_link_constant_varyings(vs.shader, fs.shader));
+}
+
+TEST_F(nir_varying_linking_test, propagate_uniform)
+{
+   nir_variable *vs_uniform =
+      create_var(vs.shader, nir_var_uniform, "tint", -1);
+   nir_variable *fs_uniform =
+      create_var(fs.shader, nir_var_uniform, "tint", -1);
+
+   nir_variable *out = add_varying(0);
+   nir_store_var(&vs, out, nir_load_var(&vs, vs_uniform), 0xf);
+
+   nir_variable *in = first_var(&fs.shader->inputs);
+
+   EXPECT_TRUE(nir_link_constant_varyings(vs.shader, fs.shader));
+   EXPECT_EQ(0u, count_loads(fs.shader, in));
+   EXPECT_EQ(1u, count_loads(fs.shader, fs_uniform));
+
+   nir_validate_shader(fs.shader);
+}
+
+TEST_F(nir_varying_linking_test, keep_uniform_not_in_consumer)
+{
+   nir_variable *vs_uniform =
+      create_var(vs.shader, nir_var_uniform, "tint", -1);
+
+   nir_variable *out = add_varying(0);
+   nir_store_var(&vs, out, nir_load_var(&vs, vs_uniform), 0xf);
+
+   EXPECT_FALSE(nir_link_constant_varyings(vs.shader, fs.shader));
+}
+
+TEST_F(nir_varying_linking_test, compact)
+{
+   nir_variable *a = add_varying(2);
+   nir_variable *b = add_varying(5);
+
+   EXPECT_TRUE(nir_compact_varyings(vs.shader, fs.shader));
+
+   EXPECT_EQ(VARYING_SLOT_VAR0, a->data.location);
+   EXPECT_EQ(VARYING_SLOT_VAR0 + 1, b->data.location);
+
+   nir_foreach_variable(in, &fs.shader->inputs) {
+      EXPECT_TRUE(in->data.location == VARYING_SLOT_VAR0 ||
+                  in->data.location == VARYING_SLOT_VAR0 + 1);
+   }
+
+   EXPECT_FALSE(nir_compact_varyings(vs.shader, fs.shader));
+}
+
+TEST_F(nir_varying_linking_test, link_and_optimize)
+{
+   nir_variable *attr = create_var(vs.shader, nir_var_shader_in, "attr",
+                                   VERT_ATTRIB_GENERIC0);
+
+   nir_variable *constant = add_varying(3);
+   nir_variable *computed = add_varying(7);
+   nir_variable *unused = create_var(vs.shader, nir_var_shader_out, "u",
+                                     VARYING_SLOT_VAR0 + 9);
+
+   nir_store_var(&vs, constant, nir_imm_vec4(&vs, 0.0, 0.0, 0.0, 1.0), 0xf);
+   nir_store_var(&vs, computed,
+                 nir_fmul(&vs, nir_load_var(&vs, attr),
+                          nir_load_var(&vs, attr)), 0xf);
+   nir_store_var(&vs, unused, nir_load_var(&vs, attr), 0xf);
+
+   EXPECT_TRUE(nir_link_opt_varyings(vs.shader, fs.shader));
+
+   ASSERT_EQ(1u, exec_list_length(&vs.shader->outputs));
+   ASSERT_EQ(1u, exec_list_length(&fs.shader->inputs));
+
+   nir_variable *out = first_var(&vs.shader->outputs);
+   nir_variable *in = first_var(&fs.shader->inputs);
+   EXPECT_EQ(computed, out);
+   EXPECT_EQ(VARYING_SLOT_VAR0, out->data.location);
+   EXPECT_EQ(VARYING_SLOT_VAR0, in->data.location);
+
+   nir_validate_shader(vs.shader);
+   nir_validate_shader(fs.shader);
+}
@@ -44,36 +44,32 @@ struct cso_cache {
    void                 *sanitize_data;
 };
 
-#if 1
+/**
+ * Hash the key 32 bits at a time, mixing every word in (this is the
+ * MurmurHash3 block function).  Templates often differ in a single field,
+ * and just XOR'ing the words together made those collide.
+ */
 static unsigned hash_key(const void *key, unsigned key_size)
 {
-   unsigned *ikey = (unsigned *)key;
-   unsigned hash = 0, i;
+   const uint32_t *ikey = (const uint32_t *)key;
+   uint32_t hash = key_size;
+   unsigned i;
 
    assert(key_size % 4 == 0);
 
-   /* I'm sure this can be improved on:
-    */
-   for (i = 0; i < key_size/4; i++)
-      hash ^= ikey[i];
+   for (i = 0; i < key_size/4; i++) {
+      uint32_t k = ikey[i] * 0xcc9e2d51;
+      k = (k << 15) | (k >> 17);
+      hash ^= k * 0x1b873593;
+      hash = (hash << 13) | (hash >> 19);
+      hash = hash * 5 + 0xe6546b64;
+   }
 
+   hash ^= hash >> 16;
+   hash *= 0x85ebca6b;
+   hash ^= hash >> 13;
    return hash;
 }
-#else
-static unsigned hash_key(const unsigned char *p, int n)
-{
-   unsigned h = 0;
-   unsigned g;
-
-   while (n--) {
-      h = (h << 4) + *p++;
-      if ((g = (h & 0xf0000000)) != 0)
-         h ^= g >> 23;
-      h &= ~g;
-   }
-   return h;
-}
-#endif
 
 unsigned cso_construct_key(void *item, int item_size)
 {
@@ -209,7 +205,8 @@ void *cso_hash_find_data_from_template( struct cso_hash *hash,
 				        int size )
 {
    struct cso_hash_iter iter = cso_hash_find(hash, hash_key);
-   while (!cso_hash_iter_is_null(iter)) {
+   while (!cso_hash_iter_is_null(iter) &&
+          cso_hash_iter_key(iter) == hash_key) {
       void *iter_data = cso_hash_iter_data(iter);
       if (!memcmp(iter_data, templ, size)) {
 	 /* We found a match
@@ -227,12 +224,19 @@ struct cso_hash_iter cso_find_state_template(struct cso_cache *sc,
                                              void *templ, unsigned size)
 {
    struct cso_hash_iter iter = cso_find_state(sc, hash_key, type);
-   while (!cso_hash_iter_is_null(iter)) {
+
+   /* Entries with the same key are next to each other, and the iterator
+    * carries on into the following buckets after them, so stop there
+    * rather than comparing against the rest of the table.
+    */
+   while (!cso_hash_iter_is_null(iter) &&
+          cso_hash_iter_key(iter) == hash_key) {
       void *iter_data = cso_hash_iter_data(iter);
       if (!memcmp(iter_data, templ, size))
          return iter;
       iter = cso_hash_iter_next(iter);
    }
+   iter.node = NULL;
    return iter;
 }
 
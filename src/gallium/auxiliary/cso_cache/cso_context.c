@@ -61,12 +61,31 @@ struct sampler_info
 };
 
 
+/**
+ * Number of entries in the direct-mapped caches which sit in front of the
+ * CSO hash tables.  Must be a power of two.
+ */
+#define CSO_DIRECT_CACHE_SIZE 32
+
+/**
+ * Entry of a direct-mapped cache of recently used state objects, indexed
+ * by the low bits of the hash key.
+ */
+struct cso_direct_entry
+{
+   unsigned hash_key;
+   void *cso;     /**< cso_blend, cso_sampler, etc. NULL if empty */
+};
+
+
 
 struct cso_context {
    struct pipe_context *pipe;
    struct cso_cache *cache;
    struct u_vbuf *vbuf;
 
+   struct cso_direct_entry direct_cache[CSO_CACHE_MAX][CSO_DIRECT_CACHE_SIZE];
+
    boolean has_geometry_shader;
    boolean has_tessellation;
    boolean has_compute_shader;
@@ -230,6 +249,9 @@ sanitize_hash(struct cso_hash *hash, enum cso_cache_type type,
    if (to_remove == 0)
       return;
 
+   /* Some of the states are going away */
+   memset(ctx->direct_cache[type], 0, sizeof(ctx->direct_cache[type]));
+
    if (type == CSO_SAMPLER) {
       int i, j;
 
@@ -277,6 +299,56 @@ sanitize_hash(struct cso_hash *hash, enum cso_cache_type type,
    }
 }
 
+/**
+ * Look up the state object matching the given template, first in the
+ * direct-mapped cache and then in the hash table.
+ * \return  the cso_blend, cso_sampler, etc. or NULL if not found
+ */
+static inline void *
+cso_lookup_state(struct cso_context *ctx, unsigned hash_key,
+                 enum cso_cache_type type, const void *templ,
+                 unsigned key_size)
+{
+   struct cso_direct_entry *entry =
+      &ctx->direct_cache[type][hash_key & (CSO_DIRECT_CACHE_SIZE - 1)];
+   struct cso_hash_iter iter;
+
+   /* All the CSO types start with the template state */
+   if (entry->cso && entry->hash_key == hash_key &&
+       !memcmp(entry->cso, templ, key_size))
+      return entry->cso;
+
+   iter = cso_find_state_template(ctx->cache, hash_key, type,
+                                  (void *)templ, key_size);
+   if (cso_hash_iter_is_null(iter))
+      return NULL;
+
+   entry->hash_key = hash_key;
+   entry->cso = cso_hash_iter_data(iter);
+   return entry->cso;
+}
+
+/**
+ * Add a new state object to the hash table and the direct-mapped cache.
+ */
+static boolean
+cso_add_state(struct cso_context *ctx, unsigned hash_key,
+              enum cso_cache_type type, void *cso)
+{
+   struct cso_direct_entry *entry;
+   struct cso_hash_iter iter;
+
+   /* This may evict entries, and flush the direct-mapped cache */
+   iter = cso_insert_state(ctx->cache, hash_key, type, cso);
+   if (cso_hash_iter_is_null(iter))
+      return FALSE;
+
+   entry = &ctx->direct_cache[type][hash_key & (CSO_DIRECT_CACHE_SIZE - 1)];
+   entry->hash_key = hash_key;
+   entry->cso = cso;
+   return TRUE;
+}
+
 static void cso_init_vbuf(struct cso_context *cso, unsigned flags)
 {
    struct u_vbuf_caps caps;
@@ -447,18 +519,17 @@ enum pipe_error cso_set_blend(struct cso_context *ctx,
                               const struct pipe_blend_state *templ)
 {
    unsigned key_size, hash_key;
-   struct cso_hash_iter iter;
+   struct cso_blend *cso;
    void *handle;
 
    key_size = templ->independent_blend_enable ?
       sizeof(struct pipe_blend_state) :
       (char *)&(templ->rt[1]) - (char *)templ;
    hash_key = cso_construct_key((void*)templ, key_size);
-   iter = cso_find_state_template(ctx->cache, hash_key, CSO_BLEND,
-                                  (void*)templ, key_size);
+   cso = cso_lookup_state(ctx, hash_key, CSO_BLEND, templ, key_size);
 
-   if (cso_hash_iter_is_null(iter)) {
-      struct cso_blend *cso = MALLOC(sizeof(struct cso_blend));
+   if (!cso) {
+      cso = MALLOC(sizeof(struct cso_blend));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -468,17 +539,12 @@ enum pipe_error cso_set_blend(struct cso_context *ctx,
       cso->delete_state = (cso_state_callback)ctx->pipe->delete_blend_state;
       cso->context = ctx->pipe;
 
-      iter = cso_insert_state(ctx->cache, hash_key, CSO_BLEND, cso);
-      if (cso_hash_iter_is_null(iter)) {
+      if (!cso_add_state(ctx, hash_key, CSO_BLEND, cso)) {
          FREE(cso);
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
-
-      handle = cso->data;
-   }
-   else {
-      handle = ((struct cso_blend *)cso_hash_iter_data(iter))->data;
    }
+   handle = cso->data;
 
    if (ctx->blend != handle) {
       ctx->blend = handle;
@@ -512,15 +578,13 @@ cso_set_depth_stencil_alpha(struct cso_context *ctx,
 {
    unsigned key_size = sizeof(struct pipe_depth_stencil_alpha_state);
    unsigned hash_key = cso_construct_key((void*)templ, key_size);
-   struct cso_hash_iter iter = cso_find_state_template(ctx->cache,
-                                                       hash_key,
-                                                       CSO_DEPTH_STENCIL_ALPHA,
-                                                       (void*)templ, key_size);
+   struct cso_depth_stencil_alpha *cso =
+      cso_lookup_state(ctx, hash_key, CSO_DEPTH_STENCIL_ALPHA,
+                       templ, key_size);
    void *handle;
 
-   if (cso_hash_iter_is_null(iter)) {
-      struct cso_depth_stencil_alpha *cso =
-         MALLOC(sizeof(struct cso_depth_stencil_alpha));
+   if (!cso) {
+      cso = MALLOC(sizeof(struct cso_depth_stencil_alpha));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -531,19 +595,12 @@ cso_set_depth_stencil_alpha(struct cso_context *ctx,
          (cso_state_callback)ctx->pipe->delete_depth_stencil_alpha_state;
       cso->context = ctx->pipe;
 
-      iter = cso_insert_state(ctx->cache, hash_key,
-                              CSO_DEPTH_STENCIL_ALPHA, cso);
-      if (cso_hash_iter_is_null(iter)) {
+      if (!cso_add_state(ctx, hash_key, CSO_DEPTH_STENCIL_ALPHA, cso)) {
          FREE(cso);
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
-
-      handle = cso->data;
-   }
-   else {
-      handle = ((struct cso_depth_stencil_alpha *)
-                cso_hash_iter_data(iter))->data;
    }
+   handle = cso->data;
 
    if (ctx->depth_stencil != handle) {
       ctx->depth_stencil = handle;
@@ -577,14 +634,12 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
 {
    unsigned key_size = sizeof(struct pipe_rasterizer_state);
    unsigned hash_key = cso_construct_key((void*)templ, key_size);
-   struct cso_hash_iter iter = cso_find_state_template(ctx->cache,
-                                                       hash_key,
-                                                       CSO_RASTERIZER,
-                                                       (void*)templ, key_size);
+   struct cso_rasterizer *cso =
+      cso_lookup_state(ctx, hash_key, CSO_RASTERIZER, templ, key_size);
    void *handle = NULL;
 
-   if (cso_hash_iter_is_null(iter)) {
-      struct cso_rasterizer *cso = MALLOC(sizeof(struct cso_rasterizer));
+   if (!cso) {
+      cso = MALLOC(sizeof(struct cso_rasterizer));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -594,17 +649,12 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
          (cso_state_callback)ctx->pipe->delete_rasterizer_state;
       cso->context = ctx->pipe;
 
-      iter = cso_insert_state(ctx->cache, hash_key, CSO_RASTERIZER, cso);
-      if (cso_hash_iter_is_null(iter)) {
+      if (!cso_add_state(ctx, hash_key, CSO_RASTERIZER, cso)) {
          FREE(cso);
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
-
-      handle = cso->data;
-   }
-   else {
-      handle = ((struct cso_rasterizer *)cso_hash_iter_data(iter))->data;
    }
+   handle = cso->data;
 
    if (ctx->rasterizer != handle) {
       ctx->rasterizer = handle;
@@ -1043,7 +1093,7 @@ cso_set_vertex_elements(struct cso_context *ctx,
 {
    struct u_vbuf *vbuf = ctx->vbuf;
    unsigned key_size, hash_key;
-   struct cso_hash_iter iter;
+   struct cso_velements *cso;
    void *handle;
    struct cso_velems_state velems_state;
 
@@ -1062,11 +1112,11 @@ cso_set_vertex_elements(struct cso_context *ctx,
    memcpy(velems_state.velems, states,
           sizeof(struct pipe_vertex_element) * count);
    hash_key = cso_construct_key((void*)&velems_state, key_size);
-   iter = cso_find_state_template(ctx->cache, hash_key, CSO_VELEMENTS,
-                                  (void*)&velems_state, key_size);
+   cso = cso_lookup_state(ctx, hash_key, CSO_VELEMENTS,
+                          &velems_state, key_size);
 
-   if (cso_hash_iter_is_null(iter)) {
-      struct cso_velements *cso = MALLOC(sizeof(struct cso_velements));
+   if (!cso) {
+      cso = MALLOC(sizeof(struct cso_velements));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -1077,17 +1127,12 @@ cso_set_vertex_elements(struct cso_context *ctx,
          (cso_state_callback) ctx->pipe->delete_vertex_elements_state;
       cso->context = ctx->pipe;
 
-      iter = cso_insert_state(ctx->cache, hash_key, CSO_VELEMENTS, cso);
-      if (cso_hash_iter_is_null(iter)) {
+      if (!cso_add_state(ctx, hash_key, CSO_VELEMENTS, cso)) {
          FREE(cso);
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
-
-      handle = cso->data;
-   }
-   else {
-      handle = ((struct cso_velements *)cso_hash_iter_data(iter))->data;
    }
+   handle = cso->data;
 
    if (ctx->velements != handle) {
       ctx->velements = handle;
@@ -1200,13 +1245,10 @@ cso_single_sampler(struct cso_context *ctx, enum pipe_shader_type shader_stage,
    if (templ) {
       unsigned key_size = sizeof(struct pipe_sampler_state);
       unsigned hash_key = cso_construct_key((void*)templ, key_size);
-      struct cso_sampler *cso;
-      struct cso_hash_iter iter =
-         cso_find_state_template(ctx->cache,
-                                 hash_key, CSO_SAMPLER,
-                                 (void *) templ, key_size);
+      struct cso_sampler *cso =
+         cso_lookup_state(ctx, hash_key, CSO_SAMPLER, templ, key_size);
 
-      if (cso_hash_iter_is_null(iter)) {
+      if (!cso) {
          cso = MALLOC(sizeof(struct cso_sampler));
          if (!cso)
             return PIPE_ERROR_OUT_OF_MEMORY;
@@ -1218,15 +1260,11 @@ cso_single_sampler(struct cso_context *ctx, enum pipe_shader_type shader_stage,
          cso->context = ctx->pipe;
          cso->hash_key = hash_key;
 
-         iter = cso_insert_state(ctx->cache, hash_key, CSO_SAMPLER, cso);
-         if (cso_hash_iter_is_null(iter)) {
+         if (!cso_add_state(ctx, hash_key, CSO_SAMPLER, cso)) {
             FREE(cso);
             return PIPE_ERROR_OUT_OF_MEMORY;
          }
       }
-      else {
-         cso = cso_hash_iter_data(iter);
-      }
 
       ctx->samplers[shader_stage].cso_samplers[idx] = cso;
       ctx->samplers[shader_stage].samplers[idx] = cso->data;
@@ -2722,10 +2722,14 @@ lp_build_rcp(struct lp_build_context *bld,
     * We could still use it on certain processors if benchmarks show that the
     * RCPPS plus necessary workarounds are still preferrable to DIVPS; or for
     * particular uses that require less workarounds.
+    *
+    * Its precision is plenty for mediump computations though, and it gets
+    * the reciprocal of 0.0 and Inf right when not refined.
     */
 
-   if (FALSE && ((util_cpu_caps.has_sse && type.width == 32 && type.length == 4) ||
-         (util_cpu_caps.has_avx && type.width == 32 && type.length == 8))){
+   if (bld->precision == LP_FLOAT_PRECISION_MEDIUM &&
+       ((util_cpu_caps.has_sse && type.width == 32 && type.length == 4) ||
+        (util_cpu_caps.has_avx && type.width == 32 && type.length == 8))) {
       const unsigned num_iterations = 0;
       LLVMValueRef res;
       unsigned i;
@@ -2792,6 +2796,15 @@ lp_build_rsqrt(struct lp_build_context *bld,
 
    assert(type.floating);
 
+   /*
+    * Good enough for mediump as is, without refinement this also gets 0.0
+    * and Inf right.
+    */
+   if (bld->precision == LP_FLOAT_PRECISION_MEDIUM &&
+       lp_build_fast_rsqrt_available(type)) {
+      return lp_build_fast_rsqrt(bld, a);
+   }
+
    /*
     * This should be faster but all denormals will end up as infinity.
     */
@@ -3279,6 +3292,18 @@ const double lp_build_exp2_polynomial[] = {
 };
 
 
+/**
+ * Lower degree fit of 2**x in range [0, 1[ for LP_FLOAT_PRECISION_MEDIUM,
+ * good for about 13.7 bits of relative precision.
+ */
+static const double lp_build_exp2_polynomial_mediump[] = {
+   0.999925218562710312959,
+   0.695833540494823811697,
+   0.226067155427249155588,
+   0.0780245226406372992967
+};
+
+
 LLVMValueRef
 lp_build_exp2(struct lp_build_context *bld,
               LLVMValueRef x)
@@ -3321,8 +3346,15 @@ lp_build_exp2(struct lp_build_context *bld,
                            lp_build_const_int_vec(bld->gallivm, type, 23), "");
    expipart = LLVMBuildBitCast(builder, expipart, vec_type, "");
 
-   expfpart = lp_build_polynomial(bld, fpart, lp_build_exp2_polynomial,
-                                  ARRAY_SIZE(lp_build_exp2_polynomial));
+   if (bld->precision == LP_FLOAT_PRECISION_MEDIUM) {
+      expfpart = lp_build_polynomial(bld, fpart,
+                                     lp_build_exp2_polynomial_mediump,
+                                     ARRAY_SIZE(lp_build_exp2_polynomial_mediump));
+   }
+   else {
+      expfpart = lp_build_polynomial(bld, fpart, lp_build_exp2_polynomial,
+                                     ARRAY_SIZE(lp_build_exp2_polynomial));
+   }
 
    res = LLVMBuildFMul(builder, expipart, expfpart, "");
 
@@ -3431,6 +3463,17 @@ const double lp_build_log2_polynomial[] = {
 #endif
 };
 
+/**
+ * Lower degree fit for LP_FLOAT_PRECISION_MEDIUM, good for about 12.6 bits
+ * of relative precision.
+ */
+static const double lp_build_log2_polynomial_mediump[] = {
+   2.88538959748872753838,
+   0.961932915889597772928,
+   0.571118517972136195241,
+   0.493997535084709500285
+};
+
 /**
  * See http://www.devmaster.net/forums/showthread.php?p=43580
  * http://en.wikipedia.org/wiki/Logarithm#Calculation
@@ -3519,8 +3562,14 @@ lp_build_log2_approx(struct lp_build_context *bld,
       z = lp_build_mul(bld, y, y);
 
       /* compute P(z) */
-      p_z = lp_build_polynomial(bld, z, lp_build_log2_polynomial,
-                                ARRAY_SIZE(lp_build_log2_polynomial));
+      if (bld->precision == LP_FLOAT_PRECISION_MEDIUM) {
+         p_z = lp_build_polynomial(bld, z, lp_build_log2_polynomial_mediump,
+                                   ARRAY_SIZE(lp_build_log2_polynomial_mediump));
+      }
+      else {
+         p_z = lp_build_polynomial(bld, z, lp_build_log2_polynomial,
+                                   ARRAY_SIZE(lp_build_log2_polynomial));
+      }
 
       /* y * P(z) + logexp */
       res = lp_build_mad(bld, y, p_z, logexp);
@@ -52,6 +52,7 @@ struct pipe_sampler_state;
 struct util_format_description;
 struct lp_type;
 struct lp_build_context;
+struct lp_sample_func_cache;
 
 
 /**
@@ -292,6 +293,13 @@ struct lp_sampler_dynamic_state
                 struct gallivm_state *gallivm,
                 LLVMValueRef thread_data_ptr,
                 unsigned unit);
+
+   /**
+    * Optional cache of compiled texture sampling functions, shared by all
+    * the shaders built with the same LLVMContext and context_ptr type.
+    * If NULL, the sampling functions are built into each module.
+    */
+   struct lp_sample_func_cache *func_cache;
 };
 
 
@@ -595,6 +603,13 @@ lp_build_sample_offset(struct lp_build_context *bld,
                        LLVMValueRef *out_j);
 
 
+struct lp_sample_func_cache *
+lp_sample_func_cache_create(LLVMContextRef context);
+
+void
+lp_sample_func_cache_destroy(struct lp_sample_func_cache *cache);
+
+
 void
 lp_build_sample_soa(const struct lp_static_texture_state *static_texture_state,
                     const struct lp_static_sampler_state *static_sampler_state,
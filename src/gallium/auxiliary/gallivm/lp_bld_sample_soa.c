@@ -61,6 +61,8 @@
 #include "lp_bld_quad.h"
 #include "lp_bld_pack.h"
 #include "lp_bld_intr.h"
+#include "lp_bld_init.h"
+#include "util/hash_table.h"
 
 
 /**
@@ -3204,6 +3206,191 @@ lp_build_sample_gen_func(struct gallivm_state *gallivm,
 }
 
 
+/**
+ * Cache of texture sampling functions, each compiled in a module of its
+ * own so that it can be called from any shader built with the same
+ * LLVMContext.  The code of a sampling function only depends on the static
+ * texture and sampler state, the sample op and the units (which pick the
+ * dynamic state in the context struct), so shader variants with the same
+ * sampling don't need to build and compile it again.
+ */
+struct lp_sample_func_cache
+{
+   LLVMContextRef context;
+
+   /** lp_sample_func_key -> lp_sample_func */
+   struct hash_table *funcs;
+};
+
+struct lp_sample_func_key
+{
+   struct lp_static_texture_state texture_state;
+   struct lp_static_sampler_state sampler_state;
+   struct lp_type type;
+   unsigned sample_key;
+   unsigned texture_index;
+   unsigned sampler_index;
+   boolean need_cache;
+   /* LLVM types are unique per context, so this identifies the layout of
+    * the struct the dynamic state is fetched from.
+    */
+   LLVMTypeRef context_ptr_type;
+   LLVMValueRef (*width)(const struct lp_sampler_dynamic_state *state,
+                         struct gallivm_state *gallivm,
+                         LLVMValueRef context_ptr,
+                         unsigned texture_unit);
+};
+
+struct lp_sample_func
+{
+   struct lp_sample_func_key key;
+   struct gallivm_state *gallivm;
+   const void *code;
+};
+
+
+static uint32_t
+sample_func_key_hash(const void *key)
+{
+   return _mesa_hash_data(key, sizeof(struct lp_sample_func_key));
+}
+
+
+static bool
+sample_func_key_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, sizeof(struct lp_sample_func_key)) == 0;
+}
+
+
+struct lp_sample_func_cache *
+lp_sample_func_cache_create(LLVMContextRef context)
+{
+   struct lp_sample_func_cache *cache = CALLOC_STRUCT(lp_sample_func_cache);
+
+   if (!cache)
+      return NULL;
+
+   cache->context = context;
+   cache->funcs = _mesa_hash_table_create(NULL, sample_func_key_hash,
+                                          sample_func_key_equal);
+   if (!cache->funcs) {
+      FREE(cache);
+      return NULL;
+   }
+
+   return cache;
+}
+
+
+void
+lp_sample_func_cache_destroy(struct lp_sample_func_cache *cache)
+{
+   struct hash_entry *entry;
+
+   if (!cache)
+      return;
+
+   hash_table_foreach(cache->funcs, entry) {
+      struct lp_sample_func *func = entry->data;
+      gallivm_destroy(func->gallivm);
+      FREE(func);
+   }
+
+   _mesa_hash_table_destroy(cache->funcs, NULL);
+   FREE(cache);
+}
+
+
+/**
+ * Return the code of the shared sampling function for the given state,
+ * compiling it first if it isn't in the cache yet.
+ * \return  NULL on failure, in which case the caller should build the
+ *          sampling function into its own module.
+ */
+static const void *
+lp_sample_func_cache_get(struct lp_sample_func_cache *cache,
+                         const struct lp_static_texture_state *static_texture_state,
+                         const struct lp_static_sampler_state *static_sampler_state,
+                         struct lp_sampler_dynamic_state *dynamic_state,
+                         const struct lp_sampler_params *params,
+                         boolean need_cache,
+                         LLVMTypeRef ret_type,
+                         LLVMTypeRef *arg_types,
+                         unsigned num_param)
+{
+   struct lp_sample_func_key key;
+   struct lp_sample_func *func;
+   struct hash_entry *entry;
+   struct gallivm_state *gallivm;
+   LLVMTypeRef function_type;
+   LLVMValueRef function;
+   unsigned i;
+
+   memset(&key, 0, sizeof key);
+   memcpy(&key.texture_state, static_texture_state, sizeof key.texture_state);
+   memcpy(&key.sampler_state, static_sampler_state, sizeof key.sampler_state);
+   key.type = params->type;
+   key.sample_key = params->sample_key;
+   key.texture_index = params->texture_index;
+   key.sampler_index = params->sampler_index;
+   key.need_cache = need_cache;
+   key.context_ptr_type = LLVMTypeOf(params->context_ptr);
+   key.width = dynamic_state->width;
+
+   entry = _mesa_hash_table_search(cache->funcs, &key);
+   if (entry) {
+      func = entry->data;
+      return func->code;
+   }
+
+   func = CALLOC_STRUCT(lp_sample_func);
+   if (!func)
+      return NULL;
+
+   gallivm = gallivm_create("texfunc", cache->context);
+   if (!gallivm) {
+      FREE(func);
+      return NULL;
+   }
+
+   function_type = LLVMFunctionType(ret_type, arg_types, num_param, 0);
+   function = LLVMAddFunction(gallivm->module, "texfunc", function_type);
+
+   for (i = 0; i < num_param; ++i) {
+      if(LLVMGetTypeKind(arg_types[i]) == LLVMPointerTypeKind) {
+
+         lp_add_function_attr(function, i + 1, LP_FUNC_ATTR_NOALIAS);
+      }
+   }
+
+   LLVMSetFunctionCallConv(function, LLVMFastCallConv);
+
+   lp_build_sample_gen_func(gallivm,
+                            static_texture_state,
+                            static_sampler_state,
+                            dynamic_state,
+                            params->type,
+                            params->texture_index,
+                            params->sampler_index,
+                            function,
+                            num_param,
+                            params->sample_key);
+
+   gallivm_compile_module(gallivm);
+
+   func->key = key;
+   func->gallivm = gallivm;
+   func->code = func_to_pointer(gallivm_jit_function(gallivm, function));
+
+   gallivm_free_ir(gallivm);
+
+   _mesa_hash_table_insert(cache->funcs, &func->key, func);
+
+   return func->code;
+}
+
+
 /**
  * Call the matching function for texture sampling.
  * If there's no match, generate a new one.
@@ -3220,9 +3407,12 @@ lp_build_sample_soa_func(struct gallivm_state *gallivm,
                              LLVMGetInsertBlock(builder)));
    LLVMValueRef function, inst;
    LLVMValueRef args[LP_MAX_TEX_FUNC_ARGS];
+   LLVMTypeRef arg_types[LP_MAX_TEX_FUNC_ARGS];
+   LLVMTypeRef val_type[4];
+   LLVMTypeRef ret_type;
    LLVMBasicBlockRef bb;
    LLVMValueRef tex_ret;
-   unsigned num_args = 0;
+   unsigned num_args = 0, num_param = 0;
    char func_name[64];
    unsigned i, num_coords, num_derivs, num_offsets, layer;
    unsigned texture_index = params->texture_index;
@@ -3251,67 +3441,85 @@ lp_build_sample_soa_func(struct gallivm_state *gallivm,
          need_cache = TRUE;
       }
    }
+
    /*
-    * texture function matches are found by name.
-    * Thus the name has to include both the texture and sampler unit
-    * (which covers all static state) plus the actual texture function
-    * (including things like offsets, shadow coord, lod control).
-    * Additionally lod_property has to be included too.
+    * Generate the function prototype.
     */
 
-   util_snprintf(func_name, sizeof(func_name), "texfunc_res_%d_sam_%d_%x",
-                 texture_index, sampler_index, sample_key);
+   arg_types[num_param++] = LLVMTypeOf(params->context_ptr);
+   if (need_cache) {
+      arg_types[num_param++] = LLVMTypeOf(params->thread_data_ptr);
+   }
+   for (i = 0; i < num_coords; i++) {
+      arg_types[num_param++] = LLVMTypeOf(coords[0]);
+      assert(LLVMTypeOf(coords[0]) == LLVMTypeOf(coords[i]));
+   }
+   if (layer) {
+      arg_types[num_param++] = LLVMTypeOf(coords[layer]);
+      assert(LLVMTypeOf(coords[0]) == LLVMTypeOf(coords[layer]));
+   }
+   if (sample_key & LP_SAMPLER_SHADOW) {
+      arg_types[num_param++] = LLVMTypeOf(coords[0]);
+   }
+   if (sample_key & LP_SAMPLER_OFFSETS) {
+      for (i = 0; i < num_offsets; i++) {
+         arg_types[num_param++] = LLVMTypeOf(offsets[0]);
+         assert(LLVMTypeOf(offsets[0]) == LLVMTypeOf(offsets[i]));
+      }
+   }
+   if (lod_control == LP_SAMPLER_LOD_BIAS ||
+       lod_control == LP_SAMPLER_LOD_EXPLICIT) {
+      arg_types[num_param++] = LLVMTypeOf(params->lod);
+   }
+   else if (lod_control == LP_SAMPLER_LOD_DERIVATIVES) {
+      for (i = 0; i < num_derivs; i++) {
+         arg_types[num_param++] = LLVMTypeOf(derivs->ddx[i]);
+         arg_types[num_param++] = LLVMTypeOf(derivs->ddy[i]);
+         assert(LLVMTypeOf(derivs->ddx[0]) == LLVMTypeOf(derivs->ddx[i]));
+         assert(LLVMTypeOf(derivs->ddy[0]) == LLVMTypeOf(derivs->ddy[i]));
+      }
+   }
 
-   function = LLVMGetNamedFunction(module, func_name);
+   val_type[0] = val_type[1] = val_type[2] = val_type[3] =
+      lp_build_vec_type(gallivm, params->type);
+   ret_type = LLVMStructTypeInContext(gallivm->context, val_type, 4, 0);
 
-   if(!function) {
-      LLVMTypeRef arg_types[LP_MAX_TEX_FUNC_ARGS];
-      LLVMTypeRef ret_type;
-      LLVMTypeRef function_type;
-      LLVMTypeRef val_type[4];
-      unsigned num_param = 0;
+   function = NULL;
+   if (dynamic_state->func_cache) {
+      const void *code = lp_sample_func_cache_get(dynamic_state->func_cache,
+                                                  static_texture_state,
+                                                  static_sampler_state,
+                                                  dynamic_state,
+                                                  params,
+                                                  need_cache,
+                                                  ret_type,
+                                                  arg_types,
+                                                  num_param);
+      if (code) {
+         function = lp_build_const_func_pointer(gallivm, code, ret_type,
+                                                arg_types, num_param,
+                                                "texfunc");
+      }
+   }
 
+   if (!function) {
       /*
-       * Generate the function prototype.
+       * texture function matches are found by name.
+       * Thus the name has to include both the texture and sampler unit
+       * (which covers all static state) plus the actual texture function
+       * (including things like offsets, shadow coord, lod control).
+       * Additionally lod_property has to be included too.
        */
 
-      arg_types[num_param++] = LLVMTypeOf(params->context_ptr);
-      if (need_cache) {
-         arg_types[num_param++] = LLVMTypeOf(params->thread_data_ptr);
-      }
-      for (i = 0; i < num_coords; i++) {
-         arg_types[num_param++] = LLVMTypeOf(coords[0]);
-         assert(LLVMTypeOf(coords[0]) == LLVMTypeOf(coords[i]));
-      }
-      if (layer) {
-         arg_types[num_param++] = LLVMTypeOf(coords[layer]);
-         assert(LLVMTypeOf(coords[0]) == LLVMTypeOf(coords[layer]));
-      }
-      if (sample_key & LP_SAMPLER_SHADOW) {
-         arg_types[num_param++] = LLVMTypeOf(coords[0]);
-      }
-      if (sample_key & LP_SAMPLER_OFFSETS) {
-         for (i = 0; i < num_offsets; i++) {
-            arg_types[num_param++] = LLVMTypeOf(offsets[0]);
-            assert(LLVMTypeOf(offsets[0]) == LLVMTypeOf(offsets[i]));
-         }
-      }
-      if (lod_control == LP_SAMPLER_LOD_BIAS ||
-          lod_control == LP_SAMPLER_LOD_EXPLICIT) {
-         arg_types[num_param++] = LLVMTypeOf(params->lod);
-      }
-      else if (lod_control == LP_SAMPLER_LOD_DERIVATIVES) {
-         for (i = 0; i < num_derivs; i++) {
-            arg_types[num_param++] = LLVMTypeOf(derivs->ddx[i]);
-            arg_types[num_param++] = LLVMTypeOf(derivs->ddy[i]);
-            assert(LLVMTypeOf(derivs->ddx[0]) == LLVMTypeOf(derivs->ddx[i]));
-            assert(LLVMTypeOf(derivs->ddy[0]) == LLVMTypeOf(derivs->ddy[i]));
-         }
-      }
+      util_snprintf(func_name, sizeof(func_name), "texfunc_res_%d_sam_%d_%x",
+                    texture_index, sampler_index, sample_key);
+
+      function = LLVMGetNamedFunction(module, func_name);
+   }
+
+   if (!function) {
+      LLVMTypeRef function_type;
 
-      val_type[0] = val_type[1] = val_type[2] = val_type[3] =
-         lp_build_vec_type(gallivm, params->type);
-      ret_type = LLVMStructTypeInContext(gallivm->context, val_type, 4, 0);
       function_type = LLVMFunctionType(ret_type, arg_types, num_param, 0);
       function = LLVMAddFunction(module, func_name, function_type);
 
@@ -465,6 +465,15 @@ struct lp_build_tgsi_soa_context
     */
    LLVMValueRef temps_array;
 
+   /* When every indirect access to temporaries names a declared array, only
+    * the indexed arrays live in memory, in temp_array_allocas[ArrayID - 1],
+    * and temps[] points into them for the registers they hold.  The other
+    * temporaries keep their own allocas, which LLVM promotes to registers.
+    */
+   struct tgsi_array_info *temp_arrays;
+   LLVMValueRef *temp_array_allocas;
+   unsigned num_temp_arrays;
+
    /* We allocate/use this array of output if (1 << TGSI_FILE_OUTPUT) is
     * set in the indirect_files field.
     * The outputs[] array above is unused then.
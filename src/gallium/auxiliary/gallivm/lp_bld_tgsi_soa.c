@@ -1063,28 +1063,18 @@ emit_mask_scatter(struct lp_build_tgsi_soa_context *bld,
 
 
 /**
- * Read the current value of the ADDR register, convert the floats to
- * ints, add the base index and return the vector of offsets.
- * The offsets will be used to index into the constant buffer or
- * temporary register file.
+ * Read the current value of the register used for indirect addressing,
+ * as a vector of ints.
  */
 static LLVMValueRef
-get_indirect_index(struct lp_build_tgsi_soa_context *bld,
-                   unsigned reg_file, unsigned reg_index,
-                   const struct tgsi_ind_register *indirect_reg)
+get_indirect_rel(struct lp_build_tgsi_soa_context *bld,
+                 const struct tgsi_ind_register *indirect_reg)
 {
    LLVMBuilderRef builder = bld->bld_base.base.gallivm->builder;
    struct lp_build_context *uint_bld = &bld->bld_base.uint_bld;
    /* always use X component of address register */
    unsigned swizzle = indirect_reg->Swizzle;
-   LLVMValueRef base;
    LLVMValueRef rel;
-   LLVMValueRef max_index;
-   LLVMValueRef index;
-
-   assert(bld->indirect_files & (1 << reg_file));
-
-   base = lp_build_const_int_vec(bld->bld_base.base.gallivm, uint_bld->type, reg_index);
 
    assert(swizzle < 4);
    switch (indirect_reg->File) {
@@ -1106,7 +1096,30 @@ get_indirect_index(struct lp_build_tgsi_soa_context *bld,
       rel = uint_bld->zero;
    }
 
-   index = lp_build_add(uint_bld, base, rel);
+   return rel;
+}
+
+/**
+ * Read the current value of the ADDR register, convert the floats to
+ * ints, add the base index and return the vector of offsets.
+ * The offsets will be used to index into the constant buffer or
+ * temporary register file.
+ */
+static LLVMValueRef
+get_indirect_index(struct lp_build_tgsi_soa_context *bld,
+                   unsigned reg_file, unsigned reg_index,
+                   const struct tgsi_ind_register *indirect_reg)
+{
+   struct lp_build_context *uint_bld = &bld->bld_base.uint_bld;
+   LLVMValueRef base;
+   LLVMValueRef max_index;
+   LLVMValueRef index;
+
+   assert(bld->indirect_files & (1 << reg_file));
+
+   base = lp_build_const_int_vec(bld->bld_base.base.gallivm, uint_bld->type, reg_index);
+
+   index = lp_build_add(uint_bld, base, get_indirect_rel(bld, indirect_reg));
 
    /*
     * emit_fetch_constant handles constant buffer overflow so this code
@@ -1129,6 +1142,66 @@ get_indirect_index(struct lp_build_tgsi_soa_context *bld,
    return index;
 }
 
+/**
+ * Like get_indirect_index(), for temporaries stored per array: returns the
+ * offsets relative to the start of the array named by the access, clamped
+ * to its size, and the array in *array.
+ */
+static LLVMValueRef
+get_temp_array_index(struct lp_build_tgsi_soa_context *bld,
+                     unsigned reg_index,
+                     const struct tgsi_ind_register *indirect_reg,
+                     LLVMValueRef *array)
+{
+   struct gallivm_state *gallivm = bld->bld_base.base.gallivm;
+   struct lp_build_context *uint_bld = &bld->bld_base.uint_bld;
+   const struct tgsi_array_info *info;
+   LLVMValueRef base;
+   LLVMValueRef max_index;
+   LLVMValueRef index;
+
+   assert(indirect_reg->ArrayID > 0 &&
+          indirect_reg->ArrayID <= bld->num_temp_arrays);
+   info = &bld->temp_arrays[indirect_reg->ArrayID - 1];
+   *array = bld->temp_array_allocas[indirect_reg->ArrayID - 1];
+   assert(*array);
+
+   base = lp_build_const_int_vec(gallivm, uint_bld->type,
+                                 reg_index - info->range.First);
+   index = lp_build_add(uint_bld, base, get_indirect_rel(bld, indirect_reg));
+
+   max_index = lp_build_const_int_vec(gallivm, uint_bld->type,
+                                      info->range.Last - info->range.First);
+   return lp_build_min(uint_bld, index, max_index);
+}
+
+/**
+ * Return whether all the active lanes of an index vector hold the same
+ * value, as an i1, and that value in *scalar_index.
+ */
+static LLVMValueRef
+index_is_uniform(struct lp_build_tgsi_soa_context *bld,
+                 LLVMValueRef indexes,
+                 LLVMValueRef *scalar_index)
+{
+   struct gallivm_state *gallivm = bld->bld_base.base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   struct lp_build_context *uint_bld = &bld->bld_base.uint_bld;
+   LLVMValueRef first, diff;
+
+   first = LLVMBuildExtractElement(builder, indexes,
+                                   lp_build_const_int32(gallivm, 0), "");
+   diff = lp_build_compare(gallivm, uint_bld->type, PIPE_FUNC_NOTEQUAL,
+                           indexes, lp_build_broadcast_scalar(uint_bld, first));
+   if (bld->exec_mask.has_mask)
+      diff = LLVMBuildAnd(builder, diff, bld->exec_mask.exec_mask, "");
+
+   *scalar_index = first;
+   return LLVMBuildNot(builder,
+                       lp_build_any_true_range(uint_bld, uint_bld->type.length,
+                                               diff), "");
+}
+
 static struct lp_build_context *
 stype_to_fetch(struct lp_build_tgsi_context * bld_base,
 	       enum tgsi_opcode_type stype)
@@ -1256,9 +1329,56 @@ emit_fetch_constant(
          swizzle_vec2 = lp_build_const_int_vec(gallivm, uint_bld->type, swizzle + 1);
          index_vec2 = lp_build_shl_imm(uint_bld, indirect_index, 2);
          index_vec2 = lp_build_add(uint_bld, index_vec2, swizzle_vec2);
+
+         /* Gather values from the constant buffer */
+         res = build_gather(bld_base, consts_ptr, index_vec, overflow_mask, index_vec2);
+      }
+      else {
+         struct lp_build_if_state if_ctx;
+         LLVMValueRef res_var;
+         LLVMValueRef is_uniform, scalar_index;
+
+         /*
+          * If all active lanes fetch the same constant, as in loops over
+          * uniform arrays, a single scalar load is enough.
+          */
+         res_var = lp_build_alloca(gallivm, bld_base->base.vec_type, "");
+         is_uniform = index_is_uniform(bld, indirect_index, &scalar_index);
+
+         lp_build_if(&if_ctx, gallivm, is_uniform);
+         {
+            LLVMValueRef overflow, index, scalar_ptr, scalar;
+
+            overflow = LLVMBuildICmp(builder, LLVMIntUGE, scalar_index,
+                                     bld->consts_sizes[dimension], "");
+            index = LLVMBuildShl(builder, scalar_index,
+                                 lp_build_const_int32(gallivm, 2), "");
+            index = LLVMBuildAdd(builder, index,
+                                 lp_build_const_int32(gallivm, swizzle), "");
+            index = LLVMBuildSelect(builder, overflow,
+                                    lp_build_const_int32(gallivm, 0), index, "");
+
+            scalar_ptr = LLVMBuildGEP(builder, consts_ptr, &index, 1, "");
+            scalar = LLVMBuildLoad(builder, scalar_ptr, "");
+            scalar = LLVMBuildSelect(builder, overflow,
+                                     lp_build_const_float(gallivm, 0.0f),
+                                     scalar, "");
+            LLVMBuildStore(builder,
+                           lp_build_broadcast_scalar(&bld_base->base, scalar),
+                           res_var);
+         }
+         lp_build_else(&if_ctx);
+         {
+            /* Gather values from the constant buffer */
+            LLVMBuildStore(builder,
+                           build_gather(bld_base, consts_ptr, index_vec,
+                                        overflow_mask, NULL),
+                           res_var);
+         }
+         lp_build_endif(&if_ctx);
+
+         res = LLVMBuildLoad(builder, res_var, "");
       }
-      /* Gather values from the constant buffer */
-      res = build_gather(bld_base, consts_ptr, index_vec, overflow_mask, index_vec2);
    }
    else {
       LLVMValueRef index;  /* index into the const buffer */
@@ -1326,6 +1446,87 @@ emit_fetch_64bit(
    return LLVMBuildBitCast(builder, res, bld_fetch->vec_type, "");
 }
 
+/**
+ * Fetch a channel of an indirectly addressed register from an array with
+ * one SoA vector per register channel.
+ *
+ * When all the active lanes use the same index, as with loop counters or
+ * indices computed from uniforms, this does a single vector load instead
+ * of a per-lane gather.
+ */
+static LLVMValueRef
+build_soa_array_fetch(struct lp_build_tgsi_soa_context *bld,
+                      LLVMValueRef array,
+                      LLVMValueRef indirect_index,
+                      unsigned swizzle,
+                      enum tgsi_opcode_type stype,
+                      boolean need_perelement_offset)
+{
+   struct lp_build_tgsi_context *bld_base = &bld->bld_base;
+   struct gallivm_state *gallivm = bld_base->base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   boolean is_64bit = tgsi_type_is_64bit(stype);
+   LLVMTypeRef res_type = is_64bit ? stype_to_fetch(bld_base, stype)->vec_type :
+                                     bld_base->base.vec_type;
+   struct lp_build_if_state if_ctx;
+   LLVMValueRef res_var, res;
+   LLVMValueRef is_uniform, scalar_index;
+
+   res_var = lp_build_alloca(gallivm, res_type, "");
+   is_uniform = index_is_uniform(bld, indirect_index, &scalar_index);
+
+   lp_build_if(&if_ctx, gallivm, is_uniform);
+   {
+      LLVMValueRef lindex, ptr;
+
+      /* lindex = scalar_index * 4 + swizzle */
+      lindex = LLVMBuildShl(builder, scalar_index,
+                            lp_build_const_int32(gallivm, 2), "");
+      lindex = LLVMBuildAdd(builder, lindex,
+                            lp_build_const_int32(gallivm, swizzle), "");
+      ptr = LLVMBuildGEP(builder, array, &lindex, 1, "");
+      res = LLVMBuildLoad(builder, ptr, "");
+
+      if (is_64bit) {
+         LLVMValueRef res2;
+
+         lindex = LLVMBuildAdd(builder, lindex,
+                               lp_build_const_int32(gallivm, 1), "");
+         ptr = LLVMBuildGEP(builder, array, &lindex, 1, "");
+         res2 = LLVMBuildLoad(builder, ptr, "");
+         res = emit_fetch_64bit(bld_base, stype, res, res2);
+      }
+      LLVMBuildStore(builder, res, res_var);
+   }
+   lp_build_else(&if_ctx);
+   {
+      LLVMValueRef index_vec, index_vec2 = NULL;
+      LLVMTypeRef fptr_type;
+
+      index_vec = get_soa_array_offsets(&bld_base->uint_bld,
+                                        indirect_index,
+                                        swizzle,
+                                        need_perelement_offset);
+      if (is_64bit) {
+         index_vec2 = get_soa_array_offsets(&bld_base->uint_bld,
+                                            indirect_index,
+                                            swizzle + 1,
+                                            need_perelement_offset);
+      }
+
+      /* cast the array pointer to float* */
+      fptr_type = LLVMPointerType(LLVMFloatTypeInContext(gallivm->context), 0);
+      array = LLVMBuildBitCast(builder, array, fptr_type, "");
+
+      res = build_gather(bld_base, array, index_vec, NULL, index_vec2);
+      res = LLVMBuildBitCast(builder, res, res_type, "");
+      LLVMBuildStore(builder, res, res_var);
+   }
+   lp_build_endif(&if_ctx);
+
+   return LLVMBuildLoad(builder, res_var, "");
+}
+
 static LLVMValueRef
 emit_fetch_immediate(
    struct lp_build_tgsi_context * bld_base,
@@ -1339,17 +1540,8 @@ emit_fetch_immediate(
    LLVMValueRef res = NULL;
 
    if (bld->use_immediates_array || reg->Register.Indirect) {
-      LLVMValueRef imms_array;
-      LLVMTypeRef fptr_type;
-
-      /* cast imms_array pointer to float* */
-      fptr_type = LLVMPointerType(LLVMFloatTypeInContext(gallivm->context), 0);
-      imms_array = LLVMBuildBitCast(builder, bld->imms_array, fptr_type, "");
-
       if (reg->Register.Indirect) {
          LLVMValueRef indirect_index;
-         LLVMValueRef index_vec;  /* index into the immediate register array */
-         LLVMValueRef index_vec2 = NULL;
          indirect_index = get_indirect_index(bld,
                                              reg->Register.File,
                                              reg->Register.Index,
@@ -1360,17 +1552,8 @@ emit_fetch_immediate(
           * to store them the same as constants) but all elements are the same
           * in any case.
           */
-         index_vec = get_soa_array_offsets(&bld_base->uint_bld,
-                                           indirect_index,
-                                           swizzle,
-                                           FALSE);
-         if (tgsi_type_is_64bit(stype))
-            index_vec2 = get_soa_array_offsets(&bld_base->uint_bld,
-                                              indirect_index,
-                                              swizzle + 1,
-                                              FALSE);
-         /* Gather values from the immediate register array */
-         res = build_gather(bld_base, imms_array, index_vec, NULL, index_vec2);
+         res = build_soa_array_fetch(bld, bld->imms_array, indirect_index,
+                                     swizzle, stype, FALSE);
       } else {
          LLVMValueRef lindex = lp_build_const_int32(gallivm,
                                         reg->Register.Index * 4 + swizzle);
@@ -1419,32 +1602,14 @@ emit_fetch_input(
 
    if (reg->Register.Indirect) {
       LLVMValueRef indirect_index;
-      LLVMValueRef index_vec;  /* index into the input reg array */
-      LLVMValueRef index_vec2 = NULL;
-      LLVMValueRef inputs_array;
-      LLVMTypeRef fptr_type;
 
       indirect_index = get_indirect_index(bld,
                                           reg->Register.File,
                                           reg->Register.Index,
                                           &reg->Indirect);
 
-      index_vec = get_soa_array_offsets(&bld_base->uint_bld,
-                                        indirect_index,
-                                        swizzle,
-                                        TRUE);
-      if (tgsi_type_is_64bit(stype)) {
-         index_vec2 = get_soa_array_offsets(&bld_base->uint_bld,
-                                           indirect_index,
-                                           swizzle + 1,
-                                           TRUE);
-      }
-      /* cast inputs_array pointer to float* */
-      fptr_type = LLVMPointerType(LLVMFloatTypeInContext(gallivm->context), 0);
-      inputs_array = LLVMBuildBitCast(builder, bld->inputs_array, fptr_type, "");
-
-      /* Gather values from the input register array */
-      res = build_gather(bld_base, inputs_array, index_vec, NULL, index_vec2);
+      res = build_soa_array_fetch(bld, bld->inputs_array, indirect_index,
+                                  swizzle, stype, TRUE);
    } else {
       if (bld->indirect_files & (1 << TGSI_FILE_INPUT)) {
          LLVMValueRef lindex = lp_build_const_int32(gallivm,
@@ -1571,32 +1736,23 @@ emit_fetch_temporary(
 
    if (reg->Register.Indirect) {
       LLVMValueRef indirect_index;
-      LLVMValueRef index_vec, index_vec2 = NULL;  /* index into the temp reg array */
       LLVMValueRef temps_array;
-      LLVMTypeRef fptr_type;
-
-      indirect_index = get_indirect_index(bld,
-                                          reg->Register.File,
-                                          reg->Register.Index,
-                                          &reg->Indirect);
 
-      index_vec = get_soa_array_offsets(&bld_base->uint_bld,
-                                        indirect_index,
-                                        swizzle,
-                                        TRUE);
-      if (tgsi_type_is_64bit(stype)) {
-               index_vec2 = get_soa_array_offsets(&bld_base->uint_bld,
-                                                  indirect_index,
-                                                  swizzle + 1,
-                                                  TRUE);
+      if (bld->temp_array_allocas) {
+         indirect_index = get_temp_array_index(bld,
+                                               reg->Register.Index,
+                                               &reg->Indirect,
+                                               &temps_array);
+      } else {
+         indirect_index = get_indirect_index(bld,
+                                             reg->Register.File,
+                                             reg->Register.Index,
+                                             &reg->Indirect);
+         temps_array = bld->temps_array;
       }
 
-      /* cast temps_array pointer to float* */
-      fptr_type = LLVMPointerType(LLVMFloatTypeInContext(gallivm->context), 0);
-      temps_array = LLVMBuildBitCast(builder, bld->temps_array, fptr_type, "");
-
-      /* Gather values from the temporary register array */
-      res = build_gather(bld_base, temps_array, index_vec, NULL, index_vec2);
+      res = build_soa_array_fetch(bld, temps_array, indirect_index,
+                                  swizzle, stype, TRUE);
    }
    else {
       LLVMValueRef temp_ptr;
@@ -1757,6 +1913,56 @@ emit_store_64bit_chan(struct lp_build_tgsi_context *bld_base,
    lp_exec_mask_store(&bld->exec_mask, float_bld, temp2, chan_ptr2);
 }
 
+/**
+ * Store a channel of an indirectly addressed register to an array with one
+ * SoA vector per register channel, with the same uniform index fast path
+ * as build_soa_array_fetch().
+ */
+static void
+build_soa_array_store(struct lp_build_tgsi_soa_context *bld,
+                      LLVMValueRef array,
+                      LLVMValueRef indirect_index,
+                      unsigned chan_index,
+                      LLVMValueRef value)
+{
+   struct lp_build_tgsi_context *bld_base = &bld->bld_base;
+   struct gallivm_state *gallivm = bld_base->base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   struct lp_build_if_state if_ctx;
+   LLVMValueRef is_uniform, scalar_index;
+
+   is_uniform = index_is_uniform(bld, indirect_index, &scalar_index);
+
+   lp_build_if(&if_ctx, gallivm, is_uniform);
+   {
+      LLVMValueRef lindex, ptr;
+
+      /* lindex = scalar_index * 4 + chan_index */
+      lindex = LLVMBuildShl(builder, scalar_index,
+                            lp_build_const_int32(gallivm, 2), "");
+      lindex = LLVMBuildAdd(builder, lindex,
+                            lp_build_const_int32(gallivm, chan_index), "");
+      ptr = LLVMBuildGEP(builder, array, &lindex, 1, "");
+      lp_exec_mask_store(&bld->exec_mask, &bld_base->base, value, ptr);
+   }
+   lp_build_else(&if_ctx);
+   {
+      LLVMValueRef index_vec;
+      LLVMTypeRef fptr_type;
+
+      index_vec = get_soa_array_offsets(&bld_base->uint_bld,
+                                        indirect_index,
+                                        chan_index,
+                                        TRUE);
+
+      fptr_type = LLVMPointerType(LLVMFloatTypeInContext(gallivm->context), 0);
+      array = LLVMBuildBitCast(builder, array, fptr_type, "");
+
+      emit_mask_scatter(bld, array, index_vec, value, &bld->exec_mask);
+   }
+   lp_build_endif(&if_ctx);
+}
+
 /**
  * Register store.
  */
@@ -1775,6 +1981,7 @@ emit_store_chan(
    struct lp_build_context *float_bld = &bld_base->base;
    struct lp_build_context *int_bld = &bld_base->int_bld;
    LLVMValueRef indirect_index = NULL;
+   LLVMValueRef temps_array = bld->temps_array;
    enum tgsi_opcode_type dtype = tgsi_opcode_infer_dst_type(inst->Instruction.Opcode);
 
    /*
@@ -1795,10 +2002,18 @@ emit_store_chan(
        * to 64-bit values, it normally uses MOV to do indirect stores.
        */
       assert(!tgsi_type_is_64bit(dtype));
-      indirect_index = get_indirect_index(bld,
-                                          reg->Register.File,
-                                          reg->Register.Index,
-                                          &reg->Indirect);
+      if (reg->Register.File == TGSI_FILE_TEMPORARY &&
+          bld->temp_array_allocas) {
+         indirect_index = get_temp_array_index(bld,
+                                               reg->Register.Index,
+                                               &reg->Indirect,
+                                               &temps_array);
+      } else {
+         indirect_index = get_indirect_index(bld,
+                                             reg->Register.File,
+                                             reg->Register.Index,
+                                             &reg->Indirect);
+      }
    } else {
       assert(reg->Register.Index <=
                              bld_base->info->file_max[reg->Register.File]);
@@ -1814,21 +2029,8 @@ emit_store_chan(
       value = LLVMBuildBitCast(builder, value, float_bld->vec_type, "");
 
       if (reg->Register.Indirect) {
-         LLVMValueRef index_vec;  /* indexes into the output registers */
-         LLVMValueRef outputs_array;
-         LLVMTypeRef fptr_type;
-
-         index_vec = get_soa_array_offsets(&bld_base->uint_bld,
-                                           indirect_index,
-                                           chan_index,
-                                           TRUE);
-
-         fptr_type = LLVMPointerType(LLVMFloatTypeInContext(gallivm->context), 0);
-         outputs_array = LLVMBuildBitCast(builder, bld->outputs_array, fptr_type, "");
-
-         /* Scatter store values into output registers */
-         emit_mask_scatter(bld, outputs_array, index_vec, value,
-                           &bld->exec_mask);
+         build_soa_array_store(bld, bld->outputs_array, indirect_index,
+                               chan_index, value);
       }
       else {
          LLVMValueRef out_ptr = lp_get_output_ptr(bld, reg->Register.Index,
@@ -1852,21 +2054,8 @@ emit_store_chan(
          value = LLVMBuildBitCast(builder, value,  LLVMVectorType(LLVMFloatTypeInContext(gallivm->context), bld_base->base.type.length * 2), "");
 
       if (reg->Register.Indirect) {
-         LLVMValueRef index_vec;  /* indexes into the temp registers */
-         LLVMValueRef temps_array;
-         LLVMTypeRef fptr_type;
-
-         index_vec = get_soa_array_offsets(&bld_base->uint_bld,
-                                           indirect_index,
-                                           chan_index,
-                                           TRUE);
-
-         fptr_type = LLVMPointerType(LLVMFloatTypeInContext(gallivm->context), 0);
-         temps_array = LLVMBuildBitCast(builder, bld->temps_array, fptr_type, "");
-
-         /* Scatter store values into temp registers */
-         emit_mask_scatter(bld, temps_array, index_vec, value,
-                           &bld->exec_mask);
+         build_soa_array_store(bld, temps_array, indirect_index,
+                               chan_index, value);
       }
       else {
          LLVMValueRef temp_ptr;
@@ -2866,10 +3055,25 @@ lp_emit_declaration_soa(
    switch (decl->Declaration.File) {
    case TGSI_FILE_TEMPORARY:
       if (!(bld->indirect_files & (1 << TGSI_FILE_TEMPORARY))) {
+         LLVMValueRef array = NULL;
+
+         if (decl->Declaration.Array && bld->temp_array_allocas &&
+             decl->Array.ArrayID <= bld->num_temp_arrays)
+            array = bld->temp_array_allocas[decl->Array.ArrayID - 1];
+
          assert(last < LP_MAX_INLINED_TEMPS);
          for (idx = first; idx <= last; ++idx) {
-            for (i = 0; i < TGSI_NUM_CHANNELS; i++)
-               bld->temps[idx][i] = lp_build_alloca(gallivm, vec_type, "temp");
+            for (i = 0; i < TGSI_NUM_CHANNELS; i++) {
+               if (array) {
+                  LLVMValueRef lindex =
+                     lp_build_const_int32(gallivm, (idx - first) * 4 + i);
+                  bld->temps[idx][i] = LLVMBuildGEP(gallivm->builder, array,
+                                                    &lindex, 1, "");
+               } else {
+                  bld->temps[idx][i] = lp_build_alloca(gallivm, vec_type,
+                                                       "temp");
+               }
+            }
          }
       }
       break;
@@ -3775,6 +3979,110 @@ static void emit_epilogue(struct lp_build_tgsi_context * bld_base)
    }
 }
 
+static boolean
+use_temp_array(const struct tgsi_array_info *arrays, unsigned num_arrays,
+               boolean *indexed, const struct tgsi_ind_register *indirect,
+               unsigned reg_index)
+{
+   const struct tgsi_array_info *array;
+
+   if (indirect->ArrayID == 0 || indirect->ArrayID > num_arrays)
+      return FALSE;
+
+   array = &arrays[indirect->ArrayID - 1];
+   if (!array->declared ||
+       reg_index < array->range.First || reg_index > array->range.Last)
+      return FALSE;
+
+   indexed[indirect->ArrayID - 1] = TRUE;
+   return TRUE;
+}
+
+/**
+ * Store the indirectly addressed temporaries per declared array rather
+ * than the whole register file in memory, if every indirect access to
+ * temporaries names its array.  Only the arrays that are actually indexed
+ * get memory of their own.
+ */
+static void
+setup_temp_arrays(struct lp_build_tgsi_soa_context *bld,
+                  const struct tgsi_token *tokens)
+{
+   struct gallivm_state *gallivm = bld->bld_base.base.gallivm;
+   unsigned num_arrays = bld->bld_base.info->array_max[TGSI_FILE_TEMPORARY];
+   struct tgsi_parse_context parse;
+   struct tgsi_array_info *arrays;
+   LLVMValueRef *allocas;
+   boolean *indexed;
+   boolean ok = TRUE;
+   unsigned i;
+
+   if (num_arrays == 0)
+      return;
+
+   arrays = CALLOC(num_arrays, sizeof *arrays);
+   indexed = CALLOC(num_arrays, sizeof *indexed);
+   if (!arrays || !indexed ||
+       tgsi_parse_init(&parse, tokens) != TGSI_PARSE_OK) {
+      FREE(arrays);
+      FREE(indexed);
+      return;
+   }
+
+   tgsi_scan_arrays(tokens, TGSI_FILE_TEMPORARY, num_arrays, arrays);
+
+   while (ok && !tgsi_parse_end_of_tokens(&parse)) {
+      const struct tgsi_full_instruction *inst;
+
+      tgsi_parse_token(&parse);
+      if (parse.FullToken.Token.Type != TGSI_TOKEN_TYPE_INSTRUCTION)
+         continue;
+
+      inst = &parse.FullToken.FullInstruction;
+      for (i = 0; ok && i < inst->Instruction.NumSrcRegs; i++) {
+         const struct tgsi_full_src_register *src = &inst->Src[i];
+         if (src->Register.File == TGSI_FILE_TEMPORARY &&
+             src->Register.Indirect)
+            ok = use_temp_array(arrays, num_arrays, indexed,
+                                &src->Indirect, src->Register.Index);
+      }
+      for (i = 0; ok && i < inst->Instruction.NumDstRegs; i++) {
+         const struct tgsi_full_dst_register *dst = &inst->Dst[i];
+         if (dst->Register.File == TGSI_FILE_TEMPORARY &&
+             dst->Register.Indirect)
+            ok = use_temp_array(arrays, num_arrays, indexed,
+                                &dst->Indirect, dst->Register.Index);
+      }
+   }
+
+   tgsi_parse_free(&parse);
+
+   allocas = ok ? CALLOC(num_arrays, sizeof *allocas) : NULL;
+   if (!allocas) {
+      FREE(arrays);
+      FREE(indexed);
+      return;
+   }
+
+   for (i = 0; i < num_arrays; i++) {
+      if (indexed[i]) {
+         unsigned size = arrays[i].range.Last - arrays[i].range.First + 1;
+         allocas[i] = lp_build_array_alloca(gallivm,
+                                            bld->bld_base.base.vec_type,
+                                            lp_build_const_int32(gallivm,
+                                                                 size * 4),
+                                            "temp_array");
+      }
+   }
+
+   FREE(indexed);
+
+   bld->temp_arrays = arrays;
+   bld->temp_array_allocas = allocas;
+   bld->num_temp_arrays = num_arrays;
+   bld->indirect_files &= ~(1 << TGSI_FILE_TEMPORARY);
+}
+
 void
 lp_build_tgsi_soa(struct gallivm_state *gallivm,
                   const struct tgsi_token *tokens,
@@ -3825,6 +4133,9 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
       int64_type.width *= 2;
       lp_build_context_init(&bld.bld_base.int64_bld, gallivm, int64_type);
    }
+   if (info->properties[TGSI_PROPERTY_MEDIUMP_FLOAT]) {
+      bld.bld_base.base.precision = LP_FLOAT_PRECISION_MEDIUM;
+   }
    bld.mask = mask;
    bld.inputs = inputs;
    bld.outputs = outputs;
@@ -3844,6 +4155,9 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
    if (info->file_max[TGSI_FILE_TEMPORARY] >= LP_MAX_INLINED_TEMPS) {
       bld.indirect_files |= (1 << TGSI_FILE_TEMPORARY);
    }
+   else if (bld.indirect_files & (1 << TGSI_FILE_TEMPORARY)) {
+      setup_temp_arrays(&bld, tokens);
+   }
    /*
     * For performance reason immediates are always backed in a static
     * array, but if their number is too great, we have to use just
@@ -3964,4 +4278,7 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
 
    }
    lp_exec_mask_fini(&bld.exec_mask);
+
+   FREE(bld.temp_arrays);
+   FREE(bld.temp_array_allocas);
 }
@@ -388,6 +388,7 @@ lp_build_context_init(struct lp_build_context *bld,
    bld->undef = LLVMGetUndef(bld->vec_type);
    bld->zero = LLVMConstNull(bld->vec_type);
    bld->one = lp_build_one(gallivm, type);
+   bld->precision = LP_FLOAT_PRECISION_HIGH;
 }
 
 
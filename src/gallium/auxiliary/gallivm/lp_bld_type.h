@@ -132,6 +132,23 @@ struct lp_type {
 };
 
 
+/**
+ * Precision required from floating point math functions (exp2, log2, rcp,
+ * rsqrt, ...), as allowed by GLSL ES precision qualifiers.
+ */
+enum lp_float_precision
+{
+   /** Full single precision, the default */
+   LP_FLOAT_PRECISION_HIGH = 0,
+
+   /**
+    * At least 10 bits of relative precision, enough for GLSL ES mediump
+    * (and lowp) computations.
+    */
+   LP_FLOAT_PRECISION_MEDIUM
+};
+
+
 /**
  * We need most of the information here in order to correctly and efficiently
  * translate an arithmetic operation into LLVM IR. Putting it here avoids the
@@ -167,6 +184,9 @@ struct lp_build_context
 
    /** Same as lp_build_one(type) */
    LLVMValueRef one;
+
+   /** Precision required from the math functions */
+   enum lp_float_precision precision;
 };
 
 
@@ -42,6 +42,9 @@
 #include "hud/font.h"
 
 #include "cso_cache/cso_context.h"
+#include "os/os_thread.h"
+#include "os/os_time.h"
+#include "util/u_atomic.h"
 #include "util/u_draw_quad.h"
 #include "util/u_format.h"
 #include "util/u_inlines.h"
@@ -54,6 +57,10 @@
 #include "tgsi/tgsi_text.h"
 #include "tgsi/tgsi_dump.h"
 
+#if defined(PIPE_OS_LINUX)
+#include <sched.h>
+#endif
+
 /* Control the visibility of all HUD contexts */
 static boolean huds_visible = TRUE;
 
@@ -101,6 +108,26 @@ struct hud_context {
    } text, bg, whitelines, color_prims;
 
    bool has_srgb;
+
+   /* OS sources are queried by this thread instead of the rendering one */
+   struct {
+      thrd_t thread;
+      boolean running;
+      unsigned quit;
+      uint64_t interval; /* in microseconds */
+      struct hud_graph **graphs;
+      unsigned num_graphs;
+   } sampler;
+
+   struct hud_export *export;
+};
+
+/* Samples of all graphs written to a CSV or JSON file */
+struct hud_export {
+   FILE *file;
+   boolean json;
+   unsigned num_samples;
+   int64_t start_time;
 };
 
 #ifdef PIPE_OS_UNIX
@@ -470,6 +497,62 @@ hud_prepare_vertices(struct hud_context *hud, struct vertex_queue *v,
    v->buffer_size = stride * num_vertices;
 }
 
+static void hud_graph_drain_samples(struct hud_graph *gr);
+
+/**
+ * Get new values of all graphs.
+ */
+static void
+hud_query_new_values(struct hud_context *hud)
+{
+   struct hud_pane *pane;
+   struct hud_graph *gr, *next;
+
+   hud_batch_query_update(hud->batch_query);
+
+   LIST_FOR_EACH_ENTRY(pane, &hud->pane_list, head) {
+      LIST_FOR_EACH_ENTRY(gr, &pane->graph_list, head) {
+         if (gr->sampled)
+            hud_graph_drain_samples(gr);
+         else
+            gr->query_new_value(gr);
+      }
+
+      if (pane->sort_items) {
+         LIST_FOR_EACH_ENTRY_SAFE(gr, next, &pane->graph_list, head) {
+            /* ignore the last one */
+            if (&gr->head == pane->graph_list.prev)
+               continue;
+
+            /* This is an incremental bubble sort, because we only do one pass
+             * per frame. It will eventually reach an equilibrium.
+             */
+            if (gr->current_value <
+                LIST_ENTRY(struct hud_graph, next, head)->current_value) {
+               LIST_DEL(&gr->head);
+               LIST_ADD(&gr->head, &next->head);
+            }
+         }
+      }
+   }
+}
+
+static void
+hud_begin_queries(struct hud_context *hud)
+{
+   struct hud_pane *pane;
+   struct hud_graph *gr;
+
+   hud_batch_query_begin(hud->batch_query);
+
+   LIST_FOR_EACH_ENTRY(pane, &hud->pane_list, head) {
+      LIST_FOR_EACH_ENTRY(gr, &pane->graph_list, head) {
+         if (gr->begin_query)
+            gr->begin_query(gr);
+      }
+   }
+}
+
 /**
  * Draw the HUD to the texture \p tex.
  * The texture is usually the back buffer being displayed.
@@ -485,10 +568,15 @@ hud_draw(struct hud_context *hud, struct pipe_resource *tex)
    const struct pipe_sampler_state *sampler_states[] =
          { &hud->font_sampler_state };
    struct hud_pane *pane;
-   struct hud_graph *gr, *next;
 
-   if (!huds_visible)
+   if (!huds_visible) {
+      /* Keep the export file going when nothing is drawn. */
+      if (hud->export) {
+         hud_query_new_values(hud);
+         hud_begin_queries(hud);
+      }
       return;
+   }
 
    hud->fb_width = tex->width0;
    hud->fb_height = tex->height0;
@@ -605,30 +693,9 @@ hud_draw(struct hud_context *hud, struct pipe_resource *tex)
                                hud->text.buffer_size / sizeof(float);
 
    /* prepare all graphs */
-   hud_batch_query_update(hud->batch_query);
+   hud_query_new_values(hud);
 
    LIST_FOR_EACH_ENTRY(pane, &hud->pane_list, head) {
-      LIST_FOR_EACH_ENTRY(gr, &pane->graph_list, head) {
-         gr->query_new_value(gr);
-      }
-
-      if (pane->sort_items) {
-         LIST_FOR_EACH_ENTRY_SAFE(gr, next, &pane->graph_list, head) {
-            /* ignore the last one */
-            if (&gr->head == pane->graph_list.prev)
-               continue;
-
-            /* This is an incremental bubble sort, because we only do one pass
-             * per frame. It will eventually reach an equilibrium.
-             */
-            if (gr->current_value <
-                LIST_ENTRY(struct hud_graph, next, head)->current_value) {
-               LIST_DEL(&gr->head);
-               LIST_ADD(&gr->head, &next->head);
-            }
-         }
-      }
-
       hud_pane_accumulate_vertices(hud, pane);
    }
 
@@ -700,15 +767,7 @@ out:
 
    pipe_surface_reference(&surf, NULL);
 
-   /* Start queries. */
-   hud_batch_query_begin(hud->batch_query);
-
-   LIST_FOR_EACH_ENTRY(pane, &hud->pane_list, head) {
-      LIST_FOR_EACH_ENTRY(gr, &pane->graph_list, head) {
-         if (gr->begin_query)
-            gr->begin_query(gr);
-      }
-   }
+   hud_begin_queries(hud);
 }
 
 static void
@@ -904,10 +963,70 @@ hud_pane_add_graph(struct hud_pane *pane, struct hud_graph *gr)
    pane->next_color++;
 }
 
-void
-hud_graph_add_value(struct hud_graph *gr, uint64_t value)
+/**
+ * Write a graph name as a JSON string or a CSV field.
+ */
+static void
+hud_export_name(struct hud_export *export, const char *name)
+{
+   const char *c;
+
+   if (export->json) {
+      fputc('"', export->file);
+      for (c = name; *c; c++) {
+         if (*c == '"' || *c == '\\')
+            fprintf(export->file, "\\%c", *c);
+         else if ((unsigned char)*c < 0x20)
+            fprintf(export->file, "\\u%04x", (unsigned char)*c);
+         else
+            fputc(*c, export->file);
+      }
+      fputc('"', export->file);
+   }
+   else if (strpbrk(name, ",\"\r\n")) {
+      /* RFC 4180: quote the field and double the quotes in it */
+      fputc('"', export->file);
+      for (c = name; *c; c++) {
+         if (*c == '"')
+            fputc('"', export->file);
+         fputc(*c, export->file);
+      }
+      fputc('"', export->file);
+   }
+   else {
+      fputs(name, export->file);
+   }
+}
+
+static void
+hud_export_sample(struct hud_export *export, const struct hud_graph *gr,
+                  int64_t time, uint64_t value)
+{
+   time -= export->start_time;
+
+   if (export->json) {
+      fprintf(export->file, "%s\n  {\"time_us\": %" PRId64 ", \"graph\": ",
+              export->num_samples ? "," : "", time);
+      hud_export_name(export, gr->name);
+      fprintf(export->file, ", \"value\": %" PRIu64 "}", value);
+   }
+   else {
+      fprintf(export->file, "%" PRId64 ",", time);
+      hud_export_name(export, gr->name);
+      fprintf(export->file, ",%" PRIu64 "\n", value);
+   }
+
+   export->num_samples++;
+}
+
+static void
+hud_graph_append_value(struct hud_graph *gr, int64_t time, uint64_t value)
 {
    gr->current_value = value;
+
+   if (gr->export)
+      hud_export_sample(gr->export, gr, time, value);
+
    value = value > gr->pane->ceiling ? gr->pane->ceiling : value;
 
    if (gr->fd)
@@ -934,6 +1053,50 @@ hud_graph_add_value(struct hud_graph *gr, uint64_t value)
    }
 }
 
+void
+hud_graph_add_value(struct hud_graph *gr, uint64_t value)
+{
+   int64_t now = gr->sampled || gr->export ? os_time_get() : 0;
+
+   if (gr->sampled) {
+      /* We are on the sampler thread, hand the value over to hud_draw. */
+      unsigned head = gr->ring.head;
+
+      /* If the ring is full, nothing has been drawn for a while and
+       * the sample is dropped.
+       */
+      if (head - p_atomic_read(&gr->ring.tail) < HUD_SAMPLE_RING_SIZE) {
+         struct hud_sample *sample =
+            &gr->ring.samples[head % HUD_SAMPLE_RING_SIZE];
+
+         sample->time = now;
+         sample->value = value;
+         p_atomic_set(&gr->ring.head, head + 1);
+      }
+      return;
+   }
+
+   hud_graph_append_value(gr, now, value);
+}
+
+/**
+ * Add the values queued by the sampler thread to the graph.
+ */
+static void
+hud_graph_drain_samples(struct hud_graph *gr)
+{
+   unsigned head = p_atomic_read(&gr->ring.head);
+   unsigned tail = gr->ring.tail;
+
+   for (; tail != head; tail++) {
+      const struct hud_sample *sample =
+         &gr->ring.samples[tail % HUD_SAMPLE_RING_SIZE];
+
+      hud_graph_append_value(gr, sample->time, sample->value);
+   }
+   p_atomic_set(&gr->ring.tail, tail);
+}
+
 static void
 hud_graph_destroy(struct hud_graph *graph)
 {
@@ -1403,6 +1566,7 @@ hud_parse_env_var(struct hud_context *hud, const char *env)
 
       LIST_FOR_EACH_ENTRY(gr, &pane->graph_list, head) {
          hud_graph_set_dump_file(gr);
+         gr->export = hud->export;
       }
    }
 }
@@ -1454,6 +1618,10 @@ print_help(struct pipe_screen *screen)
    puts("");
    puts("  Example: GALLIUM_HUD=\".w256.h64.x1600.y520.d.c1000fps+cpu,.datom-count\"");
    puts("");
+   puts("  GALLIUM_HUD_EXPORT=file writes all samples of all graphs to the file,");
+   puts("  as JSON if the name ends with \".json\" and as CSV otherwise.");
+   puts("  Nothing is drawn then, unless GALLIUM_HUD_VISIBLE=true is set.");
+   puts("");
    puts("  Available names:");
    puts("    fps");
    puts("    cpu");
@@ -1511,6 +1679,151 @@ print_help(struct pipe_screen *screen)
    fflush(stdout);
 }
 
+static int
+hud_sampler_thread_func(void *data)
+{
+   struct hud_context *hud = data;
+   unsigned i;
+
+   u_thread_setname("hud sampler");
+
+#if defined(PIPE_OS_LINUX) && defined(HAVE_PTHREAD) && defined(SCHED_IDLE)
+   {
+      /* Only use otherwise idle CPU time, so as not to disturb what the
+       * HUD measures.
+       */
+      struct sched_param param = {0};
+
+      pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+   }
+#endif
+
+   while (!p_atomic_read(&hud->sampler.quit)) {
+      /* The sources only read new values once per period of their pane. */
+      for (i = 0; i < hud->sampler.num_graphs; i++)
+         hud->sampler.graphs[i]->query_new_value(hud->sampler.graphs[i]);
+
+      os_time_sleep(hud->sampler.interval);
+   }
+   return 0;
+}
+
+/**
+ * Move querying OS sources (which read files in /proc, sysfs, etc.) from
+ * hud_draw to a separate thread.  The graph lists are reordered by
+ * hud_draw, so the thread gets its own list of graphs.
+ */
+static void
+hud_start_sampler(struct hud_context *hud)
+{
+   struct hud_pane *pane;
+   struct hud_graph *gr;
+   uint64_t min_period = ~0ull;
+   unsigned num_graphs = 0, i;
+
+   LIST_FOR_EACH_ENTRY(pane, &hud->pane_list, head) {
+      /* Period 0 means sampling every frame, keep that on the rendering
+       * thread.
+       */
+      if (!pane->period)
+         continue;
+
+      LIST_FOR_EACH_ENTRY(gr, &pane->graph_list, head) {
+         if (gr->os_source) {
+            min_period = MIN2(min_period, pane->period);
+            num_graphs++;
+         }
+      }
+   }
+
+   if (!num_graphs)
+      return;
+
+   hud->sampler.graphs = MALLOC(num_graphs * sizeof(*hud->sampler.graphs));
+   if (!hud->sampler.graphs)
+      return;
+
+   LIST_FOR_EACH_ENTRY(pane, &hud->pane_list, head) {
+      if (!pane->period)
+         continue;
+
+      LIST_FOR_EACH_ENTRY(gr, &pane->graph_list, head) {
+         if (gr->os_source) {
+            gr->sampled = TRUE;
+            hud->sampler.graphs[hud->sampler.num_graphs++] = gr;
+         }
+      }
+   }
+
+   /* Wake up often enough to keep the sampling jitter under 10% of the
+    * period, and to not hold up hud_destroy for long.
+    */
+   hud->sampler.interval = CLAMP(min_period / 10, 1000, 50000);
+
+   hud->sampler.thread = u_thread_create(hud_sampler_thread_func, hud);
+   if (!hud->sampler.thread) {
+      for (i = 0; i < hud->sampler.num_graphs; i++)
+         hud->sampler.graphs[i]->sampled = FALSE;
+      hud->sampler.num_graphs = 0;
+      FREE(hud->sampler.graphs);
+      hud->sampler.graphs = NULL;
+      return;
+   }
+   hud->sampler.running = TRUE;
+}
+
+static void
+hud_stop_sampler(struct hud_context *hud)
+{
+   if (hud->sampler.running) {
+      p_atomic_set(&hud->sampler.quit, 1);
+      thrd_join(hud->sampler.thread, NULL);
+      hud->sampler.running = FALSE;
+   }
+   FREE(hud->sampler.graphs);
+   hud->sampler.graphs = NULL;
+}
+
+/**
+ * Open the file for GALLIUM_HUD_EXPORT.  All samples of all graphs are
+ * written to it, as JSON if the file name ends with ".json" and as CSV
+ * otherwise.
+ */
+static struct hud_export *
+hud_export_create(const char *filename)
+{
+   struct hud_export *export;
+   size_t len = strlen(filename);
+
+   export = CALLOC_STRUCT(hud_export);
+   if (!export)
+      return NULL;
+
+   export->file = fopen(filename, "w");
+   if (!export->file) {
+      fprintf(stderr, "gallium_hud: unable to open %s for writing\n",
+              filename);
+      fflush(stderr);
+      FREE(export);
+      return NULL;
+   }
+
+   export->json = len >= 5 && strcmp(filename + len - 5, ".json") == 0;
+   export->start_time = os_time_get();
+
+   fputs(export->json ? "[" : "time_us,graph,value\n", export->file);
+   return export;
+}
+
+static void
+hud_export_destroy(struct hud_export *export)
+{
+   if (export->json)
+      fputs("\n]\n", export->file);
+   fclose(export->file);
+   FREE(export);
+}
+
 struct hud_context *
 hud_create(struct pipe_context *pipe, struct cso_context *cso)
 {
@@ -1519,12 +1832,14 @@ hud_create(struct pipe_context *pipe, struct cso_context *cso)
    struct pipe_sampler_view view_templ;
    unsigned i;
    const char *env = debug_get_option("GALLIUM_HUD", NULL);
+   const char *export_file = debug_get_option("GALLIUM_HUD_EXPORT", NULL);
 #ifdef PIPE_OS_UNIX
    unsigned signo = debug_get_num_option("GALLIUM_HUD_TOGGLE_SIGNAL", 0);
    static boolean sig_handled = FALSE;
    struct sigaction action = {};
 #endif
-   huds_visible = debug_get_bool_option("GALLIUM_HUD_VISIBLE", TRUE);
+   /* Exporting is meant for headless use, don't draw by default. */
+   huds_visible = debug_get_bool_option("GALLIUM_HUD_VISIBLE", !export_file);
 
    if (!env || !*env)
       return NULL;
@@ -1688,7 +2003,11 @@ hud_create(struct pipe_context *pipe, struct cso_context *cso)
    }
 #endif
 
+   if (export_file)
+      hud->export = hud_export_create(export_file);
+
    hud_parse_env_var(hud, env);
+   hud_start_sampler(hud);
    return hud;
 }
 
@@ -1699,6 +2018,8 @@ hud_destroy(struct hud_context *hud)
    struct hud_pane *pane, *pane_tmp;
    struct hud_graph *graph, *graph_tmp;
 
+   hud_stop_sampler(hud);
+
    LIST_FOR_EACH_ENTRY_SAFE(pane, pane_tmp, &hud->pane_list, head) {
       LIST_FOR_EACH_ENTRY_SAFE(graph, graph_tmp, &pane->graph_list, head) {
          LIST_DEL(&graph->head);
@@ -1714,5 +2035,7 @@ hud_destroy(struct hud_context *hud)
    pipe->delete_vs_state(pipe, hud->vs);
    pipe_sampler_view_reference(&hud->font_sampler_view, NULL);
    pipe_resource_reference(&hud->font.texture, NULL);
+   if (hud->export)
+      hud_export_destroy(hud->export);
    FREE(hud);
 }
@@ -31,8 +31,11 @@
 #include "hud/hud_private.h"
 #include "os/os_time.h"
 #include "os/os_thread.h"
+#include "util/u_math.h"
 #include "util/u_memory.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
 #ifdef PIPE_OS_WINDOWS
 #include <windows.h>
@@ -87,52 +90,121 @@ get_cpu_stats(unsigned cpu_index, uint64_t *busy_time, uint64_t *total_time)
 
 #else
 
+/* /proc/stat is parsed once for all CPUs, and the result is shared by all
+ * cpu graphs which sample at about the same time, instead of reading the
+ * whole file again for each of them.
+ */
+#define CPU_STATS_MAX_AGE 1000 /* in microseconds */
+
+struct cpu_stats {
+   boolean valid;
+   uint64_t busy_time, total_time;
+};
+
+static mtx_t cpu_stats_mutex = _MTX_INITIALIZER_NP;
+static struct cpu_stats *cpu_stats; /* [0] = all CPUs, [i + 1] = CPU i */
+static unsigned cpu_stats_size;
+static int64_t cpu_stats_time;
+
 static boolean
-get_cpu_stats(unsigned cpu_index, uint64_t *busy_time, uint64_t *total_time)
+parse_cpu_line(const char *line, unsigned *index, struct cpu_stats *stats)
 {
    char cpuname[32];
+   uint64_t v[12];
+   unsigned cpu;
+   int i, num;
+
+   num = sscanf(line,
+                "%31s %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64
+                " %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64
+                " %"PRIu64" %"PRIu64"",
+                cpuname, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5],
+                &v[6], &v[7], &v[8], &v[9], &v[10], &v[11]);
+   if (num < 5)
+      return FALSE;
+
+   if (strcmp(cpuname, "cpu") == 0)
+      *index = 0;
+   else if (sscanf(cpuname, "cpu%u", &cpu) == 1)
+      *index = cpu + 1;
+   else
+      return FALSE;
+
+   /* user + nice + system */
+   stats->busy_time = v[0] + v[1] + v[2];
+   stats->total_time = stats->busy_time;
+
+   /* ... + idle + iowait + irq + softirq + ...  */
+   for (i = 3; i < num-1; i++) {
+      stats->total_time += v[i];
+   }
+   stats->valid = TRUE;
+   return TRUE;
+}
+
+/* Called with cpu_stats_mutex held. */
+static void
+read_cpu_stats(void)
+{
    char line[1024];
+   unsigned i;
    FILE *f;
 
-   if (cpu_index == ALL_CPUS)
-      strcpy(cpuname, "cpu");
-   else
-      sprintf(cpuname, "cpu%u", cpu_index);
+   for (i = 0; i < cpu_stats_size; i++)
+      cpu_stats[i].valid = FALSE;
 
    f = fopen("/proc/stat", "r");
    if (!f)
-      return FALSE;
+      return;
 
-   while (!feof(f) && fgets(line, sizeof(line), f)) {
-      if (strstr(line, cpuname) == line) {
-         uint64_t v[12];
-         int i, num;
-
-         num = sscanf(line,
-                      "%s %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64
-                      " %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64
-                      " %"PRIu64" %"PRIu64"",
-                      cpuname, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5],
-                      &v[6], &v[7], &v[8], &v[9], &v[10], &v[11]);
-         if (num < 5) {
-            fclose(f);
-            return FALSE;
-         }
-
-         /* user + nice + system */
-         *busy_time = v[0] + v[1] + v[2];
-         *total_time = *busy_time;
-
-         /* ... + idle + iowait + irq + softirq + ...  */
-         for (i = 3; i < num-1; i++) {
-            *total_time += v[i];
-         }
-         fclose(f);
-         return TRUE;
+   /* The cpu lines come first, so stop at the first other line and skip
+    * the (long) rest of the file.
+    */
+   while (fgets(line, sizeof(line), f) && strncmp(line, "cpu", 3) == 0) {
+      struct cpu_stats stats;
+      unsigned index;
+
+      if (!parse_cpu_line(line, &index, &stats))
+         break;
+
+      if (index >= cpu_stats_size) {
+         unsigned new_size = MAX2(index + 1, cpu_stats_size * 2);
+         struct cpu_stats *new_stats =
+            REALLOC(cpu_stats, cpu_stats_size * sizeof(*cpu_stats),
+                    new_size * sizeof(*cpu_stats));
+
+         if (!new_stats)
+            break;
+         memset(new_stats + cpu_stats_size, 0,
+                (new_size - cpu_stats_size) * sizeof(*cpu_stats));
+         cpu_stats = new_stats;
+         cpu_stats_size = new_size;
       }
+      cpu_stats[index] = stats;
    }
    fclose(f);
-   return FALSE;
+}
+
+static boolean
+get_cpu_stats(unsigned cpu_index, uint64_t *busy_time, uint64_t *total_time)
+{
+   unsigned index = cpu_index == ALL_CPUS ? 0 : cpu_index + 1;
+   int64_t now = os_time_get();
+   boolean ret = FALSE;
+
+   mtx_lock(&cpu_stats_mutex);
+   if (!cpu_stats_time || now - cpu_stats_time >= CPU_STATS_MAX_AGE) {
+      read_cpu_stats();
+      cpu_stats_time = now;
+   }
+
+   if (index < cpu_stats_size && cpu_stats[index].valid) {
+      *busy_time = cpu_stats[index].busy_time;
+      *total_time = cpu_stats[index].total_time;
+      ret = TRUE;
+   }
+   mtx_unlock(&cpu_stats_mutex);
+   return ret;
 }
 #endif
 
@@ -205,6 +277,7 @@ hud_cpu_graph_install(struct hud_pane *pane, unsigned cpu_index)
    }
 
    gr->query_new_value = query_cpu_load;
+   gr->os_source = TRUE;
 
    /* Don't use free() as our callback as that messes up Gallium's
     * memory debugger.  Use simple free_query_data() wrapper.
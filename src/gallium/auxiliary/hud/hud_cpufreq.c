@@ -156,6 +156,7 @@ hud_cpufreq_graph_install(struct hud_pane *pane, int cpu_index,
 
    gr->query_data = cfi;
    gr->query_new_value = query_cfi_load;
+   gr->os_source = TRUE;
 
    hud_pane_add_graph(pane, gr);
    hud_pane_set_max_value(pane, 3000000 /* 3 GHz */);
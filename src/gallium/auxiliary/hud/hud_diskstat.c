@@ -201,6 +201,7 @@ hud_diskstat_graph_install(struct hud_pane *pane, const char *dev_name,
 
    gr->query_data = dsi;
    gr->query_new_value = query_dsi_load;
+   gr->os_source = TRUE;
 
    hud_pane_add_graph(pane, gr);
    hud_pane_set_max_value(pane, 100);
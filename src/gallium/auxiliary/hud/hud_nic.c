@@ -277,6 +277,7 @@ hud_nic_graph_install(struct hud_pane *pane, const char *nic_name,
 
    gr->query_data = nic;
    gr->query_new_value = query_nic_load;
+   gr->os_source = TRUE;
 
    hud_pane_add_graph(pane, gr);
    hud_pane_set_max_value(pane, 100);
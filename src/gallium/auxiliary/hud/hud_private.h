@@ -31,6 +31,16 @@
 #include "pipe/p_context.h"
 #include "util/list.h"
 
+struct hud_export;
+
+/* Must be a power of two. */
+#define HUD_SAMPLE_RING_SIZE 64
+
+struct hud_sample {
+   int64_t time; /* in microseconds */
+   uint64_t value;
+};
+
 struct hud_graph {
    /* initialized by common code */
    struct list_head head;
@@ -45,11 +55,28 @@ struct hud_graph {
    void (*query_new_value)(struct hud_graph *gr);
    void (*free_query_data)(void *ptr); /**< do not use ordinary free() */
 
+   /* Set by sources which only read OS statistics (/proc, sysfs, ...)
+    * and can therefore be queried from the sampler thread.
+    */
+   boolean os_source;
+
    /* mutable variables */
    unsigned num_vertices;
    unsigned index; /* vertex index being updated */
    uint64_t current_value;
    FILE *fd;
+   struct hud_export *export;
+
+   /* If set, query_new_value is called by the sampler thread, which
+    * passes the values to the rendering thread through this
+    * single-producer single-consumer ring.
+    */
+   boolean sampled;
+   struct {
+      struct hud_sample samples[HUD_SAMPLE_RING_SIZE];
+      unsigned head; /* written by the sampler thread */
+      unsigned tail; /* written by the rendering thread */
+   } ring;
 };
 
 struct hud_pane {
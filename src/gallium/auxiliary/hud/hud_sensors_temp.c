@@ -227,6 +227,7 @@ hud_sensors_temp_graph_install(struct hud_pane *pane, const char *dev_name,
 
    gr->query_data = sti;
    gr->query_new_value = query_sti_load;
+   gr->os_source = TRUE;
 
    hud_pane_add_graph(pane, gr);
    switch (sti->mode) {
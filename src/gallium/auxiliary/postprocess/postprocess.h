@@ -89,6 +89,17 @@ void pp_celshade_free(struct pp_queue_t *, unsigned int);
 void pp_nocolor_free(struct pp_queue_t *, unsigned int);
 void pp_jimenezmlaa_free(struct pp_queue_t *, unsigned int);
 
+/* The CPU versions of the filters, for software screens */
+
+struct pp_cpu_filter;
+
+extern const struct pp_cpu_filter pp_nored_cpu;
+extern const struct pp_cpu_filter pp_nogreen_cpu;
+extern const struct pp_cpu_filter pp_noblue_cpu;
+extern const struct pp_cpu_filter pp_celshade_cpu;
+extern const struct pp_cpu_filter pp_jimenezmlaa_cpu;
+extern const struct pp_cpu_filter pp_jimenezmlaa_color_cpu;
+
 
 #ifdef __cplusplus
 }
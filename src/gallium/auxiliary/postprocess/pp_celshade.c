@@ -30,6 +30,8 @@
 #include "postprocess/pp_filters.h"
 #include "postprocess/pp_private.h"
 
+#include "util/u_math.h"
+
 /** Init function */
 bool
 pp_celshade_init(struct pp_queue_t *ppq, unsigned int n, unsigned int val)
@@ -45,3 +47,36 @@ void
 pp_celshade_free(struct pp_queue_t *ppq, unsigned int n)
 {
 }
+
+/** The CPU version, doing the same math as the shader. */
+static void
+pp_celshade_pixels(uint8_t *rgba, unsigned int width)
+{
+   unsigned int x, c;
+
+   for (x = 0; x < width; x++, rgba += 4) {
+      float lum = (0.2126f * rgba[0] + 0.7152f * rgba[1] +
+                   0.0722f * rgba[2]) * (1.0f / 255.0f);
+      float level = roundf(lum * 4.0f) * 0.25f;
+      float diff = lum - level;
+      float factor, t;
+
+      /* Smooth the steps between the levels */
+      if (diff > 0.1f) {
+         t = (diff - 0.1f) * 40.0f;
+         level += t * t * (3.0f - 2.0f * t) * 0.125f;
+      } else if (diff < -0.1f) {
+         t = (diff + 0.125f) * 40.0f;
+         level -= (1.0f - t * t * (3.0f - 2.0f * t)) * 0.125f;
+      }
+
+      factor = level * 2.0f + 0.1f;
+
+      for (c = 0; c < 4; c++)
+         rgba[c] = float_to_ubyte(rgba[c] * (1.0f / 255.0f) * factor);
+   }
+}
+
+const struct pp_cpu_filter pp_celshade_cpu = {
+   pp_celshade_pixels, NULL, 0, false
+};
@@ -92,3 +92,45 @@ void
 pp_nocolor_free(struct pp_queue_t *ppq, unsigned int n)
 {
 }
+
+
+/* CPU versions */
+
+static inline void
+pp_nocolor_pixels(uint8_t *rgba, unsigned int width, unsigned int chan)
+{
+   unsigned int x;
+
+   for (x = 0; x < width; x++)
+      rgba[x * 4 + chan] = 0;
+}
+
+static void
+pp_nored_pixels(uint8_t *rgba, unsigned int width)
+{
+   pp_nocolor_pixels(rgba, width, 0);
+}
+
+static void
+pp_nogreen_pixels(uint8_t *rgba, unsigned int width)
+{
+   pp_nocolor_pixels(rgba, width, 1);
+}
+
+static void
+pp_noblue_pixels(uint8_t *rgba, unsigned int width)
+{
+   pp_nocolor_pixels(rgba, width, 2);
+}
+
+const struct pp_cpu_filter pp_nored_cpu = {
+   pp_nored_pixels, NULL, 0, false
+};
+
+const struct pp_cpu_filter pp_nogreen_cpu = {
+   pp_nogreen_pixels, NULL, 0, false
+};
+
+const struct pp_cpu_filter pp_noblue_cpu = {
+   pp_noblue_pixels, NULL, 0, false
+};
@@ -0,0 +1,482 @@
+/**************************************************************************
+ *
+ * Copyright © 2026 agent <agent@local>
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+
+/**
+ * CPU version of the post-processing queue, for software screens.
+ *
+ * On llvmpipe or softpipe every pass of a filter is a whole scene, so the
+ * queue costs as many full-frame renders as there are passes.  Instead the
+ * render targets are mapped once and the filters run directly on the
+ * pixels, in horizontal bands on a thread pool.
+ *
+ * The frame is read into RGBA8 rows, running the per-pixel filters on the
+ * way, and written back the same way.  Filters needing the neighbourhood
+ * of a pixel (MLAA) run on a whole RGBA8 copy of the frame, and feed the
+ * per-pixel filters after them as they write their output rows.  A queue
+ * of per-pixel filters thus takes one pass over the frame, and each MLAA
+ * adds its own three passes over the copy.
+ */
+
+#include "postprocess/filters.h"
+#include "postprocess/pp_private.h"
+
+#include "pipe/p_screen.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_debug.h"
+#include "util/u_format.h"
+#include "util/u_inlines.h"
+#include "util/u_math.h"
+#include "util/u_memory.h"
+
+
+struct pp_cpu_read
+{
+   struct pp_cpu *cpu;
+   const struct pp_cpu_target *target;
+
+   const uint8_t *map;
+   unsigned int stride;
+   const struct util_format_description *format;
+
+   const uint8_t *depth_map;
+   unsigned int depth_stride;
+   const struct util_format_description *depth_format;
+};
+
+
+/** Whether the frame can be read and written as RGBA8 rows. */
+static bool
+pp_cpu_format_supported(enum pipe_format format)
+{
+   const struct util_format_description *desc =
+      util_format_description(format);
+
+   return desc &&
+          desc->layout == UTIL_FORMAT_LAYOUT_PLAIN &&
+          desc->colorspace == UTIL_FORMAT_COLORSPACE_RGB &&
+          desc->block.width == 1 && desc->block.height == 1 &&
+          !util_format_is_pure_integer(format) &&
+          desc->unpack_rgba_8unorm && desc->pack_rgba_8unorm;
+}
+
+static const struct util_format_description *
+pp_cpu_format(enum pipe_format format)
+{
+   /* RGBA8 rows are copied as they are */
+   if (format == PIPE_FORMAT_R8G8B8A8_UNORM)
+      return NULL;
+
+   return util_format_description(format);
+}
+
+
+static void
+pp_cpu_execute_band(void *job, int thread_index)
+{
+   struct pp_cpu_band *band = (struct pp_cpu_band *) job;
+
+   band->func(band->data, band->y0, band->y1, band->tmp);
+}
+
+/**
+ * Run func over all the rows of the frame, in bands on the thread pool,
+ * and wait for it to finish.  Each band gets PP_CPU_BAND_TMP bytes per
+ * pixel of a row of temporary storage.
+ */
+void
+pp_cpu_parallel(struct pp_cpu *cpu, pp_cpu_band_func func, void *data)
+{
+   unsigned int rows, y, i, n_bands = 0;
+
+   if (cpu->n_threads <= 1) {
+      func(data, 0, cpu->height, cpu->band_tmp);
+      return;
+   }
+
+   /* A few bands per thread to even out the load, but not too thin ones */
+   rows = DIV_ROUND_UP(cpu->height, MIN2(cpu->n_threads * 4,
+                                         PP_CPU_MAX_BANDS));
+   rows = MAX2(rows, 16);
+
+   for (y = 0; y < cpu->height; y += rows) {
+      struct pp_cpu_band *band = &cpu->bands[n_bands++];
+
+      band->func = func;
+      band->data = data;
+      band->y0 = y;
+      band->y1 = MIN2(y + rows, cpu->height);
+      band->tmp = cpu->band_tmp +
+                  (n_bands - 1) * cpu->width * PP_CPU_BAND_TMP;
+
+      util_queue_add_job(&cpu->queue, band, &band->fence,
+                         pp_cpu_execute_band, NULL);
+   }
+
+   for (i = 0; i < n_bands; i++)
+      util_queue_fence_wait(&cpu->bands[i].fence);
+}
+
+/**
+ * Run the fused per-pixel filters on a row of RGBA8 pixels, which is
+ * clobbered, and store it to row y of the target.
+ */
+void
+pp_cpu_write_row(const struct pp_cpu_target *target, unsigned int y,
+                 uint8_t *rgba, unsigned int width)
+{
+   uint8_t *dst = target->map + y * target->stride;
+   unsigned int i;
+
+   for (i = 0; i < target->n_pixel; i++)
+      target->pixel[i](rgba, width);
+
+   if (target->format)
+      target->format->pack_rgba_8unorm(dst, 0, rgba, 0, width, 1);
+   else
+      memcpy(dst, rgba, width * 4);
+}
+
+/** First pass: read the input frame (and depth) and write the target. */
+static void
+pp_cpu_read_band(void *data, unsigned int y0, unsigned int y1, void *tmp)
+{
+   const struct pp_cpu_read *r = (const struct pp_cpu_read *) data;
+   struct pp_cpu *cpu = r->cpu;
+   unsigned int w = cpu->width;
+   uint8_t *row = (uint8_t *) tmp;
+   unsigned int y;
+
+   for (y = y0; y < y1; y++) {
+      const uint8_t *src = r->map + y * r->stride;
+
+      if (r->format)
+         r->format->unpack_rgba_8unorm(row, 0, src, 0, w, 1);
+      else
+         memcpy(row, src, w * 4);
+
+      pp_cpu_write_row(r->target, y, row, w);
+
+      if (r->depth_map)
+         r->depth_format->unpack_z_float(cpu->depth + y * w, 0,
+                                         r->depth_map + y * r->depth_stride,
+                                         0, w, 1);
+   }
+}
+
+
+/** (Re)allocate the frame copies when the size or the queue need it. */
+static bool
+pp_cpu_resize(struct pp_cpu *cpu, const struct pp_queue_t *ppq,
+              unsigned int w, unsigned int h)
+{
+   unsigned int i, n_image = 0, scratch = 0;
+   bool depth = false;
+   size_t size = (size_t) w * h;
+
+   if (cpu->width == w && cpu->height == h)
+      return true;
+
+   FREE(cpu->src);
+   FREE(cpu->dst);
+   FREE(cpu->depth);
+   FREE(cpu->scratch);
+   FREE(cpu->band_tmp);
+   cpu->src = cpu->dst = cpu->scratch = cpu->band_tmp = NULL;
+   cpu->depth = NULL;
+   cpu->width = cpu->height = 0;
+
+   for (i = 0; i < ppq->n_filters; i++) {
+      const struct pp_cpu_filter *filter = pp_filters[ppq->filters[i]].cpu;
+
+      if (filter->image) {
+         n_image++;
+         scratch = MAX2(scratch, filter->scratch);
+         depth |= filter->depth;
+      }
+   }
+
+   cpu->band_tmp = MALLOC(w * PP_CPU_BAND_TMP *
+                          (cpu->n_threads > 1 ? PP_CPU_MAX_BANDS : 1));
+   if (!cpu->band_tmp)
+      return false;
+
+   if (n_image > 0) {
+      cpu->src = MALLOC(size * 4);
+      if (!cpu->src)
+         return false;
+   }
+   if (n_image > 1) {
+      cpu->dst = MALLOC(size * 4);
+      if (!cpu->dst)
+         return false;
+   }
+   if (depth) {
+      cpu->depth = MALLOC(size * sizeof(float));
+      if (!cpu->depth)
+         return false;
+   }
+   if (scratch) {
+      cpu->scratch = MALLOC(size * scratch);
+      if (!cpu->scratch)
+         return false;
+   }
+
+   cpu->width = w;
+   cpu->height = h;
+
+   return true;
+}
+
+/**
+ * Collect the per-pixel filters from entry i of the queue up to the next
+ * image filter, which is returned (n_filters if there is none).
+ */
+static unsigned int
+pp_cpu_fuse(const struct pp_queue_t *ppq, unsigned int i, bool has_depth,
+            struct pp_cpu_target *target)
+{
+   target->n_pixel = 0;
+
+   for (; i < ppq->n_filters; i++) {
+      const struct pp_cpu_filter *filter = pp_filters[ppq->filters[i]].cpu;
+
+      if (filter->pixel) {
+         target->pixel[target->n_pixel++] = filter->pixel;
+      } else if (!filter->depth || has_depth) {
+         /* The depth MLAA does nothing without depth, like on the GPU */
+         break;
+      }
+   }
+
+   return i;
+}
+
+
+/**
+ * Run the queue on the CPU.  Returns false if it can't be done for these
+ * resources, and the GPU path has to be used.
+ */
+bool
+pp_cpu_run(struct pp_queue_t *ppq, struct pipe_resource *in,
+           struct pipe_resource *out, struct pipe_resource *indepth)
+{
+   struct pp_cpu *cpu = ppq->cpu;
+   struct pipe_context *pipe = ppq->p->pipe;
+   struct pipe_transfer *in_transfer, *out_transfer = NULL;
+   struct pipe_transfer *depth_transfer = NULL;
+   struct pp_cpu_target target;
+   struct pp_cpu_read read;
+   unsigned int w = in->width0, h = in->height0;
+   uint8_t *out_map;
+   unsigned int i;
+
+   if (out->width0 != w || out->height0 != h ||
+       in->nr_samples > 1 || out->nr_samples > 1 ||
+       !pp_cpu_format_supported(in->format) ||
+       !pp_cpu_format_supported(out->format))
+      return false;
+
+   if (indepth) {
+      const struct util_format_description *desc =
+         util_format_description(indepth->format);
+
+      if (indepth->width0 < w || indepth->height0 < h ||
+          !util_format_has_depth(desc) || !desc->unpack_z_float)
+         return false;
+   }
+
+   if (!pp_cpu_resize(cpu, ppq, w, h)) {
+      pp_debug("Failed to allocate the CPU buffers.\n");
+      return false;
+   }
+
+   memset(&read, 0, sizeof(read));
+   read.cpu = cpu;
+   read.format = pp_cpu_format(in->format);
+   read.map = pipe_transfer_map(pipe, in, 0, 0,
+                                in == out ? PIPE_TRANSFER_READ_WRITE :
+                                            PIPE_TRANSFER_READ,
+                                0, 0, w, h, &in_transfer);
+   if (!read.map)
+      return false;
+   read.stride = in_transfer->stride;
+
+   if (in == out) {
+      out_map = (uint8_t *) read.map;
+      target.stride = in_transfer->stride;
+   } else {
+      out_map = pipe_transfer_map(pipe, out, 0, 0,
+                                  PIPE_TRANSFER_WRITE |
+                                  PIPE_TRANSFER_DISCARD_RANGE,
+                                  0, 0, w, h, &out_transfer);
+      if (!out_map) {
+         pipe_transfer_unmap(pipe, in_transfer);
+         return false;
+      }
+      target.stride = out_transfer->stride;
+   }
+
+   if (indepth && cpu->depth) {
+      read.depth_format = util_format_description(indepth->format);
+      read.depth_map = pipe_transfer_map(pipe, indepth, 0, 0,
+                                         PIPE_TRANSFER_READ,
+                                         0, 0, w, h, &depth_transfer);
+      if (read.depth_map)
+         read.depth_stride = depth_transfer->stride;
+   }
+
+   /* The pixel filters up to the first image filter run while reading */
+   i = pp_cpu_fuse(ppq, 0, read.depth_map != NULL, &target);
+   if (i == ppq->n_filters) {
+      target.map = out_map;
+      target.format = pp_cpu_format(out->format);
+   } else {
+      target.map = cpu->src;
+      target.stride = w * 4;
+      target.format = NULL;
+   }
+   read.target = &target;
+   pp_cpu_parallel(cpu, pp_cpu_read_band, &read);
+
+   /* Then each image filter, with the pixel filters up to the next one */
+   while (i < ppq->n_filters) {
+      const struct pp_cpu_filter *filter = pp_filters[ppq->filters[i]].cpu;
+      unsigned int n = i;
+
+      i = pp_cpu_fuse(ppq, n + 1, read.depth_map != NULL, &target);
+      if (i == ppq->n_filters) {
+         target.map = out_map;
+         target.stride = out_transfer ? out_transfer->stride :
+                                        in_transfer->stride;
+         target.format = pp_cpu_format(out->format);
+      } else {
+         target.map = cpu->dst;
+         target.stride = w * 4;
+         target.format = NULL;
+      }
+
+      filter->image(cpu, &target, n);
+
+      if (i < ppq->n_filters) {
+         uint8_t *tmp = cpu->src;
+
+         cpu->src = cpu->dst;
+         cpu->dst = tmp;
+      }
+   }
+
+   if (depth_transfer)
+      pipe_transfer_unmap(pipe, depth_transfer);
+   if (out_transfer)
+      pipe_transfer_unmap(pipe, out_transfer);
+   pipe_transfer_unmap(pipe, in_transfer);
+
+   return true;
+}
+
+
+/**
+ * Set up the CPU version of the queue if the screen is a software one and
+ * all the enabled filters have a CPU version.
+ */
+bool
+pp_cpu_init(struct pp_queue_t *ppq, const unsigned int *enabled)
+{
+   struct pipe_screen *screen = ppq->p->screen;
+   struct pp_cpu *cpu;
+   unsigned int i, n_threads;
+
+   if (screen->get_param(screen, PIPE_CAP_ACCELERATED) ||
+       !debug_get_bool_option("PP_CPU", TRUE))
+      return false;
+
+   for (i = 0; i < ppq->n_filters; i++) {
+      if (!pp_filters[ppq->filters[i]].cpu)
+         return false;
+   }
+
+   cpu = CALLOC_STRUCT(pp_cpu);
+   if (!cpu)
+      return false;
+
+   cpu->vals = CALLOC(ppq->n_filters, sizeof(unsigned int));
+   if (!cpu->vals) {
+      FREE(cpu);
+      return false;
+   }
+
+   for (i = 0; i < ppq->n_filters; i++)
+      cpu->vals[i] = enabled[ppq->filters[i]];
+
+   util_cpu_detect();
+   n_threads = debug_get_num_option("PP_CPU_THREADS", util_cpu_caps.nr_cpus);
+   n_threads = MIN2(n_threads, PP_CPU_MAX_THREADS);
+
+   if (n_threads > 1 &&
+       !util_queue_init(&cpu->queue, "pp", PP_CPU_MAX_BANDS, n_threads))
+      n_threads = 1;
+
+   if (n_threads > 1) {
+      for (i = 0; i < PP_CPU_MAX_BANDS; i++)
+         util_queue_fence_init(&cpu->bands[i].fence);
+   }
+
+   cpu->n_threads = n_threads;
+   ppq->cpu = cpu;
+
+   pp_debug("Running the queue on the CPU, %u thread(s).\n", n_threads);
+
+   return true;
+}
+
+void
+pp_cpu_free(struct pp_queue_t *ppq)
+{
+   struct pp_cpu *cpu = ppq->cpu;
+   unsigned int i;
+
+   if (!cpu)
+      return;
+
+   if (cpu->n_threads > 1) {
+      util_queue_destroy(&cpu->queue);
+
+      for (i = 0; i < PP_CPU_MAX_BANDS; i++)
+         util_queue_fence_destroy(&cpu->bands[i].fence);
+   }
+
+   FREE(cpu->src);
+   FREE(cpu->dst);
+   FREE(cpu->depth);
+   FREE(cpu->scratch);
+   FREE(cpu->band_tmp);
+   FREE(cpu->vals);
+   FREE(cpu);
+
+   ppq->cpu = NULL;
+}
@@ -120,6 +120,9 @@ pp_init(struct pipe_context *pipe, const unsigned int *enabled,
    for (i = 0; i < curpos; i++)
       ppq->shaders[i][0] = ppq->p->passvs;
 
+   /* The shaders stay around for what the CPU version can't handle. */
+   pp_cpu_init(ppq, enabled);
+
    pp_debug("Queue successfully allocated. %u filter(s).\n", curpos);
    
    return ppq;
@@ -174,6 +177,7 @@ pp_free(struct pp_queue_t *ppq)
       return;
 
    pp_free_fbos(ppq);
+   pp_cpu_free(ppq);
 
    if (ppq->p) {
       if (ppq->p->pipe && ppq->filters && ppq->shaders) {
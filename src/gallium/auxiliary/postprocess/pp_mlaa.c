@@ -48,6 +48,7 @@
 #include "util/u_box.h"
 #include "util/u_sampler.h"
 #include "util/u_inlines.h"
+#include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/u_string.h"
 #include "pipe/p_screen.h"
@@ -361,3 +362,279 @@ pp_jimenezmlaa_free(struct pp_queue_t *ppq, unsigned int n)
    }
 }
 
+
+
+/*
+ * CPU version, doing the same three passes as the shaders above.  The edges
+ * are kept as bits instead of a texture, and the search for the ends of an
+ * edge reads them directly instead of through bilinear fetches.
+ */
+
+#define MLAA_LEFT   (1 << 0)
+#define MLAA_TOP    (1 << 1)
+#define MLAA_RIGHT  (1 << 2)
+#define MLAA_BOTTOM (1 << 3)
+
+struct mlaa_cpu
+{
+   struct pp_cpu *cpu;
+   const struct pp_cpu_target *target;
+   bool iscolor;
+   unsigned int steps;          /* Max search steps */
+
+   uint8_t *edges;              /* MLAA_* bits of each pixel */
+   uint8_t *weights;            /* RGBA8, like the blend weight texture */
+};
+
+/** Row y of the values compared by the edge detection. */
+static const float *
+mlaa_cpu_values(const struct mlaa_cpu *m, unsigned int y, float *rows)
+{
+   const struct pp_cpu *cpu = m->cpu;
+   const uint8_t *rgba = cpu->src + y * cpu->width * 4;
+   float *lum;
+   unsigned int x;
+
+   if (!m->iscolor)
+      return cpu->depth + y * cpu->width;
+
+   /* Three rows are live at a time */
+   lum = rows + (y % 3) * cpu->width;
+   for (x = 0; x < cpu->width; x++, rgba += 4)
+      lum[x] = (0.2126f * rgba[0] + 0.7152f * rgba[1] +
+                0.0722f * rgba[2]) * (1.0f / 255.0f);
+
+   return lum;
+}
+
+/** First pass: edge detection. */
+static void
+mlaa_cpu_edges(void *data, unsigned int y0, unsigned int y1, void *tmp)
+{
+   const struct mlaa_cpu *m = (const struct mlaa_cpu *) data;
+   const unsigned int w = m->cpu->width, h = m->cpu->height;
+   const float threshold = m->iscolor ? 0.1f : 0.003f;
+   const float *top, *row, *bottom;
+   unsigned int x, y;
+
+   top = mlaa_cpu_values(m, y0 > 0 ? y0 - 1 : 0, tmp);
+   row = y0 > 0 ? mlaa_cpu_values(m, y0, tmp) : top;
+
+   for (y = y0; y < y1; y++) {
+      uint8_t *edges = m->edges + y * w;
+
+      bottom = y + 1 < h ? mlaa_cpu_values(m, y + 1, tmp) : row;
+
+      for (x = 0; x < w; x++) {
+         const float c = row[x];
+         const float left = row[x > 0 ? x - 1 : 0];
+         const float right = row[x + 1 < w ? x + 1 : x];
+
+         edges[x] = (fabsf(c - left) >= threshold ? MLAA_LEFT : 0) |
+                    (fabsf(c - top[x]) >= threshold ? MLAA_TOP : 0) |
+                    (fabsf(c - right) >= threshold ? MLAA_RIGHT : 0) |
+                    (fabsf(c - bottom[x]) >= threshold ? MLAA_BOTTOM : 0);
+      }
+
+      top = row;
+      row = bottom;
+   }
+}
+
+/** An edge bit at (x, y), clamped to the frame like the texture fetches. */
+static inline float
+mlaa_cpu_edge(const struct mlaa_cpu *m, int x, int y, unsigned int bit)
+{
+   x = CLAMP(x, 0, (int) m->cpu->width - 1);
+   y = CLAMP(y, 0, (int) m->cpu->height - 1);
+
+   return (m->edges[y * m->cpu->width + x] & bit) ? 1.0f : 0.0f;
+}
+
+/**
+ * Distance from (x, y) to the end of the edge going in direction (dx, dy).
+ * Like the shader, this looks at two pixels per step and finds the end
+ * with a half-pixel precision.
+ */
+static int
+mlaa_cpu_search(const struct mlaa_cpu *m, int x, int y, int dx, int dy,
+                unsigned int bit)
+{
+   const float max = 2.0f * m->steps;
+   float offset = 1.5f, e = 0.0f;
+
+   while (offset < max) {
+      const int i = (int) offset;
+
+      e = 0.5f * (mlaa_cpu_edge(m, x + i * dx, y + i * dy, bit) +
+                  mlaa_cpu_edge(m, x + (i + 1) * dx, y + (i + 1) * dy, bit));
+      if (e < 0.9f)
+         break;
+
+      offset += 2.0f;
+   }
+
+   return (int) MIN2(offset - 1.5f + 2.0f * e, max);
+}
+
+/** Look up the coverage areas for an edge, see the area map texture. */
+static inline void
+mlaa_cpu_area(int d1, int d2, float e1, float e2, uint8_t *area)
+{
+   const int u = MIN2(33 * util_iround(4.0f * e1) + d1, 164);
+   const int v = MIN2(33 * util_iround(4.0f * e2) + d2, 164);
+
+   area[0] = areamap[(v * 165 + u) * 2];
+   area[1] = areamap[(v * 165 + u) * 2 + 1];
+}
+
+/** Second pass: blending weights of the pixels on a top or left edge. */
+static void
+mlaa_cpu_weights(void *data, unsigned int y0, unsigned int y1, void *tmp)
+{
+   const struct mlaa_cpu *m = (const struct mlaa_cpu *) data;
+   const unsigned int w = m->cpu->width;
+   int x, y;
+
+   for (y = y0; y < (int) y1; y++) {
+      const uint8_t *edges = m->edges + y * w;
+      uint8_t *weights = m->weights + y * w * 4;
+
+      memset(weights, 0, w * 4);
+
+      for (x = 0; x < (int) w; x++) {
+         int d1, d2;
+         float e1, e2;
+
+         if (edges[x] & MLAA_TOP) {
+            d1 = mlaa_cpu_search(m, x, y, -1, 0, MLAA_TOP);
+            d2 = mlaa_cpu_search(m, x, y, 1, 0, MLAA_TOP);
+
+            /* Crossing edges at both ends, from a quarter pixel above */
+            e1 = 0.75f * mlaa_cpu_edge(m, x - d1, y, MLAA_LEFT) +
+                 0.25f * mlaa_cpu_edge(m, x - d1, y - 1, MLAA_LEFT);
+            e2 = 0.75f * mlaa_cpu_edge(m, x + d2 + 1, y, MLAA_LEFT) +
+                 0.25f * mlaa_cpu_edge(m, x + d2 + 1, y - 1, MLAA_LEFT);
+
+            mlaa_cpu_area(d1, d2, e1, e2, &weights[x * 4]);
+         }
+
+         if (edges[x] & MLAA_LEFT) {
+            d1 = mlaa_cpu_search(m, x, y, 0, -1, MLAA_LEFT);
+            d2 = mlaa_cpu_search(m, x, y, 0, 1, MLAA_LEFT);
+
+            e1 = 0.75f * mlaa_cpu_edge(m, x, y - d1, MLAA_TOP) +
+                 0.25f * mlaa_cpu_edge(m, x - 1, y - d1, MLAA_TOP);
+            e2 = 0.75f * mlaa_cpu_edge(m, x, y + d2 + 1, MLAA_TOP) +
+                 0.25f * mlaa_cpu_edge(m, x - 1, y + d2 + 1, MLAA_TOP);
+
+            mlaa_cpu_area(d1, d2, e1, e2, &weights[x * 4 + 2]);
+         }
+      }
+   }
+}
+
+/** Third pass: blend each pixel with its neighbours. */
+static void
+mlaa_cpu_blend(void *data, unsigned int y0, unsigned int y1, void *tmp)
+{
+   const struct mlaa_cpu *m = (const struct mlaa_cpu *) data;
+   const unsigned int w = m->cpu->width, h = m->cpu->height;
+   const unsigned int stride = w * 4;
+   uint8_t *out = (uint8_t *) tmp;
+   unsigned int x, y, i, c;
+
+   for (y = y0; y < y1; y++) {
+      const uint8_t *row = m->cpu->src + y * stride;
+      const uint8_t *top = y > 0 ? row - stride : row;
+      const uint8_t *bottom = y + 1 < h ? row + stride : row;
+      const uint8_t *weights = m->weights + y * stride;
+      const uint8_t *weights_below = y + 1 < h ? weights + stride : weights;
+
+      for (x = 0; x < w; x++) {
+         const unsigned int left = x > 0 ? x - 1 : 0;
+         const unsigned int right = x + 1 < w ? x + 1 : x;
+         const uint8_t *color = &row[x * 4];
+         const uint8_t *neighbour[4] = {
+            &top[x * 4], &bottom[x * 4], &row[left * 4], &row[right * 4]
+         };
+         float a[4], a3[4], sum = 0.0f, result[4], alpha;
+
+         a[0] = weights[x * 4 + 0];
+         a[1] = weights_below[x * 4 + 1];
+         a[2] = weights[x * 4 + 2];
+         a[3] = weights[right * 4 + 3];
+
+         for (i = 0; i < 4; i++) {
+            a[i] *= 1.0f / 255.0f;
+            a3[i] = a[i] * a[i] * a[i];
+            sum += a3[i];
+         }
+
+         if (sum < 0.00001f) {
+            memcpy(&out[x * 4], color, 4);
+            continue;
+         }
+
+         for (c = 0; c < 4; c++) {
+            result[c] = 0.0f;
+            for (i = 0; i < 4; i++)
+               result[c] += a3[i] * (color[c] * (1.0f - a[i]) +
+                                     neighbour[i][c] * a[i]);
+            result[c] *= 1.0f / (255.0f * sum);
+         }
+
+         /* The GPU pass alpha-blends the result over the input */
+         alpha = CLAMP(result[3], 0.0f, 1.0f);
+         for (c = 0; c < 4; c++)
+            out[x * 4 + c] =
+               float_to_ubyte(CLAMP(result[c], 0.0f, 1.0f) * alpha +
+                              color[c] * (1.0f / 255.0f) * (1.0f - alpha));
+      }
+
+      pp_cpu_write_row(m->target, y, out, w);
+   }
+}
+
+static void
+pp_jimenezmlaa_cpu_run(struct pp_cpu *cpu,
+                       const struct pp_cpu_target *target, unsigned int n,
+                       bool iscolor)
+{
+   struct mlaa_cpu m;
+
+   m.cpu = cpu;
+   m.target = target;
+   m.iscolor = iscolor;
+   m.steps = cpu->vals[n];
+   m.edges = cpu->scratch;
+   m.weights = cpu->scratch + cpu->width * cpu->height;
+
+   pp_cpu_parallel(cpu, mlaa_cpu_edges, &m);
+   pp_cpu_parallel(cpu, mlaa_cpu_weights, &m);
+   pp_cpu_parallel(cpu, mlaa_cpu_blend, &m);
+}
+
+static void
+pp_jimenezmlaa_image(struct pp_cpu *cpu, const struct pp_cpu_target *target,
+                     unsigned int n)
+{
+   pp_jimenezmlaa_cpu_run(cpu, target, n, false);
+}
+
+static void
+pp_jimenezmlaa_color_image(struct pp_cpu *cpu,
+                           const struct pp_cpu_target *target,
+                           unsigned int n)
+{
+   pp_jimenezmlaa_cpu_run(cpu, target, n, true);
+}
+
+/* Edge bits and blend weights take five bytes per pixel */
+const struct pp_cpu_filter pp_jimenezmlaa_cpu = {
+   NULL, pp_jimenezmlaa_image, 5, true
+};
+
+const struct pp_cpu_filter pp_jimenezmlaa_color_cpu = {
+   NULL, pp_jimenezmlaa_color_image, 5, false
+};
@@ -30,6 +30,9 @@
 
 
 #include "postprocess.h"
+#include "postprocess/filters.h"
+
+#include "util/u_queue.h"
 
 
 /**
@@ -84,11 +87,92 @@ struct pp_queue_t
    void ***shaders;             /* Shaders in TGSI form */
    unsigned int *filters;       /* Active filter to filters.h mapping. */
    struct pp_program *p;
+   struct pp_cpu *cpu;          /* CPU version of the queue, or NULL */
 
    bool fbos_init;
 };
 
 
+/**
+ * CPU version of the queue, used instead of the shaders on software
+ * screens, where every full-screen pass is a whole scene for the
+ * rasterizer.
+ *
+ * Images are processed as rows of RGBA8 pixels, in horizontal bands on a
+ * thread pool.  Filters working on single pixels only provide a function
+ * for one row, and are applied while reading or writing the render
+ * targets, so a queue of them takes a single pass over the frame.
+ */
+#define PP_CPU_MAX_THREADS 16
+#define PP_CPU_MAX_BANDS (4 * PP_CPU_MAX_THREADS)
+#define PP_CPU_BAND_TMP 16      /* Bytes per pixel of the band temp rows */
+
+struct pp_cpu_target;
+struct util_format_description;
+
+typedef void (*pp_cpu_pixel_func) (uint8_t *rgba, unsigned int width);
+typedef void (*pp_cpu_image_func) (struct pp_cpu *,
+                                   const struct pp_cpu_target *,
+                                   unsigned int n);
+typedef void (*pp_cpu_band_func) (void *data, unsigned int y0,
+                                  unsigned int y1, void *tmp);
+
+struct pp_cpu_filter
+{
+   pp_cpu_pixel_func pixel;     /* Runs on one row of pixels, or ... */
+   pp_cpu_image_func image;     /* ... on pp_cpu::src, writing the target */
+   unsigned int scratch;        /* Bytes per pixel of pp_cpu::scratch used */
+   bool depth;                  /* Needs pp_cpu::depth */
+};
+
+/** Where an image filter writes its rows to. */
+struct pp_cpu_target
+{
+   pp_cpu_pixel_func pixel[PP_FILTERS];     /* Fused pixel filters */
+   unsigned int n_pixel;
+
+   uint8_t *map;
+   unsigned int stride;
+   const struct util_format_description *format;        /* NULL if RGBA8 */
+};
+
+struct pp_cpu_band
+{
+   struct util_queue_fence fence;
+   pp_cpu_band_func func;
+   void *data;
+   unsigned int y0, y1;
+   void *tmp;
+};
+
+struct pp_cpu
+{
+   struct util_queue queue;
+   unsigned int n_threads;
+   struct pp_cpu_band bands[PP_CPU_MAX_BANDS];
+   uint8_t *band_tmp;           /* Temp rows of each band */
+
+   unsigned int width, height;
+
+   uint8_t *src;                /* Input of an image filter, RGBA8 */
+   uint8_t *dst;                /* Output between two image filters */
+   float *depth;                /* Unpacked depth, if any filter needs it */
+   uint8_t *scratch;            /* For the image filters' own use */
+
+   unsigned int *vals;          /* Config value of each queue entry */
+};
+
+
+bool pp_cpu_init(struct pp_queue_t *, const unsigned int *enabled);
+bool pp_cpu_run(struct pp_queue_t *, struct pipe_resource *,
+                struct pipe_resource *, struct pipe_resource *);
+void pp_cpu_free(struct pp_queue_t *);
+
+void pp_cpu_parallel(struct pp_cpu *, pp_cpu_band_func, void *data);
+void pp_cpu_write_row(const struct pp_cpu_target *, unsigned int y,
+                      uint8_t *rgba, unsigned int width);
+
+
 void pp_free_fbos(struct pp_queue_t *);
 
 void pp_debug(const char *, ...);
@@ -91,6 +91,10 @@ pp_run(struct pp_queue_t *ppq, struct pipe_resource *in,
    if (ppq->n_filters == 0)
       return;
 
+   /* Software screens run the queue directly on the mapped buffers. */
+   if (ppq->cpu && pp_cpu_run(ppq, in, out, indepth))
+      return;
+
    assert(ppq->pp_queue);
    assert(ppq->tmp[0]);
 
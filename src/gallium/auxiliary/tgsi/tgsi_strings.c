@@ -157,6 +157,7 @@ const char *tgsi_property_names[TGSI_PROPERTY_COUNT] =
    "CS_FIXED_BLOCK_HEIGHT",
    "CS_FIXED_BLOCK_DEPTH",
    "MUL_ZERO_WINS",
+   "MEDIUMP_FLOAT",
 };
 
 const char *tgsi_return_type_names[TGSI_RETURN_TYPE_COUNT] =
@@ -27,15 +27,20 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
+#include <dirent.h>
 #include <fcntl.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <unistd.h>
 #include <err.h>
 
 #include "tgsi/tgsi_parse.h"
 #include "tgsi/tgsi_text.h"
 #include "tgsi/tgsi_dump.h"
+#include "os/os_time.h"
+#include "util/crc32.h"
+#include "util/u_queue.h"
 
 #include "freedreno_util.h"
 
@@ -108,8 +113,10 @@ load_glsl(unsigned num_files, char* const* files, gl_shader_stage stage)
 	struct gl_shader_program *prog;
 
 	prog = standalone_compile_shader(&options, num_files, files);
-	if (!prog)
-		errx(1, "couldn't parse `%s'", files[0]);
+	if (!prog) {
+		warnx("couldn't parse `%s'", files[0]);
+		return NULL;
+	}
 
 	nir_shader *nir = glsl_to_nir(prog, stage, ir3_get_compiler_options(compiler));
 
@@ -153,7 +160,9 @@ load_glsl(unsigned num_files, char* const* files, gl_shader_stage stage)
 				st_glsl_type_size);
 		break;
 	default:
-		errx(1, "unhandled shader stage: %d", stage);
+		warnx("unhandled shader stage: %d", stage);
+		ralloc_free(nir);
+		return NULL;
 	}
 
 	nir_assign_var_locations(&nir->uniforms,
@@ -195,9 +204,379 @@ read_file(const char *filename, void **ptr, size_t *size)
 	return 0;
 }
 
+static nir_shader *
+load_tgsi(const char *filename)
+{
+	struct tgsi_token *toks;
+	nir_shader *nir = NULL;
+	void *ptr;
+	size_t size;
+
+	if (read_file(filename, &ptr, &size))
+		return NULL;
+
+	if (fd_mesa_debug & FD_DBG_OPTMSGS)
+		debug_printf("%s\n", (char *)ptr);
+
+	toks = calloc(65536, sizeof(*toks));
+	if (!tgsi_text_translate(ptr, toks, 65536)) {
+		warnx("could not parse `%s'", filename);
+		goto out;
+	}
+
+	if (fd_mesa_debug & FD_DBG_OPTMSGS)
+		tgsi_dump(toks, 0);
+
+	nir = ir3_tgsi_to_nir(toks);
+
+out:
+	free(toks);
+	munmap(ptr, size);
+	return nir;
+}
+
+static enum shader_t
+shader_type(gl_shader_stage stage)
+{
+	switch (stage) {
+	case MESA_SHADER_FRAGMENT:
+		return SHADER_FRAGMENT;
+	case MESA_SHADER_VERTEX:
+		return SHADER_VERTEX;
+	case MESA_SHADER_COMPUTE:
+		return SHADER_COMPUTE;
+	default:
+		errx(1, "unhandled shader stage: %d", stage);
+	}
+}
+
+/*
+ * Batch mode: compile every shader found in a directory (recursively),
+ * for one or all of the variant keys below, on a pool of threads.  The
+ * per-variant lines printed are in a stable order and the binaries are
+ * only hashed, so the output of two runs can be diffed to find codegen
+ * changes, while the summary gives the time spent in each compiler pass.
+ */
+
+static const struct {
+	const char *name;
+	unsigned types;             /* bitmask of (1 << shader_t) */
+	struct ir3_shader_key key;
+} variant_keys[] = {
+	{ "default", ~0, { } },
+	{ "binning", 1 << SHADER_VERTEX, { .binning_pass = true } },
+	{ "ucp", (1 << SHADER_VERTEX) | (1 << SHADER_FRAGMENT),
+			{ .ucp_enables = 0x3f } },
+	{ "two-side", 1 << SHADER_FRAGMENT, { .color_two_side = true } },
+	{ "half", 1 << SHADER_FRAGMENT, { .half_precision = true } },
+	{ "saturate", (1 << SHADER_VERTEX) | (1 << SHADER_FRAGMENT),
+			{ .has_per_samp = true,
+			  .vsaturate_s = 0xffff, .vsaturate_t = 0xffff, .vsaturate_r = 0xffff,
+			  .fsaturate_s = 0xffff, .fsaturate_t = 0xffff, .fsaturate_r = 0xffff } },
+};
+
+struct batch_variant {
+	const char *name;
+	bool failed;
+	struct ir3_info info;
+	unsigned constlen;
+	uint32_t hash;
+	struct ir3_compile_timings timings;
+	uint64_t assemble_time;
+};
+
+struct batch_shader {
+	char *filename;
+	struct util_queue_fence fence;
+	bool failed;
+	uint64_t frontend_time, nir_time;
+	unsigned num_variants;
+	struct batch_variant variants[ARRAY_SIZE(variant_keys)];
+};
+
+static struct {
+	/* shader key when not compiling all variants: */
+	struct ir3_shader_key key;
+	bool all_variants;
+	unsigned num_threads;
+	/* for stream-out and other per-shader settings: */
+	struct ir3_shader shader;
+	/* the GLSL standalone compiler isn't thread-safe: */
+	mtx_t frontend_lock;
+} batch;
+
+static bool
+is_shader_file(const char *filename)
+{
+	const char *ext = strrchr(filename, '.');
+
+	return ext && (!strcmp(ext, ".tgsi") || !strcmp(ext, ".vert") ||
+			!strcmp(ext, ".frag"));
+}
+
+static nir_shader *
+load_shader(char *filename)
+{
+	const char *ext = strrchr(filename, '.');
+
+	if (!strcmp(ext, ".tgsi"))
+		return load_tgsi(filename);
+	else if (!strcmp(ext, ".vert"))
+		return load_glsl(1, &filename, MESA_SHADER_VERTEX);
+	else
+		return load_glsl(1, &filename, MESA_SHADER_FRAGMENT);
+}
+
+static void
+batch_compile_variant(struct ir3_shader *s, const char *name,
+		const struct ir3_shader_key *key, struct batch_variant *bv)
+{
+	struct ir3_shader_variant v;
+	void *bin;
+	int64_t start;
+
+	memset(&v, 0, sizeof(v));
+	v.key = *key;
+	v.shader = s;
+	v.type = s->type;
+	v.timings = &bv->timings;
+
+	bv->name = name;
+
+	if (ir3_compile_shader_nir(s->compiler, &v)) {
+		bv->failed = true;
+		return;
+	}
+
+	start = os_time_get_nano();
+	bin = ir3_shader_assemble(&v, s->compiler->gpu_id);
+	bv->assemble_time = os_time_get_nano() - start;
+
+	if (bin) {
+		bv->info = v.info;
+		bv->constlen = v.constlen;
+		bv->hash = util_hash_crc32(bin, v.info.sizedwords * 4);
+	} else {
+		bv->failed = true;
+	}
+
+	free(bin);
+	ir3_destroy(v.ir);
+}
+
+static void
+batch_compile_shader(void *job, int thread_index)
+{
+	struct batch_shader *bs = job;
+	struct ir3_shader s = batch.shader;
+	nir_shader *nir;
+	int64_t start, end;
+
+	/* Time the frontend itself, not the wait for the other threads. */
+	mtx_lock(&batch.frontend_lock);
+	start = os_time_get_nano();
+	nir = load_shader(bs->filename);
+	mtx_unlock(&batch.frontend_lock);
+	end = os_time_get_nano();
+	bs->frontend_time = end - start;
+
+	if (!nir) {
+		bs->failed = true;
+		return;
+	}
+
+	s.compiler = compiler;
+	s.type = shader_type(nir->stage);
+	s.nir = ir3_optimize_nir(&s, nir, NULL);
+	bs->nir_time = os_time_get_nano() - end;
+
+	if (batch.all_variants) {
+		for (unsigned i = 0; i < ARRAY_SIZE(variant_keys); i++) {
+			if (!(variant_keys[i].types & (1 << s.type)))
+				continue;
+			batch_compile_variant(&s, variant_keys[i].name,
+					&variant_keys[i].key,
+					&bs->variants[bs->num_variants++]);
+		}
+	} else {
+		batch_compile_variant(&s, "key", &batch.key,
+				&bs->variants[bs->num_variants++]);
+	}
+
+	ralloc_free(s.nir);
+}
+
+struct file_list {
+	char **names;
+	unsigned count, size;
+};
+
+static void
+find_shaders(const char *path, struct file_list *files)
+{
+	struct dirent *entry;
+	DIR *dir;
+
+	dir = opendir(path);
+	if (!dir)
+		errx(1, "couldn't open directory `%s'", path);
+
+	while ((entry = readdir(dir))) {
+		struct stat st;
+		char *name;
+
+		if (entry->d_name[0] == '.')
+			continue;
+
+		if (asprintf(&name, "%s/%s", path, entry->d_name) < 0)
+			errx(1, "out of memory");
+
+		if (stat(name, &st) == 0 && S_ISDIR(st.st_mode)) {
+			find_shaders(name, files);
+			free(name);
+		} else if (is_shader_file(name)) {
+			if (files->count == files->size) {
+				files->size = MAX2(64, files->size * 2);
+				files->names = realloc(files->names,
+						files->size * sizeof(char *));
+			}
+			files->names[files->count++] = name;
+		} else {
+			free(name);
+		}
+	}
+
+	closedir(dir);
+}
+
+static int
+compare_names(const void *a, const void *b)
+{
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+static void
+print_time(const char *name, uint64_t ns, uint64_t total)
+{
+	printf(";   %-10s %10.3f ms  %5.1f%%\n", name, ns / 1000000.0,
+			total ? ns * 100.0 / total : 0.0);
+}
+
+static int
+run_batch(const char *path)
+{
+	struct file_list files = {0};
+	struct batch_shader *shaders;
+	struct ir3_compile_timings timings = {0};
+	struct util_queue queue;
+	uint64_t frontend = 0, nir_time = 0, assemble = 0, total;
+	unsigned num_variants = 0, num_failed = 0, instrs = 0, dwords = 0;
+	uint32_t *hashes;
+	int64_t start, wall;
+
+	find_shaders(path, &files);
+	if (!files.count)
+		errx(1, "no shaders found in `%s'", path);
+
+	/* sort, to get the same output order on every run: */
+	qsort(files.names, files.count, sizeof(char *), compare_names);
+
+	shaders = calloc(files.count, sizeof(*shaders));
+	hashes = calloc(files.count * ARRAY_SIZE(variant_keys), sizeof(*hashes));
+
+	mtx_init(&batch.frontend_lock, mtx_plain);
+	if (!util_queue_init(&queue, "ir3", files.count, batch.num_threads))
+		errx(1, "couldn't create thread pool");
+
+	start = os_time_get_nano();
+
+	for (unsigned i = 0; i < files.count; i++) {
+		shaders[i].filename = files.names[i];
+		util_queue_fence_init(&shaders[i].fence);
+		util_queue_add_job(&queue, &shaders[i], &shaders[i].fence,
+				batch_compile_shader, NULL);
+	}
+
+	for (unsigned i = 0; i < files.count; i++)
+		util_queue_fence_wait(&shaders[i].fence);
+
+	wall = os_time_get_nano() - start;
+
+	for (unsigned i = 0; i < files.count; i++) {
+		struct batch_shader *bs = &shaders[i];
+
+		if (bs->failed) {
+			printf("%s: FAILED\n", bs->filename);
+			num_failed++;
+		}
+
+		frontend += bs->frontend_time;
+		nir_time += bs->nir_time;
+
+		for (unsigned j = 0; j < bs->num_variants; j++) {
+			struct batch_variant *bv = &bs->variants[j];
+
+			if (bv->failed) {
+				printf("%s (%s): FAILED\n", bs->filename, bv->name);
+				num_failed++;
+				continue;
+			}
+
+			printf("%s (%s): %u instrs, %u dwords, %d full, %d half, "
+					"%u const, hash %08x\n",
+					bs->filename, bv->name, bv->info.instrs_count,
+					bv->info.sizedwords, bv->info.max_reg + 1,
+					bv->info.max_half_reg + 1, bv->constlen, bv->hash);
+
+			instrs += bv->info.instrs_count;
+			dwords += bv->info.sizedwords;
+			hashes[num_variants++] = bv->hash;
+
+			timings.nir += bv->timings.nir;
+			timings.emit += bv->timings.emit;
+			timings.cp += bv->timings.cp;
+			timings.sched += bv->timings.sched;
+			timings.ra += bv->timings.ra;
+			timings.legalize += bv->timings.legalize;
+			assemble += bv->assemble_time;
+		}
+
+		util_queue_fence_destroy(&bs->fence);
+		free(bs->filename);
+	}
+
+	total = frontend + nir_time + timings.nir + timings.emit + timings.cp +
+			timings.sched + timings.ra + timings.legalize + assemble;
+
+	printf("; %u shaders, %u variants, %u failed, %u instrs, %u dwords\n",
+			files.count, num_variants, num_failed, instrs, dwords);
+	printf("; %.3f ms on %u threads, %.1f variants/s\n",
+			wall / 1000000.0, batch.num_threads,
+			wall ? num_variants * 1000000000.0 / wall : 0.0);
+	printf("; cpu time per pass:\n");
+	print_time("frontend", frontend, total);
+	print_time("nir", nir_time + timings.nir, total);
+	print_time("emit", timings.emit, total);
+	print_time("cp", timings.cp, total);
+	print_time("sched", timings.sched, total);
+	print_time("ra", timings.ra, total);
+	print_time("legalize", timings.legalize, total);
+	print_time("assemble", assemble, total);
+	printf("; output hash: %08x\n",
+			util_hash_crc32(hashes, num_variants * sizeof(*hashes)));
+
+	util_queue_destroy(&queue);
+	mtx_destroy(&batch.frontend_lock);
+	free(hashes);
+	free(shaders);
+	free(files.names);
+
+	return num_failed ? 1 : 0;
+}
+
 static void print_usage(void)
 {
-	printf("Usage: ir3_compiler [OPTIONS]... <file.tgsi | (file.vert | file.frag)*>\n");
+	printf("Usage: ir3_compiler [OPTIONS]... <file.tgsi | (file.vert | file.frag)* | directory>\n");
 	printf("    --verbose         - verbose compiler/debug messages\n");
 	printf("    --binning-pass    - generate binning pass shader (VERT)\n");
 	printf("    --color-two-side  - emulate two-sided color (FRAG)\n");
@@ -209,6 +588,8 @@ static void print_usage(void)
 	printf("    --stream-out      - enable stream-out (aka transform feedback)\n");
 	printf("    --ucp MASK        - bitmask of enabled user-clip-planes\n");
 	printf("    --gpu GPU_ID      - specify gpu-id (default 320)\n");
+	printf("    --all-variants    - compile all variant keys (directory)\n");
+	printf("    --threads N       - number of compiler threads (directory)\n");
 	printf("    --help            - show this message\n");
 }
 
@@ -224,8 +605,7 @@ int main(int argc, char **argv)
 	/* TODO cmdline option to target different gpus: */
 	unsigned gpu_id = 320;
 	const char *info;
-	void *ptr;
-	size_t size;
+	struct stat st;
 
 	memset(&s, 0, sizeof(s));
 	memset(&v, 0, sizeof(v));
@@ -325,6 +705,18 @@ int main(int argc, char **argv)
 			continue;
 		}
 
+		if (!strcmp(argv[n], "--all-variants")) {
+			batch.all_variants = true;
+			n++;
+			continue;
+		}
+
+		if (!strcmp(argv[n], "--threads")) {
+			batch.num_threads = strtol(argv[n+1], NULL, 0);
+			n += 2;
+			continue;
+		}
+
 		if (!strcmp(argv[n], "--help")) {
 			print_usage();
 			return 0;
@@ -334,11 +726,23 @@ int main(int argc, char **argv)
 	}
 	debug_printf("\n");
 
+	if (n == argc - 1 && stat(argv[n], &st) == 0 && S_ISDIR(st.st_mode)) {
+		batch.key = key;
+		batch.shader = s;
+		if (!batch.num_threads)
+			batch.num_threads = MAX2(1, sysconf(_SC_NPROCESSORS_ONLN));
+		compiler = ir3_compiler_create(NULL, gpu_id);
+		return run_batch(argv[n]);
+	}
+
 	while (n < argc) {
 		char *filename = argv[n];
 		char *ext = rindex(filename, '.');
 
-		if (strcmp(ext, ".tgsi") == 0) {
+		if (!ext) {
+			print_usage();
+			return -1;
+		} else if (strcmp(ext, ".tgsi") == 0) {
 			if (num_files != 0)
 				errx(1, "in TGSI mode, only a single file may be specified");
 			s.from_tgsi = true;
@@ -369,26 +773,15 @@ int main(int argc, char **argv)
 	compiler = ir3_compiler_create(NULL, gpu_id);
 
 	if (s.from_tgsi) {
-		struct tgsi_token toks[65536];
-
-		ret = read_file(filenames[0], &ptr, &size);
-		if (ret) {
+		nir = load_tgsi(filenames[0]);
+		if (!nir) {
 			print_usage();
-			return ret;
+			return 1;
 		}
-
-		if (fd_mesa_debug & FD_DBG_OPTMSGS)
-			debug_printf("%s\n", (char *)ptr);
-
-		if (!tgsi_text_translate(ptr, toks, ARRAY_SIZE(toks)))
-			errx(1, "could not parse `%s'", filenames[0]);
-
-		if (fd_mesa_debug & FD_DBG_OPTMSGS)
-			tgsi_dump(toks, 0);
-
-		nir = ir3_tgsi_to_nir(toks);
 	} else if (num_files > 0) {
 		nir = load_glsl(num_files, filenames, stage);
+		if (!nir)
+			return 1;
 	} else {
 		print_usage();
 		return -1;
@@ -400,19 +793,7 @@ int main(int argc, char **argv)
 	v.key = key;
 	v.shader = &s;
 
-	switch (nir->stage) {
-	case MESA_SHADER_FRAGMENT:
-		s.type = v.type = SHADER_FRAGMENT;
-		break;
-	case MESA_SHADER_VERTEX:
-		s.type = v.type = SHADER_VERTEX;
-		break;
-	case MESA_SHADER_COMPUTE:
-		s.type = v.type = SHADER_COMPUTE;
-		break;
-	default:
-		errx(1, "unhandled shader stage: %d", nir->stage);
-	}
+	s.type = v.type = shader_type(nir->stage);
 
 	info = "NIR compiler";
 	ret = ir3_compile_shader_nir(s.compiler, &v);
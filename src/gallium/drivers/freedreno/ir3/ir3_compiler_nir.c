@@ -32,6 +32,7 @@
 #include "util/u_string.h"
 #include "util/u_memory.h"
 #include "util/u_inlines.h"
+#include "os/os_time.h"
 
 #include "freedreno_util.h"
 
@@ -2669,6 +2670,15 @@ fixup_astc_srgb(struct ir3_compile *ctx)
 	}
 }
 
+/* accumulate the time since the previous phase into so->timings: */
+#define COMPILE_TIME(phase) do { \
+		if (so->timings) { \
+			int64_t now = os_time_get_nano(); \
+			so->timings->phase += now - time; \
+			time = now; \
+		} \
+	} while (0)
+
 int
 ir3_compile_shader_nir(struct ir3_compiler *compiler,
 		struct ir3_shader_variant *so)
@@ -2678,6 +2688,7 @@ ir3_compile_shader_nir(struct ir3_compiler *compiler,
 	struct ir3_instruction **inputs;
 	unsigned i, j, actual_in, inloc;
 	int ret = 0, max_bary;
+	int64_t time = so->timings ? os_time_get_nano() : 0;
 
 	assert(!so->ir);
 
@@ -2688,8 +2699,12 @@ ir3_compile_shader_nir(struct ir3_compiler *compiler,
 		goto out;
 	}
 
+	COMPILE_TIME(nir);
+
 	emit_instructions(ctx);
 
+	COMPILE_TIME(emit);
+
 	if (ctx->error) {
 		DBG("EMIT failed!");
 		ret = -1;
@@ -2775,6 +2790,8 @@ ir3_compile_shader_nir(struct ir3_compiler *compiler,
 
 	ir3_depth(ir);
 
+	COMPILE_TIME(cp);
+
 	if (fd_mesa_debug & FD_DBG_OPTMSGS) {
 		printf("AFTER DEPTH:\n");
 		ir3_print(ir);
@@ -2786,6 +2803,8 @@ ir3_compile_shader_nir(struct ir3_compiler *compiler,
 		goto out;
 	}
 
+	COMPILE_TIME(sched);
+
 	if (fd_mesa_debug & FD_DBG_OPTMSGS) {
 		printf("AFTER SCHED:\n");
 		ir3_print(ir);
@@ -2797,6 +2816,8 @@ ir3_compile_shader_nir(struct ir3_compiler *compiler,
 		goto out;
 	}
 
+	COMPILE_TIME(ra);
+
 	if (fd_mesa_debug & FD_DBG_OPTMSGS) {
 		printf("AFTER RA:\n");
 		ir3_print(ir);
@@ -2847,6 +2868,8 @@ ir3_compile_shader_nir(struct ir3_compiler *compiler,
 	 */
 	ir3_legalize(ir, &so->has_samp, &so->has_ssbo, &max_bary);
 
+	COMPILE_TIME(legalize);
+
 	if (fd_mesa_debug & FD_DBG_OPTMSGS) {
 		printf("AFTER LEGALIZE:\n");
 		ir3_print(ir);
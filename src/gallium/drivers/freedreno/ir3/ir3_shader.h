@@ -163,6 +163,16 @@ ir3_shader_key_changes_vs(struct ir3_shader_key *key, struct ir3_shader_key *las
 	return false;
 }
 
+/* time spent in each phase of ir3_compile_shader_nir(), in nanoseconds: */
+struct ir3_compile_timings {
+	uint64_t nir;        /* variant specific NIR lowering/optimization */
+	uint64_t emit;       /* NIR -> ir3 */
+	uint64_t cp;         /* copy propagation, grouping and depth */
+	uint64_t sched;
+	uint64_t ra;
+	uint64_t legalize;
+};
+
 struct ir3_shader_variant {
 	struct fd_bo *bo;
 
@@ -293,6 +303,9 @@ struct ir3_shader_variant {
 	/* replicated here to avoid passing extra ptrs everywhere: */
 	enum shader_t type;
 	struct ir3_shader *shader;
+
+	/* if non-NULL, compile times get accumulated here (for ir3_compiler): */
+	struct ir3_compile_timings *timings;
 };
 
 typedef struct nir_shader nir_shader;
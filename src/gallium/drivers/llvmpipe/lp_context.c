@@ -38,6 +38,7 @@
 #include "util/u_memory.h"
 #include "util/simple_list.h"
 #include "util/u_upload_mgr.h"
+#include "gallivm/lp_bld_sample.h"
 #include "lp_clear.h"
 #include "lp_context.h"
 #include "lp_flush.h"
@@ -101,6 +102,8 @@ static void llvmpipe_destroy( struct pipe_context *pipe )
 
    lp_delete_setup_variants(llvmpipe);
 
+   lp_sample_func_cache_destroy(llvmpipe->sample_func_cache);
+
 #ifndef USE_GLOBAL_LLVM_CONTEXT
    LLVMContextDispose(llvmpipe->context);
 #endif
@@ -131,6 +134,23 @@ llvmpipe_render_condition ( struct pipe_context *pipe,
    llvmpipe->render_cond_cond = condition;
 }
 
+
+static void
+llvmpipe_get_sample_position(struct pipe_context *pipe,
+                             unsigned sample_count,
+                             unsigned sample_index,
+                             float *out_value)
+{
+   if (sample_count == 4 && sample_index < 4) {
+      out_value[0] = lp_sample_pos_4x[sample_index][0];
+      out_value[1] = lp_sample_pos_4x[sample_index][1];
+   }
+   else {
+      out_value[0] = 0.5f;
+      out_value[1] = 0.5f;
+   }
+}
+
 struct pipe_context *
 llvmpipe_create_context(struct pipe_screen *screen, void *priv,
                         unsigned flags)
@@ -160,6 +180,7 @@ llvmpipe_create_context(struct pipe_screen *screen, void *priv,
    llvmpipe->pipe.flush = do_flush;
 
    llvmpipe->pipe.render_condition = llvmpipe_render_condition;
+   llvmpipe->pipe.get_sample_position = llvmpipe_get_sample_position;
 
    llvmpipe_init_blend_funcs(llvmpipe);
    llvmpipe_init_clip_funcs(llvmpipe);
@@ -184,6 +205,10 @@ llvmpipe_create_context(struct pipe_screen *screen, void *priv,
    if (!llvmpipe->context)
       goto fail;
 
+   llvmpipe->sample_func_cache = lp_sample_func_cache_create(llvmpipe->context);
+   if (!llvmpipe->sample_func_cache)
+      goto fail;
+
    /*
     * Create drawing context and plug our rendering stage into it.
     */
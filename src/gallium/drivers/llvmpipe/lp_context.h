@@ -153,6 +153,9 @@ struct llvmpipe_context {
 
    /** The LLVMContext to use for LLVM related work */
    LLVMContextRef context;
+
+   /** Texture sampling functions shared by the fragment shader variants */
+   struct lp_sample_func_cache *sample_func_cache;
 };
 
 
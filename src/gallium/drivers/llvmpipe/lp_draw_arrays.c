@@ -39,6 +39,7 @@
 #include "lp_context.h"
 #include "lp_state.h"
 #include "lp_query.h"
+#include "lp_screen.h"
 
 #include "draw/draw_context.h"
 
@@ -66,7 +67,9 @@ llvmpipe_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info)
       return;
    }
 
-   if (lp->dirty)
+   /* Textures may have been given new storage by another context */
+   if (lp->dirty ||
+       lp->tex_timestamp != llvmpipe_screen(pipe->screen)->timestamp)
       llvmpipe_update_derived( lp );
 
    /*
@@ -37,7 +37,9 @@
 #include "draw/draw_context.h"
 #include "lp_flush.h"
 #include "lp_context.h"
+#include "lp_screen.h"
 #include "lp_setup.h"
+#include "lp_texture.h"
 
 
 /**
@@ -55,6 +57,9 @@ llvmpipe_flush( struct pipe_context *pipe,
    /* ask the setup module to flush */
    lp_setup_flush(llvmpipe->setup, fence, reason);
 
+   /* recycle storage orphaned by discarding maps */
+   llvmpipe_release_retired_storage(llvmpipe_screen(pipe->screen));
+
    /* Enable to dump BMPs of the color/depth buffers each frame */
    if (0) {
       static unsigned frame_no = 1;
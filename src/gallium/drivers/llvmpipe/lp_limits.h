@@ -50,6 +50,10 @@
 #define LP_MAX_TEXTURE_ARRAY_LAYERS 512 /* 8K x 512 / 8K x 8K x 512 */
 
 
+/** The only supported sample count of multisample render targets */
+#define LP_MAX_SAMPLES 4
+
+
 /** This must be the larger of LP_MAX_TEXTURE_2D/3D_LEVELS */
 #define LP_MAX_TEXTURE_LEVELS LP_MAX_TEXTURE_2D_LEVELS
 
@@ -76,9 +76,18 @@ lp_rast_begin( struct lp_rasterizer *rast,
 static void
 lp_rast_end( struct lp_rasterizer *rast )
 {
-   lp_scene_end_rasterization( rast->curr_scene );
+   struct lp_scene *scene = rast->curr_scene;
+
+   lp_scene_end_rasterization( scene );
 
    rast->curr_scene = NULL;
+
+   /* Only signal once the scene has been ended, as the setup code reuses
+    * the scene as soon as the fence is signalled.
+    */
+   if (scene->fence) {
+      lp_fence_signal(scene->fence);
+   }
 }
 
 
@@ -126,7 +135,7 @@ lp_rast_tile_begin(struct lp_rasterizer_task *task,
 /**
  * Clear the rasterizer's current color tile.
  * This is a bin command called during bin processing.
- * Clear commands always clear all bound layers.
+ * Clear commands always clear all bound layers and samples.
  */
 static void
 lp_rast_clear_color(struct lp_rasterizer_task *task,
@@ -152,16 +161,17 @@ lp_rast_clear_color(struct lp_rasterizer_task *task,
           __FUNCTION__, format, uc.ui[0], uc.ui[1], uc.ui[2], uc.ui[3]);
 
 
+   /* The sample planes of all the layers are consecutive */
    util_fill_box(scene->cbufs[cbuf].map,
                  format,
                  scene->cbufs[cbuf].stride,
-                 scene->cbufs[cbuf].layer_stride,
+                 scene->cbufs[cbuf].sample_stride,
                  task->x,
                  task->y,
                  0,
                  task->width,
                  task->height,
-                 scene->fb_max_layer + 1,
+                 (scene->fb_max_layer + 1) * scene->fb_nr_samples,
                  &uc);
 
    /* this will increase for each rb which probably doesn't mean much */
@@ -172,7 +182,7 @@ lp_rast_clear_color(struct lp_rasterizer_task *task,
 /**
  * Clear the rasterizer's current z/stencil tile.
  * This is a bin command called during bin processing.
- * Clear commands always clear all bound layers.
+ * Clear commands always clear all bound layers and samples.
  */
 static void
 lp_rast_clear_zstencil(struct lp_rasterizer_task *task,
@@ -198,13 +208,16 @@ lp_rast_clear_zstencil(struct lp_rasterizer_task *task,
     */
 
    if (scene->fb.zsbuf) {
-      unsigned layer;
+      /* The sample planes of all the layers are consecutive */
+      const unsigned num_planes = (scene->fb_max_layer + 1) *
+                                  scene->fb_nr_samples;
+      unsigned plane;
       uint8_t *dst_layer = task->depth_tile;
       block_size = util_format_get_blocksize(scene->fb.zsbuf->format);
 
       clear_value &= clear_mask;
 
-      for (layer = 0; layer <= scene->fb_max_layer; layer++) {
+      for (plane = 0; plane < num_planes; plane++) {
          dst = dst_layer;
 
          switch (block_size) {
@@ -278,7 +291,7 @@ lp_rast_clear_zstencil(struct lp_rasterizer_task *task,
             assert(0);
             break;
          }
-         dst_layer += scene->zsbuf.layer_stride;
+         dst_layer += scene->zsbuf.sample_stride;
       }
    }
 }
@@ -315,24 +328,39 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
    }
    variant = state->variant;
 
+   if (inputs->poly_stipple || scene->fb_nr_samples > 1) {
+      /* not all pixels are covered, or the samples to write are given by
+       * the mask, go through the masked path
+       */
+      for (y = 0; y < task->height; y += 4)
+         for (x = 0; x < task->width; x += 4)
+            lp_rast_shade_quads_mask(task, inputs, tile_x + x, tile_y + y,
+                                     0xffff);
+      return;
+   }
+
    /* render the whole 64x64 tile in 4x4 chunks */
    for (y = 0; y < task->height; y += 4){
       for (x = 0; x < task->width; x += 4) {
          uint8_t *color[PIPE_MAX_COLOR_BUFS];
          unsigned stride[PIPE_MAX_COLOR_BUFS];
+         unsigned sample_stride[PIPE_MAX_COLOR_BUFS];
          uint8_t *depth = NULL;
          unsigned depth_stride = 0;
+         unsigned depth_sample_stride = 0;
          unsigned i;
 
          /* color buffer */
          for (i = 0; i < scene->fb.nr_cbufs; i++){
             if (scene->fb.cbufs[i]) {
                stride[i] = scene->cbufs[i].stride;
+               sample_stride[i] = scene->cbufs[i].sample_stride;
                color[i] = lp_rast_get_color_block_pointer(task, i, tile_x + x,
                                                           tile_y + y, inputs->layer);
             }
             else {
                stride[i] = 0;
+               sample_stride[i] = 0;
                color[i] = NULL;
             }
          }
@@ -342,6 +370,7 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
             depth = lp_rast_get_depth_block_pointer(task, tile_x + x,
                                                     tile_y + y, inputs->layer);
             depth_stride = scene->zsbuf.stride;
+            depth_sample_stride = scene->zsbuf.sample_stride;
          }
 
          /* Propagate non-interpolated raster state. */
@@ -360,7 +389,9 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
                                             0xffff,
                                             &task->thread_data,
                                             stride,
-                                            depth_stride);
+                                            depth_stride,
+                                            sample_stride,
+                                            depth_sample_stride);
          END_JIT_CALL();
       }
    }
@@ -392,24 +423,53 @@ lp_rast_shade_tile_opaque(struct lp_rasterizer_task *task,
  * This is a bin command called during bin processing.
  * \param x  X position of quad in window coords
  * \param y  Y position of quad in window coords
+ * \param mask  coverage of the pixels, the same for all their samples
  */
 void
 lp_rast_shade_quads_mask(struct lp_rasterizer_task *task,
                          const struct lp_rast_shader_inputs *inputs,
                          unsigned x, unsigned y,
                          unsigned mask)
+{
+   lp_rast_shade_quads_mask_sample(task, inputs, x, y,
+                                   lp_rast_expand_mask(task->scene, inputs,
+                                                       mask));
+}
+
+
+/**
+ * Compute shading for a 4x4 block of pixels, given the coverage of each
+ * sample.  The shader runs once per pixel covered by any sample.
+ * \param x  X position of quad in window coords
+ * \param y  Y position of quad in window coords
+ * \param mask  per-sample coverage, as returned by lp_rast_expand_mask()
+ */
+void
+lp_rast_shade_quads_mask_sample(struct lp_rasterizer_task *task,
+                                const struct lp_rast_shader_inputs *inputs,
+                                unsigned x, unsigned y,
+                                uint64_t mask)
 {
    const struct lp_rast_state *state = task->state;
    struct lp_fragment_shader_variant *variant = state->variant;
    const struct lp_scene *scene = task->scene;
    uint8_t *color[PIPE_MAX_COLOR_BUFS];
    unsigned stride[PIPE_MAX_COLOR_BUFS];
+   unsigned sample_stride[PIPE_MAX_COLOR_BUFS];
    uint8_t *depth = NULL;
    unsigned depth_stride = 0;
+   unsigned depth_sample_stride = 0;
    unsigned i;
 
    assert(state);
 
+   if (inputs->poly_stipple) {
+      mask &= lp_rast_expand_mask(scene, inputs,
+                                  lp_rast_poly_stipple_mask(state, x, y));
+      if (!mask)
+         return;
+   }
+
    /* Sanity checks */
    assert(x < scene->tiles_x * TILE_SIZE);
    assert(y < scene->tiles_y * TILE_SIZE);
@@ -423,11 +483,13 @@ lp_rast_shade_quads_mask(struct lp_rasterizer_task *task,
    for (i = 0; i < scene->fb.nr_cbufs; i++) {
       if (scene->fb.cbufs[i]) {
          stride[i] = scene->cbufs[i].stride;
+         sample_stride[i] = scene->cbufs[i].sample_stride;
          color[i] = lp_rast_get_color_block_pointer(task, i, x, y,
                                                     inputs->layer);
       }
       else {
          stride[i] = 0;
+         sample_stride[i] = 0;
          color[i] = NULL;
       }
    }
@@ -435,6 +497,7 @@ lp_rast_shade_quads_mask(struct lp_rasterizer_task *task,
    /* depth buffer */
    if (scene->zsbuf.map) {
       depth_stride = scene->zsbuf.stride;
+      depth_sample_stride = scene->zsbuf.sample_stride;
       depth = lp_rast_get_depth_block_pointer(task, x, y, inputs->layer);
    }
 
@@ -465,7 +528,9 @@ lp_rast_shade_quads_mask(struct lp_rasterizer_task *task,
                                             mask,
                                             &task->thread_data,
                                             stride,
-                                            depth_stride);
+                                            depth_stride,
+                                            sample_stride,
+                                            depth_sample_stride);
       END_JIT_CALL();
    }
 }
@@ -589,7 +654,15 @@ static lp_rast_cmd_func dispatch[LP_RAST_OP_MAX] =
    lp_rast_triangle_32_8,
    lp_rast_triangle_32_3_4,
    lp_rast_triangle_32_3_16,
-   lp_rast_triangle_32_4_16
+   lp_rast_triangle_32_4_16,
+   lp_rast_triangle_ms_1,
+   lp_rast_triangle_ms_2,
+   lp_rast_triangle_ms_3,
+   lp_rast_triangle_ms_4,
+   lp_rast_triangle_ms_5,
+   lp_rast_triangle_ms_6,
+   lp_rast_triangle_ms_7,
+   lp_rast_triangle_ms_8
 };
 
 
@@ -705,10 +778,6 @@ rasterize_scene(struct lp_rasterizer_task *task,
    }
 #endif
 
-   if (scene->fence) {
-      lp_fence_signal(scene->fence);
-   }
-
    task->scene = NULL;
 }
 
@@ -757,23 +826,6 @@ lp_rast_queue_scene( struct lp_rasterizer *rast,
 }
 
 
-void
-lp_rast_finish( struct lp_rasterizer *rast )
-{
-   if (rast->num_threads == 0) {
-      /* nothing to do */
-   }
-   else {
-      int i;
-
-      /* wait for work to complete */
-      for (i = 0; i < rast->num_threads; i++) {
-         pipe_semaphore_wait(&rast->tasks[i].work_done);
-      }
-   }
-}
-
-
 /**
  * This is the thread's main entrypoint.
  * It's a simple loop:
@@ -832,17 +884,15 @@ thread_function(void *init_data)
       /* wait for all threads to finish with this scene */
       pipe_barrier_wait( &rast->barrier );
 
-      /* XXX: shouldn't be necessary:
+      /* thread[0] ends the scene and signals its fence; the barrier
+       * above guarantees nobody else is still using it.
        */
       if (task->thread_index == 0) {
          lp_rast_end( rast );
       }
 
-      /* signal done with work */
       if (debug)
          debug_printf("thread %d done working\n", task->thread_index);
-
-      pipe_semaphore_signal(&task->work_done);
    }
 
 #ifdef _WIN32
@@ -88,6 +88,11 @@ struct lp_rast_state {
     * the tile color/z/stencil data somehow
      */
    struct lp_fragment_shader_variant *variant;
+
+   /* Polygon stipple pattern, one row per framebuffer row modulo 32,
+    * with bit i of a row covering framebuffer column i modulo 32.
+    */
+   const uint32_t *poly_stipple;
 };
 
 
@@ -100,7 +105,9 @@ struct lp_rast_shader_inputs {
    unsigned frontfacing:1;      /** True for front-facing */
    unsigned disable:1;          /** Partially binned, disable this command */
    unsigned opaque:1;           /** Is opaque */
-   unsigned pad0:29;            /* wasted space */
+   unsigned poly_stipple:1;     /** Apply the polygon stipple pattern */
+   unsigned sample_mask:LP_MAX_SAMPLES; /** Samples written when multisampling */
+   unsigned pad0:24;            /* wasted space */
    unsigned stride;             /* how much to advance data between a0, dadx, dady */
    unsigned layer;              /* the layer to render to (from gs, already clamped) */
    unsigned viewport_index;     /* the active viewport index (from gs, already clamped) */
@@ -124,6 +131,49 @@ struct lp_rast_plane {
    uint32_t pad;
 };
 
+
+/**
+ * Offsets of the multisample positions (lp_sample_pos_4x) from the pixel
+ * center, in 1/FIXED_ONE pixels.
+ */
+static const int32_t lp_sample_offset_4x[LP_MAX_SAMPLES][2] = {
+   { -32, -96 },
+   {  96, -32 },
+   { -96,  32 },
+   {  32,  96 }
+};
+
+
+/**
+ * Change of a plane's edge function from the pixel center to sample s.
+ * The low FIXED_ORDER bits of dcdx and dcdy are always 0.
+ */
+static inline int64_t
+lp_rast_sample_offset(const struct lp_rast_plane *plane, unsigned s)
+{
+   return IMUL64(plane->dcdy >> FIXED_ORDER, lp_sample_offset_4x[s][1]) -
+          IMUL64(plane->dcdx >> FIXED_ORDER, lp_sample_offset_4x[s][0]);
+}
+
+
+/**
+ * Largest change of a plane's edge function from the pixel center to any
+ * sample.  The trivial reject and accept tests widen by this much so that
+ * they hold for the samples and not just the pixel centers.
+ */
+static inline int64_t
+lp_rast_sample_max_offset(const struct lp_rast_plane *plane)
+{
+   int64_t max = 0;
+   unsigned s;
+
+   for (s = 0; s < LP_MAX_SAMPLES; s++) {
+      int64_t offset = lp_rast_sample_offset(plane, s);
+      max = MAX2(max, offset < 0 ? -offset : offset);
+   }
+   return max;
+}
+
 /**
  * Rasterization information for a triangle known to be in this bin,
  * plus inputs to run the shader:
@@ -166,9 +216,6 @@ void
 lp_rast_queue_scene( struct lp_rasterizer *rast,
                      struct lp_scene *scene );
 
-void
-lp_rast_finish( struct lp_rasterizer *rast );
-
 
 union lp_rast_cmd_arg {
    const struct lp_rast_shader_inputs *shade_tile;
@@ -302,8 +349,16 @@ lp_rast_arg_null( void )
 #define LP_RAST_OP_TRIANGLE_32_3_4   0x1a
 #define LP_RAST_OP_TRIANGLE_32_3_16  0x1b
 #define LP_RAST_OP_TRIANGLE_32_4_16  0x1c
-
-#define LP_RAST_OP_MAX               0x1d
+#define LP_RAST_OP_MS_TRIANGLE_1     0x1d
+#define LP_RAST_OP_MS_TRIANGLE_2     0x1e
+#define LP_RAST_OP_MS_TRIANGLE_3     0x1f
+#define LP_RAST_OP_MS_TRIANGLE_4     0x20
+#define LP_RAST_OP_MS_TRIANGLE_5     0x21
+#define LP_RAST_OP_MS_TRIANGLE_6     0x22
+#define LP_RAST_OP_MS_TRIANGLE_7     0x23
+#define LP_RAST_OP_MS_TRIANGLE_8     0x24
+
+#define LP_RAST_OP_MAX               0x25
 #define LP_RAST_OP_MASK              0xff
 
 void
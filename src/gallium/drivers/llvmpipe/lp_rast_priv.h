@@ -140,6 +140,36 @@ lp_rast_shade_quads_mask(struct lp_rasterizer_task *task,
                          unsigned x, unsigned y,
                          unsigned mask);
 
+void
+lp_rast_shade_quads_mask_sample(struct lp_rasterizer_task *task,
+                                const struct lp_rast_shader_inputs *inputs,
+                                unsigned x, unsigned y,
+                                uint64_t mask);
+
+
+/**
+ * Expand a 4x4 pixel mask to the per-sample coverage mask taken by the
+ * fragment shader, where sample s of the block is in bits [16*s, 16*s+15].
+ * Samples disabled by the sample mask are left uncovered.
+ */
+static inline uint64_t
+lp_rast_expand_mask(const struct lp_scene *scene,
+                    const struct lp_rast_shader_inputs *inputs,
+                    unsigned mask)
+{
+   uint64_t sample_mask = 0;
+   unsigned s;
+
+   if (scene->fb_nr_samples == 1)
+      return mask;
+
+   for (s = 0; s < scene->fb_nr_samples; s++) {
+      if (inputs->sample_mask & (1 << s))
+         sample_mask |= (uint64_t)mask << (16 * s);
+   }
+   return sample_mask;
+}
+
 
 /**
  * Get the pointer to a 4x4 color block (within a 64x64 tile).
@@ -217,6 +247,24 @@ lp_rast_get_depth_block_pointer(struct lp_rasterizer_task *task,
 
 
 
+/**
+ * Return the coverage of the polygon stipple pattern for the 4x4 block at
+ * \p x, \p y (in window coords), in the layout of the fragment shader mask.
+ */
+static inline unsigned
+lp_rast_poly_stipple_mask(const struct lp_rast_state *state,
+                          unsigned x, unsigned y)
+{
+   const uint32_t *rows = state->poly_stipple;
+   unsigned shift = x % 32;
+
+   return ((rows[(y + 0) % 32] >> shift) & 0xf) |
+          (((rows[(y + 1) % 32] >> shift) & 0xf) << 4) |
+          (((rows[(y + 2) % 32] >> shift) & 0xf) << 8) |
+          (((rows[(y + 3) % 32] >> shift) & 0xf) << 12);
+}
+
+
 /**
  * Shade all pixels in a 4x4 block.  The fragment code omits the
  * triangle in/out tests.
@@ -232,19 +280,31 @@ lp_rast_shade_quads_all( struct lp_rasterizer_task *task,
    struct lp_fragment_shader_variant *variant = state->variant;
    uint8_t *color[PIPE_MAX_COLOR_BUFS];
    unsigned stride[PIPE_MAX_COLOR_BUFS];
+   unsigned sample_stride[PIPE_MAX_COLOR_BUFS];
    uint8_t *depth = NULL;
    unsigned depth_stride = 0;
+   unsigned depth_sample_stride = 0;
    unsigned i;
 
+   /* Multisample variants have no whole-block path, they always need
+    * the sample mask.
+    */
+   if (inputs->poly_stipple || scene->fb_nr_samples > 1) {
+      lp_rast_shade_quads_mask(task, inputs, x, y, 0xffff);
+      return;
+   }
+
    /* color buffer */
    for (i = 0; i < scene->fb.nr_cbufs; i++) {
       if (scene->fb.cbufs[i]) {
          stride[i] = scene->cbufs[i].stride;
+         sample_stride[i] = scene->cbufs[i].sample_stride;
          color[i] = lp_rast_get_color_block_pointer(task, i, x, y,
                                                     inputs->layer);
       }
       else {
          stride[i] = 0;
+         sample_stride[i] = 0;
          color[i] = NULL;
       }
    }
@@ -252,6 +312,7 @@ lp_rast_shade_quads_all( struct lp_rasterizer_task *task,
    if (scene->zsbuf.map) {
       depth = lp_rast_get_depth_block_pointer(task, x, y, inputs->layer);
       depth_stride = scene->zsbuf.stride;
+      depth_sample_stride = scene->zsbuf.sample_stride;
    }
 
    /*
@@ -279,7 +340,9 @@ lp_rast_shade_quads_all( struct lp_rasterizer_task *task,
                                          0xffff,
                                          &task->thread_data,
                                          stride,
-                                         depth_stride);
+                                         depth_stride,
+                                         sample_stride,
+                                         depth_sample_stride);
       END_JIT_CALL();
    }
 }
@@ -337,6 +400,24 @@ void lp_rast_triangle_32_3_16( struct lp_rasterizer_task *,
 void lp_rast_triangle_32_4_16( struct lp_rasterizer_task *, 
                             const union lp_rast_cmd_arg );
 
+
+void lp_rast_triangle_ms_1( struct lp_rasterizer_task *,
+                            const union lp_rast_cmd_arg );
+void lp_rast_triangle_ms_2( struct lp_rasterizer_task *,
+                            const union lp_rast_cmd_arg );
+void lp_rast_triangle_ms_3( struct lp_rasterizer_task *,
+                            const union lp_rast_cmd_arg );
+void lp_rast_triangle_ms_4( struct lp_rasterizer_task *,
+                            const union lp_rast_cmd_arg );
+void lp_rast_triangle_ms_5( struct lp_rasterizer_task *,
+                            const union lp_rast_cmd_arg );
+void lp_rast_triangle_ms_6( struct lp_rasterizer_task *,
+                            const union lp_rast_cmd_arg );
+void lp_rast_triangle_ms_7( struct lp_rasterizer_task *,
+                            const union lp_rast_cmd_arg );
+void lp_rast_triangle_ms_8( struct lp_rasterizer_task *,
+                            const union lp_rast_cmd_arg );
+
 void
 lp_rast_set_state(struct lp_rasterizer_task *task,
                   const union lp_rast_cmd_arg arg);
@@ -732,6 +732,50 @@ lp_rast_triangle_32_3_4(struct lp_rasterizer_task *task,
 #define NR_PLANES 8
 #include "lp_rast_tri_tmp.h"
 
+/*
+ * Multisample variants, with per-sample coverage.  These only come in
+ * the 64 bit flavour.
+ */
+#define TAG(x) x##_ms_1
+#define NR_PLANES 1
+#define MULTISAMPLE 1
+#include "lp_rast_tri_tmp.h"
+
+#define TAG(x) x##_ms_2
+#define NR_PLANES 2
+#define MULTISAMPLE 1
+#include "lp_rast_tri_tmp.h"
+
+#define TAG(x) x##_ms_3
+#define NR_PLANES 3
+#define MULTISAMPLE 1
+#include "lp_rast_tri_tmp.h"
+
+#define TAG(x) x##_ms_4
+#define NR_PLANES 4
+#define MULTISAMPLE 1
+#include "lp_rast_tri_tmp.h"
+
+#define TAG(x) x##_ms_5
+#define NR_PLANES 5
+#define MULTISAMPLE 1
+#include "lp_rast_tri_tmp.h"
+
+#define TAG(x) x##_ms_6
+#define NR_PLANES 6
+#define MULTISAMPLE 1
+#include "lp_rast_tri_tmp.h"
+
+#define TAG(x) x##_ms_7
+#define NR_PLANES 7
+#define MULTISAMPLE 1
+#include "lp_rast_tri_tmp.h"
+
+#define TAG(x) x##_ms_8
+#define NR_PLANES 8
+#define MULTISAMPLE 1
+#include "lp_rast_tri_tmp.h"
+
 #undef RASTER_64
 
 #define TAG(x) x##_32_1
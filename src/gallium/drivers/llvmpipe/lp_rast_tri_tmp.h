@@ -46,6 +46,33 @@ TAG(do_block_4)(struct lp_rasterizer_task *task,
                 int x, int y,
                 const int64_t *c)
 {
+#ifdef MULTISAMPLE
+   /* Evaluate the edge functions at each sample, the shader still runs
+    * once for the pixels covered by any of them.
+    */
+   uint64_t mask = 0;
+   unsigned s;
+   int j;
+
+   for (s = 0; s < task->scene->fb_nr_samples; s++) {
+      unsigned sample_mask = 0xffff;
+
+      if (!(tri->inputs.sample_mask & (1 << s)))
+         continue;
+
+      for (j = 0; j < NR_PLANES; j++) {
+         const int64_t cs = c[j] + lp_rast_sample_offset(&plane[j], s);
+
+         sample_mask &= ~BUILD_MASK_LINEAR(((cs - 1) >> (int64_t)FIXED_ORDER),
+                                           -plane[j].dcdx >> FIXED_ORDER,
+                                           plane[j].dcdy >> FIXED_ORDER);
+      }
+      mask |= (uint64_t)sample_mask << (16 * s);
+   }
+
+   if (mask)
+      lp_rast_shade_quads_mask_sample(task, &tri->inputs, x, y, mask);
+#else
    unsigned mask = 0xffff;
    int j;
 
@@ -65,6 +92,7 @@ TAG(do_block_4)(struct lp_rasterizer_task *task,
     */
    if (mask)
       lp_rast_shade_quads_mask(task, &tri->inputs, x, y, mask);
+#endif
 }
 
 /**
@@ -91,10 +119,22 @@ TAG(do_block_16)(struct lp_rasterizer_task *task,
       const int32_t cox = plane[j].eo >> FIXED_ORDER;
       const int32_t ei = (dcdy + dcdx - cox) << 2;
       const int32_t cox_s = cox << 2;
-      const int32_t co = (int32_t)(c[j] >> (int64_t)FIXED_ORDER) + cox_s;
+      int32_t co = (int32_t)(c[j] >> (int64_t)FIXED_ORDER) + cox_s;
       int32_t cdiff;
       cdiff = ei - cox_s + ((int32_t)((c[j] - 1) >> (int64_t)FIXED_ORDER) -
                             (int32_t)(c[j] >> (int64_t)FIXED_ORDER));
+#ifdef MULTISAMPLE
+      /*
+       * Make the trivial reject and accept tests hold for all the
+       * samples, not just the pixel centers.
+       */
+      {
+         const int32_t ms = (int32_t)((lp_rast_sample_max_offset(&plane[j]) +
+                                       FIXED_ONE - 1) >> FIXED_ORDER);
+         co += ms;
+         cdiff -= 2 * ms;
+      }
+#endif
       dcdx <<= 2;
       dcdy <<= 2;
 #else
@@ -218,7 +258,7 @@ TAG(lp_rast_triangle)(struct lp_rasterizer_task *task,
          const int32_t cox = plane[j].eo >> FIXED_ORDER;
          const int32_t ei = (dcdy + dcdx - cox) << 4;
          const int32_t cox_s = cox << 4;
-         const int32_t co = (int32_t)(c[j] >> (int64_t)FIXED_ORDER) + cox_s;
+         int32_t co = (int32_t)(c[j] >> (int64_t)FIXED_ORDER) + cox_s;
          int32_t cdiff;
          /*
           * Plausibility check to ensure the 32bit math works.
@@ -247,6 +287,14 @@ TAG(lp_rast_triangle)(struct lp_rasterizer_task *task,
           */
          cdiff = ei - cox_s + ((int32_t)((c[j] - 1) >> (int64_t)FIXED_ORDER) -
                                (int32_t)(c[j] >> (int64_t)FIXED_ORDER));
+#ifdef MULTISAMPLE
+         {
+            const int32_t ms = (int32_t)((lp_rast_sample_max_offset(&plane[j]) +
+                                          FIXED_ONE - 1) >> FIXED_ORDER);
+            co += ms;
+            cdiff -= 2 * ms;
+         }
+#endif
          dcdx <<= 4;
          dcdy <<= 4;
 #else
@@ -450,4 +498,5 @@ TRI_4(struct lp_rasterizer_task *task,
 #undef TRI_4
 #undef TRI_16
 #undef NR_PLANES
+#undef MULTISAMPLE
 
@@ -34,6 +34,7 @@
 #include "lp_scene.h"
 #include "lp_fence.h"
 #include "lp_debug.h"
+#include "lp_screen.h"
 
 
 #define RESOURCE_REF_SZ 32
@@ -64,6 +65,8 @@ lp_scene_create( struct pipe_context *pipe )
 
    (void) mtx_init(&scene->mutex, mtx_plain);
 
+   list_inithead(&scene->screen_link);
+
 #ifdef DEBUG
    /* Do some scene limit sanity checks here */
    {
@@ -83,12 +86,28 @@ lp_scene_create( struct pipe_context *pipe )
 }
 
 
+/**
+ * Remove the scene from the screen's list of live scenes, letting go of
+ * any storage only kept alive for it.
+ */
+static void
+lp_scene_unlink(struct lp_scene *scene)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(scene->pipe->screen);
+
+   mtx_lock(&screen->storage_mutex);
+   list_delinit(&scene->screen_link);
+   mtx_unlock(&screen->storage_mutex);
+}
+
+
 /**
  * Free all data associated with the given scene, and the scene itself.
  */
 void
 lp_scene_destroy(struct lp_scene *scene)
 {
+   lp_scene_unlink(scene);
    lp_fence_reference(&scene->fence, NULL);
    mtx_destroy(&scene->mutex);
    assert(scene->data.head->next == NULL);
@@ -160,6 +179,7 @@ lp_scene_begin_rasterization(struct lp_scene *scene)
       if (!cbuf) {
          scene->cbufs[i].stride = 0;
          scene->cbufs[i].layer_stride = 0;
+         scene->cbufs[i].sample_stride = 0;
          scene->cbufs[i].map = NULL;
          continue;
       }
@@ -169,6 +189,8 @@ lp_scene_begin_rasterization(struct lp_scene *scene)
                                                            cbuf->u.tex.level);
          scene->cbufs[i].layer_stride = llvmpipe_layer_stride(cbuf->texture,
                                                               cbuf->u.tex.level);
+         scene->cbufs[i].sample_stride = llvmpipe_sample_stride(cbuf->texture,
+                                                                cbuf->u.tex.level);
 
          scene->cbufs[i].map = llvmpipe_resource_map(cbuf->texture,
                                                      cbuf->u.tex.level,
@@ -181,6 +203,7 @@ lp_scene_begin_rasterization(struct lp_scene *scene)
          unsigned pixstride = util_format_get_blocksize(cbuf->format);
          scene->cbufs[i].stride = cbuf->texture->width0;
          scene->cbufs[i].layer_stride = 0;
+         scene->cbufs[i].sample_stride = 0;
          scene->cbufs[i].map = lpr->data;
          scene->cbufs[i].map += cbuf->u.buf.first_element * pixstride;
          scene->cbufs[i].format_bytes = util_format_get_blocksize(cbuf->format);
@@ -191,6 +214,7 @@ lp_scene_begin_rasterization(struct lp_scene *scene)
       struct pipe_surface *zsbuf = scene->fb.zsbuf;
       scene->zsbuf.stride = llvmpipe_resource_stride(zsbuf->texture, zsbuf->u.tex.level);
       scene->zsbuf.layer_stride = llvmpipe_layer_stride(zsbuf->texture, zsbuf->u.tex.level);
+      scene->zsbuf.sample_stride = llvmpipe_sample_stride(zsbuf->texture, zsbuf->u.tex.level);
 
       scene->zsbuf.map = llvmpipe_resource_map(zsbuf->texture,
                                                zsbuf->u.tex.level,
@@ -249,8 +273,11 @@ lp_scene_end_rasterization(struct lp_scene *scene )
     */
    assert(lp_scene_is_empty(scene));
 
-   /* Decrement texture ref counts
+   /* Decrement texture ref counts.  The setup code may be checking the
+    * references of a queued scene concurrently, see
+    * lp_scene_is_resource_referenced().
     */
+   mtx_lock(&scene->mutex);
    {
       struct resource_ref *ref;
       int i, j = 0;
@@ -289,15 +316,16 @@ lp_scene_end_rasterization(struct lp_scene *scene )
       list->head->used = 0;
    }
 
-   lp_fence_reference(&scene->fence, NULL);
-
    scene->resources = NULL;
    scene->scene_size = 0;
    scene->resource_reference_size = 0;
 
-   scene->alloc_failed = FALSE;
-
    util_unreference_framebuffer_state( &scene->fb );
+   mtx_unlock(&scene->mutex);
+
+   lp_scene_unlink(scene);
+
+   scene->alloc_failed = FALSE;
 }
 
 
@@ -429,21 +457,43 @@ lp_scene_add_resource_reference(struct lp_scene *scene,
 
 /**
  * Does this scene have a reference to the given resource?
+ * The render targets of a queued scene are still being written, the
+ * other referenced resources are only read.
+ * \return bitmask of LP_REFERENCED_FOR_READ/WRITE bits
  */
-boolean
+unsigned
 lp_scene_is_resource_referenced(const struct lp_scene *scene,
                                 const struct pipe_resource *resource)
 {
    const struct resource_ref *ref;
+   unsigned referenced = LP_UNREFERENCED;
    int i;
 
+   mtx_lock((mtx_t *) &scene->mutex);
+   for (i = 0; i < scene->fb.nr_cbufs; i++) {
+      if (scene->fb.cbufs[i] && scene->fb.cbufs[i]->texture == resource) {
+         referenced = LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
+         goto out;
+      }
+   }
+   if (scene->fb.zsbuf && scene->fb.zsbuf->texture == resource) {
+      referenced = LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
+      goto out;
+   }
+
    for (ref = scene->resources; ref; ref = ref->next) {
-      for (i = 0; i < ref->count; i++)
-         if (ref->resource[i] == resource)
-            return TRUE;
+      for (i = 0; i < ref->count; i++) {
+         if (ref->resource[i] == resource) {
+            referenced = LP_REFERENCED_FOR_READ;
+            goto out;
+         }
+      }
    }
 
-   return FALSE;
+out:
+   mtx_unlock((mtx_t *) &scene->mutex);
+
+   return referenced;
 }
 
 
@@ -510,13 +560,25 @@ end:
 void lp_scene_begin_binning( struct lp_scene *scene,
                              struct pipe_framebuffer_state *fb, boolean discard )
 {
+   struct llvmpipe_screen *screen = llvmpipe_screen(scene->pipe->screen);
    int i;
    unsigned max_layer = ~0;
 
    assert(lp_scene_is_empty(scene));
 
+   mtx_lock(&screen->storage_mutex);
+   scene->seq = ++screen->scene_seq;
+   list_addtail(&scene->screen_link, &screen->live_scenes);
+   mtx_unlock(&screen->storage_mutex);
+
    scene->discard = discard;
+
+   /* the render targets count as references of the scene, see
+    * lp_scene_is_resource_referenced()
+    */
+   mtx_lock(&scene->mutex);
    util_copy_framebuffer_state(&scene->fb, fb);
+   mtx_unlock(&scene->mutex);
 
    scene->tiles_x = align(fb->width, TILE_SIZE) / TILE_SIZE;
    scene->tiles_y = align(fb->height, TILE_SIZE) / TILE_SIZE;
@@ -546,6 +608,7 @@ void lp_scene_begin_binning( struct lp_scene *scene,
       max_layer = MIN2(max_layer, zsbuf->u.tex.last_layer - zsbuf->u.tex.first_layer);
    }
    scene->fb_max_layer = max_layer;
+   scene->fb_nr_samples = util_framebuffer_get_num_samples(fb);
 }
 
 
@@ -36,6 +36,7 @@
 #define LP_SCENE_H
 
 #include "os/os_thread.h"
+#include "util/list.h"
 #include "lp_rast.h"
 #include "lp_debug.h"
 
@@ -142,12 +143,16 @@ struct lp_scene {
       uint8_t *map;
       unsigned stride;
       unsigned layer_stride;
+      unsigned sample_stride;
       unsigned format_bytes;
    } zsbuf, cbufs[PIPE_MAX_COLOR_BUFS];
 
    /* The amount of layers in the fb (minimum of all attachments) */
    unsigned fb_max_layer;
 
+   /* The amount of samples of the fb attachments */
+   unsigned fb_nr_samples;
+
    /** the framebuffer to render the scene into */
    struct pipe_framebuffer_state fb;
 
@@ -176,6 +181,10 @@ struct lp_scene {
    int curr_x, curr_y;  /**< for iterating over bins */
    mtx_t mutex;
 
+   /** Link in the screen's live_scenes list, and position in it */
+   struct list_head screen_link;
+   unsigned seq;
+
    struct cmd_bin tile[TILES_X][TILES_Y];
    struct data_block_list data;
 };
@@ -199,8 +208,8 @@ boolean lp_scene_add_resource_reference(struct lp_scene *scene,
                                         struct pipe_resource *resource,
                                         boolean initializing_scene);
 
-boolean lp_scene_is_resource_referenced(const struct lp_scene *scene,
-                                        const struct pipe_resource *resource );
+unsigned lp_scene_is_resource_referenced(const struct lp_scene *scene,
+                                         const struct pipe_resource *resource );
 
 
 /**
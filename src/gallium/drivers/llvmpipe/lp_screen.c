@@ -457,8 +457,21 @@ llvmpipe_is_format_supported( struct pipe_screen *_screen,
           target == PIPE_TEXTURE_CUBE ||
           target == PIPE_TEXTURE_CUBE_ARRAY);
 
-   if (sample_count > 1)
-      return FALSE;
+   /* Multisampling is only supported for rendering, the sample planes
+    * can't be sampled from by shaders.
+    */
+   if (sample_count > 1) {
+      if (!screen->native_msaa || sample_count != LP_MAX_SAMPLES)
+         return FALSE;
+
+      if (target != PIPE_TEXTURE_2D &&
+          target != PIPE_TEXTURE_2D_ARRAY &&
+          target != PIPE_TEXTURE_RECT)
+         return FALSE;
+
+      if (bind & ~(PIPE_BIND_RENDER_TARGET | PIPE_BIND_DEPTH_STENCIL))
+         return FALSE;
+   }
 
    if (bind & PIPE_BIND_RENDER_TARGET) {
       if (format_desc->colorspace == UTIL_FORMAT_COLORSPACE_SRGB) {
@@ -552,6 +565,19 @@ llvmpipe_flush_frontbuffer(struct pipe_screen *_screen,
    struct llvmpipe_screen *screen = llvmpipe_screen(_screen);
    struct sw_winsys *winsys = screen->winsys;
    struct llvmpipe_resource *texture = llvmpipe_resource(resource);
+   struct lp_fence *fence = NULL;
+
+   /* Scenes are rasterized asynchronously, and we don't know which context
+    * rendered to the display target, so wait for everything queued so far.
+    */
+   mtx_lock(&screen->rast_mutex);
+   lp_fence_reference(&fence, screen->last_fence);
+   mtx_unlock(&screen->rast_mutex);
+
+   if (fence) {
+      lp_fence_wait(fence);
+      lp_fence_reference(&fence, NULL);
+   }
 
    assert(texture->dt);
    if (texture->dt)
@@ -567,6 +593,8 @@ llvmpipe_destroy_screen( struct pipe_screen *_screen )
    if (screen->rast)
       lp_rast_destroy(screen->rast);
 
+   lp_fence_reference(&screen->last_fence, NULL);
+
    lp_jit_screen_cleanup(screen);
 
    if(winsys->destroy)
@@ -574,6 +602,9 @@ llvmpipe_destroy_screen( struct pipe_screen *_screen )
 
    mtx_destroy(&screen->rast_mutex);
 
+   llvmpipe_free_storage(screen);
+   mtx_destroy(&screen->storage_mutex);
+
    FREE(screen);
 }
 
@@ -673,6 +704,11 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
    screen->num_threads = debug_get_num_option("LP_NUM_THREADS", screen->num_threads);
    screen->num_threads = MIN2(screen->num_threads, LP_MAX_THREADS);
 
+   /* Real multisampling disables the fake multisampling which provides
+    * ARB_texture_multisample, so it is opt-in for now.
+    */
+   screen->native_msaa = debug_get_bool_option("LP_NATIVE_MSAA", FALSE);
+
    screen->rast = lp_rast_create(screen->num_threads);
    if (!screen->rast) {
       lp_jit_screen_cleanup(screen);
@@ -681,6 +717,11 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
    }
    (void) mtx_init(&screen->rast_mutex, mtx_plain);
 
+   (void) mtx_init(&screen->storage_mutex, mtx_plain);
+   list_inithead(&screen->live_scenes);
+   list_inithead(&screen->retired_storage);
+   list_inithead(&screen->storage_pool);
+
    util_format_s3tc_init();
 
    return &screen->base;
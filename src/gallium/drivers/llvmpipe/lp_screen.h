@@ -37,10 +37,12 @@
 #include "pipe/p_screen.h"
 #include "pipe/p_defines.h"
 #include "os/os_thread.h"
+#include "util/list.h"
 #include "gallivm/lp_bld.h"
 
 
 struct sw_winsys;
+struct lp_fence;
 
 
 struct llvmpipe_screen
@@ -51,12 +53,28 @@ struct llvmpipe_screen
 
    unsigned num_threads;
 
+   /* Whether LP_MAX_SAMPLES multisample render targets are supported */
+   boolean native_msaa;
+
    /* Increments whenever textures are modified.  Contexts can track this.
     */
    unsigned timestamp;
 
    struct lp_rasterizer *rast;
    mtx_t rast_mutex;
+   struct lp_fence *last_fence;  /**< of the last scene queued on rast */
+
+   /* Resource storage orphaned by discarding transfer maps.  Retired
+    * storage is kept until every scene which was alive at the time of
+    * the discard has been rasterized, and is then recycled through the
+    * pool.
+    */
+   mtx_t storage_mutex;
+   struct list_head live_scenes;     /**< binning/rasterizing, oldest first */
+   struct list_head retired_storage; /**< possibly still read by a scene */
+   struct list_head storage_pool;    /**< idle, ready for reuse */
+   unsigned storage_pool_size;
+   unsigned scene_seq;
 };
 
 
@@ -79,7 +79,9 @@ lp_setup_get_empty_scene(struct lp_setup_context *setup)
          debug_printf("%s: wait for scene %d\n",
                       __FUNCTION__, setup->scene->fence->id);
 
+      /* The rasterizer signals the fence once it's done with the scene */
       lp_fence_wait(setup->scene->fence);
+      lp_fence_reference(&setup->scene->fence, NULL);
    }
 
    lp_scene_begin_binning(setup->scene, &setup->fb, setup->rasterizer_discard);
@@ -87,6 +89,17 @@ lp_setup_get_empty_scene(struct lp_setup_context *setup)
 }
 
 
+/**
+ * The standard 4x pattern, relative to the upper left pixel corner.
+ */
+const float lp_sample_pos_4x[4][2] = {
+   { 0.375f, 0.125f },
+   { 0.875f, 0.375f },
+   { 0.125f, 0.625f },
+   { 0.625f, 0.875f }
+};
+
+
 static void
 first_triangle( struct lp_setup_context *setup,
                 const float (*v0)[4],
@@ -165,23 +178,16 @@ lp_setup_rasterize_scene( struct lp_setup_context *setup )
    if (setup->last_fence)
       setup->last_fence->issued = TRUE;
 
-   mtx_lock(&screen->rast_mutex);
-
-   /* FIXME: We enqueue the scene then wait on the rasterizer to finish.
-    * This means we never actually run any vertex stuff in parallel to
-    * rasterization (not in the same context at least) which is what the
-    * multiple scenes per setup is about - when we get a new empty scene
-    * any old one is already empty again because we waited here for
-    * raster tasks to be finished. Ideally, we shouldn't need to wait here
-    * and rely on fences elsewhere when waiting is necessary.
-    * Certainly, lp_scene_end_rasterization() would need to be deferred too
-    * and there's probably other bits why this doesn't actually work.
+   /* The scene is queued on the rasterizer shared by all contexts of the
+    * screen, and we don't wait for it here: the rasterizer ends the scene
+    * and signals its fence when done, and anybody who needs the results
+    * waits on that fence.  The mutex only keeps the queue ordered.
     */
+   mtx_lock(&screen->rast_mutex);
    lp_rast_queue_scene(screen->rast, scene);
-   lp_rast_finish(screen->rast);
+   lp_fence_reference(&screen->last_fence, scene->fence);
    mtx_unlock(&screen->rast_mutex);
 
-   lp_scene_end_rasterization(setup->scene);
    lp_setup_reset( setup );
 
    LP_DBG(DEBUG_SETUP, "%s done \n", __FUNCTION__);
@@ -199,9 +205,10 @@ begin_binning( struct lp_setup_context *setup )
    assert(scene);
    assert(scene->fence == NULL);
 
-   /* Always create a fence:
+   /* Always create a fence.  It gets signalled once by the rasterizer,
+    * after the scene has been ended.
     */
-   scene->fence = lp_fence_create(MAX2(1, setup->num_threads));
+   scene->fence = lp_fence_create(1);
    if (!scene->fence)
       return FALSE;
 
@@ -343,6 +350,8 @@ set_scene_state( struct lp_setup_context *setup,
 fail:
    if (setup->scene) {
       lp_scene_end_rasterization(setup->scene);
+      /* never queued, so nobody is going to signal it */
+      lp_fence_reference(&setup->scene->fence, NULL);
       setup->scene = NULL;
    }
 
@@ -581,11 +590,13 @@ lp_setup_set_triangle_state( struct lp_setup_context *setup,
                              boolean ccw_is_frontface,
                              boolean scissor,
                              boolean half_pixel_center,
-                             boolean bottom_edge_rule)
+                             boolean bottom_edge_rule,
+                             boolean poly_stipple_enable)
 {
    LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
 
    setup->ccw_is_frontface = ccw_is_frontface;
+   setup->poly_stipple_enable = poly_stipple_enable;
    setup->cullmode = cull_mode;
    setup->triangle = first_triangle;
    setup->pixel_offset = half_pixel_center ? 0.5f : 0.0f;
@@ -597,6 +608,17 @@ lp_setup_set_triangle_state( struct lp_setup_context *setup,
    }
 }
 
+void
+lp_setup_set_multisample( struct lp_setup_context *setup,
+                          boolean multisample,
+                          unsigned sample_mask )
+{
+   LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
+
+   setup->multisample = multisample;
+   setup->sample_mask = sample_mask;
+}
+
 void 
 lp_setup_set_line_state( struct lp_setup_context *setup,
 			 float line_width)
@@ -689,6 +711,32 @@ lp_setup_set_stencil_ref_values( struct lp_setup_context *setup,
    }
 }
 
+/**
+ * The polygon stipple is applied by the rasterizer as a coverage mask,
+ * rather than by the draw module's fragment shader rewrite.
+ */
+void
+lp_setup_set_poly_stipple( struct lp_setup_context *setup,
+                           const struct pipe_poly_stipple *stipple )
+{
+   uint32_t rows[32];
+   unsigned i;
+
+   LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
+
+   /* The leftmost pixel is the most significant bit in the pattern,
+    * reverse the bits so that the rasterizer can shift by the x position.
+    */
+   for (i = 0; i < 32; i++)
+      rows[i] = util_bitreverse(stipple->stipple[i]);
+
+   if (memcmp(setup->poly_stipple.current, rows, sizeof rows) != 0) {
+      memcpy(setup->poly_stipple.current, rows, sizeof rows);
+      setup->dirty |= LP_SETUP_NEW_STIPPLE;
+   }
+}
+
+
 void
 lp_setup_set_blend_color( struct lp_setup_context *setup,
                           const struct pipe_blend_color *blend_color )
@@ -981,11 +1029,14 @@ lp_setup_is_resource_referenced( const struct lp_setup_context *setup,
       return LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
    }
 
-   /* check textures referenced by the scene */
+   /* check render targets and textures of the scenes, including those
+    * queued but not yet rasterized
+    */
    for (i = 0; i < ARRAY_SIZE(setup->scenes); i++) {
-      if (lp_scene_is_resource_referenced(setup->scenes[i], texture)) {
-         return LP_REFERENCED_FOR_READ;
-      }
+      unsigned referenced =
+         lp_scene_is_resource_referenced(setup->scenes[i], texture);
+      if (referenced)
+         return referenced;
    }
 
    return LP_UNREFERENCED;
@@ -1072,6 +1123,23 @@ try_update_scene_state( struct lp_setup_context *setup )
       setup->dirty |= LP_SETUP_NEW_FS;
    }
 
+   if (setup->dirty & LP_SETUP_NEW_STIPPLE) {
+      uint32_t *stored;
+
+      stored = lp_scene_alloc(scene, sizeof setup->poly_stipple.current);
+
+      if (!stored) {
+         assert(!new_scene);
+         return FALSE;
+      }
+
+      memcpy(stored, setup->poly_stipple.current,
+             sizeof setup->poly_stipple.current);
+
+      setup->fs.current.poly_stipple = stored;
+      setup->dirty |= LP_SETUP_NEW_FS;
+   }
+
    if (setup->dirty & LP_SETUP_NEW_CONSTANTS) {
       for (i = 0; i < ARRAY_SIZE(setup->constants); ++i) {
          struct pipe_resource *buffer = setup->constants[i].current.buffer;
@@ -1287,7 +1355,8 @@ lp_setup_destroy( struct lp_setup_context *setup )
    for (i = 0; i < ARRAY_SIZE(setup->scenes); i++) {
       struct lp_scene *scene = setup->scenes[i];
 
-      if (scene->fence)
+      /* wait for scenes still queued on the rasterizer */
+      if (scene->fence && lp_fence_issued(scene->fence))
          lp_fence_wait(scene->fence);
 
       lp_scene_destroy(scene);
@@ -1344,6 +1413,8 @@ lp_setup_create( struct pipe_context *pipe,
    setup->triangle = first_triangle;
    setup->line     = first_line;
    setup->point    = first_point;
+
+   setup->sample_mask = ~0;
    
    setup->dirty = ~0;
 
@@ -38,6 +38,7 @@ struct pipe_resource;
 struct pipe_query;
 struct pipe_surface;
 struct pipe_blend_color;
+struct pipe_poly_stipple;
 struct pipe_screen;
 struct pipe_framebuffer_state;
 struct lp_fragment_shader_variant;
@@ -47,6 +48,9 @@ struct pipe_fence_handle;
 struct lp_setup_variant;
 struct lp_setup_context;
 
+/** Positions of the samples within the pixel when multisampling */
+extern const float lp_sample_pos_4x[4][2];
+
 void lp_setup_reset( struct lp_setup_context *setup );
 
 struct lp_setup_context *
@@ -78,7 +82,13 @@ lp_setup_set_triangle_state( struct lp_setup_context *setup,
                              boolean front_is_ccw,
                              boolean scissor,
                              boolean half_pixel_center,
-                             boolean bottom_edge_rule);
+                             boolean bottom_edge_rule,
+                             boolean poly_stipple_enable);
+
+void
+lp_setup_set_multisample( struct lp_setup_context *setup,
+                          boolean multisample,
+                          unsigned sample_mask );
 
 void 
 lp_setup_set_line_state( struct lp_setup_context *setup,
@@ -112,6 +122,10 @@ void
 lp_setup_set_stencil_ref_values( struct lp_setup_context *setup,
                                  const ubyte refs[2] );
 
+void
+lp_setup_set_poly_stipple( struct lp_setup_context *setup,
+                           const struct pipe_poly_stipple *stipple );
+
 void
 lp_setup_set_blend_color( struct lp_setup_context *setup,
                           const struct pipe_blend_color *blend_color );
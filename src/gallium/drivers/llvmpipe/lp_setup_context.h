@@ -49,14 +49,14 @@
 #define LP_SETUP_NEW_BLEND_COLOR 0x04
 #define LP_SETUP_NEW_SCISSOR     0x08
 #define LP_SETUP_NEW_VIEWPORTS   0x10
+#define LP_SETUP_NEW_STIPPLE     0x20
 
 
 struct lp_setup_variant;
 
 
-/** Max number of scenes */
-/* XXX: make multiple scenes per context work, see lp_setup_rasterize_scene */
-#define MAX_SCENES 1
+/** Max number of scenes, so we can bin one while another is rasterized */
+#define MAX_SCENES 2
 
 
 
@@ -98,11 +98,14 @@ struct lp_setup_context
    boolean flatshade_first;
    boolean ccw_is_frontface;
    boolean scissor_test;
+   boolean poly_stipple_enable;
    boolean point_size_per_vertex;
    boolean rasterizer_discard;
    unsigned cullmode;
    unsigned bottom_edge_rule;
    float pixel_offset;
+   boolean multisample;      /**< rasterize at the sample positions */
+   unsigned sample_mask;
    float line_width;
    float point_size;
    int8_t psize_slot;
@@ -148,6 +151,10 @@ struct lp_setup_context
       uint8_t *stored;
    } blend_color;
 
+   struct {
+      uint32_t current[32];  /**< bit-reversed rows, see lp_rast_state */
+   } poly_stipple;
+
 
    struct {
       const struct lp_setup_variant *variant;
@@ -564,6 +564,16 @@ try_setup_line( struct lp_setup_context *setup,
        */
       bbox.x1--;
       bbox.y1--;
+
+      /* Samples may be covered in the pixels next to the ones whose
+       * centers are.
+       */
+      if (setup->multisample) {
+         bbox.x0--;
+         bbox.y0--;
+         bbox.x1++;
+         bbox.y1++;
+      }
    }
 
    if (bbox.x1 < bbox.x0 ||
@@ -646,7 +656,9 @@ try_setup_line( struct lp_setup_context *setup,
 
    line->inputs.disable = FALSE;
    line->inputs.opaque = FALSE;
+   line->inputs.poly_stipple = FALSE;
    line->inputs.layer = layer;
+   line->inputs.sample_mask = setup->sample_mask;
    line->inputs.viewport_index = viewport_index;
 
    /*
@@ -722,33 +734,37 @@ try_setup_line( struct lp_setup_context *setup,
       const struct u_rect *scissor = &setup->scissors[viewport_index];
       struct lp_rast_plane *plane_s = &plane[4];
       boolean s_planes[4];
+      /* Keep sample offsets from crossing the scissor, see
+       * do_triangle_ccw().
+       */
+      const int64_t ms_bias = setup->multisample ? FIXED_ONE / 2 : 0;
       scissor_planes_needed(s_planes, &bbox, scissor);
 
       if (s_planes[0]) {
          plane_s->dcdx = -1 << 8;
          plane_s->dcdy = 0;
-         plane_s->c = (1-scissor->x0) << 8;
+         plane_s->c = ((1-scissor->x0) << 8) - ms_bias;
          plane_s->eo = 1 << 8;
          plane_s++;
       }
       if (s_planes[1]) {
          plane_s->dcdx = 1 << 8;
          plane_s->dcdy = 0;
-         plane_s->c = (scissor->x1+1) << 8;
+         plane_s->c = ((scissor->x1+1) << 8) - ms_bias;
          plane_s->eo = 0 << 8;
          plane_s++;
       }
       if (s_planes[2]) {
          plane_s->dcdx = 0;
          plane_s->dcdy = 1 << 8;
-         plane_s->c = (1-scissor->y0) << 8;
+         plane_s->c = ((1-scissor->y0) << 8) - ms_bias;
          plane_s->eo = 1 << 8;
          plane_s++;
       }
       if (s_planes[3]) {
          plane_s->dcdx = 0;
          plane_s->dcdy = -1 << 8;
-         plane_s->c = (scissor->y1+1) << 8;
+         plane_s->c = ((scissor->y1+1) << 8) - ms_bias;
          plane_s->eo = 0;
          plane_s++;
       }
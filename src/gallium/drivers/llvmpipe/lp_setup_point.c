@@ -486,30 +486,37 @@ try_setup_point( struct lp_setup_context *setup,
 
    point->inputs.disable = FALSE;
    point->inputs.opaque = FALSE;
+   point->inputs.poly_stipple = FALSE;
    point->inputs.layer = layer;
+   point->inputs.sample_mask = setup->sample_mask;
    point->inputs.viewport_index = viewport_index;
 
    {
       struct lp_rast_plane *plane = GET_PLANES(point);
+      /* Points cover whole pixels, with all their samples.  Move the
+       * edges half a pixel inwards when multisampling so that no sample
+       * offset can cross them.
+       */
+      const int64_t ms_bias = setup->multisample ? FIXED_ONE / 2 : 0;
 
       plane[0].dcdx = -1 << 8;
       plane[0].dcdy = 0;
-      plane[0].c = (1-bbox.x0) << 8;
+      plane[0].c = ((1-bbox.x0) << 8) - ms_bias;
       plane[0].eo = 1 << 8;
 
       plane[1].dcdx = 1 << 8;
       plane[1].dcdy = 0;
-      plane[1].c = (bbox.x1+1) << 8;
+      plane[1].c = ((bbox.x1+1) << 8) - ms_bias;
       plane[1].eo = 0;
 
       plane[2].dcdx = 0;
       plane[2].dcdy = 1 << 8;
-      plane[2].c = (1-bbox.y0) << 8;
+      plane[2].c = ((1-bbox.y0) << 8) - ms_bias;
       plane[2].eo = 1 << 8;
 
       plane[3].dcdx = 0;
       plane[3].dcdy = -1 << 8;
-      plane[3].c = (bbox.y1+1) << 8;
+      plane[3].c = ((bbox.y1+1) << 8) - ms_bias;
       plane[3].eo = 0;
    }
 
@@ -204,6 +204,19 @@ lp_rast_32_tri_tab[MAX_PLANES+1] = {
    LP_RAST_OP_TRIANGLE_32_8
 };
 
+static unsigned
+lp_rast_ms_tri_tab[MAX_PLANES+1] = {
+   0,               /* should be impossible */
+   LP_RAST_OP_MS_TRIANGLE_1,
+   LP_RAST_OP_MS_TRIANGLE_2,
+   LP_RAST_OP_MS_TRIANGLE_3,
+   LP_RAST_OP_MS_TRIANGLE_4,
+   LP_RAST_OP_MS_TRIANGLE_5,
+   LP_RAST_OP_MS_TRIANGLE_6,
+   LP_RAST_OP_MS_TRIANGLE_7,
+   LP_RAST_OP_MS_TRIANGLE_8
+};
+
 
 
 /**
@@ -317,6 +330,16 @@ do_triangle_ccw(struct lp_setup_context *setup,
       /* Inclusive / exclusive depending upon adj (bottom-left or top-right) */
       bbox.y0 = (MIN3(position->y[0], position->y[1], position->y[2]) + adj) >> FIXED_ORDER;
       bbox.y1 = (MAX3(position->y[0], position->y[1], position->y[2]) - 1 + adj) >> FIXED_ORDER;
+
+      /* Samples may be covered in the pixels next to the ones whose
+       * centers are.
+       */
+      if (setup->multisample) {
+         bbox.x0--;
+         bbox.y0--;
+         bbox.x1++;
+         bbox.y1++;
+      }
    }
 
    if (bbox.x1 < bbox.x0 ||
@@ -379,8 +402,12 @@ do_triangle_ccw(struct lp_setup_context *setup,
 
    tri->inputs.frontfacing = frontfacing;
    tri->inputs.disable = FALSE;
-   tri->inputs.opaque = setup->fs.current.variant->opaque;
+   /* A stippled triangle never covers a whole tile. */
+   tri->inputs.opaque = setup->fs.current.variant->opaque &&
+                        !setup->poly_stipple_enable;
+   tri->inputs.poly_stipple = setup->poly_stipple_enable;
    tri->inputs.layer = layer;
+   tri->inputs.sample_mask = setup->sample_mask;
    tri->inputs.viewport_index = viewport_index;
 
    if (0)
@@ -683,33 +710,39 @@ do_triangle_ccw(struct lp_setup_context *setup,
       const struct u_rect *scissor = &setup->scissors[viewport_index];
       struct lp_rast_plane *plane_s = &plane[3];
       boolean s_planes[4];
+      /*
+       * The scissor applies to whole pixels.  When multisampling, move the
+       * scissor edges half a pixel inwards, which gives the same result at
+       * the pixel centers, so that no sample offset can cross them.
+       */
+      const int64_t ms_bias = setup->multisample ? FIXED_ONE / 2 : 0;
       scissor_planes_needed(s_planes, &bbox, scissor);
 
       if (s_planes[0]) {
          plane_s->dcdx = -1 << 8;
          plane_s->dcdy = 0;
-         plane_s->c = (1-scissor->x0) << 8;
+         plane_s->c = ((1-scissor->x0) << 8) - ms_bias;
          plane_s->eo = 1 << 8;
          plane_s++;
       }
       if (s_planes[1]) {
          plane_s->dcdx = 1 << 8;
          plane_s->dcdy = 0;
-         plane_s->c = (scissor->x1+1) << 8;
+         plane_s->c = ((scissor->x1+1) << 8) - ms_bias;
          plane_s->eo = 0 << 8;
          plane_s++;
       }
       if (s_planes[2]) {
          plane_s->dcdx = 0;
          plane_s->dcdy = 1 << 8;
-         plane_s->c = (1-scissor->y0) << 8;
+         plane_s->c = ((1-scissor->y0) << 8) - ms_bias;
          plane_s->eo = 1 << 8;
          plane_s++;
       }
       if (s_planes[3]) {
          plane_s->dcdx = 0;
          plane_s->dcdy = -1 << 8;
-         plane_s->c = (scissor->y1+1) << 8;
+         plane_s->c = ((scissor->y1+1) << 8) - ms_bias;
          plane_s->eo = 0;
          plane_s++;
       }
@@ -789,6 +822,14 @@ lp_setup_bin_triangle( struct lp_setup_context *setup,
       assert(iy0 == bbox->y1 / TILE_SIZE &&
 	     ix0 == bbox->x1 / TILE_SIZE);
 
+      if (setup->multisample) {
+         /* The small triangle paths only test the pixel centers */
+         return lp_scene_bin_cmd_with_state(
+            scene, ix0, iy0, setup->fs.stored,
+            lp_rast_ms_tri_tab[nr_planes],
+            lp_rast_arg_triangle(tri, (1<<nr_planes)-1));
+      }
+
       if (nr_planes == 3) {
          if (sz < 4)
          {
@@ -861,6 +902,9 @@ lp_setup_bin_triangle( struct lp_setup_context *setup,
       int64_t eo[MAX_PLANES];
       int64_t xstep[MAX_PLANES];
       int64_t ystep[MAX_PLANES];
+      const unsigned *tri_tab = setup->multisample ? lp_rast_ms_tri_tab :
+                                use_32bits ? lp_rast_32_tri_tab :
+                                lp_rast_tri_tab;
       int x, y;
 
       int ix0 = trimmed_box.x0 / TILE_SIZE;
@@ -880,6 +924,13 @@ lp_setup_bin_triangle( struct lp_setup_context *setup,
          eo[i] = (int64_t)plane[i].eo << TILE_ORDER;
          xstep[i] = -(((int64_t)plane[i].dcdx) << TILE_ORDER);
          ystep[i] = ((int64_t)plane[i].dcdy) << TILE_ORDER;
+
+         /* Test the samples rather than the pixel centers */
+         if (setup->multisample) {
+            int64_t ms = lp_rast_sample_max_offset(&plane[i]);
+            eo[i] += ms;
+            ei[i] -= ms;
+         }
       }
 
 
@@ -924,9 +975,7 @@ lp_setup_bin_triangle( struct lp_setup_context *setup,
                
                if (!lp_scene_bin_cmd_with_state( scene, x, y,
                                                  setup->fs.stored,
-                                                 use_32bits ?
-                                                 lp_rast_32_tri_tab[count] :
-                                                 lp_rast_tri_tab[count],
+                                                 tri_tab[count],
                                                  lp_rast_arg_triangle(tri, partial) ))
                   goto fail;
 
@@ -25,6 +25,7 @@
  * 
  **************************************************************************/
 
+#include "util/u_framebuffer.h"
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "pipe/p_shader_tokens.h"
@@ -209,11 +210,19 @@ void llvmpipe_update_derived( struct llvmpipe_context *llvmpipe )
                           LP_NEW_OCCLUSION_QUERY))
       llvmpipe_update_fs( llvmpipe );
 
-   if (llvmpipe->dirty & (LP_NEW_RASTERIZER)) {
+   if (llvmpipe->dirty & (LP_NEW_RASTERIZER |
+                          LP_NEW_FRAMEBUFFER)) {
+      unsigned nr_samples =
+         util_framebuffer_get_num_samples(&llvmpipe->framebuffer);
+      unsigned samples_mask = (1 << MIN2(nr_samples, LP_MAX_SAMPLES)) - 1;
+      boolean multisample = nr_samples > 1 &&
+         (llvmpipe->rasterizer ? llvmpipe->rasterizer->multisample : FALSE);
       boolean discard =
-         (llvmpipe->sample_mask & 1) == 0 ||
+         (llvmpipe->sample_mask & samples_mask) == 0 ||
          (llvmpipe->rasterizer ? llvmpipe->rasterizer->rasterizer_discard : FALSE);
 
+      lp_setup_set_multisample(llvmpipe->setup, multisample,
+                               llvmpipe->sample_mask);
       lp_setup_set_rasterizer_discard(llvmpipe->setup, discard);
    }
 
@@ -226,6 +235,9 @@ void llvmpipe_update_derived( struct llvmpipe_context *llvmpipe )
       lp_setup_set_blend_color(llvmpipe->setup,
                                &llvmpipe->blend_color);
 
+   if (llvmpipe->dirty & LP_NEW_STIPPLE)
+      lp_setup_set_poly_stipple(llvmpipe->setup, &llvmpipe->poly_stipple);
+
    if (llvmpipe->dirty & LP_NEW_SCISSOR)
       lp_setup_set_scissors(llvmpipe->setup, llvmpipe->scissors);
 
@@ -63,6 +63,7 @@
 #include "util/u_memory.h"
 #include "util/u_pointer.h"
 #include "util/u_format.h"
+#include "util/u_framebuffer.h"
 #include "util/u_dump.h"
 #include "util/u_string.h"
 #include "util/simple_list.h"
@@ -286,6 +287,105 @@ lp_build_depth_clamp(struct gallivm_state *gallivm,
 }
 
 
+/**
+ * Depth/stencil test and write each sample of the quads when multisampling.
+ * The shader runs once per pixel, so z is offset from the pixel center to
+ * the sample positions unless it was written by the shader.  The per-sample
+ * coverage in sample_mask_store is limited to the current pixel mask and
+ * updated with the test results.
+ *
+ * \return the pixels with at least one sample passing the test
+ */
+static LLVMValueRef
+generate_ms_depth_stencil(struct gallivm_state *gallivm,
+                          const struct lp_fragment_shader_variant_key *key,
+                          struct lp_type type,
+                          const struct util_format_description *zs_format_desc,
+                          LLVMValueRef context_ptr,
+                          LLVMValueRef thread_data_ptr,
+                          LLVMValueRef pixel_mask,
+                          LLVMValueRef sample_mask_store,
+                          LLVMValueRef loop_counter,
+                          LLVMValueRef num_loop,
+                          LLVMValueRef z,
+                          const LLVMValueRef *sample_zoffset,
+                          LLVMValueRef *stencil_refs,
+                          LLVMValueRef facing,
+                          LLVMValueRef depth_ptr,
+                          LLVMValueRef depth_stride,
+                          LLVMValueRef depth_sample_stride,
+                          boolean do_write)
+{
+   LLVMBuilderRef builder = gallivm->builder;
+   struct lp_build_context f32_bld;
+   LLVMValueRef covered = lp_build_zero(gallivm, lp_int_type(type));
+   unsigned s;
+
+   lp_build_context_init(&f32_bld, gallivm, type);
+
+   for (s = 0; s < LP_MAX_SAMPLES; s++) {
+      LLVMValueRef sample = lp_build_const_int32(gallivm, s);
+      struct lp_build_mask_context sample_mask;
+      LLVMValueRef index, mask_ptr, mask_val;
+      LLVMValueRef offset, sample_depth_ptr, z_s;
+      LLVMValueRef z_fb, s_fb, z_value, s_value;
+
+      index = LLVMBuildAdd(builder, LLVMBuildMul(builder, sample, num_loop, ""),
+                           loop_counter, "");
+      mask_ptr = LLVMBuildGEP(builder, sample_mask_store, &index, 1,
+                              "sample_mask_ptr");
+      mask_val = LLVMBuildAnd(builder, LLVMBuildLoad(builder, mask_ptr, ""),
+                              pixel_mask, "");
+
+      lp_build_mask_begin(&sample_mask, gallivm, type, mask_val);
+
+      z_s = z;
+      if (sample_zoffset) {
+         z_s = lp_build_add(&f32_bld, z, sample_zoffset[s]);
+         if (!key->depth_clamp)
+            z_s = lp_build_min(&f32_bld, z_s, f32_bld.one);
+      }
+      if (key->depth_clamp) {
+         z_s = lp_build_depth_clamp(gallivm, builder, type, context_ptr,
+                                    thread_data_ptr, z_s);
+      }
+
+      offset = LLVMBuildMul(builder, sample, depth_sample_stride, "");
+      sample_depth_ptr = LLVMBuildGEP(builder, depth_ptr, &offset, 1,
+                                      "sample_depth_ptr");
+
+      lp_build_depth_stencil_load_swizzled(gallivm, type,
+                                           zs_format_desc, key->resource_1d,
+                                           sample_depth_ptr, depth_stride,
+                                           &z_fb, &s_fb, loop_counter);
+      lp_build_depth_stencil_test(gallivm,
+                                  &key->depth,
+                                  key->stencil,
+                                  type,
+                                  zs_format_desc,
+                                  &sample_mask,
+                                  stencil_refs,
+                                  z_s, z_fb, s_fb,
+                                  facing,
+                                  &z_value, &s_value,
+                                  FALSE);
+      if (do_write) {
+         lp_build_depth_stencil_write_swizzled(gallivm, type,
+                                               zs_format_desc, key->resource_1d,
+                                               NULL, NULL, NULL, loop_counter,
+                                               sample_depth_ptr, depth_stride,
+                                               z_value, s_value);
+      }
+
+      mask_val = lp_build_mask_end(&sample_mask);
+      LLVMBuildStore(builder, mask_val, mask_ptr);
+      covered = LLVMBuildOr(builder, covered, mask_val, "");
+   }
+
+   return covered;
+}
+
+
 /**
  * Generate the fragment shader, depth/stencil test, and alpha tests.
  */
@@ -300,9 +400,12 @@ generate_fs_loop(struct gallivm_state *gallivm,
                  struct lp_build_interp_soa_context *interp,
                  struct lp_build_sampler_soa *sampler,
                  LLVMValueRef mask_store,
+                 LLVMValueRef sample_mask_store,
                  LLVMValueRef (*out_color)[4],
                  LLVMValueRef depth_ptr,
                  LLVMValueRef depth_stride,
+                 LLVMValueRef depth_sample_stride,
+                 const LLVMValueRef *sample_zoffset,
                  LLVMValueRef facing,
                  LLVMValueRef thread_data_ptr)
 {
@@ -373,6 +476,13 @@ generate_fs_loop(struct gallivm_state *gallivm,
                                         (key->stencil[1].enabled &&
                                          key->stencil[1].writemask))))
          depth_mode &= ~(LATE_DEPTH_WRITE | EARLY_DEPTH_WRITE);
+
+      /* The deferred depth write would need the early per-sample results
+       * as well as the final mask, just test late instead.
+       */
+      if (key->multisample &&
+          (depth_mode & EARLY_DEPTH_TEST) && (depth_mode & LATE_DEPTH_WRITE))
+         depth_mode = LATE_DEPTH_TEST | LATE_DEPTH_WRITE;
    }
    else {
       depth_mode = 0;
@@ -430,7 +540,24 @@ generate_fs_loop(struct gallivm_state *gallivm,
    lp_build_interp_soa_update_pos_dyn(interp, gallivm, loop_state.counter);
    z = interp->pos[2];
 
-   if (depth_mode & EARLY_DEPTH_TEST) {
+   if ((depth_mode & EARLY_DEPTH_TEST) && key->multisample) {
+      LLVMValueRef covered;
+
+      covered = generate_ms_depth_stencil(gallivm, key, type, zs_format_desc,
+                                          context_ptr, thread_data_ptr,
+                                          lp_build_mask_value(&mask),
+                                          sample_mask_store,
+                                          loop_state.counter, num_loop,
+                                          z, sample_zoffset,
+                                          stencil_refs, facing,
+                                          depth_ptr, depth_stride,
+                                          depth_sample_stride,
+                                          (depth_mode & EARLY_DEPTH_WRITE) != 0);
+      lp_build_mask_update(&mask, covered);
+      if (!simple_shader)
+         lp_build_mask_check(&mask);
+   }
+   else if (depth_mode & EARLY_DEPTH_TEST) {
       /*
        * Clamp according to ARB_depth_clamp semantics.
        */
@@ -524,13 +651,15 @@ generate_fs_loop(struct gallivm_state *gallivm,
       int s_out = find_output_by_semantic(&shader->info.base,
                                           TGSI_SEMANTIC_STENCIL,
                                           0);
-      if (pos0 != -1 && outputs[pos0][2]) {
+      boolean writes_z = pos0 != -1 && outputs[pos0][2];
+
+      if (writes_z) {
          z = LLVMBuildLoad(builder, outputs[pos0][2], "output.z");
       }
       /*
        * Clamp according to ARB_depth_clamp semantics.
        */
-      if (key->depth_clamp) {
+      if (key->depth_clamp && !key->multisample) {
          z = lp_build_depth_clamp(gallivm, builder, type, context_ptr,
                                   thread_data_ptr, z);
       }
@@ -544,29 +673,47 @@ generate_fs_loop(struct gallivm_state *gallivm,
          stencil_refs[1] = stencil_refs[0];
       }
 
-      lp_build_depth_stencil_load_swizzled(gallivm, type,
-                                           zs_format_desc, key->resource_1d,
-                                           depth_ptr, depth_stride,
-                                           &z_fb, &s_fb, loop_state.counter);
+      if (key->multisample) {
+         LLVMValueRef covered;
 
-      lp_build_depth_stencil_test(gallivm,
-                                  &key->depth,
-                                  key->stencil,
-                                  type,
-                                  zs_format_desc,
-                                  &mask,
-                                  stencil_refs,
-                                  z, z_fb, s_fb,
-                                  facing,
-                                  &z_value, &s_value,
-                                  !simple_shader);
-      /* Late Z write */
-      if (depth_mode & LATE_DEPTH_WRITE) {
-         lp_build_depth_stencil_write_swizzled(gallivm, type,
-                                               zs_format_desc, key->resource_1d,
-                                               NULL, NULL, NULL, loop_state.counter,
-                                               depth_ptr, depth_stride,
-                                               z_value, s_value);
+         covered = generate_ms_depth_stencil(gallivm, key, type, zs_format_desc,
+                                             context_ptr, thread_data_ptr,
+                                             lp_build_mask_value(&mask),
+                                             sample_mask_store,
+                                             loop_state.counter, num_loop,
+                                             z,
+                                             writes_z ? NULL : sample_zoffset,
+                                             stencil_refs, facing,
+                                             depth_ptr, depth_stride,
+                                             depth_sample_stride,
+                                             (depth_mode & LATE_DEPTH_WRITE) != 0);
+         lp_build_mask_update(&mask, covered);
+      }
+      else {
+         lp_build_depth_stencil_load_swizzled(gallivm, type,
+                                              zs_format_desc, key->resource_1d,
+                                              depth_ptr, depth_stride,
+                                              &z_fb, &s_fb, loop_state.counter);
+
+         lp_build_depth_stencil_test(gallivm,
+                                     &key->depth,
+                                     key->stencil,
+                                     type,
+                                     zs_format_desc,
+                                     &mask,
+                                     stencil_refs,
+                                     z, z_fb, s_fb,
+                                     facing,
+                                     &z_value, &s_value,
+                                     !simple_shader);
+         /* Late Z write */
+         if (depth_mode & LATE_DEPTH_WRITE) {
+            lp_build_depth_stencil_write_swizzled(gallivm, type,
+                                                  zs_format_desc, key->resource_1d,
+                                                  NULL, NULL, NULL, loop_state.counter,
+                                                  depth_ptr, depth_stride,
+                                                  z_value, s_value);
+         }
       }
    }
    else if ((depth_mode & EARLY_DEPTH_TEST) &&
@@ -607,7 +754,7 @@ generate_fs_loop(struct gallivm_state *gallivm,
       }
    }
 
-   if (key->occlusion_count) {
+   if (key->occlusion_count && !key->multisample) {
       LLVMValueRef counter = lp_jit_thread_data_counter(gallivm, thread_data_ptr);
       lp_build_name(counter, "counter");
       lp_build_occlusion_count(gallivm, type,
@@ -616,6 +763,36 @@ generate_fs_loop(struct gallivm_state *gallivm,
 
    mask_val = lp_build_mask_end(&mask);
    LLVMBuildStore(builder, mask_val, mask_ptr);
+
+   if (key->multisample) {
+      /* Drop the samples of the pixels killed after the depth test, and
+       * count samples rather than pixels.
+       */
+      unsigned s;
+
+      for (s = 0; s < LP_MAX_SAMPLES; s++) {
+         LLVMValueRef sample = lp_build_const_int32(gallivm, s);
+         LLVMValueRef index, sample_mask_ptr, sample_mask_val;
+
+         index = LLVMBuildAdd(builder,
+                              LLVMBuildMul(builder, sample, num_loop, ""),
+                              loop_state.counter, "");
+         sample_mask_ptr = LLVMBuildGEP(builder, sample_mask_store,
+                                        &index, 1, "sample_mask_ptr");
+         sample_mask_val = LLVMBuildAnd(builder,
+                                        LLVMBuildLoad(builder,
+                                                      sample_mask_ptr, ""),
+                                        mask_val, "");
+         LLVMBuildStore(builder, sample_mask_val, sample_mask_ptr);
+
+         if (key->occlusion_count) {
+            LLVMValueRef counter =
+               lp_jit_thread_data_counter(gallivm, thread_data_ptr);
+            lp_build_occlusion_count(gallivm, type, sample_mask_val, counter);
+         }
+      }
+   }
+
    lp_build_for_loop_end(&loop_state);
 }
 
@@ -2389,8 +2566,9 @@ generate_fragment(struct llvmpipe_context *lp,
    struct lp_type blend_type;
    LLVMTypeRef fs_elem_type;
    LLVMTypeRef blend_vec_type;
-   LLVMTypeRef arg_types[13];
+   LLVMTypeRef arg_types[15];
    LLVMTypeRef func_type;
+   LLVMTypeRef int64_type = LLVMInt64TypeInContext(gallivm->context);
    LLVMTypeRef int32_type = LLVMInt32TypeInContext(gallivm->context);
    LLVMTypeRef int8_type = LLVMInt8TypeInContext(gallivm->context);
    LLVMValueRef context_ptr;
@@ -2403,18 +2581,23 @@ generate_fragment(struct llvmpipe_context *lp,
    LLVMValueRef stride_ptr;
    LLVMValueRef depth_ptr;
    LLVMValueRef depth_stride;
+   LLVMValueRef sample_stride_ptr;
+   LLVMValueRef depth_sample_stride;
    LLVMValueRef mask_input;
+   LLVMValueRef pixel_mask_input;
    LLVMValueRef thread_data_ptr;
    LLVMBasicBlockRef block;
    LLVMBuilderRef builder;
    struct lp_build_sampler_soa *sampler;
    struct lp_build_interp_soa_context interp;
    LLVMValueRef fs_mask[16 / 4];
+   LLVMValueRef fs_sample_mask[LP_MAX_SAMPLES][16 / 4];
+   LLVMValueRef sample_zoffset[LP_MAX_SAMPLES];
    LLVMValueRef fs_out_color[PIPE_MAX_COLOR_BUFS][TGSI_NUM_CHANNELS][16 / 4];
    LLVMValueRef function;
    LLVMValueRef facing;
    unsigned num_fs;
-   unsigned i;
+   unsigned i, s;
    unsigned chan;
    unsigned cbuf;
    boolean cbuf0_write_all;
@@ -2477,10 +2660,12 @@ generate_fragment(struct llvmpipe_context *lp,
    arg_types[6] = LLVMPointerType(fs_elem_type, 0);    /* dady */
    arg_types[7] = LLVMPointerType(LLVMPointerType(blend_vec_type, 0), 0);  /* color */
    arg_types[8] = LLVMPointerType(int8_type, 0);       /* depth */
-   arg_types[9] = int32_type;                          /* mask_input */
+   arg_types[9] = int64_type;                          /* mask_input */
    arg_types[10] = variant->jit_thread_data_ptr_type;  /* per thread data */
    arg_types[11] = LLVMPointerType(int32_type, 0);     /* stride */
    arg_types[12] = int32_type;                         /* depth_stride */
+   arg_types[13] = LLVMPointerType(int32_type, 0);     /* sample_stride */
+   arg_types[14] = int32_type;                         /* depth_sample_stride */
 
    func_type = LLVMFunctionType(LLVMVoidTypeInContext(gallivm->context),
                                 arg_types, ARRAY_SIZE(arg_types), 0);
@@ -2510,6 +2695,8 @@ generate_fragment(struct llvmpipe_context *lp,
    thread_data_ptr  = LLVMGetParam(function, 10);
    stride_ptr   = LLVMGetParam(function, 11);
    depth_stride = LLVMGetParam(function, 12);
+   sample_stride_ptr = LLVMGetParam(function, 13);
+   depth_sample_stride = LLVMGetParam(function, 14);
 
    lp_build_name(context_ptr, "context");
    lp_build_name(x, "x");
@@ -2523,6 +2710,8 @@ generate_fragment(struct llvmpipe_context *lp,
    lp_build_name(thread_data_ptr, "thread_data");
    lp_build_name(stride_ptr, "stride_ptr");
    lp_build_name(depth_stride, "depth_stride");
+   lp_build_name(sample_stride_ptr, "sample_stride_ptr");
+   lp_build_name(depth_sample_stride, "depth_sample_stride");
 
    /*
     * Function body
@@ -2534,18 +2723,42 @@ generate_fragment(struct llvmpipe_context *lp,
    LLVMPositionBuilderAtEnd(builder, block);
 
    /* code generated texture sampling */
-   sampler = lp_llvm_sampler_soa_create(key->state);
+   sampler = lp_llvm_sampler_soa_create(key->state, lp->sample_func_cache);
 
    num_fs = 16 / fs_type.length; /* number of loops per 4x4 stamp */
    /* for 1d resources only run "upper half" of stamp */
    if (key->resource_1d)
       num_fs /= 2;
 
+   /*
+    * The mask holds 16 bits of coverage per sample.  The shader runs for
+    * the pixels with any sample covered.
+    */
+   if (key->multisample) {
+      pixel_mask_input = mask_input;
+      for (s = 1; s < LP_MAX_SAMPLES; s++) {
+         pixel_mask_input =
+            LLVMBuildOr(builder, pixel_mask_input,
+                        LLVMBuildLShr(builder, mask_input,
+                                      LLVMConstInt(int64_type, 16 * s, 0),
+                                      ""), "");
+      }
+      pixel_mask_input = LLVMBuildAnd(builder, pixel_mask_input,
+                                      LLVMConstInt(int64_type, 0xffff, 0), "");
+      pixel_mask_input = LLVMBuildTrunc(builder, pixel_mask_input,
+                                        int32_type, "pixel_mask_input");
+   }
+   else {
+      pixel_mask_input = LLVMBuildTrunc(builder, mask_input, int32_type,
+                                        "pixel_mask_input");
+   }
+
    {
       LLVMValueRef num_loop = lp_build_const_int32(gallivm, num_fs);
       LLVMTypeRef mask_type = lp_build_int_vec_type(gallivm, fs_type);
       LLVMValueRef mask_store = lp_build_array_alloca(gallivm, mask_type,
                                                       num_loop, "mask_store");
+      LLVMValueRef sample_mask_store = NULL;
       LLVMValueRef color_store[PIPE_MAX_COLOR_BUFS][TGSI_NUM_CHANNELS];
       boolean pixel_center_integer =
          shader->info.base.properties[TGSI_PROPERTY_FS_COORD_PIXEL_CENTER];
@@ -2573,7 +2786,7 @@ generate_fragment(struct llvmpipe_context *lp,
 
          if (partial_mask) {
             mask = generate_quad_mask(gallivm, fs_type,
-                                      i*fs_type.length/4, mask_input);
+                                      i*fs_type.length/4, pixel_mask_input);
          }
          else {
             mask = lp_build_const_int_vec(gallivm, fs_type, ~0);
@@ -2581,6 +2794,65 @@ generate_fragment(struct llvmpipe_context *lp,
          LLVMBuildStore(builder, mask, mask_ptr);
       }
 
+      if (key->multisample) {
+         struct lp_build_context f32_bld;
+         LLVMValueRef index = lp_build_const_int32(gallivm, 2);
+         LLVMValueRef dzdx, dzdy;
+
+         assert(partial_mask);
+
+         sample_mask_store =
+            lp_build_array_alloca(gallivm, mask_type,
+                                  lp_build_const_int32(gallivm,
+                                                       num_fs * LP_MAX_SAMPLES),
+                                  "sample_mask_store");
+
+         for (s = 0; s < LP_MAX_SAMPLES; s++) {
+            LLVMValueRef sample_mask_input =
+               LLVMBuildLShr(builder, mask_input,
+                             LLVMConstInt(int64_type, 16 * s, 0), "");
+
+            sample_mask_input = LLVMBuildTrunc(builder, sample_mask_input,
+                                               int32_type, "");
+
+            for (i = 0; i < num_fs; i++) {
+               LLVMValueRef indexi =
+                  lp_build_const_int32(gallivm, s * num_fs + i);
+               LLVMValueRef mask_ptr = LLVMBuildGEP(builder, sample_mask_store,
+                                                    &indexi, 1, "mask_ptr");
+               LLVMValueRef mask = generate_quad_mask(gallivm, fs_type,
+                                                      i*fs_type.length/4,
+                                                      sample_mask_input);
+               LLVMBuildStore(builder, mask, mask_ptr);
+            }
+         }
+
+         /*
+          * Position is attribute 0, so the z gradients are the third
+          * elements of dadx/dady.  z is interpolated at the pixel center.
+          */
+         lp_build_context_init(&f32_bld, gallivm, fs_type);
+         dzdx = LLVMBuildLoad(builder,
+                              LLVMBuildGEP(builder, dadx_ptr, &index, 1, ""),
+                              "dzdx");
+         dzdy = LLVMBuildLoad(builder,
+                              LLVMBuildGEP(builder, dady_ptr, &index, 1, ""),
+                              "dzdy");
+         dzdx = lp_build_broadcast_scalar(&f32_bld, dzdx);
+         dzdy = lp_build_broadcast_scalar(&f32_bld, dzdy);
+
+         for (s = 0; s < LP_MAX_SAMPLES; s++) {
+            LLVMValueRef ox = lp_build_const_vec(gallivm, fs_type,
+                                                 lp_sample_pos_4x[s][0] - 0.5);
+            LLVMValueRef oy = lp_build_const_vec(gallivm, fs_type,
+                                                 lp_sample_pos_4x[s][1] - 0.5);
+
+            sample_zoffset[s] = lp_build_add(&f32_bld,
+                                             lp_build_mul(&f32_bld, dzdx, ox),
+                                             lp_build_mul(&f32_bld, dzdy, oy));
+         }
+      }
+
       generate_fs_loop(gallivm,
                        shader, key,
                        builder,
@@ -2590,9 +2862,12 @@ generate_fragment(struct llvmpipe_context *lp,
                        &interp,
                        sampler,
                        mask_store, /* output */
+                       sample_mask_store, /* output */
                        color_store,
                        depth_ptr,
                        depth_stride,
+                       depth_sample_stride,
+                       key->multisample ? sample_zoffset : NULL,
                        facing,
                        thread_data_ptr);
 
@@ -2601,6 +2876,16 @@ generate_fragment(struct llvmpipe_context *lp,
          LLVMValueRef ptr = LLVMBuildGEP(builder, mask_store,
                                          &indexi, 1, "");
          fs_mask[i] = LLVMBuildLoad(builder, ptr, "mask");
+         if (key->multisample) {
+            for (s = 0; s < LP_MAX_SAMPLES; s++) {
+               LLVMValueRef indexs =
+                  lp_build_const_int32(gallivm, s * num_fs + i);
+               ptr = LLVMBuildGEP(builder, sample_mask_store,
+                                  &indexs, 1, "");
+               fs_sample_mask[s][i] = LLVMBuildLoad(builder, ptr,
+                                                    "sample_mask");
+            }
+         }
          /* This is fucked up need to reorganize things */
          for (cbuf = 0; cbuf < key->nr_cbufs; cbuf++) {
             for (chan = 0; chan < TGSI_NUM_CHANNELS; ++chan) {
@@ -2648,11 +2933,42 @@ generate_fragment(struct llvmpipe_context *lp,
                                 LLVMBuildGEP(builder, stride_ptr, &index, 1, ""),
                                 "");
 
-         generate_unswizzled_blend(gallivm, cbuf, variant,
-                                   key->cbuf_format[cbuf],
-                                   num_fs, fs_type, fs_mask, fs_out_color,
-                                   context_ptr, color_ptr, stride,
-                                   partial_mask, do_branch);
+         if (key->multisample) {
+            /* Blend the shaded color into each sample plane */
+            LLVMValueRef sample_stride =
+               LLVMBuildLoad(builder,
+                             LLVMBuildGEP(builder, sample_stride_ptr,
+                                          &index, 1, ""),
+                             "");
+
+            for (s = 0; s < LP_MAX_SAMPLES; s++) {
+               LLVMValueRef offset =
+                  LLVMBuildMul(builder, lp_build_const_int32(gallivm, s),
+                               sample_stride, "");
+               LLVMValueRef sample_color_ptr =
+                  LLVMBuildBitCast(builder, color_ptr,
+                                   LLVMPointerType(int8_type, 0), "");
+
+               sample_color_ptr = LLVMBuildGEP(builder, sample_color_ptr,
+                                               &offset, 1, "");
+               sample_color_ptr = LLVMBuildBitCast(builder, sample_color_ptr,
+                                                   LLVMTypeOf(color_ptr), "");
+
+               generate_unswizzled_blend(gallivm, cbuf, variant,
+                                         key->cbuf_format[cbuf],
+                                         num_fs, fs_type, fs_sample_mask[s],
+                                         fs_out_color,
+                                         context_ptr, sample_color_ptr, stride,
+                                         partial_mask, do_branch);
+            }
+         }
+         else {
+            generate_unswizzled_blend(gallivm, cbuf, variant,
+                                      key->cbuf_format[cbuf],
+                                      num_fs, fs_type, fs_mask, fs_out_color,
+                                      context_ptr, color_ptr, stride,
+                                      partial_mask, do_branch);
+         }
       }
    }
 
@@ -2672,6 +2988,9 @@ dump_fs_variant_key(const struct lp_fragment_shader_variant_key *key)
    if (key->flatshade) {
       debug_printf("flatshade = 1\n");
    }
+   if (key->multisample) {
+      debug_printf("multisample = 1\n");
+   }
    for (i = 0; i < key->nr_cbufs; ++i) {
       debug_printf("cbuf_format[%u] = %s\n", i, util_format_name(key->cbuf_format[i]));
    }
@@ -2818,6 +3137,7 @@ generate_variant(struct llvmpipe_context *lp,
          !key->alpha.enabled &&
          !key->blend.alpha_to_coverage &&
          !key->depth.enabled &&
+         !key->multisample &&
          !shader->info.base.uses_kill
       ? TRUE : FALSE;
 
@@ -3193,6 +3513,8 @@ make_variant_key(struct llvmpipe_context *lp,
    /* alpha.ref_value is passed in jit_context */
 
    key->flatshade = lp->rasterizer->flatshade;
+   key->multisample =
+      util_framebuffer_get_num_samples(&lp->framebuffer) > 1;
    if (lp->active_occlusion_queries) {
       key->occlusion_count = TRUE;
    }
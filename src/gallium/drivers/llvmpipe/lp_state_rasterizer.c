@@ -50,6 +50,7 @@ clear_flags(struct pipe_rasterizer_state *rast)
    rast->offset_point = 0;
    rast->offset_units = 0.0f;
    rast->offset_scale = 0.0f;
+   rast->poly_stipple_enable = 0;
 }
 
 
@@ -71,7 +72,7 @@ llvmpipe_create_rasterizer_state(struct pipe_context *pipe,
    memcpy(&state->lp_state, rast, sizeof *rast);
 
    /* We rely on draw module to do unfilled polyons, AA lines and
-    * points and stipple.
+    * points and line stipple.
     * 
     * Over time, reduce this list of conditions, and expand the list
     * of flags which get cleared in clear_flags().
@@ -80,8 +81,7 @@ llvmpipe_create_rasterizer_state(struct pipe_context *pipe,
 		    rast->fill_back != PIPE_POLYGON_MODE_FILL ||
 		    rast->point_smooth ||
 		    rast->line_smooth ||
-		    rast->line_stipple_enable ||
-		    rast->poly_stipple_enable);
+		    rast->line_stipple_enable);
 
    /* If not using the pipeline, clear out the flags which we can
     * handle ourselves.  If we *are* using the pipeline, do everything
@@ -116,7 +116,8 @@ llvmpipe_bind_rasterizer_state(struct pipe_context *pipe, void *handle)
                                   state->lp_state.front_ccw,
                                   state->lp_state.scissor,
                                   state->lp_state.half_pixel_center,
-                                  state->lp_state.bottom_edge_rule);
+                                  state->lp_state.bottom_edge_rule,
+                                  state->lp_state.poly_stipple_enable);
       lp_setup_set_flatshade_first( llvmpipe->setup,
 				    state->lp_state.flatshade_first);
       lp_setup_set_line_state( llvmpipe->setup,
@@ -25,6 +25,9 @@
  * 
  **************************************************************************/
 
+#include "util/u_format.h"
+#include "util/u_memory.h"
+#include "util/u_pack_color.h"
 #include "util/u_rect.h"
 #include "util/u_surface.h"
 #include "lp_context.h"
@@ -35,6 +38,41 @@
 #include "lp_query.h"
 
 
+/**
+ * Copy a box of every sample plane between two multisample textures.
+ */
+static void
+lp_resource_copy_ms(struct pipe_resource *dst,
+                    unsigned dstx, unsigned dsty, unsigned dstz,
+                    struct pipe_resource *src,
+                    const struct pipe_box *src_box)
+{
+   unsigned dst_stride = llvmpipe_resource_stride(dst, 0);
+   unsigned src_stride = llvmpipe_resource_stride(src, 0);
+   unsigned dst_sample_stride = llvmpipe_sample_stride(dst, 0);
+   unsigned src_sample_stride = llvmpipe_sample_stride(src, 0);
+   unsigned s;
+   int z;
+
+   assert(dst->nr_samples == src->nr_samples);
+
+   for (z = 0; z < src_box->depth; z++) {
+      ubyte *dst_map = llvmpipe_resource_map(dst, 0, dstz + z,
+                                             LP_TEX_USAGE_READ_WRITE);
+      const ubyte *src_map = llvmpipe_resource_map(src, 0, src_box->z + z,
+                                                   LP_TEX_USAGE_READ);
+
+      for (s = 0; s < src->nr_samples; s++) {
+         util_copy_rect(dst_map + s * dst_sample_stride, dst->format,
+                        dst_stride, dstx, dsty,
+                        src_box->width, src_box->height,
+                        src_map + s * src_sample_stride,
+                        src_stride, src_box->x, src_box->y);
+      }
+   }
+}
+
+
 static void
 lp_resource_copy(struct pipe_context *pipe,
                  struct pipe_resource *dst, unsigned dst_level,
@@ -56,11 +94,111 @@ lp_resource_copy(struct pipe_context *pipe,
                            FALSE, /* do_not_block */
                            "blit src");
 
+   if (src->nr_samples > 1) {
+      lp_resource_copy_ms(dst, dstx, dsty, dstz, src, src_box);
+      return;
+   }
+
    util_resource_copy_region(pipe, dst, dst_level, dstx, dsty, dstz,
                              src, src_level, src_box);
 }
 
 
+/**
+ * Resolve the source box of a multisample blit into a new single-sample
+ * texture of the size of the box.  Color samples are averaged, for
+ * depth/stencil and integer formats the first sample is taken.
+ */
+static struct pipe_resource *
+lp_resolve_blit_src(struct pipe_context *pipe,
+                    const struct pipe_blit_info *info,
+                    const struct pipe_box *box)
+{
+   struct pipe_screen *screen = pipe->screen;
+   struct pipe_resource *src = info->src.resource;
+   enum pipe_format format = src->format;
+   unsigned src_stride = llvmpipe_resource_stride(src, 0);
+   unsigned sample_stride = llvmpipe_sample_stride(src, 0);
+   struct pipe_resource templ, *tmp;
+   unsigned tmp_stride;
+   boolean average;
+   float *row = NULL, *sum = NULL;
+   float scale = 1.0f / src->nr_samples;
+   unsigned x, y, s;
+   int z;
+
+   memset(&templ, 0, sizeof templ);
+   templ.target = box->depth > 1 ? PIPE_TEXTURE_2D_ARRAY : PIPE_TEXTURE_2D;
+   templ.format = format;
+   templ.width0 = box->width;
+   templ.height0 = box->height;
+   templ.depth0 = 1;
+   templ.array_size = box->depth;
+   templ.bind = PIPE_BIND_SAMPLER_VIEW;
+
+   tmp = screen->resource_create(screen, &templ);
+   if (!tmp)
+      return NULL;
+
+   average = !util_format_is_depth_or_stencil(format) &&
+             !util_format_is_pure_integer(format);
+   if (average) {
+      row = MALLOC(box->width * 4 * sizeof(float));
+      sum = MALLOC(box->width * 4 * sizeof(float));
+      if (!row || !sum) {
+         FREE(row);
+         FREE(sum);
+         pipe_resource_reference(&tmp, NULL);
+         return NULL;
+      }
+   }
+
+   llvmpipe_flush_resource(pipe,
+                           src, 0,
+                           TRUE, /* read_only */
+                           TRUE, /* cpu_access */
+                           FALSE, /* do_not_block */
+                           "resolve src");
+
+   tmp_stride = llvmpipe_resource_stride(tmp, 0);
+
+   for (z = 0; z < box->depth; z++) {
+      const ubyte *src_map = llvmpipe_resource_map(src, 0, box->z + z,
+                                                   LP_TEX_USAGE_READ);
+      ubyte *tmp_map = llvmpipe_resource_map(tmp, 0, z,
+                                             LP_TEX_USAGE_WRITE_ALL);
+
+      if (!average) {
+         util_copy_rect(tmp_map, format, tmp_stride, 0, 0,
+                        box->width, box->height,
+                        src_map, src_stride, box->x, box->y);
+         continue;
+      }
+
+      for (y = 0; y < box->height; y++) {
+         memset(sum, 0, box->width * 4 * sizeof(float));
+         for (s = 0; s < src->nr_samples; s++) {
+            util_format_read_4f(format, row, 0,
+                                src_map + s * sample_stride, src_stride,
+                                box->x, box->y + y, box->width, 1);
+            for (x = 0; x < box->width * 4; x++)
+               sum[x] += row[x];
+         }
+         for (x = 0; x < box->width * 4; x++)
+            sum[x] *= scale;
+         util_format_write_4f(format, sum, 0,
+                              tmp_map, tmp_stride,
+                              0, y, box->width, 1);
+      }
+   }
+
+   FREE(row);
+   FREE(sum);
+
+   return tmp;
+}
+
+
 static void lp_blit(struct pipe_context *pipe,
                     const struct pipe_blit_info *blit_info)
 {
@@ -71,10 +209,35 @@ static void lp_blit(struct pipe_context *pipe,
       return;
 
    if (info.src.resource->nr_samples > 1 &&
-       info.dst.resource->nr_samples <= 1 &&
-       !util_format_is_depth_or_stencil(info.src.resource->format) &&
-       !util_format_is_pure_integer(info.src.resource->format)) {
-      debug_printf("llvmpipe: color resolve unimplemented\n");
+       info.dst.resource->nr_samples <= 1) {
+      struct pipe_resource *tmp;
+      struct pipe_box box = info.src.box;
+
+      /* The source box may be flipped */
+      if (box.width < 0) {
+         box.x += box.width;
+         box.width = -box.width;
+      }
+      if (box.height < 0) {
+         box.y += box.height;
+         box.height = -box.height;
+      }
+
+      tmp = lp_resolve_blit_src(pipe, &info, &box);
+      if (!tmp) {
+         debug_printf("llvmpipe: out of memory for resolve\n");
+         return;
+      }
+
+      info.src.resource = tmp;
+      info.src.level = 0;
+      info.src.box.x -= box.x;
+      info.src.box.y -= box.y;
+      info.src.box.z = 0;
+      info.render_condition_enable = FALSE;
+      lp_blit(pipe, &info);
+
+      pipe_resource_reference(&tmp, NULL);
       return;
    }
 
@@ -185,6 +348,84 @@ llvmpipe_surface_destroy(struct pipe_context *pipe,
 }
 
 
+/**
+ * The u_surface clears only know about the first sample of multisample
+ * surfaces, so copy the cleared rect from there to the other samples.
+ */
+static void
+lp_replicate_sample0(struct pipe_surface *dst,
+                     unsigned dstx, unsigned dsty,
+                     unsigned width, unsigned height)
+{
+   struct pipe_resource *pt = dst->texture;
+   unsigned stride = llvmpipe_resource_stride(pt, 0);
+   unsigned sample_stride = llvmpipe_sample_stride(pt, 0);
+   unsigned layer, s;
+
+   for (layer = dst->u.tex.first_layer;
+        layer <= dst->u.tex.last_layer; layer++) {
+      ubyte *map = llvmpipe_resource_map(pt, 0, layer,
+                                         LP_TEX_USAGE_READ_WRITE);
+
+      for (s = 1; s < pt->nr_samples; s++) {
+         util_copy_rect(map + s * sample_stride, dst->format, stride,
+                        dstx, dsty, width, height,
+                        map, stride, dstx, dsty);
+      }
+   }
+}
+
+
+/**
+ * Like lp_replicate_sample0(), but only copy the bits of each packed
+ * depth/stencil value that are set in mask, so that a depth-only or
+ * stencil-only clear keeps the other component of the other samples.
+ */
+static void
+lp_replicate_sample0_masked(struct pipe_surface *dst,
+                            uint64_t mask,
+                            unsigned dstx, unsigned dsty,
+                            unsigned width, unsigned height)
+{
+   struct pipe_resource *pt = dst->texture;
+   unsigned stride = llvmpipe_resource_stride(pt, 0);
+   unsigned sample_stride = llvmpipe_sample_stride(pt, 0);
+   unsigned blocksize = util_format_get_blocksize(dst->format);
+   unsigned layer, s, i, j;
+
+   assert(blocksize == 4 || blocksize == 8);
+
+   for (layer = dst->u.tex.first_layer;
+        layer <= dst->u.tex.last_layer; layer++) {
+      ubyte *map = llvmpipe_resource_map(pt, 0, layer,
+                                         LP_TEX_USAGE_READ_WRITE);
+      map += dsty * stride + dstx * blocksize;
+
+      for (s = 1; s < pt->nr_samples; s++) {
+         const ubyte *src_row = map;
+         ubyte *dst_row = map + s * sample_stride;
+
+         for (i = 0; i < height; i++) {
+            if (blocksize == 4) {
+               const uint32_t *src = (const uint32_t *)src_row;
+               uint32_t *dst = (uint32_t *)dst_row;
+               for (j = 0; j < width; j++)
+                  dst[j] = (dst[j] & ~(uint32_t)mask) | (src[j] & (uint32_t)mask);
+            }
+            else {
+               const uint64_t *src = (const uint64_t *)src_row;
+               uint64_t *dst = (uint64_t *)dst_row;
+               for (j = 0; j < width; j++)
+                  dst[j] = (dst[j] & ~mask) | (src[j] & mask);
+            }
+            src_row += stride;
+            dst_row += stride;
+         }
+      }
+   }
+}
+
+
 static void
 llvmpipe_clear_render_target(struct pipe_context *pipe,
                              struct pipe_surface *dst,
@@ -200,6 +441,9 @@ llvmpipe_clear_render_target(struct pipe_context *pipe,
 
    util_clear_render_target(pipe, dst, color,
                             dstx, dsty, width, height);
+
+   if (dst->texture->nr_samples > 1)
+      lp_replicate_sample0(dst, dstx, dsty, width, height);
 }
 
 
@@ -221,6 +465,22 @@ llvmpipe_clear_depth_stencil(struct pipe_context *pipe,
    util_clear_depth_stencil(pipe, dst, clear_flags,
                             depth, stencil,
                             dstx, dsty, width, height);
+
+   if (dst->texture->nr_samples > 1) {
+      if ((clear_flags & PIPE_CLEAR_DEPTHSTENCIL) != PIPE_CLEAR_DEPTHSTENCIL &&
+          util_format_is_depth_and_stencil(dst->format)) {
+         uint64_t mask =
+            util_pack64_mask_z_stencil(dst->format,
+                                       (clear_flags & PIPE_CLEAR_DEPTH) ?
+                                       0xffffffff : 0,
+                                       (clear_flags & PIPE_CLEAR_STENCIL) ?
+                                       0xff : 0);
+         lp_replicate_sample0_masked(dst, mask, dstx, dsty, width, height);
+      }
+      else {
+         lp_replicate_sample0(dst, dstx, dsty, width, height);
+      }
+   }
 }
 
 
@@ -87,6 +87,11 @@ struct unary_test_t
     * Required precision in bits.
     */
    double precision;
+
+   /*
+    * Precision the builder is allowed to trade accuracy for.
+    */
+   enum lp_float_precision float_precision;
 };
 
 
@@ -312,6 +317,13 @@ unary_tests[] = {
    {"floor", &lp_build_floor, &floorf, round_values, ARRAY_SIZE(round_values), 24.0 },
    {"ceil", &lp_build_ceil, &ceilf, round_values, ARRAY_SIZE(round_values), 24.0 },
    {"fract", &lp_build_fract_safe, &fractf, fract_values, ARRAY_SIZE(fract_values), 24.0 },
+   /* GLSL ES mediump needs a relative precision of 2^-10 */
+   {"exp2_mediump", &lp_build_exp2, &exp2f, exp2_values, ARRAY_SIZE(exp2_values), 10.0, LP_FLOAT_PRECISION_MEDIUM },
+   {"log2_mediump", &lp_build_log2_safe, &log2f, log2_values, ARRAY_SIZE(log2_values), 10.0, LP_FLOAT_PRECISION_MEDIUM },
+   {"exp_mediump", &lp_build_exp, &expf, exp2_values, ARRAY_SIZE(exp2_values), 10.0, LP_FLOAT_PRECISION_MEDIUM },
+   {"log_mediump", &lp_build_log_safe, &logf, log2_values, ARRAY_SIZE(log2_values), 10.0, LP_FLOAT_PRECISION_MEDIUM },
+   {"rcp_mediump", &lp_build_rcp, &rcpf, rcp_values, ARRAY_SIZE(rcp_values), 10.0, LP_FLOAT_PRECISION_MEDIUM },
+   {"rsqrt_mediump", &lp_build_rsqrt, &rsqrtf, rsqrt_values, ARRAY_SIZE(rsqrt_values), 10.0, LP_FLOAT_PRECISION_MEDIUM },
 };
 
 
@@ -341,6 +353,7 @@ build_unary_test_func(struct gallivm_state *gallivm,
    struct lp_build_context bld;
 
    lp_build_context_init(&bld, gallivm, type);
+   bld.precision = test->float_precision;
 
    LLVMSetFunctionCallConv(func, LLVMCCallConv);
 
@@ -290,7 +290,8 @@ lp_llvm_sampler_soa_emit_size_query(const struct lp_build_sampler_soa *base,
 
 
 struct lp_build_sampler_soa *
-lp_llvm_sampler_soa_create(const struct lp_sampler_static_state *static_state)
+lp_llvm_sampler_soa_create(const struct lp_sampler_static_state *static_state,
+                           struct lp_sample_func_cache *func_cache)
 {
    struct lp_llvm_sampler_soa *sampler;
 
@@ -318,6 +319,7 @@ lp_llvm_sampler_soa_create(const struct lp_sampler_static_state *static_state)
 #if LP_USE_TEXTURE_CACHE
    sampler->dynamic_state.base.cache_ptr = lp_llvm_texture_cache_ptr;
 #endif
+   sampler->dynamic_state.base.func_cache = func_cache;
 
    sampler->dynamic_state.static_state = static_state;
 
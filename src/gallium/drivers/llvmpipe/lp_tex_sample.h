@@ -33,6 +33,7 @@
 
 
 struct lp_sampler_static_state;
+struct lp_sample_func_cache;
 
 /**
  * Whether texture cache is used for s3tc textures.
@@ -44,6 +45,7 @@ struct lp_sampler_static_state;
  *
  */
 struct lp_build_sampler_soa *
-lp_llvm_sampler_soa_create(const struct lp_sampler_static_state *key);
+lp_llvm_sampler_soa_create(const struct lp_sampler_static_state *key,
+                           struct lp_sample_func_cache *func_cache);
 
 #endif /* LP_TEX_SAMPLE_H */
@@ -50,6 +50,7 @@
 #include "lp_setup.h"
 #include "lp_state.h"
 #include "lp_rast.h"
+#include "lp_scene.h"
 
 #include "state_tracker/sw_winsys.h"
 
@@ -60,6 +61,29 @@ static struct llvmpipe_resource resource_list;
 static unsigned id_counter = 0;
 
 
+/** Upper bound on the idle storage kept around for reuse, in bytes */
+#define LP_MAX_STORAGE_POOL_SIZE (64*1024*1024)
+
+
+/**
+ * Resource storage orphaned by a discarding transfer map.
+ */
+struct llvmpipe_storage
+{
+   struct list_head list;
+   void *data;
+   unsigned size;
+   unsigned seq;   /**< newest scene which may still reference data */
+};
+
+
+static unsigned
+llvmpipe_storage_alignment(void)
+{
+   return MAX2(64, util_cpu_caps.cacheline);
+}
+
+
 /**
  * Conventional allocation path for non-display textures:
  * Compute strides and allocate data (unless asked not to).
@@ -131,6 +155,18 @@ llvmpipe_texture_layout(struct llvmpipe_screen *screen,
 
       lpr->img_stride[level] = lpr->row_stride[level] * nblocksy;
 
+      /* Multisample textures (which have no mipmaps) keep the samples of
+       * each layer as consecutive planes.
+       */
+      if (pt->nr_samples > 1) {
+         if ((uint64_t)lpr->img_stride[level] * pt->nr_samples >
+             LP_MAX_TEXTURE_SIZE) {
+            goto fail;
+         }
+         lpr->sample_stride = lpr->img_stride[level];
+         lpr->img_stride[level] *= pt->nr_samples;
+      }
+
       /* Number of 3D image slices, cube faces or texture array layers */
       if (lpr->base.target == PIPE_TEXTURE_CUBE) {
          assert(layers == 6);
@@ -174,6 +210,7 @@ llvmpipe_texture_layout(struct llvmpipe_screen *screen,
       else {
          memset(lpr->tex_data, 0, total_size);
       }
+      lpr->storage_size = total_size;
    }
 
    return TRUE;
@@ -257,6 +294,9 @@ llvmpipe_resource_create_front(struct pipe_screen *_screen,
                             PIPE_BIND_SCANOUT |
                             PIPE_BIND_SHARED)) {
          /* displayable surface */
+         if (lpr->base.nr_samples > 1)
+            goto fail;
+
          if (!llvmpipe_displaytarget_layout(screen, lpr, map_front_private))
             goto fail;
       }
@@ -278,7 +318,8 @@ llvmpipe_resource_create_front(struct pipe_screen *_screen,
        * read/write always LP_RASTER_BLOCK_SIZE pixels, but the element
        * offset doesn't need to be aligned to LP_RASTER_BLOCK_SIZE.
        */
-      lpr->data = align_malloc(bytes + (LP_RASTER_BLOCK_SIZE - 1) * 4 * sizeof(float), 64);
+      lpr->storage_size = bytes + (LP_RASTER_BLOCK_SIZE - 1) * 4 * sizeof(float);
+      lpr->data = align_malloc(lpr->storage_size, 64);
 
       /*
        * buffers don't really have stride but it's probably safer
@@ -501,6 +542,185 @@ llvmpipe_resource_get_handle(struct pipe_screen *screen,
 }
 
 
+/**
+ * Move all retired storage which no scene can reference anymore into the
+ * pool, freeing it instead if the pool is full.
+ * Called with storage_mutex held.
+ */
+static void
+llvmpipe_release_storage_locked(struct llvmpipe_screen *screen)
+{
+   struct llvmpipe_storage *storage, *next;
+   boolean any_live = !list_empty(&screen->live_scenes);
+   unsigned oldest_seq = 0;
+
+   if (any_live) {
+      oldest_seq = list_first_entry(&screen->live_scenes,
+                                    struct lp_scene, screen_link)->seq;
+   }
+
+   LIST_FOR_EACH_ENTRY_SAFE(storage, next, &screen->retired_storage, list) {
+      /* The retired list is sorted by seq */
+      if (any_live && (int)(storage->seq - oldest_seq) >= 0)
+         break;
+
+      list_del(&storage->list);
+
+      if (screen->storage_pool_size + storage->size <= LP_MAX_STORAGE_POOL_SIZE) {
+         list_add(&storage->list, &screen->storage_pool);
+         screen->storage_pool_size += storage->size;
+      }
+      else {
+         align_free(storage->data);
+         FREE(storage);
+      }
+   }
+}
+
+
+void
+llvmpipe_release_retired_storage(struct llvmpipe_screen *screen)
+{
+   mtx_lock(&screen->storage_mutex);
+   llvmpipe_release_storage_locked(screen);
+   mtx_unlock(&screen->storage_mutex);
+}
+
+
+/**
+ * Free all retired and pooled storage.  Only safe when no scene is alive.
+ */
+void
+llvmpipe_free_storage(struct llvmpipe_screen *screen)
+{
+   struct llvmpipe_storage *storage, *next;
+
+   assert(list_empty(&screen->live_scenes));
+
+   LIST_FOR_EACH_ENTRY_SAFE(storage, next, &screen->retired_storage, list) {
+      align_free(storage->data);
+      FREE(storage);
+   }
+   LIST_FOR_EACH_ENTRY_SAFE(storage, next, &screen->storage_pool, list) {
+      align_free(storage->data);
+      FREE(storage);
+   }
+   list_inithead(&screen->retired_storage);
+   list_inithead(&screen->storage_pool);
+   screen->storage_pool_size = 0;
+}
+
+
+/**
+ * Give the resource new backing storage, retiring the current one until
+ * all scenes which might still read from it are done.
+ * \return the retired storage, or NULL if new storage couldn't be allocated
+ */
+static void *
+llvmpipe_discard_storage(struct llvmpipe_screen *screen,
+                         struct llvmpipe_resource *lpr)
+{
+   void **data = llvmpipe_resource_is_texture(&lpr->base) ?
+                 &lpr->tex_data : &lpr->data;
+   struct llvmpipe_storage *storage = NULL, *iter;
+   const unsigned size = lpr->storage_size;
+   void *old;
+
+   mtx_lock(&screen->storage_mutex);
+   llvmpipe_release_storage_locked(screen);
+   LIST_FOR_EACH_ENTRY(iter, &screen->storage_pool, list) {
+      if (iter->size == size) {
+         storage = iter;
+         list_del(&storage->list);
+         screen->storage_pool_size -= size;
+         break;
+      }
+   }
+   mtx_unlock(&screen->storage_mutex);
+
+   if (!storage) {
+      storage = CALLOC_STRUCT(llvmpipe_storage);
+      if (!storage)
+         return NULL;
+      storage->data = align_malloc(size, llvmpipe_storage_alignment());
+      if (!storage->data) {
+         FREE(storage);
+         return NULL;
+      }
+      storage->size = size;
+   }
+
+   mtx_lock(&screen->storage_mutex);
+   old = *data;
+   *data = storage->data;
+   storage->data = old;
+   storage->seq = screen->scene_seq;
+   list_addtail(&storage->list, &screen->retired_storage);
+   mtx_unlock(&screen->storage_mutex);
+
+   return old;
+}
+
+
+/**
+ * Try to satisfy a discarding write map without waiting for the scenes
+ * which read from the resource, by renaming its storage.
+ * \return TRUE if the resource got fresh storage and no flush is needed
+ */
+static boolean
+llvmpipe_try_discard_transfer(struct llvmpipe_context *llvmpipe,
+                              struct llvmpipe_resource *lpr,
+                              unsigned level,
+                              unsigned usage,
+                              const struct pipe_box *box)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(llvmpipe->pipe.screen);
+   struct pipe_resource *resource = &lpr->base;
+   boolean whole;
+   ubyte *old;
+
+   if ((usage & PIPE_TRANSFER_READ_WRITE) != PIPE_TRANSFER_WRITE)
+      return FALSE;
+
+   if (usage & PIPE_TRANSFER_DISCARD_WHOLE_RESOURCE)
+      whole = TRUE;
+   else if ((usage & PIPE_TRANSFER_DISCARD_RANGE) &&
+            resource->target == PIPE_BUFFER)
+      whole = box->x == 0 && box->width == resource->width0;
+   else
+      return FALSE;
+
+   if (lpr->dt || lpr->userBuffer || !lpr->storage_size)
+      return FALSE;
+
+   /*
+    * Only storage which is sampled from can be swapped.  Bound render
+    * targets are mapped by the scene at rasterization time, so the queued
+    * rendering would end up in the new storage.
+    */
+   if (llvmpipe_is_resource_referenced(&llvmpipe->pipe, resource, level) !=
+       LP_REFERENCED_FOR_READ)
+      return FALSE;
+
+   old = llvmpipe_discard_storage(screen, lpr);
+   if (!old)
+      return FALSE;
+
+   if (!whole) {
+      /* Keep the contents outside the discarded range */
+      ubyte *data = lpr->data;
+      unsigned end = box->x + box->width;
+      memcpy(data, old, box->x);
+      memcpy(data + end, old + end, resource->width0 - end);
+   }
+
+   /* The current sampler state still points at the old storage */
+   llvmpipe->dirty |= LP_NEW_SAMPLER_VIEW;
+
+   return TRUE;
+}
+
+
 static void *
 llvmpipe_transfer_map( struct pipe_context *pipe,
                        struct pipe_resource *resource,
@@ -524,9 +744,11 @@ llvmpipe_transfer_map( struct pipe_context *pipe,
 
    /*
     * Transfers, like other pipe operations, must happen in order, so flush the
-    * context if necessary.
+    * context if necessary.  Discarding maps of resources the queued scenes
+    * only read from get fresh storage instead.
     */
-   if (!(usage & PIPE_TRANSFER_UNSYNCHRONIZED)) {
+   if (!(usage & PIPE_TRANSFER_UNSYNCHRONIZED) &&
+       !llvmpipe_try_discard_transfer(llvmpipe, lpr, level, usage, box)) {
       boolean read_only = !(usage & PIPE_TRANSFER_WRITE);
       boolean do_not_block = !!(usage & PIPE_TRANSFER_DONTBLOCK);
       if (!llvmpipe_flush_resource(pipe, resource,
@@ -45,6 +45,7 @@ enum lp_texture_usage
 struct pipe_context;
 struct pipe_screen;
 struct llvmpipe_context;
+struct llvmpipe_screen;
 
 struct sw_displaytarget;
 
@@ -66,8 +67,16 @@ struct llvmpipe_resource
    unsigned img_stride[LP_MAX_TEXTURE_LEVELS];
    /** Offset to start of mipmap level, in bytes */
    unsigned mip_offsets[LP_MAX_TEXTURE_LEVELS];
+   /**
+    * Stride between the sample planes of a multisample texture, in bytes.
+    * The samples of each layer are stored as consecutive planes, so the
+    * image stride covers all of them.
+    */
+   unsigned sample_stride;
    /** allocated total size (for non-display target texture resources only) */
    unsigned total_alloc_size;
+   /** size of the tex_data/data allocation, zero if not owned by us */
+   unsigned storage_size;
 
    /**
     * Display target, for textures with the PIPE_BIND_DISPLAY_TARGET
@@ -185,6 +194,22 @@ llvmpipe_layer_stride(struct pipe_resource *resource,
 }
 
 
+/**
+ * Stride between sample planes.  Single-sampled textures are treated
+ * as having one plane per layer.
+ */
+static inline unsigned
+llvmpipe_sample_stride(struct pipe_resource *resource,
+                       unsigned level)
+{
+   struct llvmpipe_resource *lpr = llvmpipe_resource(resource);
+   assert(level < LP_MAX_TEXTURE_2D_LEVELS);
+   if (resource->nr_samples > 1)
+      return lpr->sample_stride;
+   return lpr->img_stride[level];
+}
+
+
 static inline unsigned
 llvmpipe_resource_stride(struct pipe_resource *resource,
                          unsigned level)
@@ -236,4 +261,10 @@ llvmpipe_is_resource_referenced( struct pipe_context *pipe,
 unsigned
 llvmpipe_get_format_alignment(enum pipe_format format);
 
+void
+llvmpipe_release_retired_storage(struct llvmpipe_screen *screen);
+
+void
+llvmpipe_free_storage(struct llvmpipe_screen *screen);
+
 #endif /* LP_TEXTURE_H */
@@ -782,8 +782,9 @@ private:
 
    inline void checkInterference(const RIG_Node *, Graph::EdgeIterator&);
 
-   inline void insertOrderedTail(std::list<RIG_Node *>&, RIG_Node *);
-   void checkList(std::list<RIG_Node *>&);
+   inline void insertNonEmpty(std::vector<RIG_Node *>&, RIG_Node *);
+   static bool livesBefore(const RIG_Node *, const RIG_Node *);
+   void checkList(std::vector<RIG_Node *>&);
 
 private:
    std::stack<uint32_t> stack;
@@ -1161,11 +1162,11 @@ GCRA::~GCRA()
 }
 
 void
-GCRA::checkList(std::list<RIG_Node *>& lst)
+GCRA::checkList(std::vector<RIG_Node *>& lst)
 {
    GCRA::RIG_Node *prev = NULL;
 
-   for (std::list<RIG_Node *>::iterator it = lst.begin();
+   for (std::vector<RIG_Node *>::iterator it = lst.begin();
         it != lst.end();
         ++it) {
       assert((*it)->getValue()->join == (*it)->getValue());
@@ -1176,40 +1177,45 @@ GCRA::checkList(std::list<RIG_Node *>& lst)
 }
 
 void
-GCRA::insertOrderedTail(std::list<RIG_Node *>& list, RIG_Node *node)
+GCRA::insertNonEmpty(std::vector<RIG_Node *>& list, RIG_Node *node)
 {
-   if (node->livei.isEmpty())
-      return;
-   // only the intervals of joined values don't necessarily arrive in order
-   std::list<RIG_Node *>::iterator prev, it;
-   for (it = list.end(); it != list.begin(); it = prev) {
-      prev = it;
-      --prev;
-      if ((*prev)->livei.begin() <= node->livei.begin())
-         break;
-   }
-   list.insert(it, node);
+   if (!node->livei.isEmpty())
+      list.push_back(node);
+}
+
+bool
+GCRA::livesBefore(const RIG_Node *a, const RIG_Node *b)
+{
+   return a->livei.begin() < b->livei.begin();
 }
 
 void
 GCRA::buildRIG(ArrayList& insns)
 {
-   std::list<RIG_Node *> values, active;
+   std::vector<RIG_Node *> values;
+   std::list<RIG_Node *> active;
+
+   values.reserve(nodeCount);
 
    for (std::deque<ValueDef>::iterator it = func->ins.begin();
         it != func->ins.end(); ++it)
-      insertOrderedTail(values, getNode(it->get()->asLValue()));
+      insertNonEmpty(values, getNode(it->get()->asLValue()));
 
    for (int i = 0; i < insns.getSize(); ++i) {
       Instruction *insn = reinterpret_cast<Instruction *>(insns.get(i));
       for (int d = 0; insn->defExists(d); ++d)
          if (insn->getDef(d)->rep() == insn->getDef(d))
-            insertOrderedTail(values, getNode(insn->getDef(d)->asLValue()));
+            insertNonEmpty(values, getNode(insn->getDef(d)->asLValue()));
    }
+   // Only the intervals of joined values don't necessarily arrive in order.
+   // Sorting them all at once keeps this O(n log n) when many of them are
+   // out of order, and a stable sort keeps the order of equal intervals.
+   std::stable_sort(values.begin(), values.end(), livesBefore);
    checkList(values);
 
-   while (!values.empty()) {
-      RIG_Node *cur = values.front();
+   for (std::vector<RIG_Node *>::iterator vi = values.begin();
+        vi != values.end(); ++vi) {
+      RIG_Node *cur = *vi;
 
       for (std::list<RIG_Node *>::iterator it = active.begin();
            it != active.end();) {
@@ -1223,7 +1229,6 @@ GCRA::buildRIG(ArrayList& insns)
             ++it;
          }
       }
-      values.pop_front();
       active.push_back(cur);
    }
 }
@@ -165,18 +165,15 @@ void DominatorTree::build()
    }
    DOM(0) = 0;
 
+   // The immediate dominator of a block always precedes it in DFS order,
+   // so a single pass attaches every block to an already attached parent.
    insert(&BasicBlock::get(cfg->getRoot())->dom);
-   do {
-      p = 0;
-      for (v = 1; v < count; ++v) {
-         nw = &BasicBlock::get(vert[DOM(v)])->dom;
-         nv = &BasicBlock::get(vert[v])->dom;
-         if (nw->getGraph() && !nv->getGraph()) {
-            ++p;
-            nw->attach(nv, Graph::Edge::TREE);
-         }
-      }
-   } while (p);
+   for (v = 1; v < count; ++v) {
+      nw = &BasicBlock::get(vert[DOM(v)])->dom;
+      nv = &BasicBlock::get(vert[v])->dom;
+      assert(nw->getGraph() && !nv->getGraph());
+      nw->attach(nv, Graph::Edge::TREE);
+   }
 
    delete[] bucket;
 }
@@ -191,6 +188,16 @@ void DominatorTree::findDominanceFrontiers()
 {
    BasicBlock *bb;
 
+   if (!getRoot())
+      return;
+
+   // The DF of a block is built from the DFs of the blocks it dominates,
+   // so without this, a block reachable from many of them would be added
+   // over and over, and the lists would grow with the depth of the tree.
+   // inDF[id] is the id of the last block whose DF the block was added to.
+   std::vector<int> inDF(
+      BasicBlock::get(getRoot())->getFunction()->allBBlocks.getSize(), -1);
+
    for (IteratorRef dtIt = iteratorDFS(false); !dtIt->end(); dtIt->next()) {
       EdgeIterator succIt, chldIt;
 
@@ -199,8 +206,10 @@ void DominatorTree::findDominanceFrontiers()
 
       for (succIt = bb->cfg.outgoing(); !succIt.end(); succIt.next()) {
          BasicBlock *dfLocal = BasicBlock::get(succIt.getNode());
-         if (dfLocal->idom() != bb)
+         if (dfLocal->idom() != bb && inDF[dfLocal->getId()] != bb->getId()) {
+            inDF[dfLocal->getId()] = bb->getId();
             bb->getDF().insert(dfLocal);
+         }
       }
 
       for (chldIt = bb->dom.outgoing(); !chldIt.end(); chldIt.next()) {
@@ -209,8 +218,10 @@ void DominatorTree::findDominanceFrontiers()
          DLList::Iterator dfIt = cb->getDF().iterator();
          for (; !dfIt.end(); dfIt.next()) {
             BasicBlock *dfUp = BasicBlock::get(dfIt);
-            if (dfUp->idom() != bb)
+            if (dfUp->idom() != bb && inDF[dfUp->getId()] != bb->getId()) {
+               inDF[dfUp->getId()] = bb->getId();
                bb->getDF().insert(dfUp);
+            }
          }
       }
    }
@@ -22,8 +22,10 @@
 
 #include <errno.h>
 
+#include "os/os_time.h"
 #include "tgsi/tgsi_text.h"
 #include "util/u_debug.h"
+#include "util/u_memory.h"
 
 #include "codegen/nv50_ir_driver.h"
 #include "nv50/nv50_context.h"
@@ -42,6 +44,7 @@ nv30_fp(int chipset, struct tgsi_token tokens[],
    fp.pipe.tokens = tokens;
    tgsi_scan_shader(fp.pipe.tokens, &fp.info);
    _nvfx_fragprog_translate(chipset >= 0x40 ? 0x4097 : 0x3097, &fp);
+   FREE(fp.consts);
    *size = fp.insn_len * 4;
    *code = fp.insn;
    return !fp.translated;
@@ -56,6 +59,7 @@ nv30_vp(int chipset, struct tgsi_token tokens[],
    vp.pipe.tokens = tokens;
    tgsi_scan_shader(vp.pipe.tokens, &vp.info);
    _nvfx_vertprog_translate(chipset >= 0x40 ? 0x4097 : 0x3097, &vp);
+   FREE(vp.consts);
    *size = vp.nr_insns * 16;
    *code = (unsigned *)vp.insns;
    return !vp.translated;
@@ -129,37 +133,34 @@ nouveau_codegen(int chipset, int type, struct tgsi_token tokens[],
       return ret;
    }
 
+   /* nothing gets uploaded, so the relocation info isn't needed */
+   FREE(info.bin.relocData);
+   FREE(info.bin.fixupData);
+
    *size = info.bin.codeSize;
    *code = info.bin.code;
    return 0;
 }
 
-int
-main(int argc, char *argv[])
+static int
+compile(int chipset, int type, struct tgsi_token tokens[],
+        unsigned *size, unsigned **code)
 {
-   struct tgsi_token tokens[4096];
-   int i, chipset = 0, type = -1;
-   const char *filename = NULL;
-   FILE *f;
-   char text[65536] = {0};
-   unsigned size = 0, *code = NULL;
+   if (chipset >= 0x50)
+      return nouveau_codegen(chipset, type, tokens, size, code);
+   if (chipset >= 0x30)
+      return nv30_codegen(chipset, type, tokens, size, code);
 
-   for (i = 1; i < argc; i++) {
-      if (!strcmp(argv[i], "-a"))
-         chipset = strtol(argv[++i], NULL, 16);
-      else
-         filename = argv[i];
-   }
-
-   if (!chipset) {
-      _debug_printf("Must specify a chipset (-a)\n");
-      return 1;
-   }
+   _debug_printf("chipset NV%02X not supported\n", chipset);
+   return 1;
+}
 
-   if (!filename) {
-      _debug_printf("Must specify a filename\n");
-      return 1;
-   }
+static int
+read_shader(const char *filename, struct tgsi_token tokens[],
+            unsigned num_tokens, int *type)
+{
+   FILE *f;
+   char text[65536] = {0};
 
    if (!strcmp(filename, "-"))
       f = stdin;
@@ -178,40 +179,192 @@ main(int argc, char *argv[])
    }
    fclose(f);
 
-   _debug_printf("Compiling for NV%X\n", chipset);
-
    if (!strncmp(text, "FRAG", 4))
-      type = PIPE_SHADER_FRAGMENT;
+      *type = PIPE_SHADER_FRAGMENT;
    else if (!strncmp(text, "VERT", 4))
-      type = PIPE_SHADER_VERTEX;
+      *type = PIPE_SHADER_VERTEX;
    else if (!strncmp(text, "GEOM", 4))
-      type = PIPE_SHADER_GEOMETRY;
+      *type = PIPE_SHADER_GEOMETRY;
    else if (!strncmp(text, "COMP", 4))
-      type = PIPE_SHADER_COMPUTE;
+      *type = PIPE_SHADER_COMPUTE;
    else if (!strncmp(text, "TESS_CTRL", 9))
-      type = PIPE_SHADER_TESS_CTRL;
+      *type = PIPE_SHADER_TESS_CTRL;
    else if (!strncmp(text, "TESS_EVAL", 9))
-      type = PIPE_SHADER_TESS_EVAL;
+      *type = PIPE_SHADER_TESS_EVAL;
    else {
       _debug_printf("Unrecognized TGSI header\n");
       return 1;
    }
 
-   if (!tgsi_text_translate(text, tokens, ARRAY_SIZE(tokens))) {
+   if (!tgsi_text_translate(text, tokens, num_tokens)) {
       _debug_printf("Failed to parse TGSI shader\n");
       return 1;
    }
 
-   if (chipset >= 0x50) {
-      i = nouveau_codegen(chipset, type, tokens, &size, &code);
-   } else if (chipset >= 0x30) {
-      i = nv30_codegen(chipset, type, tokens, &size, &code);
-   } else {
-      _debug_printf("chipset NV%02X not supported\n", chipset);
-      i = 1;
+   return 0;
+}
+
+/* Chipsets compiled for by "-a all": one per nv50 ir target and ISA. */
+static const int all_chipsets[] = {
+   0x50, 0xa0, 0xc0, 0xe4, 0xf0, 0x117, 0x120,
+};
+
+/*
+ * Benchmark mode: compile every file for every chipset, repeats times,
+ * and print the fastest compile time of each, and the totals per chipset.
+ */
+static int
+benchmark(const int *chipsets, unsigned num_chipsets,
+          char **filenames, unsigned num_files, unsigned repeats)
+{
+   struct tgsi_token (*tokens)[4096];
+   int *types;
+   unsigned c, i, r;
+   int ret = 0;
+
+   tokens = MALLOC(num_files * sizeof(*tokens));
+   types = MALLOC(num_files * sizeof(*types));
+   if (!tokens || !types) {
+      _debug_printf("Out of memory\n");
+      FREE(tokens);
+      FREE(types);
+      return 1;
+   }
+
+   for (i = 0; i < num_files; i++) {
+      if (read_shader(filenames[i], tokens[i], ARRAY_SIZE(tokens[i]),
+                      &types[i]))
+         types[i] = -1;
+   }
+
+   for (c = 0; c < num_chipsets; c++) {
+      int64_t total = 0;
+      unsigned total_size = 0, failed = 0;
+
+      for (i = 0; i < num_files; i++) {
+         int64_t best = INT64_MAX;
+         unsigned size = 0, *code = NULL;
+
+         if (types[i] < 0) {
+            failed++;
+            continue;
+         }
+
+         for (r = 0; r < repeats; r++) {
+            int64_t start = os_time_get_nano();
+            int err;
+
+            code = NULL;
+            err = compile(chipsets[c], types[i], tokens[i], &size, &code);
+            if (!err)
+               best = MIN2(best, os_time_get_nano() - start);
+            FREE(code);
+            if (err)
+               break;
+         }
+
+         if (r < repeats) {
+            printf("NV%X %s: failed\n", chipsets[c], filenames[i]);
+            failed++;
+            continue;
+         }
+
+         printf("NV%X %s: %u bytes, %.3f ms\n", chipsets[c], filenames[i],
+                size, best / 1000000.0);
+         total += best;
+         total_size += size;
+      }
+
+      printf("NV%X: %u shaders, %u failed, %u bytes, %.3f ms\n",
+             chipsets[c], num_files, failed, total_size, total / 1000000.0);
+      if (failed)
+         ret = 1;
+   }
+
+   FREE(tokens);
+   FREE(types);
+   return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+   struct tgsi_token tokens[4096];
+   int i, type = -1, ret = 1;
+   int chipsets[ARRAY_SIZE(all_chipsets)];
+   unsigned num_chipsets = 0, num_files = 0, repeats = 0;
+   char **filenames = CALLOC(argc, sizeof(char *));
+   unsigned size = 0, *code = NULL;
+
+   if (!filenames)
+      return 1;
+
+   for (i = 1; i < argc; i++) {
+      if (!strcmp(argv[i], "-a") || !strcmp(argv[i], "-b")) {
+         const char *opt = argv[i];
+         const char *arg = argv[++i];
+         char *end;
+         long value;
+
+         if (!arg) {
+            _debug_printf("Missing argument for %s\n", opt);
+            goto out;
+         }
+
+         if (!strcmp(opt, "-a") && !strcmp(arg, "all")) {
+            memcpy(chipsets, all_chipsets, sizeof(all_chipsets));
+            num_chipsets = ARRAY_SIZE(all_chipsets);
+            continue;
+         }
+
+         value = strtol(arg, &end, !strcmp(opt, "-a") ? 16 : 0);
+         if (*end || value <= 0) {
+            _debug_printf("Invalid argument for %s: '%s'\n", opt, arg);
+            goto out;
+         }
+
+         if (!strcmp(opt, "-b")) {
+            repeats = value;
+         } else if (num_chipsets < ARRAY_SIZE(chipsets)) {
+            chipsets[num_chipsets++] = value;
+         } else {
+            _debug_printf("Too many chipsets, at most %u can be given\n",
+                          (unsigned)ARRAY_SIZE(chipsets));
+            goto out;
+         }
+      } else {
+         filenames[num_files++] = argv[i];
+      }
+   }
+
+   if (!num_chipsets) {
+      _debug_printf("Must specify a chipset (-a)\n");
+      goto out;
+   }
+
+   if (!num_files) {
+      _debug_printf("Must specify a filename\n");
+      goto out;
+   }
+
+   if (repeats) {
+      ret = benchmark(chipsets, num_chipsets, filenames, num_files, repeats);
+      goto out;
+   }
+
+   if (num_chipsets > 1 || num_files > 1) {
+      _debug_printf("Multiple chipsets or files need benchmark mode (-b)\n");
+      goto out;
    }
-   if (i)
-      return i;
+
+   if (read_shader(filenames[0], tokens, ARRAY_SIZE(tokens), &type))
+      goto out;
+
+   _debug_printf("Compiling for NV%X\n", chipsets[0]);
+
+   ret = compile(chipsets[0], type, tokens, &size, &code);
+   if (ret)
+      goto out;
 
    _debug_printf("program binary (%d bytes)\n", size);
    for (i = 0; i < size; i += 4) {
@@ -222,5 +375,8 @@ main(int argc, char *argv[])
    if (i % (8 * 4) != 0)
       printf("\n");
 
-   return 0;
+out:
+   FREE(code);
+   FREE(filenames);
+   return ret;
 }
@@ -430,6 +430,11 @@ void SetupDefaultState(SWR_CONTEXT *pContext)
     pState->depthBoundsState.depthBoundsTestEnable = false;
     pState->depthBoundsState.depthBoundsTestMinValue = 0.0f;
     pState->depthBoundsState.depthBoundsTestMaxValue = 1.0f;
+
+    for (uint32_t rt = 0; rt < SWR_NUM_RENDERTARGETS; ++rt)
+    {
+        pState->colorHottileFormat[rt] = KNOB_COLOR_HOT_TILE_FORMAT;
+    }
 }
 
 void SwrSync(HANDLE hContext, PFN_CALLBACK_FUNC pfnFunc, uint64_t userData, uint64_t userData2, uint64_t userData3)
@@ -677,6 +682,17 @@ void SwrSetBlendFunc(
     pState->pfnBlendFunc[renderTarget] = pfnBlendFunc;
 }
 
+void SwrSetRenderTargetFormats(
+    HANDLE hContext,
+    const SWR_FORMAT *pFormats)
+{
+    API_STATE *pState = GetDrawState(GetContext(hContext));
+    for (uint32_t rt = 0; rt < SWR_NUM_RENDERTARGETS; ++rt)
+    {
+        pState->colorHottileFormat[rt] = GetColorHotTileFormat(pFormats[rt]);
+    }
+}
+
 // update guardband multipliers for the viewport
 void updateGuardbands(API_STATE *pState)
 {
@@ -1683,6 +1699,7 @@ void SwrGetInterface(SWR_INTERFACE &out_funcs)
     out_funcs.pfnSwrSetPixelShaderState = SwrSetPixelShaderState;
     out_funcs.pfnSwrSetBlendState = SwrSetBlendState;
     out_funcs.pfnSwrSetBlendFunc = SwrSetBlendFunc;
+    out_funcs.pfnSwrSetRenderTargetFormats = SwrSetRenderTargetFormats;
     out_funcs.pfnSwrDraw = SwrDraw;
     out_funcs.pfnSwrDrawInstanced = SwrDrawInstanced;
     out_funcs.pfnSwrDrawIndexed = SwrDrawIndexed;
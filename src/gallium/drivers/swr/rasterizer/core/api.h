@@ -451,6 +451,15 @@ SWR_FUNC(void, SwrSetBlendFunc,
     uint32_t renderTarget,
     PFN_BLEND_JIT_FUNC pfnBlendFunc);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Set render target surface formats, used to pick the color
+///        hot tile format of each render target
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param pFormats - SWR_NUM_RENDERTARGETS surface formats
+SWR_FUNC(void, SwrSetRenderTargetFormats,
+    HANDLE hContext,
+    const SWR_FORMAT *pFormats);
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief SwrDraw
 /// @param hContext - Handle passed back from SwrCreateContext
@@ -731,6 +740,7 @@ struct SWR_INTERFACE
     PFNSwrSetPixelShaderState pfnSwrSetPixelShaderState;
     PFNSwrSetBlendState pfnSwrSetBlendState;
     PFNSwrSetBlendFunc pfnSwrSetBlendFunc;
+    PFNSwrSetRenderTargetFormats pfnSwrSetRenderTargetFormats;
     PFNSwrDraw pfnSwrDraw;
     PFNSwrDrawInstanced pfnSwrDrawInstanced;
     PFNSwrDrawIndexed pfnSwrDrawIndexed;
@@ -260,6 +260,8 @@ void ProcessClearBE(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, vo
                 HOTTILE *pHotTile = pContext->pHotTileMgr->GetHotTile(pContext, pDC, macroTile, (SWR_RENDERTARGET_ATTACHMENT)rt, true, numSamples, pClear->renderTargetArrayIndex);
 
                 // All we want to do here is to mark the hot tile as being in a "needs clear" state.
+                // The whole tile gets cleared, so it can simply switch to the current hot tile format.
+                pHotTile->format = pDC->pState->state.colorHottileFormat[rt];
                 pHotTile->clearData[0] = *(DWORD*)&(pClear->clearRTColor[0]);
                 pHotTile->clearData[1] = *(DWORD*)&(pClear->clearRTColor[1]);
                 pHotTile->clearData[2] = *(DWORD*)&(pClear->clearRTColor[2]);
@@ -299,8 +301,7 @@ void ProcessClearBE(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, vo
             clearData[2] = *(DWORD*)&(pClear->clearRTColor[2]);
             clearData[3] = *(DWORD*)&(pClear->clearRTColor[3]);
 
-            PFN_CLEAR_TILES pfnClearTiles = sClearTilesTable[KNOB_COLOR_HOT_TILE_FORMAT];
-            SWR_ASSERT(pfnClearTiles != nullptr);
+            uint32_t numSamples = GetNumSamples(pDC->pState->state.rastState.sampleCount);
 
             unsigned long rt = 0;
             uint32_t mask = pClear->attachmentMask & SWR_ATTACHMENT_MASK_COLOR;
@@ -308,6 +309,13 @@ void ProcessClearBE(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, vo
             {
                 mask &= ~(1 << rt);
 
+                HOTTILE *pHotTile = pContext->pHotTileMgr->GetHotTile(pContext, pDC, macroTile, (SWR_RENDERTARGET_ATTACHMENT)rt, true, numSamples, pClear->renderTargetArrayIndex);
+                pContext->pHotTileMgr->SetColorHotTileFormat(pContext, pDC, macroTile, (SWR_RENDERTARGET_ATTACHMENT)rt, pHotTile,
+                    pDC->pState->state.colorHottileFormat[rt]);
+
+                PFN_CLEAR_TILES pfnClearTiles = sClearTilesTable[pHotTile->format];
+                SWR_ASSERT(pfnClearTiles != nullptr);
+
                 pfnClearTiles(pDC, (SWR_RENDERTARGET_ATTACHMENT)rt, macroTile, pClear->renderTargetArrayIndex, clearData, pClear->rect);
             }
         }
@@ -342,22 +350,6 @@ void ProcessStoreTileBE(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile
 
     AR_BEGIN(BEStoreTiles, pDC->drawId);
 
-    SWR_FORMAT srcFormat;
-    switch (attachment)
-    {
-    case SWR_ATTACHMENT_COLOR0:
-    case SWR_ATTACHMENT_COLOR1:
-    case SWR_ATTACHMENT_COLOR2:
-    case SWR_ATTACHMENT_COLOR3:
-    case SWR_ATTACHMENT_COLOR4:
-    case SWR_ATTACHMENT_COLOR5:
-    case SWR_ATTACHMENT_COLOR6:
-    case SWR_ATTACHMENT_COLOR7: srcFormat = KNOB_COLOR_HOT_TILE_FORMAT; break;
-    case SWR_ATTACHMENT_DEPTH: srcFormat = KNOB_DEPTH_HOT_TILE_FORMAT; break;
-    case SWR_ATTACHMENT_STENCIL: srcFormat = KNOB_STENCIL_HOT_TILE_FORMAT; break;
-    default: SWR_INVALID("Unknown attachment: %d", attachment); srcFormat = KNOB_COLOR_HOT_TILE_FORMAT; break;
-    }
-
     uint32_t x, y;
     MacroTileMgr::getTileIndices(macroTile, x, y);
 
@@ -365,6 +357,8 @@ void ProcessStoreTileBE(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile
     HOTTILE *pHotTile = pContext->pHotTileMgr->GetHotTileNoLoad(pContext, pDC, macroTile, attachment, false);
     if (pHotTile)
     {
+        SWR_FORMAT srcFormat = pHotTile->format;
+
         // clear if clear is pending (i.e., not rendered to), then mark as dirty for store.
         if (pHotTile->state == HOTTILE_CLEAR)
         {
@@ -602,9 +596,9 @@ void BackendSingleSample(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint3
                 // output merger
                 AR_BEGIN(BEOutputMerger, pDC->drawId);
 #if USE_8x2_TILE_BACKEND
-                OutputMerger8x2(psContext, pColorBuffer, 0, &state.blendState, state.pfnBlendFunc, vCoverageMask, depthPassMask, state.psState.numRenderTargets, state.colorHottileEnable, useAlternateOffset);
+                OutputMerger8x2(psContext, pColorBuffer, 0, &state.blendState, state.pfnBlendFunc, vCoverageMask, depthPassMask, state.psState.numRenderTargets, state.colorHottileEnable, useAlternateOffset, state.colorHottileFormat);
 #else
-                OutputMerger4x2(psContext, pColorBuffer, 0, &state.blendState, state.pfnBlendFunc, vCoverageMask, depthPassMask, state.psState.numRenderTargets);
+                OutputMerger4x2(psContext, pColorBuffer, 0, &state.blendState, state.pfnBlendFunc, vCoverageMask, depthPassMask, state.psState.numRenderTargets, state.colorHottileFormat);
 #endif
 
                 // do final depth write after all pixel kills
@@ -630,13 +624,13 @@ Endtile:
             {
                 for (uint32_t rt = 0; rt < state.psState.numRenderTargets; ++rt)
                 {
-                    pColorBuffer[rt] += (2 * KNOB_SIMD_WIDTH * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp) / 8;
+                    pColorBuffer[rt] += ((2 * KNOB_SIMD_WIDTH * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp) / 8) >> ColorHotTileShift(state.colorHottileFormat[rt]);
                 }
             }
 #else
             for (uint32_t rt = 0; rt < state.psState.numRenderTargets; ++rt)
             {
-                pColorBuffer[rt] += (KNOB_SIMD_WIDTH * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp) / 8;
+                pColorBuffer[rt] += ((KNOB_SIMD_WIDTH * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp) / 8) >> ColorHotTileShift(state.colorHottileFormat[rt]);
             }
 #endif
             pDepthBuffer += (KNOB_SIMD_WIDTH * FormatTraits<KNOB_DEPTH_HOT_TILE_FORMAT>::bpp) / 8;
@@ -817,9 +811,9 @@ void BackendSampleRate(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint32_
                     // output merger
                     AR_BEGIN(BEOutputMerger, pDC->drawId);
 #if USE_8x2_TILE_BACKEND
-                    OutputMerger8x2(psContext, pColorBuffer, sample, &state.blendState, state.pfnBlendFunc, vCoverageMask, depthPassMask, state.psState.numRenderTargets, state.colorHottileEnable, useAlternateOffset);
+                    OutputMerger8x2(psContext, pColorBuffer, sample, &state.blendState, state.pfnBlendFunc, vCoverageMask, depthPassMask, state.psState.numRenderTargets, state.colorHottileEnable, useAlternateOffset, state.colorHottileFormat);
 #else
-                    OutputMerger4x2(psContext, pColorBuffer, sample, &state.blendState, state.pfnBlendFunc, vCoverageMask, depthPassMask, state.psState.numRenderTargets);
+                    OutputMerger4x2(psContext, pColorBuffer, sample, &state.blendState, state.pfnBlendFunc, vCoverageMask, depthPassMask, state.psState.numRenderTargets, state.colorHottileFormat);
 #endif
 
                     // do final depth write after all pixel kills
@@ -848,13 +842,13 @@ Endtile:
             {
                 for (uint32_t rt = 0; rt < state.psState.numRenderTargets; ++rt)
                 {
-                    pColorBuffer[rt] += (2 * KNOB_SIMD_WIDTH * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp) / 8;
+                    pColorBuffer[rt] += ((2 * KNOB_SIMD_WIDTH * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp) / 8) >> ColorHotTileShift(state.colorHottileFormat[rt]);
                 }
             }
 #else
             for (uint32_t rt = 0; rt < state.psState.numRenderTargets; ++rt)
             {
-                pColorBuffer[rt] += (KNOB_SIMD_WIDTH * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp) / 8;
+                pColorBuffer[rt] += ((KNOB_SIMD_WIDTH * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp) / 8) >> ColorHotTileShift(state.colorHottileFormat[rt]);
             }
 #endif
             pDepthBuffer += (KNOB_SIMD_WIDTH * FormatTraits<KNOB_DEPTH_HOT_TILE_FORMAT>::bpp) / 8;
@@ -995,6 +989,7 @@ void InitClearTilesTable()
     sClearTilesTable[B8G8R8A8_UNORM] = ClearMacroTile<B8G8R8A8_UNORM>;
     sClearTilesTable[R32_FLOAT] = ClearMacroTile<R32_FLOAT>;
     sClearTilesTable[R32G32B32A32_FLOAT] = ClearMacroTile<R32G32B32A32_FLOAT>;
+    sClearTilesTable[R16G16B16A16_FLOAT] = ClearMacroTile<R16G16B16A16_FLOAT>;
     sClearTilesTable[R8_UINT] = ClearMacroTile<R8_UINT>;
 }
 
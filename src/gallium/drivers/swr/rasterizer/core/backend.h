@@ -705,144 +705,204 @@ INLINE void CalcSampleBarycentrics(const BarycentricCoeffs& coeffs, SWR_PS_CONTE
     psContext.vOneOverW.sample = vplaneps(coeffs.vAOneOverW, coeffs.vBOneOverW, coeffs.vCOneOverW, psContext.vI.sample, psContext.vJ.sample);
 }
 
-// Merge Output to 4x2 SIMD Tile Format
-INLINE void OutputMerger4x2(SWR_PS_CONTEXT &psContext, uint8_t* (&pColorBase)[SWR_NUM_RENDERTARGETS], uint32_t sample, const SWR_BLEND_STATE *pBlendState,
-    const PFN_BLEND_JIT_FUNC (&pfnBlendFunc)[SWR_NUM_RENDERTARGETS], simdscalar &coverageMask, simdscalar depthPassMask, const uint32_t NumRT)
+//////////////////////////////////////////////////////////////////////////
+/// @brief Load a SIMD of color hot tile data and convert it to SOA
+///        RGBA32_FLOAT format.
+/// @param pSrc - hot tile data in SOA form
+/// @param compStride - byte offset between the components of the SIMD
+/// @param dst - output data in SOA form
+template<SWR_FORMAT HotTileFormat>
+INLINE void LoadHotTileColor(const uint8_t *pSrc, uint32_t compStride, simdvector &dst)
 {
-    // type safety guaranteed from template instantiation in BEChooser<>::GetFunc
-    const uint32_t rasterTileColorOffset = RasterTileColorOffset(sample);
-    simdvector blendOut;
-
-    for(uint32_t rt = 0; rt < NumRT; ++rt)
+    for (uint32_t comp = 0; comp < FormatTraits<HotTileFormat>::numComps; ++comp)
     {
-        uint8_t *pColorSample = pColorBase[rt] + rasterTileColorOffset;
+        simdscalar vComp = FormatTraits<HotTileFormat>::loadSOA(comp, pSrc + comp * compStride);
 
-        const SWR_RENDER_TARGET_BLEND_STATE *pRTBlend = &pBlendState->renderTarget[rt];
+        vComp = FormatTraits<HotTileFormat>::unpack(comp, vComp);
 
+        if (FormatTraits<HotTileFormat>::isNormalized(comp))
         {
-            // pfnBlendFunc may not update all channels.  Initialize with PS output.
-            /// TODO: move this into the blend JIT.
-            blendOut = psContext.shaded[rt];
-
-            // Blend outputs and update coverage mask for alpha test
-            if(pfnBlendFunc[rt] != nullptr)
-            {
-                pfnBlendFunc[rt](
-                    pBlendState,
-                    psContext.shaded[rt],
-                    psContext.shaded[1],
-                    psContext.shaded[0].w,
-                    sample,
-                    pColorSample,
-                    blendOut,
-                    &psContext.oMask,
-                    (simdscalari*)&coverageMask);
-            }
+            vComp = _simd_cvtepi32_ps(_simd_castps_si(vComp));
+            vComp = _simd_mul_ps(vComp, _simd_set1_ps(FormatTraits<HotTileFormat>::toFloat(comp)));
         }
 
-        // final write mask 
-        simdscalari outputMask = _simd_castps_si(_simd_and_ps(coverageMask, depthPassMask));
+        dst.v[FormatTraits<HotTileFormat>::swizzle(comp)] = vComp;
+    }
+}
 
-        ///@todo can only use maskstore fast path if bpc is 32. Assuming hot tile is RGBA32_FLOAT.
-        static_assert(KNOB_COLOR_HOT_TILE_FORMAT == R32G32B32A32_FLOAT, "Unsupported hot tile format");
+//////////////////////////////////////////////////////////////////////////
+/// @brief Convert SOA RGBA32_FLOAT data and store it to a SIMD of color
+///        hot tile data.
+/// @param src - source data in SOA form
+/// @param compStride - byte offset between the components of the SIMD
+/// @param pDst - hot tile data in SOA form
+template<SWR_FORMAT HotTileFormat>
+INLINE void StoreHotTileColor(const simdvector &src, uint32_t compStride, uint8_t *pDst)
+{
+    for (uint32_t comp = 0; comp < FormatTraits<HotTileFormat>::numComps; ++comp)
+    {
+        simdscalar vComp = src.v[FormatTraits<HotTileFormat>::swizzle(comp)];
 
-        const uint32_t simd = KNOB_SIMD_WIDTH * sizeof(float);
+        vComp = Clamp<HotTileFormat>(vComp, comp);
+        vComp = Normalize<HotTileFormat>(vComp, comp);
+        vComp = FormatTraits<HotTileFormat>::pack(comp, vComp);
 
-        // store with color mask
-        if(!pRTBlend->writeDisableRed)
-        {
-            _simd_maskstore_ps((float*)pColorSample, outputMask, blendOut.x);
-        }
-        if(!pRTBlend->writeDisableGreen)
-        {
-            _simd_maskstore_ps((float*)(pColorSample + simd), outputMask, blendOut.y);
-        }
-        if(!pRTBlend->writeDisableBlue)
-        {
-            _simd_maskstore_ps((float*)(pColorSample + simd * 2), outputMask, blendOut.z);
-        }
-        if(!pRTBlend->writeDisableAlpha)
-        {
-            _simd_maskstore_ps((float*)(pColorSample + simd * 3), outputMask, blendOut.w);
-        }
+        FormatTraits<HotTileFormat>::storeSOA(comp, pDst + comp * compStride, vComp);
     }
 }
 
-#if USE_8x2_TILE_BACKEND
-// Merge Output to 8x2 SIMD16 Tile Format
-INLINE void OutputMerger8x2(SWR_PS_CONTEXT &psContext, uint8_t* (&pColorBase)[SWR_NUM_RENDERTARGETS], uint32_t sample, const SWR_BLEND_STATE *pBlendState,
-    const PFN_BLEND_JIT_FUNC(&pfnBlendFunc)[SWR_NUM_RENDERTARGETS], simdscalar &coverageMask, simdscalar depthPassMask, const uint32_t NumRT, const uint32_t colorBufferEnableMask, bool useAlternateOffset)
+// Blend and write one render target's output to a SIMD of its color hot tile
+template<SWR_FORMAT HotTileFormat>
+INLINE void OutputMergerRT(SWR_PS_CONTEXT &psContext, uint8_t *pColorSample, uint32_t compStride, uint32_t rt, uint32_t sample,
+    const SWR_BLEND_STATE *pBlendState, PFN_BLEND_JIT_FUNC pfnBlendFunc, simdscalar &coverageMask, simdscalar depthPassMask, bool colorBufferEnable)
 {
-    // type safety guaranteed from template instantiation in BEChooser<>::GetFunc
-    uint32_t rasterTileColorOffset = RasterTileColorOffset(sample);
-
-    if (useAlternateOffset)
-    {
-        rasterTileColorOffset += sizeof(simdscalar);
-    }
+    const SWR_RENDER_TARGET_BLEND_STATE *pRTBlend = &pBlendState->renderTarget[rt];
 
     simdvector blendSrc;
     simdvector blendOut;
 
-    uint32_t colorBufferBit = 1;
-    for (uint32_t rt = 0; rt < NumRT; rt += 1, colorBufferBit <<= 1)
+    // the blend JIT always reads the render target as SOA RGBA32_FLOAT
+    if (colorBufferEnable)
     {
-        simdscalar *pColorSample = reinterpret_cast<simdscalar *>(pColorBase[rt] + rasterTileColorOffset);
+        LoadHotTileColor<HotTileFormat>(pColorSample, compStride, blendSrc);
+    }
 
-        const SWR_RENDER_TARGET_BLEND_STATE *pRTBlend = &pBlendState->renderTarget[rt];
+    {
+        // pfnBlendFunc may not update all channels.  Initialize with PS output.
+        /// TODO: move this into the blend JIT.
+        blendOut = psContext.shaded[rt];
 
-        if (colorBufferBit & colorBufferEnableMask)
+        // Blend outputs and update coverage mask for alpha test
+        if(pfnBlendFunc != nullptr)
         {
-            blendSrc[0] = pColorSample[0];
-            blendSrc[1] = pColorSample[2];
-            blendSrc[2] = pColorSample[4];
-            blendSrc[3] = pColorSample[6];
+            pfnBlendFunc(
+                pBlendState,
+                psContext.shaded[rt],
+                psContext.shaded[1],
+                psContext.shaded[0].w,
+                sample,
+                reinterpret_cast<uint8_t *>(&blendSrc),
+                blendOut,
+                &psContext.oMask,
+                reinterpret_cast<simdscalari *>(&coverageMask));
         }
+    }
 
-        {
-            // pfnBlendFunc may not update all channels.  Initialize with PS output.
-            /// TODO: move this into the blend JIT.
-            blendOut = psContext.shaded[rt];
-
-            // Blend outputs and update coverage mask for alpha test
-            if(pfnBlendFunc[rt] != nullptr)
-            {
-                pfnBlendFunc[rt](
-                    pBlendState,
-                    psContext.shaded[rt],
-                    psContext.shaded[1],
-                    psContext.shaded[0].w,
-                    sample,
-                    reinterpret_cast<uint8_t *>(&blendSrc),
-                    blendOut,
-                    &psContext.oMask,
-                    reinterpret_cast<simdscalari *>(&coverageMask));
-            }
-        }
+    if (!colorBufferEnable)
+    {
+        return;
+    }
 
-        // final write mask 
-        simdscalari outputMask = _simd_castps_si(_simd_and_ps(coverageMask, depthPassMask));
+    // final write mask 
+    simdscalar outputMask = _simd_and_ps(coverageMask, depthPassMask);
 
-        ///@todo can only use maskstore fast path if bpc is 32. Assuming hot tile is RGBA32_FLOAT.
-        static_assert(KNOB_COLOR_HOT_TILE_FORMAT == R32G32B32A32_FLOAT, "Unsupported hot tile format");
+    if ((FormatTraits<HotTileFormat>::GetType(0) == SWR_TYPE_FLOAT) && (FormatTraits<HotTileFormat>::GetBPC(0) == 32))
+    {
+        // fast path for float32, store with color mask
+        simdscalari outputMaski = _simd_castps_si(outputMask);
 
-        // store with color mask
         if (!pRTBlend->writeDisableRed)
         {
-            _simd_maskstore_ps(reinterpret_cast<float *>(&pColorSample[0]), outputMask, blendOut.x);
+            _simd_maskstore_ps(reinterpret_cast<float *>(pColorSample), outputMaski, blendOut.x);
         }
         if (!pRTBlend->writeDisableGreen)
         {
-            _simd_maskstore_ps(reinterpret_cast<float *>(&pColorSample[2]), outputMask, blendOut.y);
+            _simd_maskstore_ps(reinterpret_cast<float *>(pColorSample + compStride), outputMaski, blendOut.y);
         }
         if (!pRTBlend->writeDisableBlue)
         {
-            _simd_maskstore_ps(reinterpret_cast<float *>(&pColorSample[4]), outputMask, blendOut.z);
+            _simd_maskstore_ps(reinterpret_cast<float *>(pColorSample + compStride * 2), outputMaski, blendOut.z);
         }
         if (!pRTBlend->writeDisableAlpha)
         {
-            _simd_maskstore_ps(reinterpret_cast<float *>(&pColorSample[6]), outputMask, blendOut.w);
+            _simd_maskstore_ps(reinterpret_cast<float *>(pColorSample + compStride * 3), outputMaski, blendOut.w);
         }
+        return;
+    }
+
+    if (_simd_movemask_ps(outputMask) == 0)
+    {
+        return;
+    }
+
+    // packed components can't be mask stored. Merge with the current hot tile contents, which
+    // round trip through float exactly, and write back the whole SIMD.
+    const simdscalar disabled = _simd_setzero_ps();
+    blendOut.x = _simd_blendv_ps(blendSrc.x, blendOut.x, pRTBlend->writeDisableRed ? disabled : outputMask);
+    blendOut.y = _simd_blendv_ps(blendSrc.y, blendOut.y, pRTBlend->writeDisableGreen ? disabled : outputMask);
+    blendOut.z = _simd_blendv_ps(blendSrc.z, blendOut.z, pRTBlend->writeDisableBlue ? disabled : outputMask);
+    blendOut.w = _simd_blendv_ps(blendSrc.w, blendOut.w, pRTBlend->writeDisableAlpha ? disabled : outputMask);
+
+    StoreHotTileColor<HotTileFormat>(blendOut, compStride, pColorSample);
+}
+
+INLINE void OutputMergerRT(SWR_FORMAT hotTileFormat, SWR_PS_CONTEXT &psContext, uint8_t *pColorSample, uint32_t compStride, uint32_t rt, uint32_t sample,
+    const SWR_BLEND_STATE *pBlendState, PFN_BLEND_JIT_FUNC pfnBlendFunc, simdscalar &coverageMask, simdscalar depthPassMask, bool colorBufferEnable)
+{
+    switch (hotTileFormat)
+    {
+    case R8G8B8A8_UNORM:
+        OutputMergerRT<R8G8B8A8_UNORM>(psContext, pColorSample, compStride, rt, sample, pBlendState, pfnBlendFunc, coverageMask, depthPassMask, colorBufferEnable);
+        break;
+    case B8G8R8A8_UNORM:
+        OutputMergerRT<B8G8R8A8_UNORM>(psContext, pColorSample, compStride, rt, sample, pBlendState, pfnBlendFunc, coverageMask, depthPassMask, colorBufferEnable);
+        break;
+    case R16G16B16A16_FLOAT:
+        OutputMergerRT<R16G16B16A16_FLOAT>(psContext, pColorSample, compStride, rt, sample, pBlendState, pfnBlendFunc, coverageMask, depthPassMask, colorBufferEnable);
+        break;
+    default:
+        SWR_ASSERT(hotTileFormat == KNOB_COLOR_HOT_TILE_FORMAT);
+        OutputMergerRT<KNOB_COLOR_HOT_TILE_FORMAT>(psContext, pColorSample, compStride, rt, sample, pBlendState, pfnBlendFunc, coverageMask, depthPassMask, colorBufferEnable);
+        break;
+    }
+}
+
+// Merge Output to 4x2 SIMD Tile Format
+INLINE void OutputMerger4x2(SWR_PS_CONTEXT &psContext, uint8_t* (&pColorBase)[SWR_NUM_RENDERTARGETS], uint32_t sample, const SWR_BLEND_STATE *pBlendState,
+    const PFN_BLEND_JIT_FUNC (&pfnBlendFunc)[SWR_NUM_RENDERTARGETS], simdscalar &coverageMask, simdscalar depthPassMask, const uint32_t NumRT,
+    const SWR_FORMAT (&colorHottileFormat)[SWR_NUM_RENDERTARGETS])
+{
+    // type safety guaranteed from template instantiation in BEChooser<>::GetFunc
+    for(uint32_t rt = 0; rt < NumRT; ++rt)
+    {
+        // hot tile offsets are in KNOB_COLOR_HOT_TILE_FORMAT units, scale them to the hot tile format of the RT
+        const uint32_t shift = ColorHotTileShift(colorHottileFormat[rt]);
+        const uint32_t compStride = (KNOB_SIMD_WIDTH * sizeof(float)) >> shift;
+        uint8_t *pColorSample = pColorBase[rt] + (RasterTileColorOffset(sample) >> shift);
+
+        const SWR_RENDER_TARGET_BLEND_STATE *pRTBlend = &pBlendState->renderTarget[rt];
+        const bool colorBufferEnable = !pRTBlend->writeDisableRed || !pRTBlend->writeDisableGreen ||
+                                       !pRTBlend->writeDisableBlue || !pRTBlend->writeDisableAlpha;
+
+        OutputMergerRT(colorHottileFormat[rt], psContext, pColorSample, compStride, rt, sample, pBlendState, pfnBlendFunc[rt],
+            coverageMask, depthPassMask, colorBufferEnable);
+    }
+}
+
+#if USE_8x2_TILE_BACKEND
+// Merge Output to 8x2 SIMD16 Tile Format
+INLINE void OutputMerger8x2(SWR_PS_CONTEXT &psContext, uint8_t* (&pColorBase)[SWR_NUM_RENDERTARGETS], uint32_t sample, const SWR_BLEND_STATE *pBlendState,
+    const PFN_BLEND_JIT_FUNC(&pfnBlendFunc)[SWR_NUM_RENDERTARGETS], simdscalar &coverageMask, simdscalar depthPassMask, const uint32_t NumRT, const uint32_t colorBufferEnableMask, bool useAlternateOffset,
+    const SWR_FORMAT (&colorHottileFormat)[SWR_NUM_RENDERTARGETS])
+{
+    // type safety guaranteed from template instantiation in BEChooser<>::GetFunc
+    uint32_t rasterTileColorOffset = RasterTileColorOffset(sample);
+
+    if (useAlternateOffset)
+    {
+        rasterTileColorOffset += sizeof(simdscalar);
+    }
+
+    uint32_t colorBufferBit = 1;
+    for (uint32_t rt = 0; rt < NumRT; rt += 1, colorBufferBit <<= 1)
+    {
+        // hot tile offsets are in KNOB_COLOR_HOT_TILE_FORMAT units, scale them to the hot tile format of the RT
+        const uint32_t shift = ColorHotTileShift(colorHottileFormat[rt]);
+        const uint32_t compStride = (2 * sizeof(simdscalar)) >> shift;
+        uint8_t *pColorSample = pColorBase[rt] + (rasterTileColorOffset >> shift);
+
+        OutputMergerRT(colorHottileFormat[rt], psContext, pColorSample, compStride, rt, sample, pBlendState, pfnBlendFunc[rt],
+            coverageMask, depthPassMask, (colorBufferBit & colorBufferEnableMask) != 0);
     }
 }
 
@@ -989,9 +1049,9 @@ void BackendPixelRate(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint32_t
                 
                 // broadcast the results of the PS to all passing pixels
 #if USE_8x2_TILE_BACKEND
-                OutputMerger8x2(psContext, psContext.pColorBuffer, sample, &state.blendState,state.pfnBlendFunc, coverageMask, depthMask, state.psState.numRenderTargets, state.colorHottileEnable, useAlternateOffset);
+                OutputMerger8x2(psContext, psContext.pColorBuffer, sample, &state.blendState,state.pfnBlendFunc, coverageMask, depthMask, state.psState.numRenderTargets, state.colorHottileEnable, useAlternateOffset, state.colorHottileFormat);
 #else // USE_8x2_TILE_BACKEND
-                OutputMerger4x2(psContext, psContext.pColorBuffer, sample, &state.blendState, state.pfnBlendFunc, coverageMask, depthMask, state.psState.numRenderTargets);
+                OutputMerger4x2(psContext, psContext.pColorBuffer, sample, &state.blendState, state.pfnBlendFunc, coverageMask, depthMask, state.psState.numRenderTargets, state.colorHottileFormat);
 #endif // USE_8x2_TILE_BACKEND
 
                 if(!state.psState.forceEarlyZ && !T::bForcedSampleCount)
@@ -1023,13 +1083,13 @@ Endtile:
             {
                 for (uint32_t rt = 0; rt < state.psState.numRenderTargets; ++rt)
                 {
-                    psContext.pColorBuffer[rt] += (2 * KNOB_SIMD_WIDTH * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp) / 8;
+                    psContext.pColorBuffer[rt] += ((2 * KNOB_SIMD_WIDTH * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp) / 8) >> ColorHotTileShift(state.colorHottileFormat[rt]);
                 }
             }
 #else
             for(uint32_t rt = 0; rt < state.psState.numRenderTargets; ++rt)
             {
-                psContext.pColorBuffer[rt] += (KNOB_SIMD_WIDTH * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp) / 8;
+                psContext.pColorBuffer[rt] += ((KNOB_SIMD_WIDTH * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp) / 8) >> ColorHotTileShift(state.colorHottileFormat[rt]);
             }
 #endif
             pDepthBuffer += (KNOB_SIMD_WIDTH * FormatTraits<KNOB_DEPTH_HOT_TILE_FORMAT>::bpp) / 8;
@@ -296,6 +296,7 @@ OSALIGNLINE(struct) API_STATE
     // OM - Output Merger State
     SWR_BLEND_STATE         blendState;
     PFN_BLEND_JIT_FUNC      pfnBlendFunc[SWR_NUM_RENDERTARGETS];
+    SWR_FORMAT              colorHottileFormat[SWR_NUM_RENDERTARGETS];
 
     struct
     {
@@ -309,6 +310,44 @@ OSALIGNLINE(struct) API_STATE
     PFN_QUANTIZE_DEPTH      pfnQuantizeDepth;
 };
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Returns the color hot tile format used for a render target
+///        surface format. Common 8-bit and half float targets are kept in
+///        their own format, everything else uses KNOB_COLOR_HOT_TILE_FORMAT.
+/// @param surfaceFormat - render target surface format
+INLINE SWR_FORMAT GetColorHotTileFormat(SWR_FORMAT surfaceFormat)
+{
+    switch (surfaceFormat)
+    {
+    case R8G8B8A8_UNORM:
+    case B8G8R8A8_UNORM:
+    case R16G16B16A16_FLOAT:
+        return surfaceFormat;
+    default:
+        return KNOB_COLOR_HOT_TILE_FORMAT;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Returns the shift that scales a KNOB_COLOR_HOT_TILE_FORMAT byte
+///        offset down to the given color hot tile format.
+/// @param hotTileFormat - format returned by GetColorHotTileFormat
+INLINE uint32_t ColorHotTileShift(SWR_FORMAT hotTileFormat)
+{
+    static_assert(KNOB_COLOR_HOT_TILE_FORMAT == R32G32B32A32_FLOAT, "Unsupported hot tile format");
+
+    switch (hotTileFormat)
+    {
+    case R8G8B8A8_UNORM:
+    case B8G8R8A8_UNORM:
+        return 2;
+    case R16G16B16A16_FLOAT:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
 class MacroTileMgr;
 class DispatchQueue;
 
@@ -1037,8 +1037,37 @@ template<> struct TypeTraits<SWR_TYPE_FLOAT, 16> : PackTraits<16>
     static simdscalar unpack(const simdscalar &in)
     {
         // input is 8 packed float16, output is 8 packed float32
-        SWR_NOT_IMPL; // @todo
-        return _simd_setzero_ps();
+#if KNOB_SIMD_WIDTH == 8
+#if (KNOB_ARCH == KNOB_ARCH_AVX)
+        __m128i src = _mm_castps_si128(_mm256_castps256_ps128(in));
+        simdscalari vSrc = _mm256_castsi128_si256(_mm_cvtepu16_epi32(src));
+        vSrc = _mm256_insertf128_si256(vSrc, _mm_cvtepu16_epi32(_mm_srli_si128(src, 8)), 1);
+
+        static const uint32_t HALF_EXP_MASK_SHIFTED = 0x7C00 << 13;
+
+        // move exponent and mantissa into place and rebias the exponent
+        simdscalari vBits   = _simd_slli_epi32(_simd_and_si(vSrc, _simd_set1_epi32(0x7FFF)), 13);
+        simdscalari vExp    = _simd_and_si(vBits, _simd_set1_epi32(HALF_EXP_MASK_SHIFTED));
+        vBits = _simd_add_epi32(vBits, _simd_set1_epi32((127 - 15) << 23));
+
+        // Infinites / NaN keep a maximum exponent
+        simdscalari vInfMask = _simd_cmpeq_epi32(vExp, _simd_set1_epi32(HALF_EXP_MASK_SHIFTED));
+        vBits = _simd_add_epi32(vBits, _simd_and_si(vInfMask, _simd_set1_epi32((128 - 16) << 23)));
+
+        // Zero and denormals (subnormals) are renormalized through a float subtract
+        simdscalari vDenormMask = _simd_cmpeq_epi32(vExp, _simd_setzero_si());
+        simdscalar vDenorm = _simd_sub_ps(_simd_castsi_ps(_simd_add_epi32(vBits, _simd_set1_epi32(1 << 23))),
+                                          _simd_castsi_ps(_simd_set1_epi32(113 << 23)));
+        simdscalar vDst = _simd_blendv_ps(_simd_castsi_ps(vBits), vDenorm, _simd_castsi_ps(vDenormMask));
+
+        // Add in sign bits
+        return _simd_or_ps(vDst, _simd_castsi_ps(_simd_slli_epi32(_simd_and_si(vSrc, _simd_set1_epi32(0x8000)), 16)));
+#else
+        return _mm256_cvtph_ps(_mm256_castsi256_si128(_simd_castps_si(in)));
+#endif
+#else
+#error Unsupported vector width
+#endif
     }
 #if ENABLE_AVX512_SIMD16
 
@@ -31,6 +31,7 @@
 #include "fifo.hpp"
 #include "core/tilemgr.h"
 #include "core/multisample.h"
+#include "core/format_conversion.h"
 #include "rdtsc_core.h"
 
 #define TILE_ID(x,y) ((x << 16 | y))
@@ -83,6 +84,24 @@ void MacroTileMgr::markTileComplete(uint32_t id)
     tile.mWorkItemsBE = 0;
 }
 
+static SWR_FORMAT GetDefaultHotTileFormat(SWR_RENDERTARGET_ATTACHMENT attachment)
+{
+    switch (attachment)
+    {
+    case SWR_ATTACHMENT_COLOR0:
+    case SWR_ATTACHMENT_COLOR1:
+    case SWR_ATTACHMENT_COLOR2:
+    case SWR_ATTACHMENT_COLOR3:
+    case SWR_ATTACHMENT_COLOR4:
+    case SWR_ATTACHMENT_COLOR5:
+    case SWR_ATTACHMENT_COLOR6:
+    case SWR_ATTACHMENT_COLOR7: return KNOB_COLOR_HOT_TILE_FORMAT;
+    case SWR_ATTACHMENT_DEPTH: return KNOB_DEPTH_HOT_TILE_FORMAT;
+    case SWR_ATTACHMENT_STENCIL: return KNOB_STENCIL_HOT_TILE_FORMAT;
+    default: SWR_INVALID("Unknown attachment: %d", attachment); return KNOB_COLOR_HOT_TILE_FORMAT;
+    }
+}
+
 HOTTILE* HotTileMgr::GetHotTile(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t macroID, SWR_RENDERTARGET_ATTACHMENT attachment, bool create, uint32_t numSamples,
     uint32_t renderTargetArrayIndex)
 {
@@ -104,6 +123,7 @@ HOTTILE* HotTileMgr::GetHotTile(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32
             hotTile.state = HOTTILE_INVALID;
             hotTile.numSamples = numSamples;
             hotTile.renderTargetArrayIndex = renderTargetArrayIndex;
+            hotTile.format = GetDefaultHotTileFormat(attachment);
         }
         else
         {
@@ -133,22 +153,6 @@ HOTTILE* HotTileMgr::GetHotTile(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32
         // and load the requested array slice
         if (renderTargetArrayIndex != hotTile.renderTargetArrayIndex)
         {
-            SWR_FORMAT format;
-            switch (attachment)
-            {
-            case SWR_ATTACHMENT_COLOR0:
-            case SWR_ATTACHMENT_COLOR1:
-            case SWR_ATTACHMENT_COLOR2:
-            case SWR_ATTACHMENT_COLOR3:
-            case SWR_ATTACHMENT_COLOR4:
-            case SWR_ATTACHMENT_COLOR5:
-            case SWR_ATTACHMENT_COLOR6:
-            case SWR_ATTACHMENT_COLOR7: format = KNOB_COLOR_HOT_TILE_FORMAT; break;
-            case SWR_ATTACHMENT_DEPTH: format = KNOB_DEPTH_HOT_TILE_FORMAT; break;
-            case SWR_ATTACHMENT_STENCIL: format = KNOB_STENCIL_HOT_TILE_FORMAT; break;
-            default: SWR_INVALID("Unknown attachment: %d", attachment); format = KNOB_COLOR_HOT_TILE_FORMAT; break;
-            }
-
             if (hotTile.state == HOTTILE_CLEAR)
             {
                 if (attachment == SWR_ATTACHMENT_STENCIL)
@@ -163,11 +167,11 @@ HOTTILE* HotTileMgr::GetHotTile(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32
 
             if (hotTile.state == HOTTILE_DIRTY)
             {
-                pContext->pfnStoreTile(GetPrivateState(pDC), format, attachment,
+                pContext->pfnStoreTile(GetPrivateState(pDC), hotTile.format, attachment,
                     x * KNOB_MACROTILE_X_DIM, y * KNOB_MACROTILE_Y_DIM, hotTile.renderTargetArrayIndex, hotTile.pBuffer);
             }
 
-            pContext->pfnLoadTile(GetPrivateState(pDC), format, attachment,
+            pContext->pfnLoadTile(GetPrivateState(pDC), hotTile.format, attachment,
                 x * KNOB_MACROTILE_X_DIM, y * KNOB_MACROTILE_Y_DIM, renderTargetArrayIndex, hotTile.pBuffer);
 
             hotTile.renderTargetArrayIndex = renderTargetArrayIndex;
@@ -198,6 +202,7 @@ HOTTILE* HotTileMgr::GetHotTileNoLoad(
             hotTile.state = HOTTILE_INVALID;
             hotTile.numSamples = numSamples;
             hotTile.renderTargetArrayIndex = 0;
+            hotTile.format = GetDefaultHotTileFormat(attachment);
         }
         else
         {
@@ -208,17 +213,55 @@ HOTTILE* HotTileMgr::GetHotTileNoLoad(
     return &hotTile;
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Switches a color hot tile to a new hot tile format. Rendered
+/// contents are stored out in the old format and loaded back in the new
+/// one. A pending clear is kept, its clear data is always float.
+void HotTileMgr::SetColorHotTileFormat(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t macroID, SWR_RENDERTARGET_ATTACHMENT attachment,
+    HOTTILE* pHotTile, SWR_FORMAT format)
+{
+    if (pHotTile->format == format)
+    {
+        return;
+    }
+
+    uint32_t x, y;
+    MacroTileMgr::getTileIndices(macroID, x, y);
+    x *= KNOB_MACROTILE_X_DIM;
+    y *= KNOB_MACROTILE_Y_DIM;
+
+    if (pHotTile->state == HOTTILE_DIRTY)
+    {
+        pContext->pfnStoreTile(GetPrivateState(pDC), pHotTile->format, attachment,
+            x, y, pHotTile->renderTargetArrayIndex, pHotTile->pBuffer);
+    }
+
+    if (pHotTile->state == HOTTILE_DIRTY || pHotTile->state == HOTTILE_RESOLVED)
+    {
+        pContext->pfnLoadTile(GetPrivateState(pDC), format, attachment,
+            x, y, pHotTile->renderTargetArrayIndex, pHotTile->pBuffer);
+        pHotTile->state = HOTTILE_DIRTY;
+    }
+
+    pHotTile->format = format;
+}
+
 #if USE_8x2_TILE_BACKEND
-void HotTileMgr::ClearColorHotTile(const HOTTILE* pHotTile)  // clear a macro tile from float4 clear data.
+template<SWR_FORMAT HotTileFormat>
+static void ClearColorHotTile(const HOTTILE* pHotTile)  // clear a macro tile from float4 clear data.
 {
-    // Load clear color into SIMD register...
+    // Convert clear color to the hot tile format and load into SIMD registers...
     float *pClearData = (float *)(pHotTile->clearData);
-    simd16scalar valR = _simd16_broadcast_ss(&pClearData[0]);
-    simd16scalar valG = _simd16_broadcast_ss(&pClearData[1]);
-    simd16scalar valB = _simd16_broadcast_ss(&pClearData[2]);
-    simd16scalar valA = _simd16_broadcast_ss(&pClearData[3]);
+    simd16scalar vClear[4];
+    for (uint32_t comp = 0; comp < FormatTraits<HotTileFormat>::numComps; ++comp)
+    {
+        simd16scalar vComp = _simd16_broadcast_ss(&pClearData[FormatTraits<HotTileFormat>::swizzle(comp)]);
+        vComp = Clamp<HotTileFormat>(vComp, comp);
+        vComp = Normalize<HotTileFormat>(vComp, comp);
+        vClear[comp] = FormatTraits<HotTileFormat>::pack(comp, vComp);
+    }
 
-    float *pfBuf = (float *)pHotTile->pBuffer;
+    uint8_t *pBuf = pHotTile->pBuffer;
     uint32_t numSamples = pHotTile->numSamples;
 
     for (uint32_t row = 0; row < KNOB_MACROTILE_Y_DIM; row += KNOB_TILE_Y_DIM)
@@ -227,17 +270,11 @@ void HotTileMgr::ClearColorHotTile(const HOTTILE* pHotTile)  // clear a macro ti
         {
             for (uint32_t si = 0; si < (KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * numSamples); si += SIMD16_TILE_X_DIM * SIMD16_TILE_Y_DIM)
             {
-                _simd16_store_ps(pfBuf, valR);
-                pfBuf += KNOB_SIMD16_WIDTH;
-
-                _simd16_store_ps(pfBuf, valG);
-                pfBuf += KNOB_SIMD16_WIDTH;
-
-                _simd16_store_ps(pfBuf, valB);
-                pfBuf += KNOB_SIMD16_WIDTH;
-
-                _simd16_store_ps(pfBuf, valA);
-                pfBuf += KNOB_SIMD16_WIDTH;
+                for (uint32_t comp = 0; comp < FormatTraits<HotTileFormat>::numComps; ++comp)
+                {
+                    FormatTraits<HotTileFormat>::storeSOA(comp, pBuf, vClear[comp]);
+                    pBuf += (KNOB_SIMD16_WIDTH * FormatTraits<HotTileFormat>::GetBPC(comp)) / 8;
+                }
             }
         }
     }
@@ -290,32 +327,34 @@ void HotTileMgr::ClearStencilHotTile(const HOTTILE* pHotTile)
 }
 
 #else
-void HotTileMgr::ClearColorHotTile(const HOTTILE* pHotTile)  // clear a macro tile from float4 clear data.
+template<SWR_FORMAT HotTileFormat>
+static void ClearColorHotTile(const HOTTILE* pHotTile)  // clear a macro tile from float4 clear data.
 {
-    // Load clear color into SIMD register...
+    // Convert clear color to the hot tile format and load into SIMD registers...
     float *pClearData = (float*)(pHotTile->clearData);
-    simdscalar valR = _simd_broadcast_ss(&pClearData[0]);
-    simdscalar valG = _simd_broadcast_ss(&pClearData[1]);
-    simdscalar valB = _simd_broadcast_ss(&pClearData[2]);
-    simdscalar valA = _simd_broadcast_ss(&pClearData[3]);
+    simdscalar vClear[4];
+    for (uint32_t comp = 0; comp < FormatTraits<HotTileFormat>::numComps; ++comp)
+    {
+        simdscalar vComp = _simd_broadcast_ss(&pClearData[FormatTraits<HotTileFormat>::swizzle(comp)]);
+        vComp = Clamp<HotTileFormat>(vComp, comp);
+        vComp = Normalize<HotTileFormat>(vComp, comp);
+        vClear[comp] = FormatTraits<HotTileFormat>::pack(comp, vComp);
+    }
 
-    float *pfBuf = (float*)pHotTile->pBuffer;
+    uint8_t *pBuf = pHotTile->pBuffer;
     uint32_t numSamples = pHotTile->numSamples;
 
     for (uint32_t row = 0; row < KNOB_MACROTILE_Y_DIM; row += KNOB_TILE_Y_DIM)
     {
         for (uint32_t col = 0; col < KNOB_MACROTILE_X_DIM; col += KNOB_TILE_X_DIM)
         {
-            for (uint32_t si = 0; si < (KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * numSamples); si += SIMD_TILE_X_DIM * SIMD_TILE_Y_DIM) //SIMD_TILE_X_DIM * SIMD_TILE_Y_DIM); si++)
+            for (uint32_t si = 0; si < (KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * numSamples); si += SIMD_TILE_X_DIM * SIMD_TILE_Y_DIM)
             {
-                _simd_store_ps(pfBuf, valR);
-                pfBuf += KNOB_SIMD_WIDTH;
-                _simd_store_ps(pfBuf, valG);
-                pfBuf += KNOB_SIMD_WIDTH;
-                _simd_store_ps(pfBuf, valB);
-                pfBuf += KNOB_SIMD_WIDTH;
-                _simd_store_ps(pfBuf, valA);
-                pfBuf += KNOB_SIMD_WIDTH;
+                for (uint32_t comp = 0; comp < FormatTraits<HotTileFormat>::numComps; ++comp)
+                {
+                    FormatTraits<HotTileFormat>::storeSOA(comp, pBuf, vClear[comp]);
+                    pBuf += (KNOB_SIMD_WIDTH * FormatTraits<HotTileFormat>::GetBPC(comp)) / 8;
+                }
             }
         }
     }
@@ -368,6 +407,20 @@ void HotTileMgr::ClearStencilHotTile(const HOTTILE* pHotTile)
 }
 
 #endif
+void HotTileMgr::ClearColorHotTile(const HOTTILE* pHotTile)
+{
+    switch (pHotTile->format)
+    {
+    case R8G8B8A8_UNORM: ::ClearColorHotTile<R8G8B8A8_UNORM>(pHotTile); break;
+    case B8G8R8A8_UNORM: ::ClearColorHotTile<B8G8R8A8_UNORM>(pHotTile); break;
+    case R16G16B16A16_FLOAT: ::ClearColorHotTile<R16G16B16A16_FLOAT>(pHotTile); break;
+    default:
+        SWR_ASSERT(pHotTile->format == KNOB_COLOR_HOT_TILE_FORMAT);
+        ::ClearColorHotTile<KNOB_COLOR_HOT_TILE_FORMAT>(pHotTile);
+        break;
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief InitializeHotTiles
 /// for draw calls, we initialize the active hot tiles and perform deferred
@@ -393,12 +446,14 @@ void HotTileMgr::InitializeHotTiles(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, ui
     while (_BitScanForward(&rtSlot, colorHottileEnableMask))
     {
         HOTTILE* pHotTile = GetHotTile(pContext, pDC, macroID, (SWR_RENDERTARGET_ATTACHMENT)(SWR_ATTACHMENT_COLOR0 + rtSlot), true, numSamples);
+        SetColorHotTileFormat(pContext, pDC, macroID, (SWR_RENDERTARGET_ATTACHMENT)(SWR_ATTACHMENT_COLOR0 + rtSlot), pHotTile,
+            state.colorHottileFormat[rtSlot]);
 
         if (pHotTile->state == HOTTILE_INVALID)
         {
             AR_BEGIN(BELoadTiles, pDC->drawId);
             // invalid hottile before draw requires a load from surface before we can draw to it
-            pContext->pfnLoadTile(GetPrivateState(pDC), KNOB_COLOR_HOT_TILE_FORMAT, (SWR_RENDERTARGET_ATTACHMENT)(SWR_ATTACHMENT_COLOR0 + rtSlot), x, y, pHotTile->renderTargetArrayIndex, pHotTile->pBuffer);
+            pContext->pfnLoadTile(GetPrivateState(pDC), pHotTile->format, (SWR_RENDERTARGET_ATTACHMENT)(SWR_ATTACHMENT_COLOR0 + rtSlot), x, y, pHotTile->renderTargetArrayIndex, pHotTile->pBuffer);
             pHotTile->state = HOTTILE_DIRTY;
             AR_END(BELoadTiles, 0);
         }
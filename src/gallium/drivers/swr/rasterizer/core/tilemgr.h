@@ -260,6 +260,7 @@ struct HOTTILE
     DWORD clearData[4];                 // May need to change based on pfnClearTile implementation.  Reorder for alignment?
     uint32_t numSamples;
     uint32_t renderTargetArrayIndex;    // current render target array index loaded
+    SWR_FORMAT format;                  // format of the data in pBuffer
 };
 
 union HotTileSet
@@ -280,7 +281,8 @@ public:
     {
         memset(mHotTiles, 0, sizeof(mHotTiles));
 
-        // cache hottile size
+        // cache hottile size. Color hot tiles are sized for KNOB_COLOR_HOT_TILE_FORMAT,
+        // the widest format a color hot tile can be switched to.
         for (uint32_t i = SWR_ATTACHMENT_COLOR0; i <= SWR_ATTACHMENT_COLOR7; ++i)
         {
             mHotTileSize[i] = KNOB_MACROTILE_X_DIM * KNOB_MACROTILE_Y_DIM * FormatTraits<KNOB_COLOR_HOT_TILE_FORMAT>::bpp / 8;
@@ -310,6 +312,8 @@ public:
 
     HOTTILE *GetHotTileNoLoad(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t macroID, SWR_RENDERTARGET_ATTACHMENT attachment, bool create, uint32_t numSamples = 1);
 
+    void SetColorHotTileFormat(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t macroID, SWR_RENDERTARGET_ATTACHMENT attachment, HOTTILE* pHotTile, SWR_FORMAT format);
+
     static void ClearColorHotTile(const HOTTILE* pHotTile);
     static void ClearDepthHotTile(const HOTTILE* pHotTile);
     static void ClearStencilHotTile(const HOTTILE* pHotTile);
@@ -562,7 +562,8 @@ struct BlendJit : public Builder
         Value* ppMask = &*argitr++;
         ppMask->setName("pMask");
 
-        static_assert(KNOB_COLOR_HOT_TILE_FORMAT == R32G32B32A32_FLOAT, "Unsupported hot tile format");
+        // the output merger hands the render target over as SOA RGBA32_FLOAT,
+        // whatever the color hot tile format is
         Value* dst[4];
         Value* constantColor[4];
         Value* src[4];
@@ -46,6 +46,25 @@ static void BUCKETS_STOP(UINT id)
 static std::vector<int> sBuckets(NUM_SWR_FORMATS, -1);
 static std::mutex sBucketMutex;
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Returns the load for a color hot tile kept in the surface format.
+/// @param tileMode - Tiling mode of the src surface
+template<SWR_FORMAT Format>
+static PFN_LOAD_TILES GetLoadTilesColorNative(SWR_TILE_MODE tileMode)
+{
+    switch (tileMode)
+    {
+    case SWR_TILE_NONE:
+        return LoadMacroTile<TilingTraits<SWR_TILE_NONE, FormatTraits<Format>::bpp>, Format, Format>::Load;
+    case SWR_TILE_MODE_YMAJOR:
+        return LoadMacroTile<TilingTraits<SWR_TILE_MODE_YMAJOR, FormatTraits<Format>::bpp>, Format, Format>::Load;
+    case SWR_TILE_MODE_XMAJOR:
+        return LoadMacroTile<TilingTraits<SWR_TILE_MODE_XMAJOR, FormatTraits<Format>::bpp>, Format, Format>::Load;
+    default:
+        return nullptr;
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Loads a full hottile from a render surface
 /// @param hPrivateContext - Handle to private DC
@@ -74,7 +93,26 @@ void SwrLoadHotTile(
         renderTargetArrayIndex = 0;
     }
 
-    if (renderTargetIndex < SWR_ATTACHMENT_DEPTH)
+    if (renderTargetIndex < SWR_ATTACHMENT_DEPTH && dstFormat != KNOB_COLOR_HOT_TILE_FORMAT)
+    {
+        // hot tile is kept in the surface format, see GetColorHotTileFormat
+        SWR_ASSERT(dstFormat == pSrcSurface->format);
+        switch (dstFormat)
+        {
+        case R8G8B8A8_UNORM:
+            pfnLoadTiles = GetLoadTilesColorNative<R8G8B8A8_UNORM>(pSrcSurface->tileMode);
+            break;
+        case B8G8R8A8_UNORM:
+            pfnLoadTiles = GetLoadTilesColorNative<B8G8R8A8_UNORM>(pSrcSurface->tileMode);
+            break;
+        case R16G16B16A16_FLOAT:
+            pfnLoadTiles = GetLoadTilesColorNative<R16G16B16A16_FLOAT>(pSrcSurface->tileMode);
+            break;
+        default:
+            break;
+        }
+    }
+    else if (renderTargetIndex < SWR_ATTACHMENT_DEPTH)
     {
         switch (pSrcSurface->tileMode)
         {
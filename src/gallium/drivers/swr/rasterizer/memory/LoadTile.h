@@ -98,6 +98,61 @@ struct LoadRasterTile
 #endif
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Copy a src pixel unconverted to a hot tile kept in the src format.
+    /// @param pSrc - Pointer to src pixel.
+    /// @param x, y - Coordinates to raster tile.
+    /// @param pDst - Destination hot tile pointer
+    INLINE static void SetDstPixel(
+        const uint8_t* pSrc,
+        uint32_t x, uint32_t y,
+        uint8_t* pDst)
+    {
+        typedef NativeSimdTile<DstFormat> SimdT;
+
+        SimdT* pDstSimdTiles = (SimdT*)pDst;
+
+#if USE_8x2_TILE_BACKEND
+        // Compute which simd tile we're accessing within 8x8 tile.
+        //   i.e. Compute linear simd tile coordinate given (x, y) in pixel coordinates.
+        uint32_t simdIndex = (y / SIMD16_TILE_Y_DIM) * (KNOB_TILE_X_DIM / SIMD16_TILE_X_DIM) + (x / SIMD16_TILE_X_DIM);
+
+        uint32_t simdOffset = (y % SIMD16_TILE_Y_DIM) * SIMD16_TILE_X_DIM + (x % SIMD16_TILE_X_DIM);
+#else
+        // Compute which simd tile we're accessing within 8x8 tile.
+        //   i.e. Compute linear simd tile coordinate given (x, y) in pixel coordinates.
+        uint32_t simdIndex = (y / SIMD_TILE_Y_DIM) * (KNOB_TILE_X_DIM / SIMD_TILE_X_DIM) + (x / SIMD_TILE_X_DIM);
+
+        uint32_t simdOffset = (y % SIMD_TILE_Y_DIM) * SIMD_TILE_X_DIM + (x % SIMD_TILE_X_DIM);
+#endif
+
+        pDstSimdTiles[simdIndex].SetPixel(simdOffset, pSrc);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Loads a src pixel to the hot tile.
+    /// @param pSrc - Pointer to src pixel.
+    /// @param x, y - Coordinates to raster tile.
+    /// @param pDst - Destination hot tile pointer
+    INLINE static void LoadPixel(
+        const uint8_t* pSrc,
+        uint32_t x, uint32_t y,
+        uint8_t* pDst)
+    {
+        if (SrcFormat == DstFormat)
+        {
+            // hot tile is kept in the src format, no conversion needed
+            SetDstPixel(pSrc, x, y, pDst);
+            return;
+        }
+
+        float srcColor[4];
+        ConvertPixelToFloat<SrcFormat>(srcColor, pSrc);
+
+        // store pixel to hottile
+        SetSwizzledDstColor(srcColor, x, y, pDst);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     /// @brief Loads an 8x8 raster tile from the src surface.
     /// @param pSrcSurface - Src surface state
@@ -123,17 +178,68 @@ struct LoadRasterTile
                             pSrcSurface->arrayIndex + renderTargetArrayIndex, sampleNum,
                             pSrcSurface->lod, pSrcSurface);
 
-                    float srcColor[4];
-                    ConvertPixelToFloat<SrcFormat>(srcColor, pSrc);
-
-                    // store pixel to hottile
-                    SetSwizzledDstColor(srcColor, rx, ry, pDst);
+                    LoadPixel(pSrc, rx, ry, pDst);
                 }
             }
         }
     }
 };
 
+template<typename TTraits, SWR_FORMAT SrcFormat, SWR_FORMAT DstFormat>
+struct OptLoadRasterTile : LoadRasterTile<TTraits, SrcFormat, DstFormat>
+{};
+
+//////////////////////////////////////////////////////////////////////////
+/// OptLoadRasterTile - SWR_TILE_MODE_NONE specialization
+/// Pixels of a row are contiguous, so the surface address is only computed
+/// once per raster tile instead of once per pixel.
+//////////////////////////////////////////////////////////////////////////
+template<int NumBits, SWR_FORMAT SrcFormat, SWR_FORMAT DstFormat>
+struct OptLoadRasterTile<TilingTraits<SWR_TILE_NONE, NumBits>, SrcFormat, DstFormat>
+{
+    typedef LoadRasterTile<TilingTraits<SWR_TILE_NONE, NumBits>, SrcFormat, DstFormat> GenericLoadTile;
+    static const size_t SRC_BYTES_PER_PIXEL = FormatTraits<SrcFormat>::bpp / 8;
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Loads an 8x8 raster tile from the src surface.
+    /// @param pSrcSurface - Src surface state
+    /// @param pDst - Destination hot tile pointer
+    /// @param x, y - Coordinates to raster tile.
+    INLINE static void Load(
+        const SWR_SURFACE_STATE* pSrcSurface,
+        uint8_t* pDst,
+        uint32_t x, uint32_t y, uint32_t sampleNum, uint32_t renderTargetArrayIndex) // (x, y) pixel coordinate to start of raster tile.
+    {
+        uint32_t lodWidth = (pSrcSurface->width == 1) ? 1 : pSrcSurface->width >> pSrcSurface->lod;
+        uint32_t lodHeight = (pSrcSurface->height == 1) ? 1 : pSrcSurface->height >> pSrcSurface->lod;
+
+        // Punt non-full tiles and block compressed / subsampled formats to generic load
+        if (FormatTraits<SrcFormat>::isBC || FormatTraits<SrcFormat>::isSubsampled ||
+            x + KNOB_TILE_X_DIM > lodWidth || y + KNOB_TILE_Y_DIM > lodHeight)
+        {
+            return GenericLoadTile::Load(pSrcSurface, pDst, x, y, sampleNum, renderTargetArrayIndex);
+        }
+
+        const uint8_t* pSrcRow = (const uint8_t*)ComputeSurfaceAddress<false, true>(x, y, pSrcSurface->arrayIndex + renderTargetArrayIndex,
+                pSrcSurface->arrayIndex + renderTargetArrayIndex, sampleNum,
+                pSrcSurface->lod, pSrcSurface);
+
+        for (uint32_t ry = 0; ry < KNOB_TILE_Y_DIM; ++ry)
+        {
+            const uint8_t* pSrc = pSrcRow;
+
+            for (uint32_t rx = 0; rx < KNOB_TILE_X_DIM; ++rx)
+            {
+                GenericLoadTile::LoadPixel(pSrc, rx, ry, pDst);
+
+                pSrc += SRC_BYTES_PER_PIXEL;
+            }
+
+            pSrcRow += pSrcSurface->pitch;
+        }
+    }
+};
+
 //////////////////////////////////////////////////////////////////////////
 /// LoadMacroTile - Loads a macro tile which consists of raster tiles.
 //////////////////////////////////////////////////////////////////////////
@@ -151,7 +257,7 @@ struct LoadMacroTile
         uint32_t x, uint32_t y, uint32_t renderTargetArrayIndex)
     {
         PFN_LOAD_RASTER_TILES loadRasterTileFn;
-        loadRasterTileFn = LoadRasterTile<TTraits, SrcFormat, DstFormat>::Load;
+        loadRasterTileFn = OptLoadRasterTile<TTraits, SrcFormat, DstFormat>::Load;
 
         // Load each raster tile from the hot tile to the destination surface.
         for (uint32_t row = 0; row < KNOB_MACROTILE_Y_DIM; row += KNOB_TILE_Y_DIM)
@@ -51,6 +51,25 @@ static void BUCKETS_STOP(UINT id)
 static std::mutex sBucketMutex;
 static std::vector<int32_t> sBuckets(NUM_SWR_FORMATS, -1);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Returns the store for a color hot tile kept in the surface format.
+/// @param tileMode - Tiling mode of the destination surface
+template<SWR_FORMAT Format>
+static PFN_STORE_TILES GetStoreTilesColorNative(SWR_TILE_MODE tileMode)
+{
+    switch (tileMode)
+    {
+    case SWR_TILE_NONE:
+        return StoreMacroTile<TilingTraits<SWR_TILE_NONE, FormatTraits<Format>::bpp>, Format, Format>::Store;
+    case SWR_TILE_MODE_YMAJOR:
+        return StoreMacroTile<TilingTraits<SWR_TILE_MODE_YMAJOR, FormatTraits<Format>::bpp>, Format, Format>::Store;
+    case SWR_TILE_MODE_XMAJOR:
+        return StoreMacroTile<TilingTraits<SWR_TILE_MODE_XMAJOR, FormatTraits<Format>::bpp>, Format, Format>::Store;
+    default:
+        return nullptr;
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Deswizzles and stores a full hottile to a render surface
 /// @param hPrivateContext - Handle to private DC
@@ -78,7 +97,26 @@ void SwrStoreHotTileToSurface(
 
     PFN_STORE_TILES pfnStoreTiles = nullptr;
 
-    if (renderTargetIndex <= SWR_ATTACHMENT_COLOR7)
+    if (renderTargetIndex <= SWR_ATTACHMENT_COLOR7 && srcFormat != KNOB_COLOR_HOT_TILE_FORMAT)
+    {
+        // hot tile is kept in the surface format, see GetColorHotTileFormat
+        SWR_ASSERT(srcFormat == pDstSurface->format);
+        switch (srcFormat)
+        {
+        case R8G8B8A8_UNORM:
+            pfnStoreTiles = GetStoreTilesColorNative<R8G8B8A8_UNORM>(pDstSurface->tileMode);
+            break;
+        case B8G8R8A8_UNORM:
+            pfnStoreTiles = GetStoreTilesColorNative<B8G8R8A8_UNORM>(pDstSurface->tileMode);
+            break;
+        case R16G16B16A16_FLOAT:
+            pfnStoreTiles = GetStoreTilesColorNative<R16G16B16A16_FLOAT>(pDstSurface->tileMode);
+            break;
+        default:
+            break;
+        }
+    }
+    else if (renderTargetIndex <= SWR_ATTACHMENT_COLOR7)
     {
         pfnStoreTiles = sStoreTilesTableColor[pDstSurface->tileMode][pDstSurface->format];
     }
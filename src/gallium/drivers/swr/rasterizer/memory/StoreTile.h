@@ -1067,6 +1067,22 @@ struct StoreRasterTile
         uint32_t x, uint32_t y,
         float outputColor[4])
     {
+        if (SrcFormat == DstFormat)
+        {
+            // hot tile is kept in the dst format, convert the raw pixel
+            OSALIGNSIMD(uint8_t) srcPixel[16];
+            GetSrcPixel(pSrc, x, y, srcPixel);
+
+            float srcColor[4];
+            ConvertPixelToFloat<SrcFormat>(srcColor, srcPixel);
+
+            for (uint32_t i = 0; i < FormatTraits<DstFormat>::numComps; ++i)
+            {
+                outputColor[i] = srcColor[FormatTraits<DstFormat>::swizzle(i)];
+            }
+            return;
+        }
+
 #if USE_8x2_TILE_BACKEND
         typedef SimdTile_16<SrcFormat, DstFormat> SimdT;
 
@@ -1098,6 +1114,37 @@ struct StoreRasterTile
 #endif
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Retrieve pixel unconverted from a hot tile kept in the dst format.
+    /// @param pSrc - Pointer to raster tile.
+    /// @param x, y - Coordinates to raster tile.
+    /// @param pDstPixel - output pixel
+    INLINE static void GetSrcPixel(
+        uint8_t* pSrc,
+        uint32_t x, uint32_t y,
+        uint8_t* pDstPixel)
+    {
+        typedef NativeSimdTile<SrcFormat> SimdT;
+
+        SimdT* pSrcSimdTiles = (SimdT*)pSrc;
+
+#if USE_8x2_TILE_BACKEND
+        // Compute which simd tile we're accessing within 8x8 tile.
+        //   i.e. Compute linear simd tile coordinate given (x, y) in pixel coordinates.
+        uint32_t simdIndex = (y / SIMD16_TILE_Y_DIM) * (KNOB_TILE_X_DIM / SIMD16_TILE_X_DIM) + (x / SIMD16_TILE_X_DIM);
+
+        uint32_t simdOffset = (y % SIMD16_TILE_Y_DIM) * SIMD16_TILE_X_DIM + (x % SIMD16_TILE_X_DIM);
+#else
+        // Compute which simd tile we're accessing within 8x8 tile.
+        //   i.e. Compute linear simd tile coordinate given (x, y) in pixel coordinates.
+        uint32_t simdIndex = (y / SIMD_TILE_Y_DIM) * (KNOB_TILE_X_DIM / SIMD_TILE_X_DIM) + (x / SIMD_TILE_X_DIM);
+
+        uint32_t simdOffset = (y % SIMD_TILE_Y_DIM) * SIMD_TILE_X_DIM + (x % SIMD_TILE_X_DIM);
+#endif
+
+        pSrcSimdTiles[simdIndex].GetPixel(simdOffset, pDstPixel);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     /// @brief Stores an 8x8 raster tile to the destination surface.
     /// @param pSrc - Pointer to raster tile.
@@ -1120,13 +1167,20 @@ struct StoreRasterTile
                 if (((x + rx) < lodWidth) &&
                     ((y + ry) < lodHeight))
                 {
-                    float srcColor[4];
-                    GetSwizzledSrcColor(pSrc, rx, ry, srcColor);
-
                     uint8_t *pDst = (uint8_t*)ComputeSurfaceAddress<false, false>((x + rx), (y + ry),
                         pDstSurface->arrayIndex + renderTargetArrayIndex, pDstSurface->arrayIndex + renderTargetArrayIndex,
                         sampleNum, pDstSurface->lod, pDstSurface);
+
+                    if (SrcFormat == DstFormat)
+                    {
+                        // hot tile is kept in the dst format, no conversion needed
+                        GetSrcPixel(pSrc, rx, ry, pDst);
+                    }
+                    else
                     {
+                        float srcColor[4];
+                        GetSwizzledSrcColor(pSrc, rx, ry, srcColor);
+
                         ConvertPixelFromFloat<DstFormat>(pDst, srcColor);
                     }
                 }
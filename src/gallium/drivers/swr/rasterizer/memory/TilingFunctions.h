@@ -254,6 +254,83 @@ struct SimdTile_16 <R8_UINT, R8_UINT>
 };
 
 #endif
+//////////////////////////////////////////////////////////////////////////
+/// NativeSimdTile - SimdTile of a hot tile kept in the surface format.
+/// Components are SOA in the same lane order as SimdTile(_16), but hold
+/// the surface bits, so pixels are copied without any conversion.
+//////////////////////////////////////////////////////////////////////////
+template<SWR_FORMAT Format>
+struct NativeSimdTile
+{
+    static const uint32_t NUM_COMPS = FormatTraits<Format>::numComps;
+    static const uint32_t BYTES_PER_COMP = FormatTraits<Format>::bpp / 8 / NUM_COMPS;
+    static_assert(BYTES_PER_COMP * 8 * NUM_COMPS == FormatTraits<Format>::bpp, "Components must be whole bytes of the same size");
+
+#if USE_8x2_TILE_BACKEND
+    static const uint32_t SIMD_WIDTH = KNOB_SIMD16_WIDTH;
+#else
+    static const uint32_t SIMD_WIDTH = KNOB_SIMD_WIDTH;
+#endif
+
+    // SimdTile is SOA (e.g. rrrrrrrr gggggggg bbbbbbbb aaaaaaaa )
+    uint8_t color[NUM_COMPS][SIMD_WIDTH * BYTES_PER_COMP];
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Converts a linear index within the simd to its lane.
+    /// @param index - linear index to color within simd.
+    INLINE static uint32_t GetLane(uint32_t index)
+    {
+        // SOA pattern for 8x2..
+        //   0 1 4 5 8 9 C D
+        //   2 3 6 7 A B E F
+        // SOA pattern for 2x2 is a subset of 4x2.
+        //   0 1 4 5
+        //   2 3 6 7
+        // The offset converts pattern to linear
+#if USE_8x2_TILE_BACKEND
+        static const uint32_t offset[] = { 0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15 };
+#elif (SIMD_TILE_X_DIM == 4)
+        static const uint32_t offset[] = { 0, 1, 4, 5, 2, 3, 6, 7 };
+#elif (SIMD_TILE_X_DIM == 2)
+        static const uint32_t offset[] = { 0, 1, 2, 3 };
+#endif
+
+        return offset[index];
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Retrieve pixel from simd in AOS surface layout.
+    /// @param index - linear index to color within simd.
+    /// @param pPixel - output pixel
+    INLINE void GetPixel(
+        uint32_t index,
+        uint8_t* pPixel) const
+    {
+        const uint32_t lane = GetLane(index);
+
+        for (uint32_t i = 0; i < NUM_COMPS; ++i)
+        {
+            memcpy(pPixel + i * BYTES_PER_COMP, &this->color[i][lane * BYTES_PER_COMP], BYTES_PER_COMP);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Store pixel in AOS surface layout to simd.
+    /// @param index - linear index to color within simd.
+    /// @param pPixel - source pixel
+    INLINE void SetPixel(
+        uint32_t index,
+        const uint8_t* pPixel)
+    {
+        const uint32_t lane = GetLane(index);
+
+        for (uint32_t i = 0; i < NUM_COMPS; ++i)
+        {
+            memcpy(&this->color[i][lane * BYTES_PER_COMP], pPixel + i * BYTES_PER_COMP, BYTES_PER_COMP);
+        }
+    }
+};
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Computes lod offset for 1D surface at specified lod.
 /// @param baseWidth - width of basemip (mip 0).
@@ -80,6 +80,19 @@ template<> struct TilingTraits <SWR_TILE_SWRZ, 32>
     static UINT GetPdepY() { return 0xC8; }
 };
 
+template<> struct TilingTraits <SWR_TILE_SWRZ, 64>
+{
+    static const SWR_TILE_MODE TileMode{ SWR_TILE_SWRZ };
+    static UINT GetCu() { return KNOB_TILE_X_DIM_SHIFT + 3; }
+    static UINT GetCv() { return KNOB_TILE_Y_DIM_SHIFT; }
+    static UINT GetCr() { return 0; }
+    static UINT GetTileIDShift() { return KNOB_TILE_X_DIM_SHIFT + KNOB_TILE_Y_DIM_SHIFT + 3; }
+
+    /// @todo correct pdep shifts for all rastertile dims.  Unused for now
+    static UINT GetPdepX() { SWR_NOT_IMPL; return 0x37; }
+    static UINT GetPdepY() { SWR_NOT_IMPL; return 0xC8; }
+};
+
 template<> struct TilingTraits <SWR_TILE_SWRZ, 128>
 {
     static const SWR_TILE_MODE TileMode{ SWR_TILE_SWRZ };
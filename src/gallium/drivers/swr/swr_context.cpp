@@ -105,28 +105,32 @@ swr_transfer_map(struct pipe_context *pipe,
    assert(resource);
    assert(level <= resource->last_level);
 
-   /* If mapping an attached rendertarget, store tiles to surface and set
-    * postStoreTileState to SWR_TILE_INVALID so tiles get reloaded on next use
-    * and nothing needs to be done at unmap. */
-   swr_store_dirty_resource(pipe, resource, SWR_TILE_INVALID);
-
-   if (!(usage & PIPE_TRANSFER_UNSYNCHRONIZED)) {
-      /* If resource is in use, finish fence before mapping.
+   /* If mapping an attached rendertarget, store the tiles covering the box
+    * to surface and set postStoreTileState to SWR_TILE_INVALID so they get
+    * reloaded on next use and nothing needs to be done at unmap.  Hot tiles
+    * outside of the box stay resident. */
+   bool still_dirty =
+      swr_store_dirty_resource_region(pipe, resource, level, box,
+                                      SWR_TILE_INVALID);
+
+   if (!(usage & PIPE_TRANSFER_UNSYNCHRONIZED) && spr->status) {
+      /* If resource is in use, wait for the last work referencing it before
+       * mapping, later work is left running.
        * Unless requested not to block, then if not done return NULL map */
-      if (usage & PIPE_TRANSFER_DONTBLOCK) {
-         if (swr_is_fence_pending(screen->flush_fence))
-            return NULL;
-      } else {
-         if (spr->status) {
-            /* But, if there's no fence pending, submit one.
-             * XXX: Remove once draw timestamps are finished. */
-            if (!swr_is_fence_pending(screen->flush_fence))
+      if (!swr_is_fence_seq_done(screen->flush_fence, spr->fence_seq)) {
+         if (usage & PIPE_TRANSFER_DONTBLOCK) {
+            /* Make sure the work gets flushed, so polling terminates */
+            if (spr->fence_seq > swr_fence(screen->flush_fence)->write)
                swr_fence_submit(swr_context(pipe), screen->flush_fence);
-
-            swr_fence_finish(pipe->screen, NULL, screen->flush_fence, 0);
-            swr_resource_unused(resource);
+            return NULL;
          }
+         swr_fence_finish_seq(swr_context(pipe), screen->flush_fence,
+                              spr->fence_seq);
       }
+      if (still_dirty)
+         spr->status = SWR_RESOURCE_WRITE;
+      else
+         swr_resource_unused(resource);
    }
 
    pt = CALLOC_STRUCT(pipe_transfer);
@@ -217,12 +217,13 @@ swr_finish(struct pipe_context *pipe)
 
 
 /*
- * Store SWR HotTiles back to renderTarget surface.
+ * Store SWR HotTiles intersecting rect back to renderTarget surface.
  */
-void
-swr_store_render_target(struct pipe_context *pipe,
-                        uint32_t attachment,
-                        enum SWR_TILE_STATE post_tile_state)
+static void
+swr_store_render_target_rect(struct pipe_context *pipe,
+                             uint32_t attachment,
+                             enum SWR_TILE_STATE post_tile_state,
+                             const SWR_RECT &rect)
 {
    struct swr_context *ctx = swr_context(pipe);
    struct swr_draw_context *pDC = &ctx->swrDC;
@@ -231,50 +232,122 @@ swr_store_render_target(struct pipe_context *pipe,
    /* Only proceed if there's a valid surface to store to */
    if (renderTarget->pBaseAddress) {
       swr_update_draw_context(ctx);
-      SWR_RECT full_rect =
-         {0, 0,
-          (int32_t)u_minify(renderTarget->width, renderTarget->lod),
-          (int32_t)u_minify(renderTarget->height, renderTarget->lod)};
       SwrStoreTiles(ctx->swrContext,
                     1 << attachment,
                     post_tile_state,
-                    full_rect);
+                    rect);
    }
 }
 
+/*
+ * Store SWR HotTiles back to renderTarget surface.
+ */
 void
-swr_store_dirty_resource(struct pipe_context *pipe,
-                         struct pipe_resource *resource,
-                         enum SWR_TILE_STATE post_tile_state)
+swr_store_render_target(struct pipe_context *pipe,
+                        uint32_t attachment,
+                        enum SWR_TILE_STATE post_tile_state)
+{
+   struct swr_context *ctx = swr_context(pipe);
+   struct SWR_SURFACE_STATE *renderTarget =
+      &ctx->swrDC.renderTargets[attachment];
+   SWR_RECT full_rect =
+      {0, 0,
+       (int32_t)u_minify(renderTarget->width, renderTarget->lod),
+       (int32_t)u_minify(renderTarget->height, renderTarget->lod)};
+
+   swr_store_render_target_rect(pipe, attachment, post_tile_state, full_rect);
+}
+
+/*
+ * Store the hot tiles of the attachments bound to resource, limited to the
+ * macrotiles intersecting box when it isn't NULL.
+ * Returns true when some dirty hot tiles were left in place.
+ */
+static bool
+swr_store_dirty_attachments(struct pipe_context *pipe,
+                            struct pipe_resource *resource,
+                            unsigned level,
+                            const struct pipe_box *box,
+                            enum SWR_TILE_STATE post_tile_state)
 {
    /* Only store resource if it has been written to */
-   if (swr_resource(resource)->status & SWR_RESOURCE_WRITE) {
-      struct swr_context *ctx = swr_context(pipe);
-      struct swr_screen *screen = swr_screen(pipe->screen);
-      struct swr_resource *spr = swr_resource(resource);
-
-      swr_draw_context *pDC = &ctx->swrDC;
-      SWR_SURFACE_STATE *renderTargets = pDC->renderTargets;
-      for (uint32_t i = 0; i < SWR_NUM_ATTACHMENTS; i++)
-         if (renderTargets[i].pBaseAddress == spr->swr.pBaseAddress ||
-             (spr->secondary.pBaseAddress &&
-              renderTargets[i].pBaseAddress == spr->secondary.pBaseAddress)) {
-            swr_store_render_target(pipe, i, post_tile_state);
-
-            /* Mesa thinks depth/stencil are fused, so we'll never get an
-             * explicit resource for stencil.  So, if checking depth, then
-             * also check for stencil. */
-            if (spr->has_stencil && (i == SWR_ATTACHMENT_DEPTH)) {
-               swr_store_render_target(
-                  pipe, SWR_ATTACHMENT_STENCIL, post_tile_state);
+   if (!(swr_resource(resource)->status & SWR_RESOURCE_WRITE))
+      return false;
+
+   struct swr_context *ctx = swr_context(pipe);
+   struct swr_screen *screen = swr_screen(pipe->screen);
+   struct swr_resource *spr = swr_resource(resource);
+
+   swr_draw_context *pDC = &ctx->swrDC;
+   SWR_SURFACE_STATE *renderTargets = pDC->renderTargets;
+   for (uint32_t i = 0; i < SWR_NUM_ATTACHMENTS; i++)
+      if (renderTargets[i].pBaseAddress == spr->swr.pBaseAddress ||
+          (spr->secondary.pBaseAddress &&
+           renderTargets[i].pBaseAddress == spr->secondary.pBaseAddress)) {
+         SWR_RECT rect =
+            {0, 0,
+             (int32_t)u_minify(renderTargets[i].width, renderTargets[i].lod),
+             (int32_t)u_minify(renderTargets[i].height, renderTargets[i].lod)};
+         bool partial = false;
+
+         if (box) {
+            /* The hot tiles only hold the level being rendered to */
+            if (level != renderTargets[i].lod)
+               return true;
+
+            if (box->x > 0 || box->y > 0 ||
+                box->x + box->width < rect.xmax ||
+                box->y + box->height < rect.ymax) {
+               rect.xmin = box->x;
+               rect.ymin = box->y;
+               rect.xmax = MIN2(box->x + box->width, rect.xmax);
+               rect.ymax = MIN2(box->y + box->height, rect.ymax);
+               partial = true;
             }
+         }
 
-            /* This fence signals StoreTiles completion */
-            swr_fence_submit(ctx, screen->flush_fence);
+         swr_store_render_target_rect(pipe, i, post_tile_state, rect);
 
-            break;
+         /* Mesa thinks depth/stencil are fused, so we'll never get an
+          * explicit resource for stencil.  So, if checking depth, then
+          * also check for stencil. */
+         if (spr->has_stencil && (i == SWR_ATTACHMENT_DEPTH)) {
+            swr_store_render_target_rect(
+               pipe, SWR_ATTACHMENT_STENCIL, post_tile_state, rect);
          }
-   }
+
+         /* This fence signals StoreTiles completion */
+         swr_fence_submit(ctx, screen->flush_fence);
+         spr->fence_seq = swr_fence(screen->flush_fence)->write;
+
+         return partial;
+      }
+
+   return false;
+}
+
+void
+swr_store_dirty_resource(struct pipe_context *pipe,
+                         struct pipe_resource *resource,
+                         enum SWR_TILE_STATE post_tile_state)
+{
+   swr_store_dirty_attachments(pipe, resource, 0, NULL, post_tile_state);
+}
+
+/*
+ * Like swr_store_dirty_resource, but only stores the macrotiles intersecting
+ * box of the given level, leaving the other hot tiles resident.
+ * Returns true if the resource still has dirty hot tiles afterwards.
+ */
+bool
+swr_store_dirty_resource_region(struct pipe_context *pipe,
+                                struct pipe_resource *resource,
+                                unsigned level,
+                                const struct pipe_box *box,
+                                enum SWR_TILE_STATE post_tile_state)
+{
+   return swr_store_dirty_attachments(pipe, resource, level, box,
+                                      post_tile_state);
 }
 
 void
@@ -132,6 +132,28 @@ swr_fence_finish(struct pipe_screen *screen,
 }
 
 
+/*
+ * Wait for the fence to signal seq, submitting it first if needed.  Unlike
+ * swr_fence_finish, work submitted after seq is not waited for.
+ */
+void
+swr_fence_finish_seq(struct swr_context *ctx,
+                     struct pipe_fence_handle *fence_handle,
+                     uint64_t seq)
+{
+   struct swr_fence *fence = swr_fence(fence_handle);
+
+   if (seq > fence->write)
+      swr_fence_submit(ctx, fence_handle);
+
+   while (!swr_is_fence_seq_done(fence_handle, seq))
+      sched_yield();
+
+   if (swr_is_fence_done(fence_handle))
+      fence->pending = FALSE;
+}
+
+
 uint64_t
 swr_get_timestamp(struct pipe_screen *screen)
 {
@@ -67,6 +67,22 @@ swr_is_fence_pending(struct pipe_fence_handle *fence_handle)
    return swr_fence(fence_handle)->pending;
 }
 
+/*
+ * Sequence number of the next submission of the fence, which will signal
+ * completion of all work queued until then.
+ */
+static INLINE uint64_t
+swr_fence_next_seq(struct pipe_fence_handle *fence_handle)
+{
+   return swr_fence(fence_handle)->write + 1;
+}
+
+static INLINE boolean
+swr_is_fence_seq_done(struct pipe_fence_handle *fence_handle, uint64_t seq)
+{
+   return swr_fence(fence_handle)->read >= seq;
+}
+
 
 void swr_fence_init(struct pipe_screen *screen);
 
@@ -84,6 +100,10 @@ boolean swr_fence_finish(struct pipe_screen *screen,
 void
 swr_fence_submit(struct swr_context *ctx, struct pipe_fence_handle *fence);
 
+void
+swr_fence_finish_seq(struct swr_context *ctx, struct pipe_fence_handle *fence,
+                     uint64_t seq);
+
 uint64_t swr_get_timestamp(struct pipe_screen *screen);
 
 #endif
@@ -54,6 +54,10 @@ struct swr_resource {
    size_t secondary_mip_offsets[PIPE_MAX_TEXTURE_LEVELS];
 
    enum swr_resource_status status;
+
+   /* Sequence number of the screen flush fence that signals completion of
+    * the last work referencing the resource, see swr_fence_next_seq */
+   uint64_t fence_seq;
 };
 
 
@@ -104,6 +108,12 @@ void swr_store_dirty_resource(struct pipe_context *pipe,
                               struct pipe_resource *resource,
                               enum SWR_TILE_STATE post_tile_state);
 
+bool swr_store_dirty_resource_region(struct pipe_context *pipe,
+                                     struct pipe_resource *resource,
+                                     unsigned level,
+                                     const struct pipe_box *box,
+                                     enum SWR_TILE_STATE post_tile_state);
+
 void swr_update_resource_status(struct pipe_context *,
                                 const struct pipe_draw_info *);
 
@@ -117,15 +127,17 @@ swr_resource_status & operator|=(enum swr_resource_status & a,
 }
 
 static INLINE void
-swr_resource_read(struct pipe_resource *resource)
+swr_resource_read(struct pipe_resource *resource, uint64_t fence_seq)
 {
    swr_resource(resource)->status |= SWR_RESOURCE_READ;
+   swr_resource(resource)->fence_seq = fence_seq;
 }
 
 static INLINE void
-swr_resource_write(struct pipe_resource *resource)
+swr_resource_write(struct pipe_resource *resource, uint64_t fence_seq)
 {
    swr_resource(resource)->status |= SWR_RESOURCE_WRITE;
+   swr_resource(resource)->fence_seq = fence_seq;
 }
 
 static INLINE void
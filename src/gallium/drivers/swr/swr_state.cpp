@@ -715,36 +715,38 @@ swr_update_resource_status(struct pipe_context *pipe,
                            const struct pipe_draw_info *p_draw_info)
 {
    struct swr_context *ctx = swr_context(pipe);
+   struct swr_screen *screen = swr_screen(pipe->screen);
    struct pipe_framebuffer_state *fb = &ctx->framebuffer;
+   uint64_t seq = swr_fence_next_seq(screen->flush_fence);
 
    /* colorbuffer targets */
    if (fb->nr_cbufs)
       for (uint32_t i = 0; i < fb->nr_cbufs; ++i)
          if (fb->cbufs[i])
-            swr_resource_write(fb->cbufs[i]->texture);
+            swr_resource_write(fb->cbufs[i]->texture, seq);
 
    /* depth/stencil target */
    if (fb->zsbuf)
-      swr_resource_write(fb->zsbuf->texture);
+      swr_resource_write(fb->zsbuf->texture, seq);
 
    /* VBO vertex buffers */
    for (uint32_t i = 0; i < ctx->num_vertex_buffers; i++) {
       struct pipe_vertex_buffer *vb = &ctx->vertex_buffer[i];
       if (!vb->is_user_buffer)
-         swr_resource_read(vb->buffer.resource);
+         swr_resource_read(vb->buffer.resource, seq);
    }
 
    /* VBO index buffer */
    if (p_draw_info && p_draw_info->index_size) {
       if (!p_draw_info->has_user_indices)
-         swr_resource_read(p_draw_info->index.resource);
+         swr_resource_read(p_draw_info->index.resource, seq);
    }
 
    /* transform feedback buffers */
    for (uint32_t i = 0; i < ctx->num_so_targets; i++) {
       struct pipe_stream_output_target *target = ctx->so_targets[i];
       if (target && target->buffer)
-         swr_resource_write(target->buffer);
+         swr_resource_write(target->buffer, seq);
    }
 
    /* texture sampler views */
@@ -752,7 +754,7 @@ swr_update_resource_status(struct pipe_context *pipe,
       for (uint32_t i = 0; i < ctx->num_sampler_views[j]; i++) {
          struct pipe_sampler_view *view = ctx->sampler_views[j][i];
          if (view)
-            swr_resource_read(view->texture);
+            swr_resource_read(view->texture, seq);
       }
    }
 
@@ -761,7 +763,7 @@ swr_update_resource_status(struct pipe_context *pipe,
       for (uint32_t i = 0; i < PIPE_MAX_CONSTANT_BUFFERS; i++) {
          struct pipe_constant_buffer *cb = &ctx->constants[j][i];
          if (cb->buffer)
-            swr_resource_read(cb->buffer);
+            swr_resource_read(cb->buffer, seq);
       }
    }
 }
@@ -1046,6 +1048,13 @@ swr_update_derived(struct pipe_context *pipe,
       for (unsigned i = fb->nr_cbufs; i < SWR_NUM_RENDERTARGETS; ++i)
          need_fence |= swr_change_rt(ctx, SWR_ATTACHMENT_COLOR0 + i, NULL);
 
+      /* let core keep color hot tiles in the target format where it can */
+      SWR_FORMAT rtFormats[SWR_NUM_RENDERTARGETS];
+      for (unsigned i = 0; i < SWR_NUM_RENDERTARGETS; ++i)
+         rtFormats[i] =
+            ctx->swrDC.renderTargets[SWR_ATTACHMENT_COLOR0 + i].format;
+      SwrSetRenderTargetFormats(ctx->swrContext, rtFormats);
+
       /* depth/stencil target */
       if (fb->zsbuf)
          desc = util_format_description(fb->zsbuf->format);
@@ -0,0 +1,233 @@
+//
+// Copyright 2026 agent <agent@local>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm-c/Core.h>
+
+#include "llvm/cache.hpp"
+#include "util/disk_cache.h"
+#include "util/mesa-sha1.h"
+
+#include <sys/stat.h>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+using namespace clover;
+using namespace clover::llvm;
+
+namespace {
+   // Builds kept in memory, the oldest ones are dropped first.
+   const unsigned max_memory_entries = 64;
+
+   struct entry {
+      module m;
+      std::string log;
+   };
+
+   std::mutex memory_mutex;
+   std::map<cache::key_type, entry> memory_entries;
+   std::deque<cache::key_type> memory_order;
+
+   uint32_t
+   function_timestamp(void *f) {
+      uint32_t timestamp;
+
+      if (!disk_cache_get_function_timestamp(f, &timestamp))
+         return 0;
+
+      return timestamp;
+   }
+
+   ///
+   /// Identifies the clover and LLVM binaries, so that their updates
+   /// invalidate all cached builds.
+   ///
+   std::string
+   build_id() {
+      static const std::string id =
+         std::to_string(function_timestamp(
+                           reinterpret_cast<void *>(&function_timestamp))) +
+         "_" + std::to_string(function_timestamp(
+                                 reinterpret_cast<void *>(&LLVMContextCreate))) +
+         "_" LLVM_VERSION_STRING;
+
+      return id;
+   }
+
+   struct disk_cache *
+   get_disk_cache() {
+      static struct disk_cache *const cache =
+         function_timestamp(reinterpret_cast<void *>(&function_timestamp)) ?
+         disk_cache_create("clover", build_id().c_str(), 0) : NULL;
+
+      return cache;
+   }
+
+   std::string
+   libclc_id(const std::string &target) {
+      const std::string path = LIBCLC_LIBEXECDIR + target + ".bc";
+      struct stat st;
+
+      if (stat(path.c_str(), &st))
+         return path;
+
+      return path + ":" + std::to_string(st.st_mtime) + ":" +
+         std::to_string(st.st_size);
+   }
+
+   void
+   put_memory_entry(const cache::key_type &key, const module &m,
+                    const std::string &log) {
+      std::lock_guard<std::mutex> lock(memory_mutex);
+
+      if (memory_entries.count(key))
+         return;
+
+      if (memory_order.size() == max_memory_entries) {
+         memory_entries.erase(memory_order.front());
+         memory_order.pop_front();
+      }
+
+      memory_entries[key] = { m, log };
+      memory_order.push_back(key);
+   }
+
+   template<typename T>
+   void
+   write_string(std::ostream &os, const std::string &s) {
+      const T size = s.size();
+      os.write(reinterpret_cast<const char *>(&size), sizeof(size));
+      os.write(s.data(), s.size());
+   }
+}
+
+cache::key_type
+cache::compute_key(const std::string &target,
+                   const std::vector<std::string> &inputs) {
+   std::ostringstream os;
+   unsigned char sha1[20];
+
+   // Prefix everything with its size so that the concatenation is
+   // unambiguous.
+   write_string<uint64_t>(os, build_id());
+   write_string<uint64_t>(os, libclc_id(target));
+   write_string<uint64_t>(os, target);
+
+   for (auto &s : inputs)
+      write_string<uint64_t>(os, s);
+
+   const std::string data = os.str();
+   _mesa_sha1_compute(data.data(), data.size(), sha1);
+
+   return { reinterpret_cast<const char *>(sha1), sizeof(sha1) };
+}
+
+cache::key_type
+cache::compile_key(const std::string &target, const std::string &opts,
+                   const std::string &source, const header_map &headers) {
+   std::vector<std::string> inputs = { "compile", opts, source };
+
+   for (auto &header : headers) {
+      inputs.push_back(header.first);
+      inputs.push_back(header.second);
+   }
+
+   return compute_key(target, inputs);
+}
+
+cache::key_type
+cache::link_key(const std::string &target, const std::string &opts,
+                enum pipe_shader_ir ir, const std::vector<module> &modules) {
+   std::vector<std::string> inputs = { "link", std::to_string(ir), opts };
+
+   for (auto &m : modules) {
+      std::ostringstream os;
+      m.serialize(os);
+      inputs.push_back(os.str());
+   }
+
+   return compute_key(target, inputs);
+}
+
+bool
+cache::get(const key_type &key, module &m, std::string &log) {
+   {
+      std::lock_guard<std::mutex> lock(memory_mutex);
+      auto it = memory_entries.find(key);
+
+      if (it != memory_entries.end()) {
+         m = it->second.m;
+         log = it->second.log;
+         return true;
+      }
+   }
+
+   if (auto disk = get_disk_cache()) {
+      size_t size;
+      char *data = reinterpret_cast<char *>(
+         disk_cache_get(disk, reinterpret_cast<const uint8_t *>(key.data()),
+                        &size));
+
+      if (data) {
+         std::istringstream is(std::string(data, size));
+         uint64_t log_size;
+
+         std::free(data);
+
+         try {
+            is.read(reinterpret_cast<char *>(&log_size), sizeof(log_size));
+            log.resize(log_size);
+            is.read(&log[0], log_size);
+            m = module::deserialize(is);
+         } catch (...) {
+            return false;
+         }
+
+         if (!is)
+            return false;
+
+         put_memory_entry(key, m, log);
+         return true;
+      }
+   }
+
+   return false;
+}
+
+void
+cache::put(const key_type &key, const module &m, const std::string &log) {
+   put_memory_entry(key, m, log);
+
+   if (auto disk = get_disk_cache()) {
+      std::ostringstream os;
+
+      write_string<uint64_t>(os, log);
+      m.serialize(os);
+
+      const std::string data = os.str();
+      disk_cache_put(disk, reinterpret_cast<const uint8_t *>(key.data()),
+                     data.data(), data.size());
+   }
+}
@@ -0,0 +1,78 @@
+//
+// Copyright 2026 agent <agent@local>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef CLOVER_LLVM_CACHE_HPP
+#define CLOVER_LLVM_CACHE_HPP
+
+#include "core/module.hpp"
+#include "core/program.hpp"
+#include "pipe/p_defines.h"
+
+#include <string>
+#include <vector>
+
+namespace clover {
+   namespace llvm {
+      ///
+      /// Cache of built modules, kept in memory for the lifetime of the
+      /// process and in the on-disk shader cache across runs.
+      ///
+      namespace cache {
+         typedef std::string key_type;
+
+         ///
+         /// Compute the key for a build for \a target from all of its
+         /// \a inputs.  The versions of clover, LLVM and libclc are
+         /// accounted for automatically.
+         ///
+         key_type
+         compute_key(const std::string &target,
+                     const std::vector<std::string> &inputs);
+
+         ///
+         /// Compute the key for compiling \a source with \a headers.
+         ///
+         key_type
+         compile_key(const std::string &target, const std::string &opts,
+                     const std::string &source, const header_map &headers);
+
+         ///
+         /// Compute the key for linking \a modules into \a ir.
+         ///
+         key_type
+         link_key(const std::string &target, const std::string &opts,
+                  enum pipe_shader_ir ir, const std::vector<module> &modules);
+
+         ///
+         /// Look up a build, returning true and filling in \a m and
+         /// \a log on a hit.
+         ///
+         bool
+         get(const key_type &key, module &m, std::string &log);
+
+         void
+         put(const key_type &key, const module &m, const std::string &log);
+      }
+   }
+}
+
+#endif
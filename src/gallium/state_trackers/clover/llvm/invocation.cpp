@@ -46,6 +46,7 @@
 // Which will break the compilation of clang/Basic/OpenCLOptions.h
 
 #include "core/error.hpp"
+#include "llvm/cache.hpp"
 #include "llvm/codegen.hpp"
 #include "llvm/compat.hpp"
 #include "llvm/invocation.hpp"
@@ -93,6 +94,23 @@ namespace {
       return ctx;
    }
 
+   ///
+   /// Look up a previous build with the same inputs.  The cache is
+   /// bypassed when the intermediate code is dumped for debugging.
+   ///
+   std::unique_ptr<module>
+   lookup_cached(const cache::key_type &key, std::string &r_log) {
+      std::unique_ptr<module> m { new module };
+      std::string log;
+
+      if (has_flag(debug::llvm) || has_flag(debug::native) ||
+          !cache::get(key, *m, log))
+         return nullptr;
+
+      r_log += log;
+      return m;
+   }
+
    std::unique_ptr<clang::CompilerInstance>
    create_compiler_instance(const target &target,
                             const std::vector<std::string> &opts,
@@ -207,6 +225,11 @@ clover::llvm::compile_program(const std::string &source,
    if (has_flag(debug::clc))
       debug::log(".cl", "// Options: " + opts + '\n' + source);
 
+   const auto key = cache::compile_key(target, opts, source, headers);
+   if (auto m = lookup_cached(key, r_log))
+      return *m;
+
+   const auto log_start = r_log.size();
    auto ctx = create_context(r_log);
    auto c = create_compiler_instance(target, tokenize(opts + " input.cl"),
                                      r_log);
@@ -216,7 +239,10 @@ clover::llvm::compile_program(const std::string &source,
    if (has_flag(debug::llvm))
       debug::log(".ll", print_module_bitcode(*mod));
 
-   return build_module_library(*mod, module::section::text_intermediate);
+   const module m = build_module_library(*mod,
+                                         module::section::text_intermediate);
+   cache::put(key, m, r_log.substr(log_start));
+   return m;
 }
 
 namespace {
@@ -271,6 +297,11 @@ module
 clover::llvm::link_program(const std::vector<module> &modules,
                            enum pipe_shader_ir ir, const std::string &target,
                            const std::string &opts, std::string &r_log) {
+   const auto key = cache::link_key(target, opts, ir, modules);
+   if (auto m = lookup_cached(key, r_log))
+      return *m;
+
+   const auto log_start = r_log.size();
    std::vector<std::string> options = tokenize(opts + " input.cl");
    const bool create_library = count("-create-library", options);
    erase_if(equals("-create-library"), options);
@@ -288,19 +319,24 @@ clover::llvm::link_program(const std::vector<module> &modules,
    if (has_flag(debug::llvm))
       debug::log(id + ".ll", print_module_bitcode(*mod));
 
+   module m;
+
    if (create_library) {
-      return build_module_library(*mod, module::section::text_library);
+      m = build_module_library(*mod, module::section::text_library);
 
    } else if (ir == PIPE_SHADER_IR_LLVM) {
-      return build_module_bitcode(*mod, *c);
+      m = build_module_bitcode(*mod, *c);
 
    } else if (ir == PIPE_SHADER_IR_NATIVE) {
       if (has_flag(debug::native))
          debug::log(id +  ".asm", print_module_native(*mod, target));
 
-      return build_module_native(*mod, target, *c, r_log);
+      m = build_module_native(*mod, target, *c, r_log);
 
    } else {
       unreachable("Unsupported IR.");
    }
+
+   cache::put(key, m, r_log.substr(log_start));
+   return m;
 }
@@ -0,0 +1,205 @@
+//
+// Copyright 2026 agent <agent@local>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+
+//
+// The build cache is exercised through the invocation layer without a
+// device.  Every build uses an option clang rejects, so a cache miss
+// throws invalid_build_options_error from the option parser while a hit
+// returns the seeded module without reaching clang at all.
+//
+
+#include <gtest/gtest.h>
+
+#include "llvm/cache.hpp"
+#include "llvm/invocation.hpp"
+
+#include <cstdlib>
+#include <sstream>
+
+using namespace clover;
+
+namespace {
+   const std::string target = "tahiti-amdgcn--";
+   const std::string opts = "-clover-test-invalid-option";
+
+   module
+   make_module(const std::string &contents) {
+      module m;
+      const std::vector<char> data(contents.begin(), contents.end());
+
+      m.secs.push_back({ 0, module::section::text_intermediate,
+                         static_cast<module::size_t>(data.size()), data });
+      return m;
+   }
+
+   std::string
+   serialize(const module &m) {
+      std::ostringstream os;
+      m.serialize(os);
+      return os.str();
+   }
+}
+
+class clover_cache : public ::testing::Test {
+public:
+   static void
+   SetUpTestCase() {
+      // Keep the test hermetic: only the in-memory cache is used.
+      setenv("MESA_GLSL_CACHE_DISABLE", "1", 1);
+   }
+};
+
+TEST_F(clover_cache, key_is_stable)
+{
+   const header_map headers = { { "a.h", "#define A 1" } };
+
+   EXPECT_EQ(llvm::cache::compile_key(target, opts, "kernel", headers),
+             llvm::cache::compile_key(target, opts, "kernel", headers));
+}
+
+TEST_F(clover_cache, get_misses_unknown_key)
+{
+   module m;
+   std::string log;
+
+   EXPECT_FALSE(llvm::cache::get(
+                   llvm::cache::compile_key(target, opts, "unknown", {}),
+                   m, log));
+}
+
+TEST_F(clover_cache, compile_hit)
+{
+   const std::string source = "compile_hit";
+   const module seeded = make_module("compiled");
+   std::string log = "previous\n";
+
+   llvm::cache::put(llvm::cache::compile_key(target, opts, source, {}),
+                    seeded, "cached log\n");
+
+   const module m = llvm::compile_program(source, {}, target, opts, log);
+
+   EXPECT_EQ(serialize(seeded), serialize(m));
+   EXPECT_EQ("previous\ncached log\n", log);
+}
+
+TEST_F(clover_cache, compile_miss)
+{
+   std::string log;
+
+   EXPECT_THROW(llvm::compile_program("compile_miss", {}, target, opts, log),
+                invalid_build_options_error);
+}
+
+TEST_F(clover_cache, compile_option_change_invalidates)
+{
+   const std::string source = "compile_option_change";
+   std::string log;
+
+   llvm::cache::put(llvm::cache::compile_key(target, opts, source, {}),
+                    make_module("compiled"), "");
+
+   EXPECT_NO_THROW(llvm::compile_program(source, {}, target, opts, log));
+   EXPECT_THROW(llvm::compile_program(source, {}, target, opts + " -DX",
+                                      log),
+                invalid_build_options_error);
+}
+
+TEST_F(clover_cache, compile_source_change_invalidates)
+{
+   const std::string source = "compile_source_change";
+   std::string log;
+
+   llvm::cache::put(llvm::cache::compile_key(target, opts, source, {}),
+                    make_module("compiled"), "");
+
+   EXPECT_NO_THROW(llvm::compile_program(source, {}, target, opts, log));
+   EXPECT_THROW(llvm::compile_program(source + " ", {}, target, opts, log),
+                invalid_build_options_error);
+}
+
+TEST_F(clover_cache, compile_header_change_invalidates)
+{
+   const std::string source = "compile_header_change";
+   const header_map headers = { { "a.h", "#define A 1" } };
+   const header_map changed = { { "a.h", "#define A 2" } };
+   std::string log;
+
+   llvm::cache::put(llvm::cache::compile_key(target, opts, source, headers),
+                    make_module("compiled"), "");
+
+   EXPECT_NO_THROW(llvm::compile_program(source, headers, target, opts, log));
+   EXPECT_THROW(llvm::compile_program(source, changed, target, opts, log),
+                invalid_build_options_error);
+}
+
+TEST_F(clover_cache, compile_target_change_invalidates)
+{
+   const std::string source = "compile_target_change";
+   std::string log;
+
+   llvm::cache::put(llvm::cache::compile_key(target, opts, source, {}),
+                    make_module("compiled"), "");
+
+   EXPECT_THROW(llvm::compile_program(source, {}, "pitcairn-amdgcn--", opts,
+                                      log),
+                invalid_build_options_error);
+}
+
+TEST_F(clover_cache, link_hit)
+{
+   const std::vector<module> modules = { make_module("link_hit") };
+   const module seeded = make_module("linked");
+   std::string log;
+
+   llvm::cache::put(llvm::cache::link_key(target, opts, PIPE_SHADER_IR_NATIVE,
+                                          modules),
+                    seeded, "cached log\n");
+
+   const module m = llvm::link_program(modules, PIPE_SHADER_IR_NATIVE,
+                                       target, opts, log);
+
+   EXPECT_EQ(serialize(seeded), serialize(m));
+   EXPECT_EQ("cached log\n", log);
+}
+
+TEST_F(clover_cache, link_input_change_invalidates)
+{
+   const std::vector<module> modules = { make_module("link_input_change") };
+   const std::vector<module> changed = { make_module("link_input_change2") };
+   std::string log;
+
+   llvm::cache::put(llvm::cache::link_key(target, opts, PIPE_SHADER_IR_NATIVE,
+                                          modules),
+                    make_module("linked"), "");
+
+   EXPECT_NO_THROW(llvm::link_program(modules, PIPE_SHADER_IR_NATIVE,
+                                      target, opts, log));
+   EXPECT_THROW(llvm::link_program(changed, PIPE_SHADER_IR_NATIVE,
+                                   target, opts, log),
+                invalid_build_options_error);
+   EXPECT_THROW(llvm::link_program(modules, PIPE_SHADER_IR_LLVM,
+                                   target, opts, log),
+                invalid_build_options_error);
+   EXPECT_THROW(llvm::link_program(modules, PIPE_SHADER_IR_NATIVE,
+                                   target, opts + " -DX", log),
+                invalid_build_options_error);
+}
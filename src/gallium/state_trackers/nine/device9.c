@@ -579,12 +579,6 @@ NineDevice9_GetScreen( struct NineDevice9 *This )
     return This->screen;
 }
 
-struct pipe_context *
-NineDevice9_GetPipe( struct NineDevice9 *This )
-{
-    return nine_context_get_pipe(This);
-}
-
 const D3DCAPS9 *
 NineDevice9_GetCaps( struct NineDevice9 *This )
 {
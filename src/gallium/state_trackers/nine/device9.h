@@ -201,8 +201,8 @@ NineDevice9_SetDefaultState( struct NineDevice9 *This, boolean is_reset );
 struct pipe_screen *
 NineDevice9_GetScreen( struct NineDevice9 *This );
 
-struct pipe_context *
-NineDevice9_GetPipe( struct NineDevice9 *This );
+/* A macro so that the CSMT sync statistics see the real caller */
+#define NineDevice9_GetPipe(This) nine_context_get_pipe(This)
 
 const D3DCAPS9 *
 NineDevice9_GetCaps( struct NineDevice9 *This );
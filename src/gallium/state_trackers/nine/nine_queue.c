@@ -23,6 +23,7 @@
 #include "nine_queue.h"
 #include "os/os_thread.h"
 #include "util/macros.h"
+#include "util/u_atomic.h"
 #include "nine_helpers.h"
 
 #define NINE_CMD_BUF_INSTR (256)
@@ -56,6 +57,15 @@
  * Constrains:
  * Only a single consumer and a single producer are supported.
  *
+ * Handing a cmdbuf over doesn't take any lock: the full flags are changed
+ * with atomics, and a side only takes the mutex to signal the other side
+ * when that one announced it is going to sleep (worker_wait and
+ * producer_wait).  Both the flag update and the announcement are full
+ * barriers, so either the sleeper sees the new flag state before waiting,
+ * or the other side sees the announcement and wakes it up.  The flags are
+ * read with acquire semantics, so a side seeing a cmdbuf handed over also
+ * sees what was written to it.
+ *
  */
 
 struct nine_cmdbuf {
@@ -63,7 +73,7 @@ struct nine_cmdbuf {
     unsigned num_instr;
     unsigned offset;
     void *mem_pool;
-    BOOL full;
+    int full;
 };
 
 struct nine_queue_pool {
@@ -71,13 +81,27 @@ struct nine_queue_pool {
     unsigned head;
     unsigned tail;
     unsigned cur_instr;
-    BOOL worker_wait;
+    int worker_wait;
+    int producer_wait;
+    struct nine_queue_stats stats;
     cnd_t event_pop;
     cnd_t event_push;
     mtx_t mutex_pop;
     mtx_t mutex_push;
 };
 
+/* Reads the full flag of a cmdbuf with acquire semantics, pairing with the
+ * barrier of the other side's update: once the new state of the flag is
+ * seen, so is everything written to the cmdbuf before.  p_atomic_read() is
+ * only an acquire load with the GCC atomic builtins, so use a
+ * compare-and-swap that never swaps.
+ */
+static inline int
+cmdbuf_full(struct nine_cmdbuf *cmdbuf)
+{
+    return p_atomic_cmpxchg(&cmdbuf->full, 0, 0);
+}
+
 /* Consumer functions: */
 void
 nine_queue_wait_flush(struct nine_queue_pool* ctx)
@@ -85,14 +109,19 @@ nine_queue_wait_flush(struct nine_queue_pool* ctx)
     struct nine_cmdbuf *cmdbuf = &ctx->pool[ctx->tail];
 
     /* wait for cmdbuf full */
-    mtx_lock(&ctx->mutex_push);
-    while (!cmdbuf->full)
-    {
-        DBG("waiting for full cmdbuf\n");
-        cnd_wait(&ctx->event_push, &ctx->mutex_push);
+    if (!cmdbuf_full(cmdbuf)) {
+        mtx_lock(&ctx->mutex_push);
+        p_atomic_inc(&ctx->worker_wait);
+        while (!cmdbuf_full(cmdbuf))
+        {
+            DBG("waiting for full cmdbuf\n");
+            ctx->stats.worker_sleeps++;
+            cnd_wait(&ctx->event_push, &ctx->mutex_push);
+        }
+        p_atomic_dec(&ctx->worker_wait);
+        mtx_unlock(&ctx->mutex_push);
     }
     DBG("got cmdbuf=%p\n", cmdbuf);
-    mtx_unlock(&ctx->mutex_push);
 
     cmdbuf->offset = 0;
     ctx->cur_instr = 0;
@@ -110,12 +139,15 @@ nine_queue_get(struct nine_queue_pool* ctx)
     /* At this pointer there's always a cmdbuf. */
 
     if (ctx->cur_instr == cmdbuf->num_instr) {
-        /* signal waiting producer */
-        mtx_lock(&ctx->mutex_pop);
         DBG("freeing cmdbuf=%p\n", cmdbuf);
-        cmdbuf->full = 0;
-        cnd_signal(&ctx->event_pop);
-        mtx_unlock(&ctx->mutex_pop);
+        p_atomic_dec(&cmdbuf->full);
+
+        /* signal waiting producer */
+        if (p_atomic_read(&ctx->producer_wait)) {
+            mtx_lock(&ctx->mutex_pop);
+            cnd_signal(&ctx->event_pop);
+            mtx_unlock(&ctx->mutex_pop);
+        }
 
         ctx->tail = (ctx->tail + 1) & NINE_CMD_BUFS_MASK;
 
@@ -147,25 +179,37 @@ nine_queue_flush(struct nine_queue_pool* ctx)
     if (!cmdbuf->num_instr)
         return;
 
+    ctx->stats.flushes++;
+    ctx->stats.instructions += cmdbuf->num_instr;
+
+    p_atomic_inc(&cmdbuf->full);
+
     /* signal waiting worker */
-    mtx_lock(&ctx->mutex_push);
-    cmdbuf->full = 1;
-    cnd_signal(&ctx->event_push);
-    mtx_unlock(&ctx->mutex_push);
+    if (p_atomic_read(&ctx->worker_wait)) {
+        mtx_lock(&ctx->mutex_push);
+        cnd_signal(&ctx->event_push);
+        mtx_unlock(&ctx->mutex_push);
+        ctx->stats.wakeups++;
+    }
 
     ctx->head = (ctx->head + 1) & NINE_CMD_BUFS_MASK;
 
     cmdbuf = &ctx->pool[ctx->head];
 
     /* wait for queue empty */
-    mtx_lock(&ctx->mutex_pop);
-    while (cmdbuf->full)
-    {
-        DBG("waiting for empty cmdbuf\n");
-        cnd_wait(&ctx->event_pop, &ctx->mutex_pop);
+    if (cmdbuf_full(cmdbuf)) {
+        mtx_lock(&ctx->mutex_pop);
+        p_atomic_inc(&ctx->producer_wait);
+        while (cmdbuf_full(cmdbuf))
+        {
+            DBG("waiting for empty cmdbuf\n");
+            ctx->stats.producer_stalls++;
+            cnd_wait(&ctx->event_pop, &ctx->mutex_pop);
+        }
+        p_atomic_dec(&ctx->producer_wait);
+        mtx_unlock(&ctx->mutex_pop);
     }
     DBG("got empty cmdbuf=%p\n", cmdbuf);
-    mtx_unlock(&ctx->mutex_pop);
     cmdbuf->offset = 0;
     cmdbuf->num_instr = 0;
 }
@@ -224,6 +268,14 @@ nine_queue_isempty(struct nine_queue_pool* ctx)
     return (ctx->tail == ctx->head) && !cmdbuf->num_instr;
 }
 
+/* Returns the queue statistics.
+ * The worker side counters are only exact once the worker is idle. */
+const struct nine_queue_stats *
+nine_queue_get_stats(struct nine_queue_pool* ctx)
+{
+    return &ctx->stats;
+}
+
 struct nine_queue_pool*
 nine_queue_create(void)
 {
@@ -246,9 +298,6 @@ nine_queue_create(void)
     cnd_init(&ctx->event_push);
     (void) mtx_init(&ctx->mutex_push, mtx_plain);
 
-    /* Block until first cmdbuf has been flushed. */
-    ctx->worker_wait = TRUE;
-
     return ctx;
 failed:
     if (ctx) {
@@ -266,7 +315,9 @@ nine_queue_delete(struct nine_queue_pool *ctx)
 {
     unsigned i;
     mtx_destroy(&ctx->mutex_pop);
+    cnd_destroy(&ctx->event_pop);
     mtx_destroy(&ctx->mutex_push);
+    cnd_destroy(&ctx->event_push);
 
     for (i = 0; i < NINE_CMD_BUFS; i++)
         FREE(ctx->pool[i].mem_pool);
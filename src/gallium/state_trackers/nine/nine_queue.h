@@ -27,6 +27,14 @@
 
 struct nine_queue_pool;
 
+struct nine_queue_stats {
+    unsigned flushes;         /* cmdbufs handed to the worker */
+    unsigned instructions;    /* instructions in those cmdbufs */
+    unsigned wakeups;         /* flushes that had to wake the worker */
+    unsigned worker_sleeps;   /* times the worker waited for a cmdbuf */
+    unsigned producer_stalls; /* times the producer waited for a free cmdbuf */
+};
+
 void
 nine_queue_wait_flush(struct nine_queue_pool* ctx);
 
@@ -45,6 +53,9 @@ nine_queue_no_flushed_work(struct nine_queue_pool* ctx);
 bool
 nine_queue_isempty(struct nine_queue_pool* ctx);
 
+const struct nine_queue_stats *
+nine_queue_get_stats(struct nine_queue_pool* ctx);
+
 struct nine_queue_pool*
 nine_queue_create(void);
 
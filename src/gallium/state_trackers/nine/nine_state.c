@@ -44,6 +44,7 @@
 #include "util/u_math.h"
 #include "util/u_box.h"
 #include "util/u_simple_shaders.h"
+#include "util/u_surface.h"
 #include "util/u_gen_mipmap.h"
 
 /* CSMT headers */
@@ -59,6 +60,15 @@ struct csmt_instruction {
     int (* func)(struct NineDevice9 *This, struct csmt_instruction *instr);
 };
 
+/* Forced syncs are counted per caller, the rest goes to the last slot */
+#define NINE_CSMT_SYNC_SITES 32
+
+struct csmt_sync_site {
+    const char *caller;
+    unsigned process;
+    unsigned pause;
+};
+
 struct csmt_context {
     thrd_t worker;
     struct nine_queue_pool* pool;
@@ -71,8 +81,58 @@ struct csmt_context {
     BOOL hasPaused;
     mtx_t thread_running;
     mtx_t thread_resume;
+    boolean stats;
+    unsigned num_sites;
+    struct csmt_sync_site sites[NINE_CSMT_SYNC_SITES];
 };
 
+/* Called from the main thread only. */
+static void
+nine_csmt_count_sync(struct csmt_context *ctx, const char *caller,
+                     boolean pause)
+{
+    struct csmt_sync_site *site;
+    unsigned i;
+
+    if (!ctx->stats)
+        return;
+
+    for (i = 0; i < ctx->num_sites; i++) {
+        if (ctx->sites[i].caller == caller ||
+            !strcmp(ctx->sites[i].caller, caller))
+            break;
+    }
+    if (i == NINE_CSMT_SYNC_SITES) {
+        i = NINE_CSMT_SYNC_SITES - 1;
+    } else if (i == ctx->num_sites) {
+        ctx->sites[i].caller = i == NINE_CSMT_SYNC_SITES - 1 ?
+            "(other)" : caller;
+        ctx->num_sites++;
+    }
+
+    site = &ctx->sites[i];
+    if (pause)
+        site->pause++;
+    else
+        site->process++;
+}
+
+static void
+nine_csmt_dump_stats(struct csmt_context *ctx)
+{
+    const struct nine_queue_stats *stats = nine_queue_get_stats(ctx->pool);
+    unsigned i;
+
+    _debug_printf("nine: CSMT queue: %u flushes, %u instructions, "
+                  "%u worker wakeups, %u worker sleeps, %u producer stalls\n",
+                  stats->flushes, stats->instructions, stats->wakeups,
+                  stats->worker_sleeps, stats->producer_stalls);
+    for (i = 0; i < ctx->num_sites; i++)
+        _debug_printf("nine: CSMT sync %-40s %8u waits %8u pauses\n",
+                      ctx->sites[i].caller, ctx->sites[i].process,
+                      ctx->sites[i].pause);
+}
+
 /* Wait for instruction to be processed.
  * Caller has to ensure that only one thread waits at time.
  */
@@ -162,6 +222,7 @@ nine_csmt_create( struct NineDevice9 *This )
 #endif
 
     ctx->device = This;
+    ctx->stats = debug_get_bool_option("NINE_CSMT_STATS", FALSE);
 
     ctx->worker = u_thread_create(nine_csmt_worker, ctx);
     if (!ctx->worker) {
@@ -187,7 +248,7 @@ nop_func( struct NineDevice9 *This, struct csmt_instruction *instr )
 /* Push nop instruction and flush the queue.
  * Waits for the worker to complete. */
 void
-nine_csmt_process( struct NineDevice9 *device )
+nine_csmt_process_from( struct NineDevice9 *device, const char *caller )
 {
     struct csmt_instruction* instr;
     struct csmt_context *ctx = device->csmt_ctx;
@@ -198,7 +259,8 @@ nine_csmt_process( struct NineDevice9 *device )
     if (nine_queue_isempty(ctx->pool))
         return;
 
-    DBG("device=%p\n", device);
+    DBG("device=%p caller=%s\n", device, caller);
+    nine_csmt_count_sync(ctx, caller, FALSE);
 
     /* NOP */
     instr = nine_queue_alloc(ctx->pool, sizeof(struct csmt_instruction));
@@ -233,6 +295,8 @@ nine_csmt_destroy( struct NineDevice9 *device, struct csmt_context *ctx )
     nine_queue_flush(ctx->pool);
 
     nine_csmt_wait_processed(ctx);
+    if (ctx->stats)
+        nine_csmt_dump_stats(ctx);
     nine_queue_delete(ctx->pool);
     mtx_destroy(&ctx->mutex_processed);
 
@@ -242,7 +306,7 @@ nine_csmt_destroy( struct NineDevice9 *device, struct csmt_context *ctx )
 }
 
 static void
-nine_csmt_pause( struct NineDevice9 *device )
+nine_csmt_pause( struct NineDevice9 *device, const char *caller )
 {
     struct csmt_context *ctx = device->csmt_ctx;
 
@@ -253,6 +317,8 @@ nine_csmt_pause( struct NineDevice9 *device )
     if (nine_queue_no_flushed_work(ctx->pool))
         return;
 
+    nine_csmt_count_sync(ctx, caller, TRUE);
+
     mtx_lock(&ctx->thread_resume);
     p_atomic_set(&ctx->toPause, TRUE);
 
@@ -279,9 +345,9 @@ nine_csmt_resume( struct NineDevice9 *device )
 }
 
 struct pipe_context *
-nine_context_get_pipe( struct NineDevice9 *device )
+nine_context_get_pipe_from( struct NineDevice9 *device, const char *caller )
 {
-    nine_csmt_process(device);
+    nine_csmt_process_from(device, caller);
     return device->context.pipe;
 }
 
@@ -300,9 +366,10 @@ nine_context_get_pipe_multithread( struct NineDevice9 *device )
 }
 
 struct pipe_context *
-nine_context_get_pipe_acquire( struct NineDevice9 *device )
+nine_context_get_pipe_acquire_from( struct NineDevice9 *device,
+                                    const char *caller )
 {
-    nine_csmt_pause(device);
+    nine_csmt_pause(device, caller);
     return device->context.pipe;
 }
 
@@ -2771,6 +2838,40 @@ CSMT_ITEM_NO_WAIT_WITH_COUNTER(nine_context_box_upload,
     pipe_transfer_unmap(pipe, transfer);
 }
 
+/* Copies res into system memory in the worker, so that reading back a
+ * render target doesn't have to wait for it.  counter is the one of the
+ * destination, so that locking it waits for the copy. */
+CSMT_ITEM_NO_WAIT_WITH_COUNTER(nine_context_box_download,
+                               ARG_BIND_REF(struct NineUnknown, src),
+                               ARG_BIND_REF(struct NineUnknown, dst),
+                               ARG_BIND_RES(struct pipe_resource, res),
+                               ARG_VAL(unsigned, level),
+                               ARG_COPY_REF(struct pipe_box, src_box),
+                               ARG_VAL(enum pipe_format, format),
+                               ARG_VAL(void *, data),
+                               ARG_VAL(unsigned, stride))
+{
+    struct nine_context *context = &device->context;
+    struct pipe_context *pipe = context->pipe;
+    struct pipe_transfer *transfer = NULL;
+    const uint8_t *map;
+
+    /* We just bind src and dst for the bind count */
+    (void)src;
+    (void)dst;
+
+    map = pipe->transfer_map(pipe, res, level, PIPE_TRANSFER_READ,
+                             src_box, &transfer);
+    if (!map)
+        return;
+
+    util_copy_rect(data, format, stride, 0, 0,
+                   src_box->width, src_box->height,
+                   map, transfer->stride, 0, 0);
+
+    pipe_transfer_unmap(pipe, transfer);
+}
+
 struct pipe_query *
 nine_context_create_query(struct NineDevice9 *device, unsigned query_type)
 {
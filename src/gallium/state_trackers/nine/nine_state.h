@@ -564,6 +564,17 @@ nine_context_range_upload(struct NineDevice9 *device,
                           unsigned size,
                           const void *data);
 
+void
+nine_context_box_download(struct NineDevice9 *device,
+                          unsigned *counter,
+                          struct NineUnknown *src,
+                          struct NineUnknown *dst,
+                          struct pipe_resource *res,
+                          unsigned level,
+                          const struct pipe_box *src_box,
+                          enum pipe_format format,
+                          void *data, unsigned stride);
+
 void
 nine_context_box_upload(struct NineDevice9 *device,
                         unsigned *counter,
@@ -633,14 +644,22 @@ nine_csmt_create( struct NineDevice9 *This );
 void
 nine_csmt_destroy( struct NineDevice9 *This, struct csmt_context *ctx );
 
+/* The nine_csmt_process, nine_context_get_pipe and
+ * nine_context_get_pipe_acquire macros pass their caller along, so that
+ * NINE_CSMT_STATS=1 can report where the worker thread gets waited for. */
 void
-nine_csmt_process( struct NineDevice9 *This );
+nine_csmt_process_from( struct NineDevice9 *This, const char *caller );
+
+#define nine_csmt_process(This) nine_csmt_process_from(This, __func__)
 
 
 /* Get the pipe_context (should not be called from the worker thread).
  * All the work in the worker thread is finished before returning. */
 struct pipe_context *
-nine_context_get_pipe( struct NineDevice9 *device );
+nine_context_get_pipe_from( struct NineDevice9 *device, const char *caller );
+
+#define nine_context_get_pipe(device) \
+    nine_context_get_pipe_from(device, __func__)
 
 /* Can be called from all threads */
 struct pipe_context *
@@ -653,7 +672,11 @@ nine_context_get_pipe_multithread( struct NineDevice9 *device );
  * This is intended for use of the nine_context pipe_context that don't
  * need the worker thread to finish all queued job. */
 struct pipe_context *
-nine_context_get_pipe_acquire( struct NineDevice9 *device );
+nine_context_get_pipe_acquire_from( struct NineDevice9 *device,
+                                    const char *caller );
+
+#define nine_context_get_pipe_acquire(device) \
+    nine_context_get_pipe_acquire_from(device, __func__)
 
 void
 nine_context_get_pipe_release( struct NineDevice9 *device );
@@ -683,12 +683,7 @@ void
 NineSurface9_CopyDefaultToMem( struct NineSurface9 *This,
                                struct NineSurface9 *From )
 {
-    struct pipe_context *pipe;
-    struct pipe_resource *r_src = From->base.resource;
-    struct pipe_transfer *transfer;
     struct pipe_box src_box;
-    uint8_t *p_dst;
-    const uint8_t *p_src;
 
     assert(This->base.pool == D3DPOOL_SYSTEMMEM &&
            From->base.pool == D3DPOOL_DEFAULT);
@@ -699,24 +694,18 @@ NineSurface9_CopyDefaultToMem( struct NineSurface9 *This,
     u_box_origin_2d(This->desc.Width, This->desc.Height, &src_box);
     src_box.z = From->layer;
 
-    if (p_atomic_read(&This->pending_uploads_counter))
-        nine_csmt_process(This->base.base.device);
-
-    pipe = NineDevice9_GetPipe(This->base.base.device);
-    p_src = pipe->transfer_map(pipe, r_src, From->level,
-                               PIPE_TRANSFER_READ,
-                               &src_box, &transfer);
-    p_dst = NineSurface9_GetSystemMemPointer(This, 0, 0);
-
-    assert (p_src && p_dst);
-
-    util_copy_rect(p_dst, This->base.info.format,
-                   This->stride, 0, 0,
-                   This->desc.Width, This->desc.Height,
-                   p_src,
-                   transfer->stride, 0, 0);
-
-    pipe->transfer_unmap(pipe, transfer);
+    /* The copy is done by the worker: pending uploads from This->data are
+     * ordered before it, and locking This waits for it. */
+    nine_context_box_download(This->base.base.device,
+                              &This->pending_uploads_counter,
+                              (struct NineUnknown *)From,
+                              (struct NineUnknown *)This,
+                              From->base.resource,
+                              From->level,
+                              &src_box,
+                              This->base.info.format,
+                              NineSurface9_GetSystemMemPointer(This, 0, 0),
+                              This->stride);
 }
 
 
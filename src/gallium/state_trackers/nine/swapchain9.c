@@ -961,6 +961,10 @@ NineSwapChain9_GetFrontBufferData( struct NineSwapChain9 *This,
 
     NineSurface9_CopyDefaultToMem(dest_surface, temp_surface);
 
+    /* The copy is queued and binds temp_surface: wait for it before
+     * destroying the temporaries. */
+    nine_csmt_process(pDevice);
+
     ID3DPresent_DestroyD3DWindowBuffer(This->present, temp_handle);
     NineUnknown_Destroy(NineUnknown(temp_surface));
 
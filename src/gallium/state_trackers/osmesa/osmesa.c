@@ -50,6 +50,7 @@
 
 
 #include <stdio.h>
+#include <c11/threads.h>
 #include "GL/osmesa.h"
 
 #include "glapi/glapi.h"  /* for OSMesaGetProcAddress below */
@@ -62,6 +63,7 @@
 #include "util/u_box.h"
 #include "util/u_debug.h"
 #include "util/u_format.h"
+#include "util/u_inlines.h"
 #include "util/u_memory.h"
 
 #include "postprocess/filters.h"
@@ -76,6 +78,13 @@ extern struct pipe_screen *
 osmesa_create_screen(void);
 
 
+/**
+ * How many buffers a context keeps around for re-use, including the
+ * current one.
+ */
+#define OSMESA_MAX_BUFFERS 4
+
+
 
 struct osmesa_buffer
 {
@@ -83,11 +92,12 @@ struct osmesa_buffer
    struct st_visual visual;
    unsigned width, height;
 
+   /** The resources, referenced here so that they outlive the st fb */
    struct pipe_resource *textures[ST_ATTACHMENT_COUNT];
 
    void *map;
 
-   struct osmesa_buffer *next;  /**< next in linked list */
+   struct osmesa_buffer *next;  /**< next in the context's list */
 };
 
 
@@ -99,6 +109,18 @@ struct osmesa_context
 
    struct osmesa_buffer *current_buffer;
 
+   /**
+    * The buffers of this context, most recently used first.
+    * We can re-use an osmesa_buffer from one OSMesaMakeCurrent() call to
+    * the next unless the formats or the size change.
+    * We have to do this to be compatible with the original OSMesa
+    * implementation because some apps call OSMesaMakeCurrent() several
+    * times during rendering a frame.  Buffers aren't shared between
+    * contexts, so each can write to a different user buffer and contexts
+    * on different threads don't need any locking.
+    */
+   struct osmesa_buffer *buffers;
+
    enum pipe_format depth_stencil_format, accum_format;
 
    GLenum format;         /*< User-specified context format */
@@ -113,17 +135,6 @@ struct osmesa_context
 };
 
 
-/**
- * Linked list of all osmesa_buffers.
- * We can re-use an osmesa_buffer from one OSMesaMakeCurrent() call to
- * the next unless the color/depth/stencil/accum formats change.
- * We have to do this to be compatible with the original OSMesa implementation
- * because some apps call OSMesaMakeCurrent() several times during rendering
- * a frame.
- */
-static struct osmesa_buffer *BufferList = NULL;
-
-
 /**
  * Called from the ST manager.
  */
@@ -135,35 +146,49 @@ osmesa_st_get_param(struct st_manager *smapi, enum st_manager_param param)
 }
 
 
+static struct st_api *stapi = NULL;
+
+static void
+create_st_api(void)
+{
+   stapi = st_gl_api_create();
+}
+
+
 /**
  * Create/return singleton st_api object.
  */
 static struct st_api *
 get_st_api(void)
 {
-   static struct st_api *stapi = NULL;
-   if (!stapi) {
-      stapi = st_gl_api_create();
-   }
+   static once_flag flag = ONCE_FLAG_INIT;
+   call_once(&flag, create_st_api);
    return stapi;
 }
 
 
+static struct st_manager *stmgr = NULL;
+
+static void
+create_st_manager(void)
+{
+   stmgr = CALLOC_STRUCT(st_manager);
+   if (stmgr) {
+      stmgr->screen = osmesa_create_screen();
+      stmgr->get_param = osmesa_st_get_param;
+      stmgr->get_egl_image = NULL;
+   }
+}
+
+
 /**
  * Create/return a singleton st_manager object.
  */
 static struct st_manager *
 get_st_manager(void)
 {
-   static struct st_manager *stmgr = NULL;
-   if (!stmgr) {
-      stmgr = CALLOC_STRUCT(st_manager);
-      if (stmgr) {
-         stmgr->screen = osmesa_create_screen();
-         stmgr->get_param = osmesa_st_get_param;
-         stmgr->get_egl_image = NULL;
-      }         
-   }
+   static once_flag flag = ONCE_FLAG_INIT;
+   call_once(&flag, create_st_manager);
    return stmgr;
 }
 
@@ -430,10 +455,20 @@ osmesa_st_framebuffer_validate(struct st_context_iface *stctx,
                        "osmesa_st_framebuffer_validate()");
       }
 
-      templat.format = format;
-      templat.bind = bind;
-      out[i] = osbuffer->textures[statts[i]] =
-         screen->resource_create(screen, &templat);
+      out[i] = NULL;
+      if (format == PIPE_FORMAT_NONE)
+         continue;
+
+      /* The size and formats of a buffer never change, so the resources
+       * from the last time it was current can be used again.
+       */
+      if (!osbuffer->textures[statts[i]]) {
+         templat.format = format;
+         templat.bind = bind;
+         osbuffer->textures[statts[i]] =
+            screen->resource_create(screen, &templat);
+      }
+      pipe_resource_reference(&out[i], osbuffer->textures[statts[i]]);
    }
 
    return TRUE;
@@ -454,16 +489,22 @@ osmesa_create_st_framebuffer(void)
 
 
 /**
- * Create new buffer and add to linked list.
+ * Create new buffer and add to the front of the context's list.
  */
 static struct osmesa_buffer *
-osmesa_create_buffer(enum pipe_format color_format,
+osmesa_create_buffer(OSMesaContext osmesa,
+                     enum pipe_format color_format,
                      enum pipe_format ds_format,
-                     enum pipe_format accum_format)
+                     enum pipe_format accum_format,
+                     GLsizei width, GLsizei height)
 {
    struct osmesa_buffer *osbuffer = CALLOC_STRUCT(osmesa_buffer);
    if (osbuffer) {
       osbuffer->stfb = osmesa_create_st_framebuffer();
+      if (!osbuffer->stfb) {
+         FREE(osbuffer);
+         return NULL;
+      }
 
       osbuffer->stfb->st_manager_private = osbuffer;
       osbuffer->stfb->visual = &osbuffer->visual;
@@ -471,9 +512,11 @@ osmesa_create_buffer(enum pipe_format color_format,
       osmesa_init_st_visual(&osbuffer->visual, color_format,
                             ds_format, accum_format);
 
-      /* insert into linked list */
-      osbuffer->next = BufferList;
-      BufferList = osbuffer;
+      osbuffer->width = width;
+      osbuffer->height = height;
+
+      osbuffer->next = osmesa->buffers;
+      osmesa->buffers = osbuffer;
    }
 
    return osbuffer;
@@ -481,23 +524,28 @@ osmesa_create_buffer(enum pipe_format color_format,
 
 
 /**
- * Search linked list for a buffer with matching pixel formats and size.
+ * Search the context's list for a buffer with matching pixel formats and
+ * size, and move it to the front of the list if found.
  */
 static struct osmesa_buffer *
-osmesa_find_buffer(enum pipe_format color_format,
+osmesa_find_buffer(OSMesaContext osmesa,
+                   enum pipe_format color_format,
                    enum pipe_format ds_format,
                    enum pipe_format accum_format,
                    GLsizei width, GLsizei height)
 {
-   struct osmesa_buffer *b;
+   struct osmesa_buffer **prev, *b;
 
    /* Check if we already have a suitable buffer for the given formats */
-   for (b = BufferList; b; b = b->next) {
+   for (prev = &osmesa->buffers; (b = *prev); prev = &b->next) {
       if (b->visual.color_format == color_format &&
           b->visual.depth_stencil_format == ds_format &&
           b->visual.accum_format == accum_format &&
           b->width == width &&
           b->height == height) {
+         *prev = b->next;
+         b->next = osmesa->buffers;
+         osmesa->buffers = b;
          return b;
       }
    }
@@ -508,11 +556,41 @@ osmesa_find_buffer(enum pipe_format color_format,
 static void
 osmesa_destroy_buffer(struct osmesa_buffer *osbuffer)
 {
+   unsigned i;
+
+   for (i = 0; i < ARRAY_SIZE(osbuffer->textures); i++)
+      pipe_resource_reference(&osbuffer->textures[i], NULL);
+
    FREE(osbuffer->stfb);
    FREE(osbuffer);
 }
 
 
+/**
+ * Destroy the least recently used buffers beyond OSMESA_MAX_BUFFERS.
+ * The current buffer is at the front of the list, and the st framebuffers
+ * of the others have already been released by the context.
+ */
+static void
+osmesa_release_buffers(OSMesaContext osmesa)
+{
+   struct osmesa_buffer **prev = &osmesa->buffers;
+   unsigned n = 0;
+
+   while (*prev && n < OSMESA_MAX_BUFFERS) {
+      prev = &(*prev)->next;
+      n++;
+   }
+
+   while (*prev) {
+      struct osmesa_buffer *b = *prev;
+      *prev = b->next;
+      assert(b != osmesa->current_buffer);
+      osmesa_destroy_buffer(b);
+   }
+}
+
+
 
 /**********************************************************************/
 /*****                    Public Functions                        *****/
@@ -714,6 +792,13 @@ OSMesaDestroyContext(OSMesaContext osmesa)
    if (osmesa) {
       pp_free(osmesa->pp);
       osmesa->stctx->destroy(osmesa->stctx);
+
+      while (osmesa->buffers) {
+         struct osmesa_buffer *b = osmesa->buffers;
+         osmesa->buffers = b->next;
+         osmesa_destroy_buffer(b);
+      }
+
       FREE(osmesa);
    }
 }
@@ -764,28 +849,28 @@ OSMesaMakeCurrent(OSMesaContext osmesa, void *buffer, GLenum type,
    }
 
    /* See if we already have a buffer that uses these pixel formats */
-   osbuffer = osmesa_find_buffer(color_format,
+   osbuffer = osmesa_find_buffer(osmesa, color_format,
                                  osmesa->depth_stencil_format,
                                  osmesa->accum_format, width, height);
    if (!osbuffer) {
-      /* Existing buffer found, create new buffer */
-      osbuffer = osmesa_create_buffer(color_format,
+      /* No existing buffer found, create new buffer */
+      osbuffer = osmesa_create_buffer(osmesa, color_format,
                                       osmesa->depth_stencil_format,
-                                      osmesa->accum_format);
+                                      osmesa->accum_format, width, height);
+      if (!osbuffer)
+         return GL_FALSE;
    }
 
-   osbuffer->width = width;
-   osbuffer->height = height;
    osbuffer->map = buffer;
 
-   /* XXX unused for now */
-   (void) osmesa_destroy_buffer;
-
    osmesa->current_buffer = osbuffer;
    osmesa->type = type;
 
    stapi->make_current(stapi, osmesa->stctx, osbuffer->stfb, osbuffer->stfb);
 
+   /* The context no longer references the buffers it was bound to before */
+   osmesa_release_buffers(osmesa);
+
    if (!osmesa->ever_used) {
       /* one-time init, just postprocessing for now */
       boolean any_pp_enabled = FALSE;
@@ -0,0 +1,845 @@
+/**************************************************************************
+ *
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/*
+ * Timed, repeatable workloads for the software rasterizers, run through
+ * the gallium API on the null sw winsys, so no window system is needed.
+ * The driver is picked like for any swrast target, with GALLIUM_DRIVER
+ * or -d.  Results are printed to stdout as JSON.
+ *
+ * Usage: sw-bench [-d driver] [-n scale] [-s size] [-w workload]
+ */
+
+#define DEFAULT_SIZE 512
+#define OVERDRAW 8
+
+/* pipe_*_state structs */
+#include "pipe/p_state.h"
+/* pipe_context */
+#include "pipe/p_context.h"
+/* pipe_screen */
+#include "pipe/p_screen.h"
+/* PIPE_* */
+#include "pipe/p_defines.h"
+/* TGSI_SEMANTIC_{POSITION|GENERIC} */
+#include "pipe/p_shader_tokens.h"
+/* pipe_buffer_* helpers */
+#include "util/u_inlines.h"
+
+/* constant state object helper */
+#include "cso_cache/cso_context.h"
+
+/* os_time_get_nano */
+#include "os/os_time.h"
+/* util_format_write_4f */
+#include "util/u_format.h"
+/* u_sampler_view_default_template */
+#include "util/u_sampler.h"
+/* util_draw_vertex_buffer helper */
+#include "util/u_draw_quad.h"
+/* FREE & CALLOC_STRUCT */
+#include "util/u_memory.h"
+/* util_make_[fragment|vertex]_passthrough_shader */
+#include "util/u_simple_shaders.h"
+/* to get a software pipe driver */
+#include "pipe-loader/pipe_loader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+struct vertex
+{
+	float pos[4];
+	float attr[4];	/* color or texcoord */
+};
+
+struct bench
+{
+	struct pipe_loader_device *dev;
+	struct pipe_screen *screen;
+	struct pipe_context *pipe;
+	struct cso_context *cso;
+
+	unsigned size;
+	unsigned scale;
+	const char *only;
+	unsigned num_results;
+
+	struct pipe_blend_state blend;
+	struct pipe_depth_stencil_alpha_state depthstencil;
+	struct pipe_rasterizer_state rasterizer;
+	struct pipe_viewport_state viewport;
+	struct pipe_framebuffer_state framebuffer;
+	struct pipe_vertex_element velem[2];
+
+	void *vs;
+	void *fs_color;
+	void *fs_tex;
+
+	struct pipe_resource *target;
+	struct pipe_resource *zbuf;
+	struct pipe_resource *quad;
+};
+
+static struct pipe_resource *
+create_vbuf(struct bench *b, const struct vertex *verts, unsigned count)
+{
+	struct pipe_resource *vbuf;
+
+	vbuf = pipe_buffer_create(b->screen, PIPE_BIND_VERTEX_BUFFER,
+	                          PIPE_USAGE_DEFAULT, count * sizeof(*verts));
+	pipe_buffer_write(b->pipe, vbuf, 0, count * sizeof(*verts), verts);
+	return vbuf;
+}
+
+/* A quad covering the framebuffer, attr going from (0,0) to (s,s). */
+static struct pipe_resource *
+create_quad(struct bench *b, float z, float s, float alpha)
+{
+	const struct vertex verts[4] = {
+		{ {  1.0f,  1.0f, z, 1.0f }, { s,    s,    0.5f, alpha } },
+		{ { -1.0f,  1.0f, z, 1.0f }, { 0.0f, s,    0.5f, alpha } },
+		{ { -1.0f, -1.0f, z, 1.0f }, { 0.0f, 0.0f, 0.5f, alpha } },
+		{ {  1.0f, -1.0f, z, 1.0f }, { s,    0.0f, 0.5f, alpha } },
+	};
+
+	return create_vbuf(b, verts, 4);
+}
+
+/* A grid of triangles, each taking half of a cell x cell pixel square. */
+static struct pipe_resource *
+create_tri_grid(struct bench *b, unsigned cell, unsigned *num_verts)
+{
+	const unsigned n = b->size / cell;
+	const float d = 2.0f * cell / b->size;
+	struct pipe_resource *vbuf;
+	struct vertex *verts, *v;
+	unsigned x, y;
+
+	*num_verts = n * n * 3;
+	verts = v = MALLOC(*num_verts * sizeof(*verts));
+
+	for (y = 0; y < n; y++) {
+		for (x = 0; x < n; x++) {
+			const float x0 = -1.0f + x * d, y0 = -1.0f + y * d;
+			const float pos[3][2] = {
+				{ x0, y0 }, { x0 + d, y0 }, { x0, y0 + d },
+			};
+			unsigned i;
+
+			for (i = 0; i < 3; i++, v++) {
+				v->pos[0] = pos[i][0];
+				v->pos[1] = pos[i][1];
+				v->pos[2] = 0.5f;
+				v->pos[3] = 1.0f;
+				v->attr[0] = (float)x / n;
+				v->attr[1] = (float)y / n;
+				v->attr[2] = 0.5f;
+				v->attr[3] = 1.0f;
+			}
+		}
+	}
+
+	vbuf = create_vbuf(b, verts, *num_verts);
+	FREE(verts);
+	return vbuf;
+}
+
+static void draw_quad(struct bench *b, struct pipe_resource *vbuf)
+{
+	util_draw_vertex_buffer(b->pipe, b->cso, vbuf, 0, 0,
+	                        PIPE_PRIM_QUADS,
+	                        4,  /* verts */
+	                        2); /* attribs/vert */
+}
+
+/* Wait for everything queued so far to be rasterized. */
+static void finish(struct bench *b)
+{
+	struct pipe_fence_handle *fence = NULL;
+
+	b->pipe->flush(b->pipe, &fence, 0);
+	b->screen->fence_finish(b->screen, NULL, fence, PIPE_TIMEOUT_INFINITE);
+	b->screen->fence_reference(b->screen, &fence, NULL);
+}
+
+static void reset_state(struct bench *b, void *fs)
+{
+	memset(&b->blend, 0, sizeof(b->blend));
+	b->blend.rt[0].colormask = PIPE_MASK_RGBA;
+
+	memset(&b->depthstencil, 0, sizeof(b->depthstencil));
+
+	memset(&b->rasterizer, 0, sizeof(b->rasterizer));
+	b->rasterizer.cull_face = PIPE_FACE_NONE;
+	b->rasterizer.half_pixel_center = 1;
+	b->rasterizer.bottom_edge_rule = 1;
+	b->rasterizer.depth_clip = 1;
+
+	cso_set_framebuffer(b->cso, &b->framebuffer);
+	cso_set_blend(b->cso, &b->blend);
+	cso_set_depth_stencil_alpha(b->cso, &b->depthstencil);
+	cso_set_rasterizer(b->cso, &b->rasterizer);
+	cso_set_viewport(b->cso, &b->viewport);
+	cso_set_fragment_shader_handle(b->cso, fs);
+	cso_set_vertex_shader_handle(b->cso, b->vs);
+	cso_set_vertex_elements(b->cso, 2, b->velem);
+}
+
+static bool wanted(struct bench *b, const char *name)
+{
+	return !b->only || strstr(name, b->only);
+}
+
+/**
+ * Print one result.  rate is work units per second, times unit_scale.
+ */
+static void report(struct bench *b, const char *name, unsigned iterations,
+                   int64_t ns, double work, double unit_scale,
+                   const char *unit)
+{
+	printf("%s\n\t\t{ \"name\": \"%s\", \"iterations\": %u, "
+	       "\"time_ms\": %.3f, \"rate\": %.3f, \"unit\": \"%s\" }",
+	       b->num_results++ ? "," : "", name, iterations, ns / 1e6,
+	       ns ? work * unit_scale * 1e9 / ns : 0.0, unit);
+	fflush(stdout);
+}
+
+static void init_bench(struct bench *b)
+{
+	struct pipe_surface surf_tmpl;
+	struct pipe_resource tmplt;
+	static const enum pipe_format zs_formats[] = {
+		PIPE_FORMAT_Z24_UNORM_S8_UINT,
+		PIPE_FORMAT_S8_UINT_Z24_UNORM,
+		PIPE_FORMAT_Z32_FLOAT,
+		PIPE_FORMAT_Z16_UNORM,
+	};
+	unsigned i;
+	bool ret;
+
+	ret = pipe_loader_sw_probe_null(&b->dev);
+	assert(ret);
+
+	b->screen = pipe_loader_create_screen(b->dev);
+	if (!b->screen) {
+		fprintf(stderr, "couldn't create a sw screen\n");
+		exit(1);
+	}
+
+	b->pipe = b->screen->context_create(b->screen, NULL, 0);
+	b->cso = cso_create_context(b->pipe, 0);
+
+	/* render target */
+	memset(&tmplt, 0, sizeof(tmplt));
+	tmplt.target = PIPE_TEXTURE_2D;
+	tmplt.format = PIPE_FORMAT_B8G8R8A8_UNORM; /* All drivers support this */
+	tmplt.width0 = b->size;
+	tmplt.height0 = b->size;
+	tmplt.depth0 = 1;
+	tmplt.array_size = 1;
+	tmplt.bind = PIPE_BIND_RENDER_TARGET;
+	b->target = b->screen->resource_create(b->screen, &tmplt);
+
+	/* depth buffer */
+	for (i = 0; i < ARRAY_SIZE(zs_formats); i++) {
+		if (b->screen->is_format_supported(b->screen, zs_formats[i],
+		                                   PIPE_TEXTURE_2D, 0,
+		                                   PIPE_BIND_DEPTH_STENCIL)) {
+			tmplt.format = zs_formats[i];
+			tmplt.bind = PIPE_BIND_DEPTH_STENCIL;
+			b->zbuf = b->screen->resource_create(b->screen, &tmplt);
+			break;
+		}
+	}
+
+	memset(&surf_tmpl, 0, sizeof(surf_tmpl));
+	memset(&b->framebuffer, 0, sizeof(b->framebuffer));
+	b->framebuffer.width = b->size;
+	b->framebuffer.height = b->size;
+	b->framebuffer.nr_cbufs = 1;
+	surf_tmpl.format = b->target->format;
+	b->framebuffer.cbufs[0] = b->pipe->create_surface(b->pipe, b->target,
+	                                                  &surf_tmpl);
+	if (b->zbuf) {
+		surf_tmpl.format = b->zbuf->format;
+		b->framebuffer.zsbuf = b->pipe->create_surface(b->pipe, b->zbuf,
+		                                               &surf_tmpl);
+	}
+
+	/* viewport, with z mapped to [0, 1] */
+	b->viewport.scale[0] = b->size / 2.0f;
+	b->viewport.scale[1] = b->size / 2.0f;
+	b->viewport.scale[2] = 0.5f;
+	b->viewport.translate[0] = b->size / 2.0f;
+	b->viewport.translate[1] = b->size / 2.0f;
+	b->viewport.translate[2] = 0.5f;
+
+	/* vertex elements state */
+	memset(b->velem, 0, sizeof(b->velem));
+	b->velem[0].src_offset = offsetof(struct vertex, pos);
+	b->velem[0].src_format = PIPE_FORMAT_R32G32B32A32_FLOAT;
+	b->velem[1].src_offset = offsetof(struct vertex, attr);
+	b->velem[1].src_format = PIPE_FORMAT_R32G32B32A32_FLOAT;
+
+	/* shaders */
+	{
+		const uint semantic_names[] = { TGSI_SEMANTIC_POSITION,
+		                                TGSI_SEMANTIC_GENERIC };
+		const uint semantic_indexes[] = { 0, 0 };
+		b->vs = util_make_vertex_passthrough_shader(b->pipe, 2, semantic_names, semantic_indexes, FALSE);
+	}
+	b->fs_color = util_make_fragment_passthrough_shader(b->pipe,
+	                                                    TGSI_SEMANTIC_GENERIC,
+	                                                    TGSI_INTERPOLATE_LINEAR,
+	                                                    FALSE);
+	b->fs_tex = util_make_fragment_tex_shader(b->pipe, TGSI_TEXTURE_2D,
+	                                          TGSI_INTERPOLATE_LINEAR,
+	                                          TGSI_RETURN_TYPE_FLOAT,
+	                                          TGSI_RETURN_TYPE_FLOAT);
+
+	b->quad = create_quad(b, 0.5f, 1.0f, 0.5f);
+}
+
+static void close_bench(struct bench *b)
+{
+	cso_destroy_context(b->cso);
+
+	b->pipe->delete_vs_state(b->pipe, b->vs);
+	b->pipe->delete_fs_state(b->pipe, b->fs_color);
+	b->pipe->delete_fs_state(b->pipe, b->fs_tex);
+
+	pipe_surface_reference(&b->framebuffer.cbufs[0], NULL);
+	pipe_surface_reference(&b->framebuffer.zsbuf, NULL);
+	pipe_resource_reference(&b->target, NULL);
+	pipe_resource_reference(&b->zbuf, NULL);
+	pipe_resource_reference(&b->quad, NULL);
+
+	b->pipe->destroy(b->pipe);
+	b->screen->destroy(b->screen);
+	pipe_loader_release(&b->dev, 1);
+}
+
+/* Plain color quads: fill rate. */
+static void bench_fill(struct bench *b)
+{
+	const unsigned iterations = 100 * b->scale;
+	int64_t start;
+	unsigned i;
+
+	if (!wanted(b, "fill"))
+		return;
+
+	reset_state(b, b->fs_color);
+	draw_quad(b, b->quad);
+	finish(b);
+
+	start = os_time_get_nano();
+	for (i = 0; i < iterations; i++)
+		draw_quad(b, b->quad);
+	finish(b);
+
+	report(b, "fill", iterations, os_time_get_nano() - start,
+	       (double)iterations * b->size * b->size, 1e-6, "Mpixel/s");
+}
+
+/* Alpha blended quads. */
+static void bench_blend(struct bench *b)
+{
+	const unsigned iterations = 100 * b->scale;
+	int64_t start;
+	unsigned i;
+
+	if (!wanted(b, "blend"))
+		return;
+
+	reset_state(b, b->fs_color);
+	b->blend.rt[0].blend_enable = 1;
+	b->blend.rt[0].rgb_func = PIPE_BLEND_ADD;
+	b->blend.rt[0].rgb_src_factor = PIPE_BLENDFACTOR_SRC_ALPHA;
+	b->blend.rt[0].rgb_dst_factor = PIPE_BLENDFACTOR_INV_SRC_ALPHA;
+	b->blend.rt[0].alpha_func = PIPE_BLEND_ADD;
+	b->blend.rt[0].alpha_src_factor = PIPE_BLENDFACTOR_ONE;
+	b->blend.rt[0].alpha_dst_factor = PIPE_BLENDFACTOR_INV_SRC_ALPHA;
+	cso_set_blend(b->cso, &b->blend);
+	draw_quad(b, b->quad);
+	finish(b);
+
+	start = os_time_get_nano();
+	for (i = 0; i < iterations; i++)
+		draw_quad(b, b->quad);
+	finish(b);
+
+	report(b, "blend", iterations, os_time_get_nano() - start,
+	       (double)iterations * b->size * b->size, 1e-6, "Mpixel/s");
+}
+
+/* Many triangles of about two pixels each: setup and binning cost. */
+static void bench_tiny_tris(struct bench *b)
+{
+	const unsigned iterations = 10 * b->scale;
+	struct pipe_resource *vbuf;
+	unsigned num_verts, i;
+	int64_t start;
+
+	if (!wanted(b, "tiny-tris"))
+		return;
+
+	vbuf = create_tri_grid(b, 2, &num_verts);
+
+	reset_state(b, b->fs_color);
+	util_draw_vertex_buffer(b->pipe, b->cso, vbuf, 0, 0,
+	                        PIPE_PRIM_TRIANGLES, num_verts, 2);
+	finish(b);
+
+	start = os_time_get_nano();
+	for (i = 0; i < iterations; i++)
+		util_draw_vertex_buffer(b->pipe, b->cso, vbuf, 0, 0,
+		                        PIPE_PRIM_TRIANGLES, num_verts, 2);
+	finish(b);
+
+	report(b, "tiny-tris", iterations, os_time_get_nano() - start,
+	       (double)iterations * num_verts / 3, 1e-6, "Mtri/s");
+
+	pipe_resource_reference(&vbuf, NULL);
+}
+
+/* Triangles which all get culled: vertex fetch, shading and setup only. */
+static void bench_vertex(struct bench *b)
+{
+	const unsigned iterations = 10 * b->scale;
+	struct pipe_resource *vbuf;
+	unsigned num_verts, i;
+	int64_t start;
+
+	if (!wanted(b, "vertex"))
+		return;
+
+	vbuf = create_tri_grid(b, 2, &num_verts);
+
+	reset_state(b, b->fs_color);
+	b->rasterizer.cull_face = PIPE_FACE_FRONT_AND_BACK;
+	cso_set_rasterizer(b->cso, &b->rasterizer);
+	util_draw_vertex_buffer(b->pipe, b->cso, vbuf, 0, 0,
+	                        PIPE_PRIM_TRIANGLES, num_verts, 2);
+	finish(b);
+
+	start = os_time_get_nano();
+	for (i = 0; i < iterations; i++)
+		util_draw_vertex_buffer(b->pipe, b->cso, vbuf, 0, 0,
+		                        PIPE_PRIM_TRIANGLES, num_verts, 2);
+	finish(b);
+
+	report(b, "vertex", iterations, os_time_get_nano() - start,
+	       (double)iterations * num_verts, 1e-6, "Mvertex/s");
+
+	pipe_resource_reference(&vbuf, NULL);
+}
+
+/* OVERDRAW layers of quads per frame, drawn in the worst and best order. */
+static void bench_depth(struct bench *b, bool front_to_back)
+{
+	const char *name = front_to_back ? "depth-front-to-back" :
+	                                   "depth-back-to-front";
+	const unsigned iterations = 20 * b->scale;
+	struct pipe_resource *layers[OVERDRAW];
+	int64_t start = 0;
+	unsigned i, j;
+
+	if (!b->zbuf || !wanted(b, name))
+		return;
+
+	for (j = 0; j < OVERDRAW; j++) {
+		float z = (j + 1.0f) / (OVERDRAW + 1);
+		layers[j] = create_quad(b, front_to_back ? z : 1.0f - z,
+		                        1.0f, 1.0f);
+	}
+
+	reset_state(b, b->fs_color);
+	b->depthstencil.depth.enabled = 1;
+	b->depthstencil.depth.writemask = 1;
+	b->depthstencil.depth.func = PIPE_FUNC_LESS;
+	cso_set_depth_stencil_alpha(b->cso, &b->depthstencil);
+
+	for (i = 0; i <= iterations; i++) {
+		if (i == 1) {
+			finish(b);
+			start = os_time_get_nano();
+		}
+		b->pipe->clear(b->pipe, PIPE_CLEAR_DEPTHSTENCIL, NULL, 1.0, 0);
+		for (j = 0; j < OVERDRAW; j++)
+			draw_quad(b, layers[j]);
+	}
+	finish(b);
+
+	report(b, name, iterations, os_time_get_nano() - start,
+	       (double)iterations * OVERDRAW * b->size * b->size, 1e-6,
+	       "Mpixel/s");
+
+	for (j = 0; j < OVERDRAW; j++)
+		pipe_resource_reference(&layers[j], NULL);
+}
+
+static struct pipe_resource *
+create_texture(struct bench *b, enum pipe_format format, unsigned size,
+               unsigned last_level)
+{
+	struct pipe_resource tmplt, *tex;
+	unsigned level;
+	float *texels;
+
+	memset(&tmplt, 0, sizeof(tmplt));
+	tmplt.target = PIPE_TEXTURE_2D;
+	tmplt.format = format;
+	tmplt.width0 = size;
+	tmplt.height0 = size;
+	tmplt.depth0 = 1;
+	tmplt.array_size = 1;
+	tmplt.last_level = last_level;
+	tmplt.bind = PIPE_BIND_SAMPLER_VIEW;
+	tex = b->screen->resource_create(b->screen, &tmplt);
+
+	/* some noise, the same on every run */
+	texels = MALLOC(size * size * 4 * sizeof(float));
+	for (level = 0; level <= last_level; level++) {
+		const unsigned w = u_minify(size, level);
+		struct pipe_transfer *t;
+		struct pipe_box box;
+		void *ptr;
+		unsigned i;
+
+		for (i = 0; i < w * w * 4; i++)
+			texels[i] = ((i * 2654435761u) >> 24) / 255.0f;
+
+		u_box_2d(0, 0, w, w, &box);
+		ptr = b->pipe->transfer_map(b->pipe, tex, level,
+		                            PIPE_TRANSFER_WRITE, &box, &t);
+		util_format_write_4f(format, texels, w * 4 * sizeof(float),
+		                     ptr, t->stride, 0, 0, w, w);
+		b->pipe->transfer_unmap(b->pipe, t);
+	}
+	FREE(texels);
+
+	return tex;
+}
+
+/* Textured quads, minified by about two for the mipmapped filter. */
+static void bench_texture(struct bench *b, enum pipe_format format,
+                          const char *filter_name, unsigned img_filter,
+                          unsigned mip_filter)
+{
+	const unsigned iterations = 50 * b->scale;
+	const unsigned tex_size = 256;
+	const struct pipe_sampler_state *samplers[1];
+	struct pipe_sampler_state sampler;
+	struct pipe_sampler_view v_tmplt, *view;
+	struct pipe_resource *tex, *quad;
+	const char *format_name;
+	char name[128];
+	int64_t start;
+	unsigned i;
+
+	format_name = util_format_short_name(format);
+	snprintf(name, sizeof(name), "texture-%s-%s", filter_name, format_name);
+	if (!wanted(b, name))
+		return;
+
+	if (!b->screen->is_format_supported(b->screen, format, PIPE_TEXTURE_2D,
+	                                    0, PIPE_BIND_SAMPLER_VIEW))
+		return;
+
+	tex = create_texture(b, format, tex_size,
+	                     mip_filter == PIPE_TEX_MIPFILTER_NONE ? 0 :
+	                     util_logbase2(tex_size));
+	u_sampler_view_default_template(&v_tmplt, tex, tex->format);
+	view = b->pipe->create_sampler_view(b->pipe, tex, &v_tmplt);
+
+	memset(&sampler, 0, sizeof(sampler));
+	sampler.wrap_s = PIPE_TEX_WRAP_REPEAT;
+	sampler.wrap_t = PIPE_TEX_WRAP_REPEAT;
+	sampler.wrap_r = PIPE_TEX_WRAP_REPEAT;
+	sampler.min_mip_filter = mip_filter;
+	sampler.min_img_filter = img_filter;
+	sampler.mag_img_filter = img_filter;
+	sampler.max_lod = PIPE_MAX_TEXTURE_LEVELS;
+	sampler.normalized_coords = 1;
+	samplers[0] = &sampler;
+
+	/* tex_size * 4 texels across size pixels: */
+	quad = create_quad(b, 0.5f, 4.0f * b->size / (2.0f * tex_size), 1.0f);
+
+	reset_state(b, b->fs_tex);
+	cso_set_samplers(b->cso, PIPE_SHADER_FRAGMENT, 1, samplers);
+	cso_set_sampler_views(b->cso, PIPE_SHADER_FRAGMENT, 1, &view);
+	draw_quad(b, quad);
+	finish(b);
+
+	start = os_time_get_nano();
+	for (i = 0; i < iterations; i++)
+		draw_quad(b, quad);
+	finish(b);
+
+	report(b, name, iterations, os_time_get_nano() - start,
+	       (double)iterations * b->size * b->size, 1e-6, "Mpixel/s");
+
+	cso_set_sampler_views(b->cso, PIPE_SHADER_FRAGMENT, 0, NULL);
+	pipe_sampler_view_reference(&view, NULL);
+	pipe_resource_reference(&tex, NULL);
+	pipe_resource_reference(&quad, NULL);
+}
+
+/* Texture uploads through discarding maps, each used by a draw. */
+static void bench_upload(struct bench *b)
+{
+	const unsigned iterations = 50 * b->scale;
+	const unsigned size = b->size;
+	const struct pipe_sampler_state *samplers[1];
+	struct pipe_sampler_state sampler;
+	struct pipe_sampler_view v_tmplt, *view;
+	struct pipe_resource *tex;
+	struct pipe_box box;
+	int64_t start;
+	unsigned i;
+
+	if (!wanted(b, "transfer-upload"))
+		return;
+
+	tex = create_texture(b, PIPE_FORMAT_B8G8R8A8_UNORM, size, 0);
+	u_sampler_view_default_template(&v_tmplt, tex, tex->format);
+	view = b->pipe->create_sampler_view(b->pipe, tex, &v_tmplt);
+
+	memset(&sampler, 0, sizeof(sampler));
+	sampler.min_img_filter = PIPE_TEX_FILTER_NEAREST;
+	sampler.mag_img_filter = PIPE_TEX_FILTER_NEAREST;
+	sampler.normalized_coords = 1;
+	samplers[0] = &sampler;
+
+	reset_state(b, b->fs_tex);
+	cso_set_samplers(b->cso, PIPE_SHADER_FRAGMENT, 1, samplers);
+	cso_set_sampler_views(b->cso, PIPE_SHADER_FRAGMENT, 1, &view);
+	draw_quad(b, b->quad);
+	finish(b);
+
+	u_box_2d(0, 0, size, size, &box);
+	start = os_time_get_nano();
+	for (i = 0; i < iterations; i++) {
+		struct pipe_transfer *t;
+		uint8_t *ptr;
+		unsigned y;
+
+		ptr = b->pipe->transfer_map(b->pipe, tex, 0,
+		                            PIPE_TRANSFER_WRITE |
+		                            PIPE_TRANSFER_DISCARD_WHOLE_RESOURCE,
+		                            &box, &t);
+		for (y = 0; y < size; y++)
+			memset(ptr + y * t->stride, i, size * 4);
+		b->pipe->transfer_unmap(b->pipe, t);
+
+		draw_quad(b, b->quad);
+	}
+	finish(b);
+
+	report(b, "transfer-upload", iterations, os_time_get_nano() - start,
+	       (double)iterations * size * size * 4, 1e-6, "MB/s");
+
+	cso_set_sampler_views(b->cso, PIPE_SHADER_FRAGMENT, 0, NULL);
+	pipe_sampler_view_reference(&view, NULL);
+	pipe_resource_reference(&tex, NULL);
+}
+
+/* Render target readbacks, each waiting for a draw. */
+static void bench_readback(struct bench *b)
+{
+	const unsigned iterations = 50 * b->scale;
+	const unsigned size = b->size;
+	uint8_t *row = MALLOC(size * 4);
+	struct pipe_box box;
+	int64_t start;
+	unsigned i;
+
+	if (!wanted(b, "transfer-readback")) {
+		FREE(row);
+		return;
+	}
+
+	reset_state(b, b->fs_color);
+	draw_quad(b, b->quad);
+	finish(b);
+
+	u_box_2d(0, 0, size, size, &box);
+	start = os_time_get_nano();
+	for (i = 0; i < iterations; i++) {
+		struct pipe_transfer *t;
+		uint8_t *ptr;
+		unsigned y;
+
+		draw_quad(b, b->quad);
+
+		ptr = b->pipe->transfer_map(b->pipe, b->target, 0,
+		                            PIPE_TRANSFER_READ, &box, &t);
+		for (y = 0; y < size; y++)
+			memcpy(row, ptr + y * t->stride, size * 4);
+		b->pipe->transfer_unmap(b->pipe, t);
+	}
+	finish(b);
+
+	report(b, "transfer-readback", iterations, os_time_get_nano() - start,
+	       (double)iterations * size * size * 4, 1e-6, "MB/s");
+
+	FREE(row);
+}
+
+/* Small draws with blend, shader and rasterizer state changing between. */
+static void bench_state_changes(struct bench *b)
+{
+	const unsigned iterations = 1000 * b->scale;
+	struct pipe_blend_state blend[2];
+	struct pipe_rasterizer_state rast[2];
+	void *fs[2] = { b->fs_color, b->fs_color };
+	struct pipe_resource *vbuf;
+	unsigned num_verts, i;
+	int64_t start = 0;
+
+	if (!wanted(b, "state-changes"))
+		return;
+
+	/* the grid of 64x64 pixel cells, drawing one triangle at a time */
+	vbuf = create_tri_grid(b, 64, &num_verts);
+
+	reset_state(b, b->fs_color);
+	blend[0] = blend[1] = b->blend;
+	blend[1].rt[0].blend_enable = 1;
+	blend[1].rt[0].rgb_func = PIPE_BLEND_ADD;
+	blend[1].rt[0].rgb_src_factor = PIPE_BLENDFACTOR_ONE;
+	blend[1].rt[0].rgb_dst_factor = PIPE_BLENDFACTOR_ONE;
+	blend[1].rt[0].alpha_func = PIPE_BLEND_ADD;
+	blend[1].rt[0].alpha_src_factor = PIPE_BLENDFACTOR_ONE;
+	blend[1].rt[0].alpha_dst_factor = PIPE_BLENDFACTOR_ONE;
+	rast[0] = rast[1] = b->rasterizer;
+	rast[1].flatshade = 1;
+	rast[1].front_ccw = 1;
+
+	/* a second, different, fragment shader */
+	fs[1] = util_make_fragment_passthrough_shader(b->pipe,
+	                                              TGSI_SEMANTIC_GENERIC,
+	                                              TGSI_INTERPOLATE_CONSTANT,
+	                                              FALSE);
+
+	for (i = 0; i <= iterations; i++) {
+		const unsigned tri = i % (num_verts / 3);
+
+		if (i == 1) {
+			finish(b);
+			start = os_time_get_nano();
+		}
+
+		cso_set_blend(b->cso, &blend[i & 1]);
+		cso_set_rasterizer(b->cso, &rast[(i >> 1) & 1]);
+		cso_set_fragment_shader_handle(b->cso, fs[(i >> 2) & 1]);
+		util_draw_vertex_buffer(b->pipe, b->cso, vbuf, 0,
+		                        tri * 3 * sizeof(struct vertex),
+		                        PIPE_PRIM_TRIANGLES, 3, 2);
+	}
+	finish(b);
+
+	report(b, "state-changes", iterations, os_time_get_nano() - start,
+	       iterations, 1e-3, "Kdraw/s");
+
+	cso_set_fragment_shader_handle(b->cso, b->fs_color);
+	b->pipe->delete_fs_state(b->pipe, fs[1]);
+	pipe_resource_reference(&vbuf, NULL);
+}
+
+int main(int argc, char** argv)
+{
+	static const enum pipe_format tex_formats[] = {
+		PIPE_FORMAT_B8G8R8A8_UNORM,
+		PIPE_FORMAT_R8_UNORM,
+		PIPE_FORMAT_B5G6R5_UNORM,
+		PIPE_FORMAT_R16G16B16A16_FLOAT,
+		PIPE_FORMAT_R32G32B32A32_FLOAT,
+	};
+	static const struct {
+		const char *name;
+		unsigned img_filter;
+		unsigned mip_filter;
+	} filters[] = {
+		{ "nearest", PIPE_TEX_FILTER_NEAREST, PIPE_TEX_MIPFILTER_NONE },
+		{ "linear", PIPE_TEX_FILTER_LINEAR, PIPE_TEX_MIPFILTER_NONE },
+		{ "trilinear", PIPE_TEX_FILTER_LINEAR, PIPE_TEX_MIPFILTER_LINEAR },
+	};
+	struct bench *b = CALLOC_STRUCT(bench);
+	unsigned i, j;
+	int n;
+
+	b->size = DEFAULT_SIZE;
+	b->scale = 1;
+
+	for (n = 1; n < argc; n++) {
+		if (!strcmp(argv[n], "-d") && n + 1 < argc) {
+			setenv("GALLIUM_DRIVER", argv[++n], 1);
+		} else if (!strcmp(argv[n], "-n") && n + 1 < argc) {
+			b->scale = MAX2(1, atoi(argv[++n]));
+		} else if (!strcmp(argv[n], "-s") && n + 1 < argc) {
+			b->size = MAX2(64, atoi(argv[++n]));
+		} else if (!strcmp(argv[n], "-w") && n + 1 < argc) {
+			b->only = argv[++n];
+		} else {
+			fprintf(stderr, "usage: %s [-d driver] [-n scale] "
+			        "[-s size] [-w workload]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	init_bench(b);
+
+	printf("{\n\t\"driver\": \"%s\",\n\t\"width\": %u,\n\t\"height\": %u,\n"
+	       "\t\"results\": [", b->screen->get_name(b->screen),
+	       b->size, b->size);
+
+	bench_fill(b);
+	bench_blend(b);
+	bench_tiny_tris(b);
+	bench_vertex(b);
+	bench_depth(b, false);
+	bench_depth(b, true);
+	for (i = 0; i < ARRAY_SIZE(filters); i++) {
+		for (j = 0; j < ARRAY_SIZE(tex_formats); j++) {
+			bench_texture(b, tex_formats[j], filters[i].name,
+			              filters[i].img_filter,
+			              filters[i].mip_filter);
+		}
+	}
+	bench_upload(b);
+	bench_readback(b);
+	bench_state_changes(b);
+
+	printf("\n\t]\n}\n");
+
+	close_bench(b);
+	FREE(b);
+
+	return 0;
+}
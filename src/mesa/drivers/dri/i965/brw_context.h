@@ -366,12 +366,17 @@ struct brw_ff_gs_prog_data {
 struct brw_cache {
    struct brw_context *brw;
 
-   struct brw_cache_item **items;
+   /** brw_cache_items by key, and by program data to find duplicates */
+   struct hash_table *items;
+   struct hash_table *data;
    struct brw_bo *bo;
-   GLuint size, n_items;
+   GLuint n_items;
 
    uint32_t next_offset;
    bool bo_used_by_gpu;
+
+   /** Whether programs go through intel_screen::program_cache */
+   bool shared;
 };
 
 /* Considered adding a member to this struct to document which flags
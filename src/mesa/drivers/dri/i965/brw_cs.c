@@ -32,6 +32,36 @@
 #include "brw_program.h"
 #include "compiler/glsl/ir_uniform.h"
 
+/**
+ * Number of compute threads the scratch space has to be allocated for.
+ */
+unsigned
+brw_cs_scratch_thread_count(const struct brw_context *brw)
+{
+   const struct gen_device_info *devinfo = &brw->screen->devinfo;
+   const unsigned subslices = MAX2(brw->screen->subslice_total, 1);
+
+   /* WaCSScratchSize:hsw
+    *
+    * Haswell's scratch space address calculation appears to be sparse
+    * rather than tightly packed.  The Thread ID has bits indicating
+    * which subslice, EU within a subslice, and thread within an EU
+    * it is.  There's a maximum of two slices and two subslices, so these
+    * can be stored with a single bit.  Even though there are only 10 EUs
+    * per subslice, this is stored in 4 bits, so there's an effective
+    * maximum value of 16 EUs.  Similarly, although there are only 7
+    * threads per EU, this is stored in a 3 bit number, giving an effective
+    * maximum value of 8 threads per EU.
+    *
+    * This means that we need to use 16 * 8 instead of 10 * 7 for the
+    * number of threads per subslice.
+    */
+   const unsigned scratch_ids_per_subslice =
+      brw->is_haswell ? 16 * 8 : devinfo->max_cs_threads;
+
+   return scratch_ids_per_subslice * subslices;
+}
+
 static void
 assign_cs_binding_table_offsets(const struct gen_device_info *devinfo,
                                 const struct gl_program *prog,
@@ -137,29 +167,9 @@ brw_codegen_cs_prog(struct brw_context *brw,
       }
    }
 
-   const unsigned subslices = MAX2(brw->screen->subslice_total, 1);
-
-   /* WaCSScratchSize:hsw
-    *
-    * Haswell's scratch space address calculation appears to be sparse
-    * rather than tightly packed.  The Thread ID has bits indicating
-    * which subslice, EU within a subslice, and thread within an EU
-    * it is.  There's a maximum of two slices and two subslices, so these
-    * can be stored with a single bit.  Even though there are only 10 EUs
-    * per subslice, this is stored in 4 bits, so there's an effective
-    * maximum value of 16 EUs.  Similarly, although there are only 7
-    * threads per EU, this is stored in a 3 bit number, giving an effective
-    * maximum value of 8 threads per EU.
-    *
-    * This means that we need to use 16 * 8 instead of 10 * 7 for the
-    * number of threads per subslice.
-    */
-   const unsigned scratch_ids_per_subslice =
-      brw->is_haswell ? 16 * 8 : devinfo->max_cs_threads;
-
    brw_alloc_stage_scratch(brw, &brw->cs.base,
                            prog_data.base.total_scratch,
-                           scratch_ids_per_subslice * subslices);
+                           brw_cs_scratch_thread_count(brw));
 
    brw_upload_cache(&brw->cache, BRW_CACHE_CS_PROG,
                     key, sizeof(*key),
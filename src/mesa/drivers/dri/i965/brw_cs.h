@@ -32,6 +32,9 @@ extern "C" {
 void
 brw_upload_cs_prog(struct brw_context *brw);
 
+unsigned
+brw_cs_scratch_thread_count(const struct brw_context *brw);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,20 +37,26 @@
  *  data) in return.  Objects in the cache may not have relocations
  * (pointers to other BOs) in them.
  *
- * The inner workings are a simple hash table based on a CRC of the
- * key data.
+ * Programs live in a util/hash_table keyed by cache_id and key.  Every
+ * program is also kept in a table shared by all contexts of the screen,
+ * so a context looking up a key another context already compiled gets a
+ * copy of the program instead of recompiling it.  Lookups that hit the
+ * context's own table don't take any lock.
  *
  * Replacement is not implemented.  Instead, when the cache gets too
  * big we throw out all of the cache data and let it get regenerated.
  */
 
 #include "main/imports.h"
+#include "util/hash_table.h"
+#include "util/ralloc.h"
 #include "intel_batchbuffer.h"
 #include "brw_state.h"
 #include "brw_wm.h"
 #include "brw_gs.h"
 #include "brw_cs.h"
 #include "brw_program.h"
+#include "brw_shared_program_cache.h"
 #include "compiler/brw_eu.h"
 
 #define FILE_DEBUG_FLAG DEBUG_STATE
@@ -73,7 +79,11 @@ struct brw_cache_item {
    uint32_t offset;
    uint32_t size;
 
-   struct brw_cache_item *next;
+   /** Hash of the program data, to find identical programs */
+   uint32_t data_hash;
+
+   /** The screen-wide copy of the program, if shared */
+   struct brw_shared_kernel *kernel;
 };
 
 static unsigned
@@ -97,116 +107,88 @@ get_program_string_id(enum brw_cache_id cache_id, const void *key)
    }
 }
 
-static GLuint
-hash_key(struct brw_cache_item *item)
+/**
+ * Whether the aux data is a brw_stage_prog_data, with arrays of its own
+ * which brw_stage_prog_data_free() frees.
+ */
+static bool
+has_stage_prog_data(enum brw_cache_id cache_id)
 {
-   GLuint *ikey = (GLuint *)item->key;
-   GLuint hash = item->cache_id, i;
-
-   assert(item->key_size % 4 == 0);
-
-   /* I'm sure this can be improved on:
-    */
-   for (i = 0; i < item->key_size/4; i++) {
-      hash ^= ikey[i];
-      hash = (hash << 5) | (hash >> 27);
-   }
-
-   return hash;
+   return cache_id == BRW_CACHE_VS_PROG ||
+          cache_id == BRW_CACHE_TCS_PROG ||
+          cache_id == BRW_CACHE_TES_PROG ||
+          cache_id == BRW_CACHE_GS_PROG ||
+          cache_id == BRW_CACHE_FS_PROG ||
+          cache_id == BRW_CACHE_CS_PROG;
 }
 
-static int
-brw_cache_item_equals(const struct brw_cache_item *a,
-                      const struct brw_cache_item *b)
+static inline uint32_t
+rotl32(uint32_t x, unsigned r)
 {
-   return a->cache_id == b->cache_id &&
-      a->hash == b->hash &&
-      a->key_size == b->key_size &&
-      (memcmp(a->key, b->key, a->key_size) == 0);
+   return (x << r) | (x >> (32 - r));
 }
 
-static struct brw_cache_item *
-search_cache(struct brw_cache *cache, GLuint hash,
-             struct brw_cache_item *lookup)
+/**
+ * MurmurHash3 over the 32-bit words of the key.  Keys differ in a few
+ * bits here and there, which the old rotate-xor hash didn't spread.
+ */
+static GLuint
+hash_key(enum brw_cache_id cache_id, const void *key, GLuint key_size)
 {
-   struct brw_cache_item *c;
-
-#if 0
-   int bucketcount = 0;
+   const uint32_t *ikey = (const uint32_t *) key;
+   uint32_t hash = cache_id;
 
-   for (c = cache->items[hash % cache->size]; c; c = c->next)
-      bucketcount++;
+   assert(key_size % 4 == 0);
 
-   fprintf(stderr, "bucket %d/%d = %d/%d items\n", hash % cache->size,
-           cache->size, bucketcount, cache->n_items);
-#endif
+   for (unsigned i = 0; i < key_size / 4; i++) {
+      uint32_t k = ikey[i] * 0xcc9e2d51;
 
-   for (c = cache->items[hash % cache->size]; c; c = c->next) {
-      if (brw_cache_item_equals(lookup, c))
-         return c;
+      hash ^= rotl32(k, 15) * 0x1b873593;
+      hash = rotl32(hash, 13) * 5 + 0xe6546b64;
    }
 
-   return NULL;
-}
+   hash ^= key_size;
+   hash ^= hash >> 16;
+   hash *= 0x85ebca6b;
+   hash ^= hash >> 13;
+   hash *= 0xc2b2ae35;
+   hash ^= hash >> 16;
 
+   return hash;
+}
 
-static void
-rehash(struct brw_cache *cache)
+static uint32_t
+hash_item(const void *key)
 {
-   struct brw_cache_item **items;
-   struct brw_cache_item *c, *next;
-   GLuint size, i;
-
-   size = cache->size * 3;
-   items = calloc(size, sizeof(*items));
-
-   for (i = 0; i < cache->size; i++)
-      for (c = cache->items[i]; c; c = next) {
-         next = c->next;
-         c->next = items[c->hash % size];
-         items[c->hash % size] = c;
-      }
-
-   free(cache->items);
-   cache->items = items;
-   cache->size = size;
+   return ((const struct brw_cache_item *) key)->hash;
 }
 
-
-/**
- * Returns the buffer object matching cache_id and key, or NULL.
- */
-bool
-brw_search_cache(struct brw_cache *cache,
-                 enum brw_cache_id cache_id,
-                 const void *key, GLuint key_size,
-                 uint32_t *inout_offset, void *inout_aux)
+static bool
+brw_cache_item_equals(const void *key_a, const void *key_b)
 {
-   struct brw_context *brw = cache->brw;
-   struct brw_cache_item *item;
-   struct brw_cache_item lookup;
-   GLuint hash;
-
-   lookup.cache_id = cache_id;
-   lookup.key = key;
-   lookup.key_size = key_size;
-   hash = hash_key(&lookup);
-   lookup.hash = hash;
-
-   item = search_cache(cache, hash, &lookup);
+   const struct brw_cache_item *a = key_a, *b = key_b;
 
-   if (item == NULL)
-      return false;
+   return a->cache_id == b->cache_id &&
+      a->hash == b->hash &&
+      a->key_size == b->key_size &&
+      (memcmp(a->key, b->key, a->key_size) == 0);
+}
 
-   void *aux = ((char *) item->key) + item->key_size;
+static uint32_t
+hash_item_data(const void *key)
+{
+   return ((const struct brw_cache_item *) key)->data_hash;
+}
 
-   if (item->offset != *inout_offset || aux != *((void **) inout_aux)) {
-      brw->ctx.NewDriverState |= (1 << cache_id);
-      *inout_offset = item->offset;
-      *((void **) inout_aux) = aux;
-   }
+/* Only a hint: the program data itself is compared by brw_lookup_prog(). */
+static bool
+brw_cache_item_data_equals(const void *key_a, const void *key_b)
+{
+   const struct brw_cache_item *a = key_a, *b = key_b;
 
-   return true;
+   return a->cache_id == b->cache_id &&
+      a->size == b->size &&
+      a->data_hash == b->data_hash;
 }
 
 static void
@@ -251,33 +233,28 @@ brw_cache_new_bo(struct brw_cache *cache, uint32_t new_size)
  */
 static const struct brw_cache_item *
 brw_lookup_prog(const struct brw_cache *cache,
-                enum brw_cache_id cache_id,
-                const void *data, unsigned data_size)
+                const struct brw_cache_item *lookup,
+                const void *data)
 {
    struct brw_context *brw = cache->brw;
-   unsigned i;
    const struct brw_cache_item *item;
+   struct hash_entry *entry;
+   int ret;
 
-   for (i = 0; i < cache->size; i++) {
-      for (item = cache->items[i]; item; item = item->next) {
-         int ret;
+   entry = _mesa_hash_table_search_pre_hashed(cache->data, lookup->data_hash,
+                                              lookup);
+   if (entry == NULL)
+      return NULL;
 
-         if (item->cache_id != cache_id || item->size != data_size)
-            continue;
+   item = entry->data;
 
-         if (!brw->has_llc)
-            brw_bo_map(brw, cache->bo, false);
-         ret = memcmp(cache->bo->virtual + item->offset, data, item->size);
-         if (!brw->has_llc)
-            brw_bo_unmap(cache->bo);
-         if (ret)
-            continue;
-
-         return item;
-      }
-   }
+   if (!brw->has_llc)
+      brw_bo_map(brw, cache->bo, false);
+   ret = memcmp(cache->bo->virtual + item->offset, data, item->size);
+   if (!brw->has_llc)
+      brw_bo_unmap(cache->bo);
 
-   return NULL;
+   return ret == 0 ? item : NULL;
 }
 
 static uint32_t
@@ -312,40 +289,25 @@ brw_alloc_item_data(struct brw_cache *cache, uint32_t size)
    return offset;
 }
 
-const void *
-brw_find_previous_compile(struct brw_cache *cache,
-                          enum brw_cache_id cache_id,
-                          unsigned program_string_id)
-{
-   for (unsigned i = 0; i < cache->size; i++) {
-      for (struct brw_cache_item *c = cache->items[i]; c; c = c->next) {
-         if (c->cache_id == cache_id &&
-             get_program_string_id(cache_id, c->key) == program_string_id) {
-            return c->key;
-         }
-      }
-   }
-
-   return NULL;
-}
-
-void
-brw_upload_cache(struct brw_cache *cache,
-                 enum brw_cache_id cache_id,
-                 const void *key,
-                 GLuint key_size,
-                 const void *data,
-                 GLuint data_size,
-                 const void *aux,
-                 GLuint aux_size,
-                 uint32_t *out_offset,
-                 void *out_aux)
+/**
+ * Add a program to the context's cache, uploading it unless an identical
+ * one is already in the BO.
+ */
+static struct brw_cache_item *
+brw_cache_add_item(struct brw_cache *cache,
+                   enum brw_cache_id cache_id,
+                   GLuint hash,
+                   const void *key,
+                   GLuint key_size,
+                   const void *data,
+                   GLuint data_size,
+                   const void *aux,
+                   GLuint aux_size,
+                   struct brw_shared_kernel *kernel)
 {
    struct brw_context *brw = cache->brw;
    struct brw_cache_item *item = CALLOC_STRUCT(brw_cache_item);
-   const struct brw_cache_item *matching_data =
-      brw_lookup_prog(cache, cache_id, data, data_size);
-   GLuint hash;
+   const struct brw_cache_item *matching_data;
    void *tmp;
 
    item->cache_id = cache_id;
@@ -353,8 +315,9 @@ brw_upload_cache(struct brw_cache *cache,
    item->key = key;
    item->key_size = key_size;
    item->aux_size = aux_size;
-   hash = hash_key(item);
    item->hash = hash;
+   item->data_hash = _mesa_hash_data(data, data_size);
+   item->kernel = kernel;
 
    /* If we can find a matching prog in the cache already, then reuse the
     * existing stuff without creating new copy into the underlying buffer
@@ -362,6 +325,7 @@ brw_upload_cache(struct brw_cache *cache,
     * runtime, where multiple shaders may compile to the same thing in our
     * backend.
     */
+   matching_data = brw_lookup_prog(cache, item, data);
    if (matching_data) {
       item->offset = matching_data->offset;
    } else {
@@ -383,17 +347,184 @@ brw_upload_cache(struct brw_cache *cache,
 
    item->key = tmp;
 
-   if (cache->n_items > cache->size * 1.5f)
-      rehash(cache);
-
-   hash %= cache->size;
-   item->next = cache->items[hash];
-   cache->items[hash] = item;
+   _mesa_hash_table_insert_pre_hashed(cache->items, hash, item, item);
+   if (!matching_data)
+      _mesa_hash_table_insert_pre_hashed(cache->data, item->data_hash,
+                                         item, item);
    cache->n_items++;
 
+   cache->brw->ctx.NewDriverState |= 1 << cache_id;
+
+   return item;
+}
+
+/**
+ * Allocate the scratch space of a program taken from another context, as
+ * codegen does for the programs the context compiles itself.
+ */
+static void
+brw_alloc_imported_scratch(struct brw_context *brw,
+                           enum brw_cache_id cache_id,
+                           const struct brw_stage_prog_data *prog_data)
+{
+   const struct gen_device_info *devinfo = &brw->screen->devinfo;
+
+   switch (cache_id) {
+   case BRW_CACHE_VS_PROG:
+      brw_alloc_stage_scratch(brw, &brw->vs.base, prog_data->total_scratch,
+                              devinfo->max_vs_threads);
+      break;
+   case BRW_CACHE_TCS_PROG:
+      brw_alloc_stage_scratch(brw, &brw->tcs.base, prog_data->total_scratch,
+                              devinfo->max_tcs_threads);
+      break;
+   case BRW_CACHE_TES_PROG:
+      brw_alloc_stage_scratch(brw, &brw->tes.base, prog_data->total_scratch,
+                              devinfo->max_tes_threads);
+      break;
+   case BRW_CACHE_GS_PROG:
+      brw_alloc_stage_scratch(brw, &brw->gs.base, prog_data->total_scratch,
+                              devinfo->max_gs_threads);
+      break;
+   case BRW_CACHE_FS_PROG:
+      brw_alloc_stage_scratch(brw, &brw->wm.base, prog_data->total_scratch,
+                              devinfo->max_wm_threads);
+      break;
+   case BRW_CACHE_CS_PROG:
+      brw_alloc_stage_scratch(brw, &brw->cs.base, prog_data->total_scratch,
+                              brw_cs_scratch_thread_count(brw));
+      break;
+   default:
+      break;
+   }
+}
+
+/**
+ * Copy a program compiled by another context of the screen into this
+ * context's cache, if there is one.
+ */
+static struct brw_cache_item *
+brw_cache_import(struct brw_cache *cache,
+                 enum brw_cache_id cache_id, GLuint hash,
+                 const void *key, GLuint key_size)
+{
+   struct brw_shared_kernel *kernel;
+   struct brw_cache_item *item;
+
+   kernel = brw_find_shared_kernel(cache->brw->screen->program_cache,
+                                   cache_id, hash, key, key_size);
+   if (kernel == NULL)
+      return NULL;
+
+   item = brw_cache_add_item(cache, cache_id, hash,
+                             kernel->key, key_size,
+                             kernel->data, kernel->data_size,
+                             (char *) kernel->key + key_size,
+                             kernel->aux_size, kernel);
+
+   if (has_stage_prog_data(cache_id)) {
+      struct brw_stage_prog_data *prog_data =
+         (void *) ((char *) item->key + key_size);
+
+      brw_dup_stage_prog_data(NULL, prog_data);
+      brw_alloc_imported_scratch(cache->brw, cache_id, prog_data);
+   }
+
+   return item;
+}
+
+/**
+ * Returns the buffer object matching cache_id and key, or NULL.
+ */
+bool
+brw_search_cache(struct brw_cache *cache,
+                 enum brw_cache_id cache_id,
+                 const void *key, GLuint key_size,
+                 uint32_t *inout_offset, void *inout_aux)
+{
+   struct brw_context *brw = cache->brw;
+   struct brw_cache_item *item;
+   struct brw_cache_item lookup;
+   struct hash_entry *entry;
+   GLuint hash;
+
+   lookup.cache_id = cache_id;
+   lookup.key = key;
+   lookup.key_size = key_size;
+   hash = hash_key(cache_id, key, key_size);
+   lookup.hash = hash;
+
+   entry = _mesa_hash_table_search_pre_hashed(cache->items, hash, &lookup);
+   if (entry) {
+      item = entry->data;
+   } else {
+      if (!cache->shared)
+         return false;
+
+      item = brw_cache_import(cache, cache_id, hash, key, key_size);
+      if (item == NULL)
+         return false;
+   }
+
+   void *aux = ((char *) item->key) + item->key_size;
+
+   if (item->offset != *inout_offset || aux != *((void **) inout_aux)) {
+      brw->ctx.NewDriverState |= (1 << cache_id);
+      *inout_offset = item->offset;
+      *((void **) inout_aux) = aux;
+   }
+
+   return true;
+}
+
+const void *
+brw_find_previous_compile(struct brw_cache *cache,
+                          enum brw_cache_id cache_id,
+                          unsigned program_string_id)
+{
+   struct hash_entry *entry;
+
+   hash_table_foreach(cache->items, entry) {
+      const struct brw_cache_item *c = entry->data;
+
+      if (c->cache_id == cache_id &&
+          get_program_string_id(cache_id, c->key) == program_string_id) {
+         return c->key;
+      }
+   }
+
+   return NULL;
+}
+
+void
+brw_upload_cache(struct brw_cache *cache,
+                 enum brw_cache_id cache_id,
+                 const void *key,
+                 GLuint key_size,
+                 const void *data,
+                 GLuint data_size,
+                 const void *aux,
+                 GLuint aux_size,
+                 uint32_t *out_offset,
+                 void *out_aux)
+{
+   struct brw_shared_kernel *kernel = NULL;
+   struct brw_cache_item *item;
+   GLuint hash = hash_key(cache_id, key, key_size);
+
+   /* Let the other contexts of the screen use the program too. */
+   if (cache->shared) {
+      kernel = brw_share_kernel(cache->brw->screen->program_cache,
+                                cache_id, hash, key, key_size,
+                                data, data_size, aux, aux_size,
+                                has_stage_prog_data(cache_id));
+   }
+
+   item = brw_cache_add_item(cache, cache_id, hash, key, key_size,
+                             data, data_size, aux, aux_size, kernel);
+
    *out_offset = item->offset;
    *(void **)out_aux = (void *)((char *)item->key + item->key_size);
-   cache->brw->ctx.NewDriverState |= 1 << cache_id;
 }
 
 void
@@ -403,10 +534,15 @@ brw_init_caches(struct brw_context *brw)
 
    cache->brw = brw;
 
-   cache->size = 7;
    cache->n_items = 0;
-   cache->items =
-      calloc(cache->size, sizeof(struct brw_cache_item *));
+   cache->items = _mesa_hash_table_create(NULL, hash_item,
+                                          brw_cache_item_equals);
+   cache->data = _mesa_hash_table_create(NULL, hash_item_data,
+                                         brw_cache_item_data_equals);
+
+   /* Shader time indices are per context, and compiled into the programs. */
+   cache->shared = brw->screen->program_cache != NULL &&
+                   !(INTEL_DEBUG & DEBUG_SHADER_TIME);
 
    cache->bo = brw_bo_alloc(brw->bufmgr, "program cache",  4096, 64);
    if (can_do_exec_capture(brw->screen))
@@ -418,29 +554,25 @@ brw_init_caches(struct brw_context *brw)
 static void
 brw_clear_cache(struct brw_context *brw, struct brw_cache *cache)
 {
-   struct brw_cache_item *c, *next;
-   GLuint i;
+   struct hash_entry *entry;
 
    DBG("%s\n", __func__);
 
-   for (i = 0; i < cache->size; i++) {
-      for (c = cache->items[i]; c; c = next) {
-         next = c->next;
-         if (c->cache_id == BRW_CACHE_VS_PROG ||
-             c->cache_id == BRW_CACHE_TCS_PROG ||
-             c->cache_id == BRW_CACHE_TES_PROG ||
-             c->cache_id == BRW_CACHE_GS_PROG ||
-             c->cache_id == BRW_CACHE_FS_PROG ||
-             c->cache_id == BRW_CACHE_CS_PROG) {
-            const void *item_aux = c->key + c->key_size;
-            brw_stage_prog_data_free(item_aux);
-         }
-         free((void *)c->key);
-         free(c);
+   hash_table_foreach(cache->items, entry) {
+      struct brw_cache_item *c = entry->data;
+
+      if (has_stage_prog_data(c->cache_id)) {
+         const void *item_aux = c->key + c->key_size;
+         brw_stage_prog_data_free(item_aux);
       }
-      cache->items[i] = NULL;
+      if (c->kernel)
+         brw_shared_kernel_unref(brw->screen->program_cache, c->kernel);
+      free((void *)c->key);
+      free(c);
    }
 
+   _mesa_hash_table_clear(cache->items, NULL);
+   _mesa_hash_table_clear(cache->data, NULL);
    cache->n_items = 0;
 
    /* Start putting programs into the start of the BO again, since
@@ -496,10 +628,12 @@ brw_destroy_cache(struct brw_context *brw, struct brw_cache *cache)
       brw_bo_unreference(cache->bo);
       cache->bo = NULL;
    }
-   brw_clear_cache(brw, cache);
-   free(cache->items);
+   if (cache->items)
+      brw_clear_cache(brw, cache);
+   _mesa_hash_table_destroy(cache->items, NULL);
+   _mesa_hash_table_destroy(cache->data, NULL);
    cache->items = NULL;
-   cache->size = 0;
+   cache->data = NULL;
 }
 
 
@@ -540,17 +674,17 @@ void
 brw_print_program_cache(struct brw_context *brw)
 {
    const struct brw_cache *cache = &brw->cache;
-   struct brw_cache_item *item;
+   struct hash_entry *entry;
 
    if (!brw->has_llc)
       brw_bo_map(brw, cache->bo, false);
 
-   for (unsigned i = 0; i < cache->size; i++) {
-      for (item = cache->items[i]; item; item = item->next) {
-         fprintf(stderr, "%s:\n", cache_name(i));
-         brw_disassemble(&brw->screen->devinfo, cache->bo->virtual,
-                         item->offset, item->size, stderr);
-      }
+   hash_table_foreach(cache->items, entry) {
+      const struct brw_cache_item *item = entry->data;
+
+      fprintf(stderr, "%s:\n", cache_name(item->cache_id));
+      brw_disassemble(&brw->screen->devinfo, cache->bo->virtual,
+                      item->offset, item->size, stderr);
    }
 
    if (!brw->has_llc)
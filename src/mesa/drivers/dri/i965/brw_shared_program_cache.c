@@ -0,0 +1,251 @@
+/*
+ * Copyright © 2017 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/** @file brw_shared_program_cache.c
+ *
+ * The table of programs shared by all contexts of a screen.  A context
+ * publishes the programs it compiles here, and one missing a program in
+ * its own cache (brw_program_cache.c) looks here before compiling it.
+ *
+ * It only deals with CPU memory, the contexts upload the programs to
+ * their own BOs.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "c11/threads.h"
+#include "util/hash_table.h"
+#include "util/ralloc.h"
+#include "compiler/brw_compiler.h"
+#include "brw_shared_program_cache.h"
+
+struct brw_shared_program_cache {
+   mtx_t mutex;
+   struct hash_table *kernels;
+};
+
+static uint32_t
+hash_shared_kernel(const void *key)
+{
+   return ((const struct brw_shared_kernel *) key)->hash;
+}
+
+static bool
+brw_shared_kernel_equals(const void *key_a, const void *key_b)
+{
+   const struct brw_shared_kernel *a = key_a, *b = key_b;
+
+   return a->cache_id == b->cache_id &&
+      a->hash == b->hash &&
+      a->key_size == b->key_size &&
+      (memcmp(a->key, b->key, a->key_size) == 0);
+}
+
+static void *
+dup_array(void *mem_ctx, const void *array, size_t size)
+{
+   void *copy;
+
+   if (array == NULL || size == 0)
+      return NULL;
+
+   copy = ralloc_size(mem_ctx, size);
+   if (copy)
+      memcpy(copy, array, size);
+
+   return copy;
+}
+
+/**
+ * Give a copy of a brw_stage_prog_data its own arrays, so the copy and the
+ * original can be freed independently.
+ */
+void
+brw_dup_stage_prog_data(void *mem_ctx, struct brw_stage_prog_data *prog_data)
+{
+   prog_data->param =
+      dup_array(mem_ctx, prog_data->param,
+                prog_data->nr_params * sizeof(*prog_data->param));
+   prog_data->pull_param =
+      dup_array(mem_ctx, prog_data->pull_param,
+                prog_data->nr_pull_params * sizeof(*prog_data->pull_param));
+   prog_data->image_param =
+      dup_array(mem_ctx, prog_data->image_param,
+                prog_data->nr_image_params *
+                sizeof(*prog_data->image_param));
+}
+
+/**
+ * Put a newly compiled program in the screen-wide cache, or take a
+ * reference on the one there if another context compiled it meanwhile.
+ */
+struct brw_shared_kernel *
+brw_share_kernel(struct brw_shared_program_cache *cache,
+                 unsigned cache_id, uint32_t hash,
+                 const void *key, unsigned key_size,
+                 const void *data, unsigned data_size,
+                 const void *aux, unsigned aux_size,
+                 bool aux_is_prog_data)
+{
+   struct brw_shared_kernel lookup, *kernel;
+   struct hash_entry *entry;
+
+   lookup.cache_id = cache_id;
+   lookup.hash = hash;
+   lookup.key = (void *) key;
+   lookup.key_size = key_size;
+
+   mtx_lock(&cache->mutex);
+
+   entry = _mesa_hash_table_search_pre_hashed(cache->kernels, hash, &lookup);
+   if (entry) {
+      kernel = entry->data;
+      kernel->refcount++;
+      goto out;
+   }
+
+   kernel = rzalloc(NULL, struct brw_shared_kernel);
+   if (kernel == NULL)
+      goto out;
+
+   kernel->cache_id = cache_id;
+   kernel->hash = hash;
+   kernel->refcount = 1;
+   kernel->key_size = key_size;
+   kernel->aux_size = aux_size;
+   kernel->data_size = data_size;
+   kernel->key = ralloc_size(kernel, key_size + aux_size);
+   kernel->data = ralloc_size(kernel, data_size);
+   if (kernel->key == NULL || kernel->data == NULL) {
+      ralloc_free(kernel);
+      kernel = NULL;
+      goto out;
+   }
+
+   memcpy(kernel->key, key, key_size);
+   memcpy((char *) kernel->key + key_size, aux, aux_size);
+   memcpy(kernel->data, data, data_size);
+   if (aux_is_prog_data) {
+      brw_dup_stage_prog_data(kernel,
+                              (void *) ((char *) kernel->key + key_size));
+   }
+
+   _mesa_hash_table_insert_pre_hashed(cache->kernels, hash, kernel, kernel);
+
+out:
+   mtx_unlock(&cache->mutex);
+
+   return kernel;
+}
+
+/**
+ * Look a program up, taking a reference on it if found.  The kernel
+ * doesn't change once shared, so it can be read without the lock.
+ */
+struct brw_shared_kernel *
+brw_find_shared_kernel(struct brw_shared_program_cache *cache,
+                       unsigned cache_id, uint32_t hash,
+                       const void *key, unsigned key_size)
+{
+   struct brw_shared_kernel lookup, *kernel = NULL;
+   struct hash_entry *entry;
+
+   lookup.cache_id = cache_id;
+   lookup.hash = hash;
+   lookup.key = (void *) key;
+   lookup.key_size = key_size;
+
+   mtx_lock(&cache->mutex);
+
+   entry = _mesa_hash_table_search_pre_hashed(cache->kernels, hash, &lookup);
+   if (entry) {
+      kernel = entry->data;
+      kernel->refcount++;
+   }
+
+   mtx_unlock(&cache->mutex);
+
+   return kernel;
+}
+
+void
+brw_shared_kernel_unref(struct brw_shared_program_cache *cache,
+                        struct brw_shared_kernel *kernel)
+{
+   mtx_lock(&cache->mutex);
+
+   assert(kernel->refcount > 0);
+   if (--kernel->refcount == 0) {
+      struct hash_entry *entry =
+         _mesa_hash_table_search_pre_hashed(cache->kernels, kernel->hash,
+                                            kernel);
+
+      assert(entry && entry->data == kernel);
+      _mesa_hash_table_remove(cache->kernels, entry);
+      ralloc_free(kernel);
+   }
+
+   mtx_unlock(&cache->mutex);
+}
+
+struct brw_shared_program_cache *
+brw_shared_program_cache_create(void *mem_ctx)
+{
+   struct brw_shared_program_cache *cache;
+
+   cache = rzalloc(mem_ctx, struct brw_shared_program_cache);
+   if (cache == NULL)
+      return NULL;
+
+   cache->kernels = _mesa_hash_table_create(cache, hash_shared_kernel,
+                                            brw_shared_kernel_equals);
+   if (cache->kernels == NULL) {
+      ralloc_free(cache);
+      return NULL;
+   }
+
+   mtx_init(&cache->mutex, mtx_plain);
+
+   return cache;
+}
+
+static void
+delete_shared_kernel(struct hash_entry *entry)
+{
+   ralloc_free(entry->data);
+}
+
+void
+brw_shared_program_cache_destroy(struct brw_shared_program_cache *cache)
+{
+   if (cache == NULL)
+      return;
+
+   /* Contexts drop their references when destroyed, so this is normally
+    * empty already.
+    */
+   _mesa_hash_table_destroy(cache->kernels, delete_shared_kernel);
+   mtx_destroy(&cache->mutex);
+   ralloc_free(cache);
+}
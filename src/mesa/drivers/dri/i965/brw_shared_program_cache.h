@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2017 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef BRW_SHARED_PROGRAM_CACHE_H
+#define BRW_SHARED_PROGRAM_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct brw_stage_prog_data;
+struct brw_shared_program_cache;
+
+/**
+ * A program in the screen-wide cache.  The contexts holding a copy of it
+ * keep a reference, and the last one to let go removes it.
+ */
+struct brw_shared_kernel {
+   unsigned cache_id;
+   uint32_t hash;
+
+   /** Protected by the mutex of the brw_shared_program_cache */
+   unsigned refcount;
+
+   unsigned key_size;
+   unsigned aux_size;
+   unsigned data_size;
+   void *key;           /**< key followed by the aux data */
+   void *data;
+};
+
+struct brw_shared_program_cache *
+brw_shared_program_cache_create(void *mem_ctx);
+
+void
+brw_shared_program_cache_destroy(struct brw_shared_program_cache *cache);
+
+struct brw_shared_kernel *
+brw_share_kernel(struct brw_shared_program_cache *cache,
+                 unsigned cache_id, uint32_t hash,
+                 const void *key, unsigned key_size,
+                 const void *data, unsigned data_size,
+                 const void *aux, unsigned aux_size,
+                 bool aux_is_prog_data);
+
+struct brw_shared_kernel *
+brw_find_shared_kernel(struct brw_shared_program_cache *cache,
+                       unsigned cache_id, uint32_t hash,
+                       const void *key, unsigned key_size);
+
+void
+brw_shared_kernel_unref(struct brw_shared_program_cache *cache,
+                        struct brw_shared_kernel *kernel);
+
+void
+brw_dup_stage_prog_data(void *mem_ctx, struct brw_stage_prog_data *prog_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BRW_SHARED_PROGRAM_CACHE_H */
@@ -114,6 +114,7 @@ DRI_CONF_END
 #include "intel_image.h"
 
 #include "brw_context.h"
+#include "brw_shared_program_cache.h"
 
 #include "i915_drm.h"
 
@@ -1143,6 +1144,7 @@ intelDestroyScreen(__DRIscreen * sPriv)
 {
    struct intel_screen *screen = sPriv->driverPrivate;
 
+   brw_shared_program_cache_destroy(screen->program_cache);
    brw_bufmgr_destroy(screen->bufmgr);
    driDestroyOptionInfo(&screen->optionCache);
 
@@ -2110,6 +2112,7 @@ __DRIconfig **intelInitScreen2(__DRIscreen *dri_screen)
    screen->compiler->shader_debug_log = shader_debug_log_mesa;
    screen->compiler->shader_perf_log = shader_perf_log_mesa;
    screen->program_id = 1;
+   screen->program_cache = brw_shared_program_cache_create(screen);
 
    screen->has_exec_fence =
      intel_get_boolean(screen, I915_PARAM_HAS_EXEC_FENCE);
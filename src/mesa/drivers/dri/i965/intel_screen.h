@@ -83,6 +83,12 @@ struct intel_screen
     */
    unsigned program_id;
 
+   /**
+    * Programs compiled by any context of the screen, see
+    * brw_shared_program_cache.c.
+    */
+   struct brw_shared_program_cache *program_cache;
+
    int winsys_msaa_samples_override;
 
    struct brw_compiler *compiler;
@@ -0,0 +1,175 @@
+/*
+ * Copyright © 2017 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+#include "util/hash_table.h"
+#include "compiler/brw_compiler.h"
+#include "brw_shared_program_cache.h"
+
+/* Any two ids do, the table doesn't know about brw_cache_id. */
+#define VS_PROG 1
+#define FS_PROG 2
+
+class shared_program_cache_test : public ::testing::Test {
+   virtual void SetUp();
+   virtual void TearDown();
+
+public:
+   struct brw_shared_kernel *share(unsigned cache_id, uint32_t key);
+   struct brw_shared_kernel *find(unsigned cache_id, uint32_t key);
+
+   struct brw_shared_program_cache *cache;
+   uint32_t program[16];
+   uint32_t aux[4];
+};
+
+void shared_program_cache_test::SetUp()
+{
+   cache = brw_shared_program_cache_create(NULL);
+   ASSERT_TRUE(cache != NULL);
+
+   for (unsigned i = 0; i < ARRAY_SIZE(program); i++)
+      program[i] = 0x10000 + i;
+   for (unsigned i = 0; i < ARRAY_SIZE(aux); i++)
+      aux[i] = 0x20000 + i;
+}
+
+void shared_program_cache_test::TearDown()
+{
+   brw_shared_program_cache_destroy(cache);
+   cache = NULL;
+}
+
+struct brw_shared_kernel *
+shared_program_cache_test::share(unsigned cache_id, uint32_t key)
+{
+   return brw_share_kernel(cache, cache_id,
+                           _mesa_hash_data(&key, sizeof(key)),
+                           &key, sizeof(key),
+                           program, sizeof(program),
+                           aux, sizeof(aux), false);
+}
+
+struct brw_shared_kernel *
+shared_program_cache_test::find(unsigned cache_id, uint32_t key)
+{
+   return brw_find_shared_kernel(cache, cache_id,
+                                 _mesa_hash_data(&key, sizeof(key)),
+                                 &key, sizeof(key));
+}
+
+TEST_F(shared_program_cache_test, find_after_share)
+{
+   struct brw_shared_kernel *kernel = share(VS_PROG, 42);
+   ASSERT_TRUE(kernel != NULL);
+
+   EXPECT_EQ(NULL, find(VS_PROG, 43));
+   EXPECT_EQ(NULL, find(FS_PROG, 42));
+   EXPECT_EQ(kernel, find(VS_PROG, 42));
+
+   /* The cache keeps copies, not the caller's buffers. */
+   uint32_t key = 42;
+   EXPECT_NE((void *) program, kernel->data);
+   EXPECT_EQ(sizeof(program), kernel->data_size);
+   EXPECT_EQ(0, memcmp(kernel->data, program, sizeof(program)));
+   EXPECT_EQ(sizeof(key), kernel->key_size);
+   EXPECT_EQ(0, memcmp(kernel->key, &key, sizeof(key)));
+   EXPECT_EQ(sizeof(aux), kernel->aux_size);
+   EXPECT_EQ(0, memcmp((char *) kernel->key + sizeof(key), aux, sizeof(aux)));
+
+   brw_shared_kernel_unref(cache, kernel);
+   brw_shared_kernel_unref(cache, kernel);
+}
+
+TEST_F(shared_program_cache_test, share_twice)
+{
+   /* Two contexts compiling the same program get the same kernel. */
+   struct brw_shared_kernel *a = share(VS_PROG, 42);
+   program[0] = ~program[0];
+   struct brw_shared_kernel *b = share(VS_PROG, 42);
+
+   ASSERT_TRUE(a != NULL);
+   EXPECT_EQ(a, b);
+   EXPECT_NE(program[0], ((uint32_t *) a->data)[0]);
+
+   brw_shared_kernel_unref(cache, a);
+   EXPECT_EQ(a, find(VS_PROG, 42));
+   brw_shared_kernel_unref(cache, a);
+   brw_shared_kernel_unref(cache, b);
+}
+
+TEST_F(shared_program_cache_test, last_unref_removes)
+{
+   struct brw_shared_kernel *vs = share(VS_PROG, 42);
+   struct brw_shared_kernel *fs = share(FS_PROG, 42);
+
+   ASSERT_TRUE(vs != NULL);
+   ASSERT_TRUE(fs != NULL);
+   EXPECT_NE(vs, fs);
+
+   brw_shared_kernel_unref(cache, vs);
+   EXPECT_EQ(NULL, find(VS_PROG, 42));
+   EXPECT_EQ(fs, find(FS_PROG, 42));
+
+   brw_shared_kernel_unref(cache, fs);
+   brw_shared_kernel_unref(cache, fs);
+   EXPECT_EQ(NULL, find(FS_PROG, 42));
+}
+
+TEST_F(shared_program_cache_test, prog_data_arrays)
+{
+   /* Only the pointers are copied, never dereferenced. */
+   static const float values[2] = { 1.0f, 2.0f };
+   const union gl_constant_value *param[2] = {
+      (const union gl_constant_value *) &values[0],
+      (const union gl_constant_value *) &values[1],
+   };
+   struct brw_stage_prog_data prog_data;
+   uint64_t key = 42;     /* keeps the prog_data after it aligned */
+
+   memset(&prog_data, 0, sizeof(prog_data));
+   prog_data.nr_params = ARRAY_SIZE(param);
+   prog_data.param = param;
+   prog_data.total_scratch = 1024;
+
+   struct brw_shared_kernel *kernel =
+      brw_share_kernel(cache, VS_PROG, _mesa_hash_data(&key, sizeof(key)),
+                       &key, sizeof(key), program, sizeof(program),
+                       &prog_data, sizeof(prog_data), true);
+   ASSERT_TRUE(kernel != NULL);
+
+   /* The shared prog_data must outlive the context that compiled it. */
+   struct brw_stage_prog_data *shared =
+      (struct brw_stage_prog_data *) ((char *) kernel->key + sizeof(key));
+   EXPECT_EQ(1024u, shared->total_scratch);
+   EXPECT_EQ(ARRAY_SIZE(param), shared->nr_params);
+   ASSERT_TRUE(shared->param != NULL);
+   EXPECT_NE(param, shared->param);
+   EXPECT_EQ(param[0], shared->param[0]);
+   EXPECT_EQ(param[1], shared->param[1]);
+   EXPECT_EQ(NULL, shared->pull_param);
+   EXPECT_EQ(NULL, shared->image_param);
+
+   brw_shared_kernel_unref(cache, kernel);
+}
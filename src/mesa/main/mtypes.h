@@ -2825,6 +2825,12 @@ struct gl_shader_program_data
    struct gl_program_resource *ProgramResourceList;
    unsigned NumProgramResourceList;
 
+   /**
+    * Index of the resource names, by interface, for lookups by name.
+    * \sa _mesa_create_program_resource_hash
+    */
+   struct hash_table *ProgramResourceHash;
+
    enum gl_link_status LinkStatus;   /**< GL_LINK_STATUS */
    GLboolean Validated;
    GLchar *InfoLog;
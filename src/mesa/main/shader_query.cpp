@@ -37,6 +37,7 @@
 #include "compiler/glsl/glsl_symbol_table.h"
 #include "compiler/glsl/ir.h"
 #include "compiler/glsl/program.h"
+#include "util/hash_table.h"
 #include "util/string_to_uint_map.h"
 
 
@@ -460,112 +461,242 @@ valid_array_index(const GLchar *name, unsigned *array_index)
    return true;
 }
 
-/* Find a program resource with specific name in given interface.
+/**
+ * Entry of the resource name index.  Each resource is entered under its
+ * name, and under its name without "[0]" if that's how the name ends.
  */
-struct gl_program_resource *
-_mesa_program_resource_find_name(struct gl_shader_program *shProg,
-                                 GLenum programInterface, const char *name,
-                                 unsigned *array_index)
+struct program_resource_name {
+   GLenum type;
+   const char *name;
+   unsigned length;
+   bool array_zero;  /**< name is missing a "[0]" suffix */
+   unsigned index;   /**< in ProgramResourceList */
+};
+
+static uint32_t
+program_resource_name_hash(const void *key)
+{
+   const struct program_resource_name *rname =
+      (const struct program_resource_name *) key;
+   uint32_t hash = _mesa_hash_data(rname->name, rname->length);
+
+   hash = _mesa_fnv32_1a_accumulate(hash, rname->type);
+   return _mesa_fnv32_1a_accumulate(hash, rname->array_zero);
+}
+
+static bool
+program_resource_name_equal(const void *a, const void *b)
+{
+   const struct program_resource_name *ra =
+      (const struct program_resource_name *) a;
+   const struct program_resource_name *rb =
+      (const struct program_resource_name *) b;
+
+   return ra->type == rb->type &&
+          ra->array_zero == rb->array_zero &&
+          ra->length == rb->length &&
+          memcmp(ra->name, rb->name, ra->length) == 0;
+}
+
+static void
+add_program_resource_name(struct hash_table *ht, GLenum type,
+                          const char *name, unsigned length,
+                          bool array_zero, unsigned index)
 {
+   struct program_resource_name key = {
+      type, name, length, array_zero, index
+   };
+
+   /* Like the list walk this replaced, the first resource wins. */
+   if (_mesa_hash_table_search(ht, &key))
+      return;
+
+   struct program_resource_name *rname =
+      ralloc(ht, struct program_resource_name);
+   if (!rname)
+      return;
+
+   *rname = key;
+   _mesa_hash_table_insert(ht, rname, rname);
+}
+
+/**
+ * Builds the name index used by _mesa_program_resource_find_name.  This
+ * must be called whenever the resource list changes.
+ */
+void
+_mesa_create_program_resource_hash(struct gl_shader_program *shProg)
+{
+   if (shProg->data->ProgramResourceHash) {
+      _mesa_hash_table_destroy(shProg->data->ProgramResourceHash, NULL);
+      shProg->data->ProgramResourceHash = NULL;
+   }
+
+   struct hash_table *ht =
+      _mesa_hash_table_create(shProg->data, program_resource_name_hash,
+                              program_resource_name_equal);
+   if (!ht)
+      return;
+
    struct gl_program_resource *res = shProg->data->ProgramResourceList;
    for (unsigned i = 0; i < shProg->data->NumProgramResourceList;
         i++, res++) {
-      if (res->Type != programInterface)
+      /* These have no names */
+      if (res->Type == GL_ATOMIC_COUNTER_BUFFER ||
+          res->Type == GL_TRANSFORM_FEEDBACK_BUFFER)
          continue;
 
-      /* Resource basename. */
-      const char *rname = _mesa_program_resource_name(res);
-      unsigned baselen = strlen(rname);
-      unsigned baselen_without_array_index = baselen;
-      const char *rname_last_square_bracket = strrchr(rname, '[');
-      bool found = false;
-      bool rname_has_array_index_zero = false;
-      /* From ARB_program_interface_query spec:
-       *
-       * "uint GetProgramResourceIndex(uint program, enum programInterface,
-       *                               const char *name);
-       *  [...]
-       *  If <name> exactly matches the name string of one of the active
-       *  resources for <programInterface>, the index of the matched resource is
-       *  returned. Additionally, if <name> would exactly match the name string
-       *  of an active resource if "[0]" were appended to <name>, the index of
-       *  the matched resource is returned. [...]"
-       *
-       * "A string provided to GetProgramResourceLocation or
-       * GetProgramResourceLocationIndex is considered to match an active variable
-       * if:
-       *
-       *  * the string exactly matches the name of the active variable;
-       *
-       *  * if the string identifies the base name of an active array, where the
-       *    string would exactly match the name of the variable if the suffix
-       *    "[0]" were appended to the string; [...]"
-       */
-      /* Remove array's index from interface block name comparison only if
-       * array's index is zero and the resulting string length is the same
-       * than the provided name's length.
-       */
-      if (rname_last_square_bracket) {
-         baselen_without_array_index -= strlen(rname_last_square_bracket);
-         rname_has_array_index_zero =
-            (strcmp(rname_last_square_bracket, "[0]") == 0) &&
-            (baselen_without_array_index == strlen(name));
-      }
+      const char *name = _mesa_program_resource_name(res);
+      unsigned length = strlen(name);
 
-      if (strncmp(rname, name, baselen) == 0)
-         found = true;
-      else if (rname_has_array_index_zero &&
-               strncmp(rname, name, baselen_without_array_index) == 0)
-         found = true;
-
-      if (found) {
-         switch (programInterface) {
-         case GL_UNIFORM_BLOCK:
-         case GL_SHADER_STORAGE_BLOCK:
-            /* Basename match, check if array or struct. */
-            if (rname_has_array_index_zero ||
-                name[baselen] == '\0' ||
-                name[baselen] == '[' ||
-                name[baselen] == '.') {
-               return res;
-            }
-            break;
-         case GL_TRANSFORM_FEEDBACK_VARYING:
-         case GL_BUFFER_VARIABLE:
-         case GL_UNIFORM:
-         case GL_VERTEX_SUBROUTINE_UNIFORM:
-         case GL_GEOMETRY_SUBROUTINE_UNIFORM:
-         case GL_FRAGMENT_SUBROUTINE_UNIFORM:
-         case GL_COMPUTE_SUBROUTINE_UNIFORM:
-         case GL_TESS_CONTROL_SUBROUTINE_UNIFORM:
-         case GL_TESS_EVALUATION_SUBROUTINE_UNIFORM:
-         case GL_VERTEX_SUBROUTINE:
-         case GL_GEOMETRY_SUBROUTINE:
-         case GL_FRAGMENT_SUBROUTINE:
-         case GL_COMPUTE_SUBROUTINE:
-         case GL_TESS_CONTROL_SUBROUTINE:
-         case GL_TESS_EVALUATION_SUBROUTINE:
-            if (name[baselen] == '.') {
-               return res;
-            }
-            /* fall-through */
-         case GL_PROGRAM_INPUT:
-         case GL_PROGRAM_OUTPUT:
-            if (name[baselen] == '\0') {
-               return res;
-            } else if (name[baselen] == '[' &&
-                valid_array_index(name, array_index)) {
-               return res;
-            }
-            break;
-         default:
-            assert(!"not implemented for given interface");
-         }
+      add_program_resource_name(ht, res->Type, name, length, false, i);
+
+      if (length >= 3 && strcmp(name + length - 3, "[0]") == 0)
+         add_program_resource_name(ht, res->Type, name, length - 3, true, i);
+   }
+
+   shProg->data->ProgramResourceHash = ht;
+}
+
+/**
+ * Looks up the resource named by the first length characters of name and
+ * checks that the rest of name is allowed to follow it.  subscript is set
+ * when name has an array subscript after the resource name.
+ */
+static const struct program_resource_name *
+match_program_resource_name(struct hash_table *ht, GLenum programInterface,
+                            const char *name, unsigned length,
+                            bool array_zero, bool *subscript)
+{
+   struct program_resource_name key = {
+      programInterface, name, length, array_zero, 0
+   };
+   struct hash_entry *entry = _mesa_hash_table_search(ht, &key);
+
+   *subscript = false;
+
+   if (!entry)
+      return NULL;
+
+   const struct program_resource_name *rname =
+      (const struct program_resource_name *) entry->data;
+
+   /* The whole of name with "[0]" appended */
+   if (array_zero)
+      return rname;
+
+   switch (programInterface) {
+   case GL_UNIFORM_BLOCK:
+   case GL_SHADER_STORAGE_BLOCK:
+      /* Basename match, check if array or struct. */
+      if (name[length] == '\0' ||
+          name[length] == '[' ||
+          name[length] == '.') {
+         return rname;
+      }
+      break;
+   case GL_TRANSFORM_FEEDBACK_VARYING:
+   case GL_BUFFER_VARIABLE:
+   case GL_UNIFORM:
+   case GL_VERTEX_SUBROUTINE_UNIFORM:
+   case GL_GEOMETRY_SUBROUTINE_UNIFORM:
+   case GL_FRAGMENT_SUBROUTINE_UNIFORM:
+   case GL_COMPUTE_SUBROUTINE_UNIFORM:
+   case GL_TESS_CONTROL_SUBROUTINE_UNIFORM:
+   case GL_TESS_EVALUATION_SUBROUTINE_UNIFORM:
+   case GL_VERTEX_SUBROUTINE:
+   case GL_GEOMETRY_SUBROUTINE:
+   case GL_FRAGMENT_SUBROUTINE:
+   case GL_COMPUTE_SUBROUTINE:
+   case GL_TESS_CONTROL_SUBROUTINE:
+   case GL_TESS_EVALUATION_SUBROUTINE:
+      if (name[length] == '.') {
+         return rname;
+      }
+      /* fall-through */
+   case GL_PROGRAM_INPUT:
+   case GL_PROGRAM_OUTPUT:
+      if (name[length] == '\0') {
+         return rname;
+      } else if (name[length] == '[' &&
+                 valid_array_index(name, NULL)) {
+         *subscript = true;
+         return rname;
       }
+      break;
+   default:
+      assert(!"not implemented for given interface");
    }
    return NULL;
 }
 
+/* Find a program resource with specific name in given interface.
+ */
+struct gl_program_resource *
+_mesa_program_resource_find_name(struct gl_shader_program *shProg,
+                                 GLenum programInterface, const char *name,
+                                 unsigned *array_index)
+{
+   struct hash_table *ht = shProg->data->ProgramResourceHash;
+   const struct program_resource_name *found = NULL;
+   bool found_subscript = false;
+
+   if (!ht)
+      return NULL;
+
+   /* From ARB_program_interface_query spec:
+    *
+    * "uint GetProgramResourceIndex(uint program, enum programInterface,
+    *                               const char *name);
+    *  [...]
+    *  If <name> exactly matches the name string of one of the active
+    *  resources for <programInterface>, the index of the matched resource is
+    *  returned. Additionally, if <name> would exactly match the name string
+    *  of an active resource if "[0]" were appended to <name>, the index of
+    *  the matched resource is returned. [...]"
+    *
+    * "A string provided to GetProgramResourceLocation or
+    * GetProgramResourceLocationIndex is considered to match an active variable
+    * if:
+    *
+    *  * the string exactly matches the name of the active variable;
+    *
+    *  * if the string identifies the base name of an active array, where the
+    *    string would exactly match the name of the variable if the suffix
+    *    "[0]" were appended to the string; [...]"
+    *
+    * We also accept an array subscript or struct member following a
+    * resource name, so the resource name may be any prefix of name that
+    * ends before a '[' or '.', or name with "[0]" appended.  When several
+    * resources match, the one first in the list is returned.
+    */
+   const unsigned length = strlen(name);
+   for (unsigned i = 0; i <= length + 1; i++) {
+      const bool array_zero = i > length;
+      bool subscript;
+
+      if (i < length && name[i] != '[' && name[i] != '.')
+         continue;
+
+      const struct program_resource_name *rname =
+         match_program_resource_name(ht, programInterface, name,
+                                     MIN2(i, length), array_zero,
+                                     &subscript);
+      if (rname && (!found || rname->index < found->index)) {
+         found = rname;
+         found_subscript = subscript;
+      }
+   }
+
+   if (!found)
+      return NULL;
+
+   if (found_subscript)
+      valid_array_index(name, array_index);
+
+   return &shProg->data->ProgramResourceList[found->index];
+}
+
 static GLuint
 calc_resource_index(struct gl_shader_program *shProg,
                     struct gl_program_resource *res)
@@ -39,6 +39,7 @@
 #include "main/uniforms.h"
 #include "program/program.h"
 #include "program/prog_parameter.h"
+#include "util/hash_table.h"
 #include "util/ralloc.h"
 #include "util/string_to_uint_map.h"
 #include "util/u_atomic.h"
@@ -372,6 +373,11 @@ _mesa_clear_shader_program_data(struct gl_context *ctx,
       shProg->data->ProgramResourceList = NULL;
       shProg->data->NumProgramResourceList = 0;
    }
+
+   if (shProg->data->ProgramResourceHash) {
+      _mesa_hash_table_destroy(shProg->data->ProgramResourceHash, NULL);
+      shProg->data->ProgramResourceHash = NULL;
+   }
 }
 
 
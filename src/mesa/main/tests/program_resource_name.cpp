@@ -0,0 +1,225 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \name program_resource_name.cpp
+ *
+ * Test the name matching rules of _mesa_program_resource_find_name.
+ */
+
+#include <gtest/gtest.h>
+#include "main/mtypes.h"
+#include "main/shaderapi.h"
+#include "compiler/glsl/ir_uniform.h"
+#include "util/hash_table.h"
+#include "util/ralloc.h"
+
+class program_resource_name : public ::testing::Test {
+public:
+   virtual void SetUp();
+   virtual void TearDown();
+
+   void add_resource(GLenum type, const char *name);
+   struct gl_program_resource *find(GLenum type, const char *name);
+
+   struct gl_shader_program *prog;
+   unsigned array_index;
+};
+
+void
+program_resource_name::SetUp()
+{
+   prog = rzalloc(NULL, struct gl_shader_program);
+   prog->data = rzalloc(prog, struct gl_shader_program_data);
+}
+
+void
+program_resource_name::TearDown()
+{
+   ralloc_free(prog);
+   prog = NULL;
+}
+
+void
+program_resource_name::add_resource(GLenum type, const char *name)
+{
+   struct gl_program_resource *res;
+   void *data;
+
+   switch (type) {
+   case GL_UNIFORM_BLOCK:
+   case GL_SHADER_STORAGE_BLOCK: {
+      struct gl_uniform_block *block = rzalloc(prog, struct gl_uniform_block);
+      block->Name = ralloc_strdup(block, name);
+      data = block;
+      break;
+   }
+   case GL_PROGRAM_INPUT:
+   case GL_PROGRAM_OUTPUT: {
+      struct gl_shader_variable *var =
+         rzalloc(prog, struct gl_shader_variable);
+      var->name = ralloc_strdup(var, name);
+      data = var;
+      break;
+   }
+   default: {
+      struct gl_uniform_storage *uni =
+         rzalloc(prog, struct gl_uniform_storage);
+      uni->name = ralloc_strdup(uni, name);
+      data = uni;
+      break;
+   }
+   }
+
+   prog->data->ProgramResourceList =
+      reralloc(prog, prog->data->ProgramResourceList, gl_program_resource,
+               prog->data->NumProgramResourceList + 1);
+   res = &prog->data->ProgramResourceList[prog->data->NumProgramResourceList++];
+   res->Type = type;
+   res->Data = data;
+   res->StageReferences = 0;
+
+   _mesa_create_program_resource_hash(prog);
+}
+
+struct gl_program_resource *
+program_resource_name::find(GLenum type, const char *name)
+{
+   array_index = 0;
+   return _mesa_program_resource_find_name(prog, type, name, &array_index);
+}
+
+#define RESOURCE(i) (&prog->data->ProgramResourceList[i])
+
+TEST_F(program_resource_name, exact_match)
+{
+   add_resource(GL_UNIFORM, "color");
+   add_resource(GL_UNIFORM, "scale");
+
+   EXPECT_EQ(RESOURCE(0), find(GL_UNIFORM, "color"));
+   EXPECT_EQ(RESOURCE(1), find(GL_UNIFORM, "scale"));
+   EXPECT_EQ(NULL, find(GL_UNIFORM, "colo"));
+   EXPECT_EQ(NULL, find(GL_UNIFORM, "colors"));
+   EXPECT_EQ(NULL, find(GL_UNIFORM, ""));
+}
+
+TEST_F(program_resource_name, interfaces_are_separate)
+{
+   add_resource(GL_PROGRAM_INPUT, "v");
+   add_resource(GL_UNIFORM, "v");
+
+   EXPECT_EQ(RESOURCE(0), find(GL_PROGRAM_INPUT, "v"));
+   EXPECT_EQ(RESOURCE(1), find(GL_UNIFORM, "v"));
+   EXPECT_EQ(NULL, find(GL_PROGRAM_OUTPUT, "v"));
+}
+
+TEST_F(program_resource_name, array_subscript)
+{
+   add_resource(GL_UNIFORM, "arr");
+   add_resource(GL_PROGRAM_INPUT, "attr");
+
+   EXPECT_EQ(RESOURCE(0), find(GL_UNIFORM, "arr[3]"));
+   EXPECT_EQ(3u, array_index);
+   EXPECT_EQ(RESOURCE(1), find(GL_PROGRAM_INPUT, "attr[1]"));
+   EXPECT_EQ(1u, array_index);
+
+   EXPECT_EQ(NULL, find(GL_UNIFORM, "arr[x]"));
+   EXPECT_EQ(NULL, find(GL_UNIFORM, "arr[3"));
+   EXPECT_EQ(NULL, find(GL_UNIFORM, "arr[01]"));
+}
+
+TEST_F(program_resource_name, array_base_name)
+{
+   /* Arrays of arrays are listed per element of the outer array */
+   add_resource(GL_UNIFORM, "a[0]");
+   add_resource(GL_UNIFORM, "a[1]");
+   add_resource(GL_TRANSFORM_FEEDBACK_VARYING, "out_v[0]");
+
+   EXPECT_EQ(RESOURCE(0), find(GL_UNIFORM, "a"));
+   EXPECT_EQ(RESOURCE(0), find(GL_UNIFORM, "a[0]"));
+   EXPECT_EQ(RESOURCE(1), find(GL_UNIFORM, "a[1]"));
+   EXPECT_EQ(RESOURCE(1), find(GL_UNIFORM, "a[1][2]"));
+   EXPECT_EQ(2u, array_index);
+   EXPECT_EQ(RESOURCE(2), find(GL_TRANSFORM_FEEDBACK_VARYING, "out_v"));
+
+   /* Only "[0]" may be left out */
+   add_resource(GL_UNIFORM, "b[1]");
+   EXPECT_EQ(NULL, find(GL_UNIFORM, "b"));
+}
+
+TEST_F(program_resource_name, struct_members)
+{
+   add_resource(GL_UNIFORM, "s.x");
+   add_resource(GL_UNIFORM, "s.y");
+   add_resource(GL_PROGRAM_INPUT, "in_s");
+
+   EXPECT_EQ(RESOURCE(0), find(GL_UNIFORM, "s.x"));
+   EXPECT_EQ(RESOURCE(1), find(GL_UNIFORM, "s.y"));
+   EXPECT_EQ(NULL, find(GL_UNIFORM, "s"));
+   EXPECT_EQ(NULL, find(GL_UNIFORM, "s.z"));
+
+   /* Inputs can't have members following their name */
+   EXPECT_EQ(NULL, find(GL_PROGRAM_INPUT, "in_s.x"));
+}
+
+TEST_F(program_resource_name, blocks)
+{
+   add_resource(GL_UNIFORM_BLOCK, "Block[0]");
+   add_resource(GL_UNIFORM_BLOCK, "Block[1]");
+   add_resource(GL_SHADER_STORAGE_BLOCK, "Data");
+
+   EXPECT_EQ(RESOURCE(0), find(GL_UNIFORM_BLOCK, "Block"));
+   EXPECT_EQ(RESOURCE(0), find(GL_UNIFORM_BLOCK, "Block[0]"));
+   EXPECT_EQ(RESOURCE(1), find(GL_UNIFORM_BLOCK, "Block[1]"));
+   EXPECT_EQ(NULL, find(GL_UNIFORM_BLOCK, "Block[2]"));
+
+   EXPECT_EQ(RESOURCE(2), find(GL_SHADER_STORAGE_BLOCK, "Data"));
+   EXPECT_EQ(RESOURCE(2), find(GL_SHADER_STORAGE_BLOCK, "Data.member"));
+   EXPECT_EQ(NULL, find(GL_SHADER_STORAGE_BLOCK, "Dat"));
+}
+
+TEST_F(program_resource_name, first_match_wins)
+{
+   add_resource(GL_UNIFORM, "u");
+   add_resource(GL_UNIFORM, "u[0]");
+
+   /* Both match "u[0]", the list order decides */
+   EXPECT_EQ(RESOURCE(0), find(GL_UNIFORM, "u[0]"));
+   EXPECT_EQ(RESOURCE(0), find(GL_UNIFORM, "u"));
+}
+
+TEST_F(program_resource_name, many_resources)
+{
+   char name[32];
+
+   for (unsigned i = 0; i < 1000; i++) {
+      snprintf(name, sizeof(name), "uniform_%u", i);
+      add_resource(GL_UNIFORM, name);
+   }
+
+   for (unsigned i = 0; i < 1000; i++) {
+      snprintf(name, sizeof(name), "uniform_%u[%u]", i, i % 7);
+      EXPECT_EQ(RESOURCE(i), find(GL_UNIFORM, name));
+      EXPECT_EQ(i % 7, array_index);
+   }
+}
@@ -432,6 +432,7 @@ public:
    bool have_fma;
    bool use_shared_memory;
    bool has_tex_txf_lz;
+   bool mediump_floats;
 
    variable_storage *find_variable_storage(ir_variable *var);
 
@@ -4557,6 +4558,7 @@ glsl_to_tgsi_visitor::glsl_to_tgsi_visitor()
    have_fma = false;
    use_shared_memory = false;
    has_tex_txf_lz = false;
+   mediump_floats = false;
 }
 
 glsl_to_tgsi_visitor::~glsl_to_tgsi_visitor()
@@ -6375,6 +6377,9 @@ st_translate_program(
       assert(0);
    }
 
+   if (program->mediump_floats)
+      ureg_property(ureg, TGSI_PROPERTY_MEDIUMP_FLOAT, 1);
+
    if (procType == PIPE_SHADER_FRAGMENT) {
       if (program->shader->Program->info.fs.early_fragment_tests ||
           program->shader->Program->info.fs.post_depth_coverage) {
@@ -6706,6 +6711,11 @@ get_mesa_program_tgsi(struct gl_context *ctx,
       pscreen->get_shader_param(pscreen, ptarget,
                                 PIPE_SHADER_CAP_TGSI_SKIP_MERGE_REGISTERS);
 
+   /* Precision qualifiers only mean something in GLSL ES. */
+   if (shader_program->IsES)
+      v->mediump_floats = has_only_mediump_floats(shader->ir,
+                                                  shader_program->data->Version);
+
    _mesa_generate_parameters_list_for_uniforms(shader_program, shader,
                                                prog->Parameters);
 
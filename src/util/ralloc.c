@@ -76,10 +76,24 @@ struct
    struct ralloc_header *next;
 
    void (*destructor)(void *);
+
+   /* Requested size, for the statistics */
+   size_t size;
 };
 
 typedef struct ralloc_header ralloc_header;
 
+static bool stats_enabled;
+static struct ralloc_stats stats;
+
+static inline void
+stats_add(long long size)
+{
+   stats.current += size;
+   if (stats.current > stats.peak)
+      stats.peak = stats.current;
+}
+
 static void unlink_block(ralloc_header *info);
 static void unsafe_free(ralloc_header *info);
 
@@ -135,6 +149,12 @@ ralloc_size(const void *ctx, size_t size)
    info->prev = NULL;
    info->next = NULL;
    info->destructor = NULL;
+   info->size = size;
+
+   if (unlikely(stats_enabled)) {
+      stats_add(size);
+      stats.allocations++;
+   }
 
    parent = ctx != NULL ? get_header(ctx) : NULL;
 
@@ -170,6 +190,10 @@ resize(void *ptr, size_t size)
    if (info == NULL)
       return NULL;
 
+   if (unlikely(stats_enabled))
+      stats_add((long long) size - (long long) info->size);
+   info->size = size;
+
    /* Update parent and sibling's links to the reallocated node. */
    if (info != old && info->parent != NULL) {
       if (info->parent->child == old)
@@ -273,6 +297,9 @@ unsafe_free(ralloc_header *info)
    if (info->destructor != NULL)
       info->destructor(PTR_FROM_HEADER(info));
 
+   if (unlikely(stats_enabled))
+      stats.current -= info->size;
+
    free(info);
 }
 
@@ -338,6 +365,25 @@ ralloc_set_destructor(const void *ptr, void(*destructor)(void *))
    info->destructor = destructor;
 }
 
+void
+ralloc_enable_stats(bool enable)
+{
+   stats_enabled = enable;
+   memset(&stats, 0, sizeof(stats));
+}
+
+void
+ralloc_get_stats(struct ralloc_stats *out)
+{
+   *out = stats;
+}
+
+void
+ralloc_reset_peak(void)
+{
+   stats.peak = stats.current;
+}
+
 char *
 ralloc_strdup(const void *ctx, const char *str)
 {
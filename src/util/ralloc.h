@@ -251,6 +251,36 @@ void *ralloc_parent(const void *ptr);
  */
 void ralloc_set_destructor(const void *ptr, void(*destructor)(void *));
 
+/**
+ * Allocation statistics, for tools measuring the memory used by code built
+ * on ralloc.  Sizes are the requested sizes, without ralloc's overhead.
+ */
+struct ralloc_stats {
+   /** Bytes allocated minus bytes freed since the stats were enabled.
+    *  Can go negative when older blocks get freed.
+    */
+   long long current;
+   /** Highest value of \c current since the last ralloc_reset_peak() */
+   long long peak;
+   /** Number of allocations since the stats were enabled */
+   unsigned long long allocations;
+};
+
+/**
+ * Start or stop collecting statistics, which also resets them.
+ *
+ * The counters are global and not thread-safe, so this is only meant for
+ * single-threaded tools like the standalone compilers.
+ */
+void ralloc_enable_stats(bool enable);
+
+void ralloc_get_stats(struct ralloc_stats *stats);
+
+/**
+ * Restart peak tracking from the current usage.
+ */
+void ralloc_reset_peak(void);
+
 /// \defgroup array String Functions @{
 /**
  * Duplicate a string, allocating the memory from the given context.
@@ -0,0 +1,242 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Checks every tiling, texel size and available set of kernels against
+ * per-byte reference address computations, on random rectangles.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tiled_memcpy.h"
+
+#define WIDTH_TILES  4
+#define HEIGHT_TILES 3
+#define ITERATIONS   200
+
+static const char *tiling_names[] = {
+   "intel-x", "intel-y", "vc4-lt", "vc4-t",
+};
+
+static const char *isa_names[] = {
+   "scalar", "sse2", "avx2", "neon",
+};
+
+/* Every case starts from the same seed, so that a failure can be
+ * reproduced whatever kernels the machine supports.
+ */
+#define SEED 1
+
+static uint32_t seed;
+
+static uint32_t
+rand_u32(void)
+{
+   /* xorshift32, to be reproducible across platforms */
+   seed ^= seed << 13;
+   seed ^= seed >> 17;
+   seed ^= seed << 5;
+   return seed;
+}
+
+/** Width in bytes and height of one tile */
+static void
+tile_size(enum tiled_memcpy_tiling tiling, unsigned cpp,
+          uint32_t *tile_w, uint32_t *tile_h)
+{
+   switch (tiling) {
+   case TILED_MEMCPY_INTEL_X:
+      *tile_w = 512;
+      *tile_h = 8;
+      break;
+   case TILED_MEMCPY_INTEL_Y:
+      *tile_w = 128;
+      *tile_h = 32;
+      break;
+   case TILED_MEMCPY_VC4_LT:
+      *tile_w = cpp == 1 ? 8 : 16;
+      *tile_h = 64 / *tile_w;
+      break;
+   case TILED_MEMCPY_VC4_T:
+      /* 8x8 microtiles */
+      *tile_w = 8 * (cpp == 1 ? 8 : 16);
+      *tile_h = 8 * (64 / (cpp == 1 ? 8 : 16));
+      break;
+   }
+}
+
+/** Offset of byte xb of row y in the tiled surface */
+static uint32_t
+reference_offset(enum tiled_memcpy_tiling tiling, unsigned cpp,
+                 uint32_t pitch, uint32_t xb, uint32_t y)
+{
+   switch (tiling) {
+   case TILED_MEMCPY_INTEL_X: {
+      uint32_t tile = (y / 8) * (pitch / 512) + xb / 512;
+      return tile * 4096 + (y % 8) * 512 + xb % 512;
+   }
+   case TILED_MEMCPY_INTEL_Y: {
+      uint32_t tile = (y / 32) * (pitch / 128) + xb / 128;
+      return tile * 4096 + (xb % 128) / 16 * 512 + (y % 32) * 16 + xb % 16;
+   }
+   case TILED_MEMCPY_VC4_LT: {
+      uint32_t uw = cpp == 1 ? 8 : 16, uh = 64 / uw;
+      return (y / uh) * (pitch / uw) * 64 + (xb / uw) * 64 +
+             (y % uh) * uw + xb % uw;
+   }
+   case TILED_MEMCPY_VC4_T: {
+      uint32_t uw = cpp == 1 ? 8 : 16, uh = 64 / uw;
+      uint32_t ux = xb / uw, uy = y / uh;
+      uint32_t tiles_per_row = pitch / uw / 8;
+      uint32_t tx = ux / 8, ty = uy / 8;
+      /* Subtile order within a 4k tile, indexed by (sy * 2 + sx). */
+      static const uint32_t even[4] = {0, 3, 1, 2};
+      static const uint32_t odd[4] = {2, 1, 3, 0};
+      uint32_t s = ((uy / 4) % 2) * 2 + (ux / 4) % 2;
+
+      if (ty % 2)
+         tx = tiles_per_row - 1 - tx;
+
+      return (ty * tiles_per_row + tx) * 4096 +
+             (ty % 2 ? odd[s] : even[s]) * 1024 +
+             ((uy % 4) * 4 + ux % 4) * 64 +
+             (y % uh) * uw + xb % uw;
+   }
+   }
+   abort();
+}
+
+static bool
+test_one(enum tiled_memcpy_isa isa, enum tiled_memcpy_tiling tiling,
+         unsigned cpp)
+{
+   uint32_t tile_w, tile_h;
+   tile_size(tiling, cpp, &tile_w, &tile_h);
+
+   const uint32_t pitch = tile_w * WIDTH_TILES;
+   const uint32_t height = tile_h * HEIGHT_TILES;
+   const uint32_t size = pitch * height;
+   /* The linear rows can be up to two texels longer than the rectangle. */
+   const uint32_t linear_size = height * (pitch + 2 * cpp);
+   const uint32_t width_px = pitch / cpp;
+   uint8_t *tiled = malloc(size);
+   uint8_t *linear = malloc(linear_size);
+   uint8_t *result = malloc(linear_size);
+   bool pass = true;
+
+   seed = SEED;
+
+   for (unsigned i = 0; i < ITERATIONS && pass; i++) {
+      uint32_t x = rand_u32() % width_px;
+      uint32_t y = rand_u32() % height;
+      uint32_t w = 1 + rand_u32() % (width_px - x);
+      uint32_t h = 1 + rand_u32() % (height - y);
+      /* Leave some of the rows unaligned in memory. */
+      int32_t linear_pitch = w * cpp + (rand_u32() % 3) * cpp;
+
+      for (uint32_t b = 0; b < size; b++)
+         tiled[b] = rand_u32();
+      for (uint32_t b = 0; b < linear_size; b++)
+         linear[b] = rand_u32();
+      memcpy(result, tiled, size);
+
+      tiled_memcpy_linear_to_tiled_isa(isa, tiling, cpp, result, pitch,
+                                       linear, linear_pitch, x, y, w, h);
+
+      for (uint32_t row = 0; row < height && pass; row++) {
+         for (uint32_t xb = 0; xb < pitch; xb++) {
+            uint32_t offset = reference_offset(tiling, cpp, pitch, xb, row);
+            uint8_t expected = tiled[offset];
+
+            if (row >= y && row < y + h &&
+                xb >= x * cpp && xb < (x + w) * cpp)
+               expected = linear[(row - y) * linear_pitch + xb - x * cpp];
+
+            if (result[offset] != expected) {
+               printf("linear to tiled: byte %u of row %u differs\n",
+                      xb, row);
+               pass = false;
+               break;
+            }
+         }
+      }
+
+      memset(result, 0, linear_size);
+      tiled_memcpy_tiled_to_linear_isa(isa, tiling, cpp, result, linear_pitch,
+                                       tiled, pitch, x, y, w, h);
+
+      for (uint32_t row = 0; row < h && pass; row++) {
+         for (uint32_t xb = 0; xb < w * cpp; xb++) {
+            uint32_t offset = reference_offset(tiling, cpp, pitch,
+                                               x * cpp + xb, y + row);
+
+            if (result[row * linear_pitch + xb] != tiled[offset]) {
+               printf("tiled to linear: byte %u of row %u differs\n",
+                      xb, row);
+               pass = false;
+               break;
+            }
+         }
+      }
+
+      if (!pass) {
+         printf("  rectangle %ux%u at (%u, %u), linear pitch %d\n",
+                w, h, x, y, linear_pitch);
+      }
+   }
+
+   free(tiled);
+   free(linear);
+   free(result);
+   return pass;
+}
+
+int
+main(void)
+{
+   bool pass = true;
+
+   for (unsigned isa = TILED_MEMCPY_ISA_SCALAR;
+        isa <= TILED_MEMCPY_ISA_NEON; isa++) {
+      if (!tiled_memcpy_isa_supported(isa))
+         continue;
+
+      for (unsigned tiling = TILED_MEMCPY_INTEL_X;
+           tiling <= TILED_MEMCPY_VC4_T; tiling++) {
+         unsigned max_cpp = tiling >= TILED_MEMCPY_VC4_LT ? 8 : 16;
+
+         for (unsigned cpp = 1; cpp <= max_cpp; cpp *= 2) {
+            if (!test_one(isa, tiling, cpp)) {
+               printf("FAIL: %s %s cpp %u\n",
+                      isa_names[isa], tiling_names[tiling], cpp);
+               pass = false;
+            }
+         }
+      }
+   }
+
+   return pass ? 0 : 1;
+}
@@ -0,0 +1,462 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "c11/threads.h"
+#include "util/macros.h"
+#include "tiled_memcpy.h"
+#include "tiled_memcpy_priv.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TILED_MEMCPY_HAVE_NEON
+#endif
+
+/**
+ * Layout of the blocks of one tiling.  See tiled_memcpy.h.
+ */
+struct tiled_layout {
+   uint32_t span;   /**< block width in bytes */
+   uint32_t rows;   /**< block height */
+   /** Byte offset of block (bx, by) in the tiled surface */
+   uint32_t (*block_offset)(uint32_t bx, uint32_t by, uint32_t rows,
+                            uint32_t pitch);
+};
+
+
+static uint32_t
+intel_x_block_offset(uint32_t bx, uint32_t by, uint32_t rows, uint32_t pitch)
+{
+   /* One block per 512x8 tile */
+   return by * pitch * rows + bx * 4096;
+}
+
+static uint32_t
+intel_y_block_offset(uint32_t bx, uint32_t by, uint32_t rows, uint32_t pitch)
+{
+   /* Eight 16x32 blocks per 128x32 tile */
+   return by * pitch * rows + (bx >> 3) * 4096 + (bx & 7) * 512;
+}
+
+static uint32_t
+vc4_lt_block_offset(uint32_t bx, uint32_t by, uint32_t rows, uint32_t pitch)
+{
+   /* One block per 64 byte microtile */
+   return by * pitch * rows + bx * 64;
+}
+
+static uint32_t
+vc4_t_block_offset(uint32_t bx, uint32_t by, uint32_t rows, uint32_t pitch)
+{
+   static const uint32_t odd_stile_map[4] = {2, 1, 3, 0};
+   static const uint32_t even_stile_map[4] = {0, 3, 1, 2};
+   /* pitch / span: width of the image in microtiles */
+   const uint32_t utile_stride = pitch * rows / 64;
+   const uint32_t tile_stride = utile_stride >> 3;
+   uint32_t tile_x = bx >> 3;
+   const uint32_t tile_y = by >> 3;
+   const bool odd_tile_y = tile_y & 1;
+   uint32_t stile_index;
+
+   assert(!(utile_stride & 7));
+
+   /* Odd lines of 4k tiles go right-to-left. */
+   if (odd_tile_y)
+      tile_x = tile_stride - tile_x - 1;
+
+   stile_index = (((by >> 2) & 1) << 1) + ((bx >> 2) & 1);
+
+   return 4096 * (tile_y * tile_stride + tile_x) +
+          1024 * (odd_tile_y ? odd_stile_map[stile_index] :
+                               even_stile_map[stile_index]) +
+          256 * (by & 3) + 64 * (bx & 3);
+}
+
+static struct tiled_layout
+get_layout(enum tiled_memcpy_tiling tiling, unsigned cpp)
+{
+   struct tiled_layout layout;
+
+   assert(cpp && !(cpp & (cpp - 1)) && cpp <= 16);
+
+   switch (tiling) {
+   case TILED_MEMCPY_INTEL_X:
+      layout.span = 512;
+      layout.rows = 8;
+      layout.block_offset = intel_x_block_offset;
+      break;
+   case TILED_MEMCPY_INTEL_Y:
+      layout.span = 16;
+      layout.rows = 32;
+      layout.block_offset = intel_y_block_offset;
+      break;
+   case TILED_MEMCPY_VC4_LT:
+   case TILED_MEMCPY_VC4_T:
+      /* 64 byte microtiles, 8x8 at 8bpp, 8x4 at 16bpp, 4x4 at 32bpp and
+       * 2x4 at 64bpp.
+       */
+      assert(cpp <= 8);
+      layout.span = cpp == 1 ? 8 : 16;
+      layout.rows = 64 / layout.span;
+      layout.block_offset = tiling == TILED_MEMCPY_VC4_LT ?
+                            vc4_lt_block_offset : vc4_t_block_offset;
+      break;
+   default:
+      unreachable("unknown tiling");
+   }
+
+   return layout;
+}
+
+
+/*
+ * Scalar kernels.
+ */
+
+static void
+block_to_tiled_scalar(uint8_t *tiled, const uint8_t *linear,
+                      int32_t linear_pitch, uint32_t span, uint32_t rows)
+{
+   for (uint32_t r = 0; r < rows; r++) {
+      memcpy(tiled, linear, span);
+      tiled += span;
+      linear += linear_pitch;
+   }
+}
+
+static void
+block_to_linear_scalar(uint8_t *linear, int32_t linear_pitch,
+                       const uint8_t *tiled, uint32_t span, uint32_t rows)
+{
+   for (uint32_t r = 0; r < rows; r++) {
+      memcpy(linear, tiled, span);
+      tiled += span;
+      linear += linear_pitch;
+   }
+}
+
+static const struct tiled_memcpy_kernels scalar_kernels = {
+   block_to_tiled_scalar,
+   block_to_linear_scalar,
+};
+
+
+/*
+ * SSE2 kernels.
+ */
+
+#if defined(__SSE2__)
+static void
+block_to_tiled_sse2(uint8_t *tiled, const uint8_t *linear,
+                    int32_t linear_pitch, uint32_t span, uint32_t rows)
+{
+   if (span == 8) {
+      for (uint32_t r = 0; r < rows; r++) {
+         _mm_storel_epi64((__m128i *)tiled,
+                          _mm_loadl_epi64((const __m128i *)linear));
+         tiled += 8;
+         linear += linear_pitch;
+      }
+      return;
+   }
+
+   for (uint32_t r = 0; r < rows; r++) {
+      for (uint32_t x = 0; x < span; x += 16) {
+         _mm_storeu_si128((__m128i *)(tiled + x),
+                          _mm_loadu_si128((const __m128i *)(linear + x)));
+      }
+      tiled += span;
+      linear += linear_pitch;
+   }
+}
+
+static void
+block_to_linear_sse2(uint8_t *linear, int32_t linear_pitch,
+                     const uint8_t *tiled, uint32_t span, uint32_t rows)
+{
+   if (span == 8) {
+      for (uint32_t r = 0; r < rows; r++) {
+         _mm_storel_epi64((__m128i *)linear,
+                          _mm_loadl_epi64((const __m128i *)tiled));
+         tiled += 8;
+         linear += linear_pitch;
+      }
+      return;
+   }
+
+   for (uint32_t r = 0; r < rows; r++) {
+      for (uint32_t x = 0; x < span; x += 16) {
+         _mm_storeu_si128((__m128i *)(linear + x),
+                          _mm_loadu_si128((const __m128i *)(tiled + x)));
+      }
+      tiled += span;
+      linear += linear_pitch;
+   }
+}
+
+static const struct tiled_memcpy_kernels sse2_kernels = {
+   block_to_tiled_sse2,
+   block_to_linear_sse2,
+};
+#endif
+
+
+/*
+ * NEON kernels.
+ */
+
+#ifdef TILED_MEMCPY_HAVE_NEON
+static void
+block_to_tiled_neon(uint8_t *tiled, const uint8_t *linear,
+                    int32_t linear_pitch, uint32_t span, uint32_t rows)
+{
+   if (span == 8) {
+      for (uint32_t r = 0; r < rows; r++) {
+         vst1_u8(tiled, vld1_u8(linear));
+         tiled += 8;
+         linear += linear_pitch;
+      }
+      return;
+   }
+
+   for (uint32_t r = 0; r < rows; r++) {
+      for (uint32_t x = 0; x < span; x += 16)
+         vst1q_u8(tiled + x, vld1q_u8(linear + x));
+      tiled += span;
+      linear += linear_pitch;
+   }
+}
+
+static void
+block_to_linear_neon(uint8_t *linear, int32_t linear_pitch,
+                     const uint8_t *tiled, uint32_t span, uint32_t rows)
+{
+   if (span == 8) {
+      for (uint32_t r = 0; r < rows; r++) {
+         vst1_u8(linear, vld1_u8(tiled));
+         tiled += 8;
+         linear += linear_pitch;
+      }
+      return;
+   }
+
+   for (uint32_t r = 0; r < rows; r++) {
+      for (uint32_t x = 0; x < span; x += 16)
+         vst1q_u8(linear + x, vld1q_u8(tiled + x));
+      tiled += span;
+      linear += linear_pitch;
+   }
+}
+
+static const struct tiled_memcpy_kernels neon_kernels = {
+   block_to_tiled_neon,
+   block_to_linear_neon,
+};
+#endif
+
+
+/*
+ * Kernel selection.
+ */
+
+static const struct tiled_memcpy_kernels *kernels = &scalar_kernels;
+static enum tiled_memcpy_isa kernels_isa = TILED_MEMCPY_ISA_SCALAR;
+static once_flag kernels_once = ONCE_FLAG_INIT;
+
+static const struct tiled_memcpy_kernels *
+get_kernels(enum tiled_memcpy_isa isa)
+{
+   switch (isa) {
+#if defined(__SSE2__)
+   case TILED_MEMCPY_ISA_SSE2:
+      return &sse2_kernels;
+#endif
+#ifdef USE_AVX2
+   case TILED_MEMCPY_ISA_AVX2:
+      return __builtin_cpu_supports("avx2") ? &tiled_memcpy_avx2_kernels :
+                                              NULL;
+#endif
+#ifdef TILED_MEMCPY_HAVE_NEON
+   case TILED_MEMCPY_ISA_NEON:
+      return &neon_kernels;
+#endif
+   case TILED_MEMCPY_ISA_SCALAR:
+      return &scalar_kernels;
+   default:
+      return NULL;
+   }
+}
+
+static void
+select_kernels(void)
+{
+   static const enum tiled_memcpy_isa preferred[] = {
+      TILED_MEMCPY_ISA_AVX2,
+      TILED_MEMCPY_ISA_SSE2,
+      TILED_MEMCPY_ISA_NEON,
+   };
+
+   for (unsigned i = 0; i < ARRAY_SIZE(preferred); i++) {
+      if (get_kernels(preferred[i])) {
+         kernels = get_kernels(preferred[i]);
+         kernels_isa = preferred[i];
+         return;
+      }
+   }
+}
+
+bool
+tiled_memcpy_isa_supported(enum tiled_memcpy_isa isa)
+{
+   return get_kernels(isa) != NULL;
+}
+
+/** The best supported kernels, picked the first time they're needed. */
+static const struct tiled_memcpy_kernels *
+selected_kernels(void)
+{
+   call_once(&kernels_once, select_kernels);
+   return kernels;
+}
+
+enum tiled_memcpy_isa
+tiled_memcpy_get_isa(void)
+{
+   call_once(&kernels_once, select_kernels);
+   return kernels_isa;
+}
+
+/**
+ * Walk the blocks touched by the rectangle, copying whole blocks with the
+ * kernels and the parts of blocks on the edges row by row.
+ */
+static void
+tiled_memcpy(const struct tiled_memcpy_kernels *k,
+             enum tiled_memcpy_tiling tiling, unsigned cpp,
+             uint8_t *tiled, uint32_t tiled_pitch,
+             uint8_t *linear, int32_t linear_pitch,
+             uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+             bool to_tiled)
+{
+   const struct tiled_layout layout = get_layout(tiling, cpp);
+   const uint32_t x0 = x * cpp, x1 = (x + width) * cpp;
+   const uint32_t y0 = y, y1 = y + height;
+
+   if (!width || !height)
+      return;
+
+   for (uint32_t by = y0 / layout.rows; by * layout.rows < y1; by++) {
+      const uint32_t row_start = by * layout.rows;
+      const uint32_t r0 = MAX2(y0, row_start) - row_start;
+      const uint32_t r1 = MIN2(y1, row_start + layout.rows) - row_start;
+
+      for (uint32_t bx = x0 / layout.span; bx * layout.span < x1; bx++) {
+         const uint32_t col_start = bx * layout.span;
+         const uint32_t c0 = MAX2(x0, col_start) - col_start;
+         const uint32_t c1 = MIN2(x1, col_start + layout.span) - col_start;
+         uint8_t *t = tiled + layout.block_offset(bx, by, layout.rows,
+                                                  tiled_pitch);
+         uint8_t *l = linear +
+                      (int64_t)(row_start + r0 - y0) * linear_pitch +
+                      (col_start + c0 - x0);
+
+         if (c0 == 0 && c1 == layout.span &&
+             r0 == 0 && r1 == layout.rows) {
+            if (to_tiled)
+               k->to_tiled(t, l, linear_pitch, layout.span, layout.rows);
+            else
+               k->to_linear(l, linear_pitch, t, layout.span, layout.rows);
+            continue;
+         }
+
+         t += r0 * layout.span + c0;
+         for (uint32_t r = r0; r < r1; r++) {
+            if (to_tiled)
+               memcpy(t, l, c1 - c0);
+            else
+               memcpy(l, t, c1 - c0);
+            t += layout.span;
+            l += linear_pitch;
+         }
+      }
+   }
+}
+
+void
+tiled_memcpy_linear_to_tiled(enum tiled_memcpy_tiling tiling, unsigned cpp,
+                             void *tiled, uint32_t tiled_pitch,
+                             const void *linear, int32_t linear_pitch,
+                             uint32_t x, uint32_t y,
+                             uint32_t width, uint32_t height)
+{
+   tiled_memcpy(selected_kernels(), tiling, cpp, tiled, tiled_pitch,
+                (uint8_t *)linear, linear_pitch,
+                x, y, width, height, true);
+}
+
+void
+tiled_memcpy_tiled_to_linear(enum tiled_memcpy_tiling tiling, unsigned cpp,
+                             void *linear, int32_t linear_pitch,
+                             const void *tiled, uint32_t tiled_pitch,
+                             uint32_t x, uint32_t y,
+                             uint32_t width, uint32_t height)
+{
+   tiled_memcpy(selected_kernels(), tiling, cpp, (uint8_t *)tiled,
+                tiled_pitch, linear, linear_pitch,
+                x, y, width, height, false);
+}
+
+void
+tiled_memcpy_linear_to_tiled_isa(enum tiled_memcpy_isa isa,
+                                 enum tiled_memcpy_tiling tiling, unsigned cpp,
+                                 void *tiled, uint32_t tiled_pitch,
+                                 const void *linear, int32_t linear_pitch,
+                                 uint32_t x, uint32_t y,
+                                 uint32_t width, uint32_t height)
+{
+   assert(tiled_memcpy_isa_supported(isa));
+
+   tiled_memcpy(get_kernels(isa), tiling, cpp, tiled, tiled_pitch,
+                (uint8_t *)linear, linear_pitch,
+                x, y, width, height, true);
+}
+
+void
+tiled_memcpy_tiled_to_linear_isa(enum tiled_memcpy_isa isa,
+                                 enum tiled_memcpy_tiling tiling, unsigned cpp,
+                                 void *linear, int32_t linear_pitch,
+                                 const void *tiled, uint32_t tiled_pitch,
+                                 uint32_t x, uint32_t y,
+                                 uint32_t width, uint32_t height)
+{
+   assert(tiled_memcpy_isa_supported(isa));
+
+   tiled_memcpy(get_kernels(isa), tiling, cpp, (uint8_t *)tiled,
+                tiled_pitch, linear, linear_pitch,
+                x, y, width, height, false);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Format-agnostic copies between linear and tiled image layouts.
+ *
+ * Every supported tiling is described as a grid of "blocks": a block is
+ * span bytes wide and some number of rows high, and stored contiguously,
+ * one row after the other.  Whole blocks are copied with SIMD kernels
+ * picked for the CPU at runtime, partial blocks at the edges of the copied
+ * rectangle with plain memcpy.
+ *
+ * Texel contents are copied verbatim, so only the texel size matters.
+ */
+
+#ifndef TILED_MEMCPY_H
+#define TILED_MEMCPY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum tiled_memcpy_tiling {
+   /** Intel X tiles: 4KB, 512 bytes by 8 rows, rows stored in order */
+   TILED_MEMCPY_INTEL_X,
+   /** Intel Y tiles: 4KB, 128 bytes by 32 rows, in columns of 16 bytes */
+   TILED_MEMCPY_INTEL_Y,
+   /** VC4 LT: 64 byte microtiles in raster order */
+   TILED_MEMCPY_VC4_LT,
+   /** VC4 T: 4KB tiles of 2x2 1KB subtiles of 4x4 microtiles */
+   TILED_MEMCPY_VC4_T,
+};
+
+enum tiled_memcpy_isa {
+   TILED_MEMCPY_ISA_SCALAR,
+   TILED_MEMCPY_ISA_SSE2,
+   TILED_MEMCPY_ISA_AVX2,
+   TILED_MEMCPY_ISA_NEON,
+};
+
+/**
+ * Copy a width x height pixel rectangle from linear memory into the tiled
+ * surface at (x, y).
+ *
+ * \param cpp           bytes per texel: 1, 2, 4, 8 or 16 (1 to 8 for VC4)
+ * \param tiled_pitch   bytes per pixel row of the tiled surface, a whole
+ *                      number of tiles (of 8 microtiles for VC4 T)
+ * \param linear        first pixel of the rectangle in linear memory
+ */
+void
+tiled_memcpy_linear_to_tiled(enum tiled_memcpy_tiling tiling, unsigned cpp,
+                             void *tiled, uint32_t tiled_pitch,
+                             const void *linear, int32_t linear_pitch,
+                             uint32_t x, uint32_t y,
+                             uint32_t width, uint32_t height);
+
+/**
+ * Copy the width x height pixel rectangle at (x, y) of the tiled surface
+ * into linear memory.  See tiled_memcpy_linear_to_tiled().
+ */
+void
+tiled_memcpy_tiled_to_linear(enum tiled_memcpy_tiling tiling, unsigned cpp,
+                             void *linear, int32_t linear_pitch,
+                             const void *tiled, uint32_t tiled_pitch,
+                             uint32_t x, uint32_t y,
+                             uint32_t width, uint32_t height);
+
+/** Whether this build and CPU can run the given kernels. */
+bool
+tiled_memcpy_isa_supported(enum tiled_memcpy_isa isa);
+
+/** The kernels currently in use, the best supported ones by default. */
+enum tiled_memcpy_isa
+tiled_memcpy_get_isa(void);
+
+/**
+ * tiled_memcpy_linear_to_tiled() with the given kernels rather than the
+ * best supported ones, mainly for testing.
+ */
+void
+tiled_memcpy_linear_to_tiled_isa(enum tiled_memcpy_isa isa,
+                                 enum tiled_memcpy_tiling tiling, unsigned cpp,
+                                 void *tiled, uint32_t tiled_pitch,
+                                 const void *linear, int32_t linear_pitch,
+                                 uint32_t x, uint32_t y,
+                                 uint32_t width, uint32_t height);
+
+/** tiled_memcpy_tiled_to_linear() with the given kernels. */
+void
+tiled_memcpy_tiled_to_linear_isa(enum tiled_memcpy_isa isa,
+                                 enum tiled_memcpy_tiling tiling, unsigned cpp,
+                                 void *linear, int32_t linear_pitch,
+                                 const void *tiled, uint32_t tiled_pitch,
+                                 uint32_t x, uint32_t y,
+                                 uint32_t width, uint32_t height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TILED_MEMCPY_H */
@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Kernels for CPUs with AVX2.  This file is compiled with -mavx2, so
+ * nothing here may be called before checking for AVX2 support.
+ */
+
+#include <immintrin.h>
+
+#include "tiled_memcpy_priv.h"
+
+static void
+block_to_tiled_avx2(uint8_t *tiled, const uint8_t *linear,
+                    int32_t linear_pitch, uint32_t span, uint32_t rows)
+{
+   if (span == 8) {
+      for (uint32_t r = 0; r < rows; r++) {
+         _mm_storel_epi64((__m128i *)tiled,
+                          _mm_loadl_epi64((const __m128i *)linear));
+         tiled += 8;
+         linear += linear_pitch;
+      }
+      return;
+   }
+
+   if (span == 16) {
+      /* Two rows are contiguous in the tiled block. */
+      for (uint32_t r = 0; r < rows; r += 2) {
+         __m128i lo = _mm_loadu_si128((const __m128i *)linear);
+         __m128i hi = _mm_loadu_si128((const __m128i *)(linear + linear_pitch));
+         _mm256_storeu_si256((__m256i *)tiled,
+                             _mm256_inserti128_si256(_mm256_castsi128_si256(lo),
+                                                     hi, 1));
+         tiled += 32;
+         linear += 2 * linear_pitch;
+      }
+      return;
+   }
+
+   for (uint32_t r = 0; r < rows; r++) {
+      for (uint32_t x = 0; x < span; x += 32) {
+         _mm256_storeu_si256((__m256i *)(tiled + x),
+                             _mm256_loadu_si256((const __m256i *)(linear + x)));
+      }
+      tiled += span;
+      linear += linear_pitch;
+   }
+}
+
+static void
+block_to_linear_avx2(uint8_t *linear, int32_t linear_pitch,
+                     const uint8_t *tiled, uint32_t span, uint32_t rows)
+{
+   if (span == 8) {
+      for (uint32_t r = 0; r < rows; r++) {
+         _mm_storel_epi64((__m128i *)linear,
+                          _mm_loadl_epi64((const __m128i *)tiled));
+         tiled += 8;
+         linear += linear_pitch;
+      }
+      return;
+   }
+
+   if (span == 16) {
+      for (uint32_t r = 0; r < rows; r += 2) {
+         __m256i v = _mm256_loadu_si256((const __m256i *)tiled);
+         _mm_storeu_si128((__m128i *)linear, _mm256_castsi256_si128(v));
+         _mm_storeu_si128((__m128i *)(linear + linear_pitch),
+                          _mm256_extracti128_si256(v, 1));
+         tiled += 32;
+         linear += 2 * linear_pitch;
+      }
+      return;
+   }
+
+   for (uint32_t r = 0; r < rows; r++) {
+      for (uint32_t x = 0; x < span; x += 32) {
+         _mm256_storeu_si256((__m256i *)(linear + x),
+                             _mm256_loadu_si256((const __m256i *)(tiled + x)));
+      }
+      tiled += span;
+      linear += linear_pitch;
+   }
+}
+
+const struct tiled_memcpy_kernels tiled_memcpy_avx2_kernels = {
+   block_to_tiled_avx2,
+   block_to_linear_avx2,
+};
@@ -0,0 +1,46 @@
+/*
+ * Copyright © 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef TILED_MEMCPY_PRIV_H
+#define TILED_MEMCPY_PRIV_H
+
+#include <stdint.h>
+
+/**
+ * Copies of one whole block, which is span bytes wide and rows rows high
+ * and stored contiguously in the tiled surface.  span is 8, 16 or a
+ * multiple of 32.
+ */
+struct tiled_memcpy_kernels {
+   void (*to_tiled)(uint8_t *tiled, const uint8_t *linear,
+                    int32_t linear_pitch, uint32_t span, uint32_t rows);
+   void (*to_linear)(uint8_t *linear, int32_t linear_pitch,
+                     const uint8_t *tiled, uint32_t span, uint32_t rows);
+};
+
+#ifdef USE_AVX2
+/* Built separately with AVX2 enabled, see tiled_memcpy_avx2.c */
+extern const struct tiled_memcpy_kernels tiled_memcpy_avx2_kernels;
+#endif
+
+#endif /* TILED_MEMCPY_PRIV_H */